@@ -62,6 +62,18 @@ static cll::opt<std::string>
                                  "checkpoint data:"
                                  " Default checkpoint_#hostId"),
                        cll::init("checkpoint"));
+static cll::opt<bool>
+    checkpointAsync("checkpointAsync",
+                    cll::desc("Write checkpoints to disk in the background "
+                              "while computation continues: Default true"),
+                    cll::init(true));
+static cll::opt<unsigned int> checkpointFullInterval(
+    "checkpointFullInterval",
+    cll::desc("Number of incremental checkpoints after which a full "
+              "checkpoint is written; 0 means only the first checkpoint "
+              "is full; apps that do not track their writes always write "
+              "full checkpoints: Default 8"),
+    cll::init(8));
 
 /**
  * Choose crashNumHosts hosts to crash.
@@ -102,7 +114,8 @@ void saveCheckpointToDisk(unsigned _num_iterations, GraphTy& _graph) {
       }
 
       TimerSaveCheckpoint.start();
-      _graph.checkpointSaveNodeData(checkpointFileName);
+      _graph.checkpointSaveNodeData(checkpointFileName, checkpointAsync,
+                                    checkpointFullInterval);
       TimerSaveCheckpoint.stop();
       galois::runtime::getHostBarrier().wait();
     }
@@ -178,6 +191,10 @@ void crashSite(GraphTy& _graph) {
       galois::runtime::reportParam("RECOVERY", "RecoveryScheme", "CHECKPOINT");
       galois::runtime::reportParam("RECOVERY", "CheckpointInterval",
                                    (checkpointInterval));
+      galois::runtime::reportParam("RECOVERY", "CheckpointAsync",
+                                   (checkpointAsync));
+      galois::runtime::reportParam("RECOVERY", "CheckpointFullInterval",
+                                   (checkpointFullInterval));
     }
     galois::gPrint("[", net.ID, "] Using CP\n");
 
@@ -197,6 +214,10 @@ void crashSite(GraphTy& _graph) {
       galois::runtime::reportParam("RECOVERY", "RecoveryScheme", "HYBRID");
       galois::runtime::reportParam("RECOVERY", "CheckpointInterval",
                                    (checkpointInterval));
+      galois::runtime::reportParam("RECOVERY", "CheckpointAsync",
+                                   (checkpointAsync));
+      galois::runtime::reportParam("RECOVERY", "CheckpointFullInterval",
+                                   (checkpointFullInterval));
     }
     galois::gPrint("[", net.ID, "] Using HR\n");
 
@@ -291,6 +312,10 @@ void crashSite(GraphTy& _graph) {
       galois::runtime::reportParam("RECOVERY", "RecoveryScheme", "CHECKPOINT");
       galois::runtime::reportParam("RECOVERY", "CheckpointInterval",
                                    (checkpointInterval));
+      galois::runtime::reportParam("RECOVERY", "CheckpointAsync",
+                                   (checkpointAsync));
+      galois::runtime::reportParam("RECOVERY", "CheckpointFullInterval",
+                                   (checkpointFullInterval));
     }
     galois::gPrint("[", net.ID, "] Using CP\n");
     // Crashed hosts need to reconstruct local graphs
@@ -309,6 +334,10 @@ void crashSite(GraphTy& _graph) {
       galois::runtime::reportParam("RECOVERY", "RecoveryScheme", "HYBRID");
       galois::runtime::reportParam("RECOVERY", "CheckpointInterval",
                                    (checkpointInterval));
+      galois::runtime::reportParam("RECOVERY", "CheckpointAsync",
+                                   (checkpointAsync));
+      galois::runtime::reportParam("RECOVERY", "CheckpointFullInterval",
+                                   (checkpointFullInterval));
     }
     galois::gPrint("[", net.ID, "] Using HR\n");
 
@@ -260,8 +260,7 @@ struct recovery {
   recovery(Graph* _graph) : graph(_graph) {}
 
   void static go(Graph& _graph) {
-    _graph.sync<writeAny, readAny, Reduce_max_value, Broadcast_value>(
-        "RECOVERY_VALUE");
+    _graph.sync<writeAny, readAny, Reduce_max_value>("RECOVERY_VALUE");
 
     // const auto& nodesWithEdges = _graph.allNodesWithEdgesRange();
     const auto& allNodes = _graph.allNodesRange();
@@ -396,8 +395,8 @@ struct PageRank {
 
           //_graph.sync<writeSource, readAny, Reduce_add_residual,
           //Bitset_residual>("PageRank-afterCrash");
-          _graph.sync<writeSource, readAny, Reduce_add_residual,
-                      Broadcast_residual>("RECOVERY_PageRank");
+          _graph.sync<writeSource, readAny, Reduce_add_residual>(
+              "RECOVERY_PageRank");
           bitset_residual.reset();
 
           crashSiteAdjust<recoveryAdjust>(_graph);
@@ -44,6 +44,7 @@ extern cll::opt<int> numThreads;
 extern cll::opt<int> numRuns;
 extern cll::opt<std::string> statFile;
 extern cll::opt<bool> verify;
+extern cll::opt<bool> overlapSync;
 
 #ifdef __GALOIS_HET_CUDA__
 enum Personality { CPU, GPU_CUDA };
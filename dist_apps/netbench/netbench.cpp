@@ -0,0 +1,215 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+/**
+ * @file netbench.cpp
+ *
+ * Ping-pong and all-to-all microbenchmarks for the buffered network
+ * interface, e.g.
+ *
+ *   mpirun -np 2 ./netbench -maxSize=4194304
+ *
+ * Ping-pong runs between hosts 0 and 1 and reports the half round trip time.
+ * All-to-all has every host send a batch of messages to every other host per
+ * round (exercising message aggregation) and reports the bytes each host
+ * receives per second. Received payloads are checked.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+#include "galois/Galois.h"
+#include "galois/Timer.h"
+#include "galois/runtime/Network.h"
+#include "galois/runtime/NetworkIO.h"
+#include "llvm/Support/CommandLine.h"
+
+namespace cll = llvm::cl;
+
+static cll::opt<unsigned> minSize("minSize",
+                                  cll::desc("Smallest message size in bytes "
+                                            "(default 8)"),
+                                  cll::init(8));
+static cll::opt<unsigned> maxSize("maxSize",
+                                  cll::desc("Largest message size in bytes "
+                                            "(default 1MB)"),
+                                  cll::init(1 << 20));
+static cll::opt<unsigned> iterations("iters",
+                                     cll::desc("Rounds per size for messages "
+                                               "up to 64KB (default 1000)"),
+                                     cll::init(1000));
+static cll::opt<unsigned> batch("batch",
+                                cll::desc("Messages per destination per "
+                                          "all-to-all round (default 16)"),
+                                cll::init(16));
+static cll::opt<bool> skipPingPong("noPingPong",
+                                   cll::desc("Skip the ping-pong benchmark"),
+                                   cll::init(false));
+static cll::opt<bool> skipAllToAll("noAllToAll",
+                                   cll::desc("Skip the all-to-all benchmark"),
+                                   cll::init(false));
+
+using namespace galois::runtime;
+
+//! larger messages get fewer rounds so each size moves similar volume
+static unsigned roundsFor(size_t size) {
+  return std::max<size_t>(10, iterations / std::max<size_t>(1, size >> 16));
+}
+
+static void nextPhase() {
+  ++evilPhase;
+  if (evilPhase >= std::numeric_limits<int16_t>::max()) {
+    evilPhase = 1;
+  }
+}
+
+//! payload of size bytes filled with a byte identifying the sender
+static void fill(SendBuffer& b, size_t size, uint32_t sender) {
+  b.resize(size);
+  memset(b.getVec().data(), sender + 1, size);
+}
+
+static void check(RecvBuffer& b, size_t size, uint32_t sender) {
+  const uint8_t* p = b.r_linearData();
+  uint8_t expect   = sender + 1;
+  if (b.r_size() != size || p[0] != expect || p[size / 2] != expect ||
+      p[size - 1] != expect) {
+    GALOIS_DIE("corrupt message from host ", sender, " of size ", size);
+  }
+}
+
+static std::pair<uint32_t, RecvBuffer> receive(NetworkInterface& net) {
+  decltype(net.recieveTagged(evilPhase, nullptr)) p;
+  do {
+    p = net.recieveTagged(evilPhase, nullptr);
+  } while (!p);
+  return std::move(*p);
+}
+
+static void pingPong(NetworkInterface& net) {
+  if (net.ID == 0) {
+    std::cout << "ping-pong\n"
+              << std::setw(10) << "bytes" << std::setw(14) << "usec"
+              << std::setw(14) << "MB/s" << "\n";
+  }
+  for (size_t size = minSize; size <= maxSize; size *= 2) {
+    unsigned rounds = roundsFor(size);
+    getHostBarrier().wait();
+    galois::Timer timer;
+    timer.start();
+    if (net.ID < 2) {
+      uint32_t peer = 1 - net.ID;
+      for (unsigned r = 0; r < rounds; ++r) {
+        if (net.ID == 0) {
+          SendBuffer b;
+          fill(b, size, net.ID);
+          net.sendTagged(peer, evilPhase, b);
+          net.flush();
+          auto p = receive(net);
+          check(p.second, size, peer);
+        } else {
+          auto p = receive(net);
+          check(p.second, size, peer);
+          SendBuffer b;
+          fill(b, size, net.ID);
+          net.sendTagged(peer, evilPhase, b);
+          net.flush();
+        }
+      }
+    }
+    timer.stop();
+    nextPhase();
+    if (net.ID == 0) {
+      double usec = (double)timer.get_usec() / rounds / 2;
+      std::cout << std::setw(10) << size << std::setw(14) << std::fixed
+                << std::setprecision(2) << usec << std::setw(14)
+                << size / usec << "\n";
+    }
+  }
+}
+
+static void allToAll(NetworkInterface& net) {
+  if (net.ID == 0) {
+    std::cout << "all-to-all, " << batch << " messages per destination\n"
+              << std::setw(10) << "bytes" << std::setw(14) << "usec/round"
+              << std::setw(14) << "MB/s/host" << "\n";
+  }
+  for (size_t size = minSize; size <= maxSize; size *= 2) {
+    unsigned rounds = std::max(1u, roundsFor(size) / batch);
+    getHostBarrier().wait();
+    galois::Timer timer;
+    timer.start();
+    for (unsigned r = 0; r < rounds; ++r) {
+      for (uint32_t h = 0; h < net.Num; ++h) {
+        if (h == net.ID)
+          continue;
+        for (unsigned m = 0; m < batch; ++m) {
+          SendBuffer b;
+          fill(b, size, net.ID);
+          net.sendTagged(h, evilPhase, b);
+        }
+      }
+      net.flush();
+      for (unsigned m = 0; m < (net.Num - 1) * batch; ++m) {
+        auto p = receive(net);
+        check(p.second, size, p.first);
+      }
+      nextPhase();
+    }
+    timer.stop();
+    getHostBarrier().wait();
+    if (net.ID == 0) {
+      double usec = (double)timer.get_usec() / rounds;
+      std::cout << std::setw(10) << size << std::setw(14) << std::fixed
+                << std::setprecision(2) << usec << std::setw(14)
+                << (net.Num - 1) * batch * size / usec << "\n";
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  cll::ParseCommandLineOptions(argc, argv);
+
+  auto& net = getSystemNetworkInterface();
+  if (net.Num < 2) {
+    GALOIS_DIE("netbench needs at least 2 hosts");
+  }
+  if (minSize == 0 || minSize > maxSize) {
+    GALOIS_DIE("invalid message size range");
+  }
+
+  if (!skipPingPong)
+    pingPong(net);
+  if (!skipAllToAll)
+    allToAll(net);
+
+  getHostBarrier().wait();
+  if (net.ID == 0) {
+    auto& pool = getNetworkBufferPool();
+    std::cout << "buffer pool hits " << pool.hits << " misses " << pool.misses
+              << "\n";
+  }
+  internal::destroySystemNetworkInterface();
+  return 0;
+}
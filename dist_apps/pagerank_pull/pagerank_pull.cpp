@@ -234,27 +234,46 @@ struct PageRank {
       // reset residual on mirrors
       _graph.reset_mirrorField<Reduce_add_residual>();
 
+      if (overlapSync) {
+        // residuals of boundary nodes are reduced while the interior nodes
+        // pull
+        galois::do_all(
+            galois::iterate(_graph.boundaryNodesRange<writeSource>()),
+            PageRank{&_graph}, galois::steal(), galois::no_stats(),
+            galois::loopname(
+                _graph.get_run_identifier("PageRank_Boundary").c_str()));
+        _graph.sync_boundary<writeSource, readDestination, Reduce_add_residual,
+                             Bitset_residual>("PageRank");
+        galois::do_all(
+            galois::iterate(_graph.interiorNodesRange<writeSource>()),
+            PageRank{&_graph}, galois::steal(), galois::no_stats(),
+            galois::loopname(
+                _graph.get_run_identifier("PageRank_Interior").c_str()));
+        _graph.sync_complete<writeSource, readDestination, Reduce_add_residual,
+                             Bitset_residual>("PageRank");
+      } else {
 #ifdef __GALOIS_HET_CUDA__
-      if (personality == GPU_CUDA) {
-        std::string impl_str("PageRank_" + (_graph.get_run_identifier()));
-        galois::StatTimer StatTimer_cuda(impl_str.c_str(), REGION_NAME);
-        StatTimer_cuda.start();
-        PageRank_nodesWithEdges_cuda(cuda_ctx);
-        StatTimer_cuda.stop();
-      } else if (personality == CPU)
+        if (personality == GPU_CUDA) {
+          std::string impl_str("PageRank_" + (_graph.get_run_identifier()));
+          galois::StatTimer StatTimer_cuda(impl_str.c_str(), REGION_NAME);
+          StatTimer_cuda.start();
+          PageRank_nodesWithEdges_cuda(cuda_ctx);
+          StatTimer_cuda.stop();
+        } else if (personality == CPU)
 #endif
-        galois::do_all(
-            galois::iterate(nodesWithEdges), PageRank{&_graph}, galois::steal(),
-            galois::no_stats(),
-            galois::loopname(_graph.get_run_identifier("PageRank").c_str()));
+          galois::do_all(
+              galois::iterate(nodesWithEdges), PageRank{&_graph},
+              galois::steal(), galois::no_stats(),
+              galois::loopname(_graph.get_run_identifier("PageRank").c_str()));
 
 #ifdef __GALOIS_HET_ASYNC__
-      _graph.sync<writeSource, readDestination, Reduce_add_residual,
-                  Bitset_residual, true>("PageRank");
+        _graph.sync<writeSource, readDestination, Reduce_add_residual,
+                    Bitset_residual, true>("PageRank");
 #else
-      _graph.sync<writeSource, readDestination, Reduce_add_residual,
-                  Bitset_residual>("PageRank");
+        _graph.sync<writeSource, readDestination, Reduce_add_residual,
+                    Bitset_residual>("PageRank");
 #endif
+      }
 
       galois::runtime::reportStat_Tsum(
           REGION_NAME, "NumWorkItems_" + (_graph.get_run_identifier()),
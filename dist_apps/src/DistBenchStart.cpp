@@ -41,6 +41,12 @@ cll::opt<bool> verify("verify",
                       cll::desc("Verify results by outputting results "
                                 "to file (default false)"),
                       cll::init(false));
+cll::opt<bool> overlapSync("overlapSync",
+                           cll::desc("Overlap the reduce of boundary nodes "
+                                     "with the computation of interior nodes "
+                                     "in apps that support it (default "
+                                     "false)"),
+                           cll::init(false));
 
 #ifdef __GALOIS_HET_CUDA__
 std::string personality_str(Personality p) {
@@ -96,6 +102,12 @@ void DistBenchStart(int argc, char** argv, const char* app, const char* desc,
   numThreads = galois::setActiveThreads(numThreads);
   galois::runtime::setStatFile(statFile);
 
+#ifdef __GALOIS_HET_ASYNC__
+  if (overlapSync) {
+    GALOIS_DIE("overlapSync requires bulk-synchronous execution");
+  }
+#endif
+
   auto& net = galois::runtime::getSystemNetworkInterface();
 
   if (net.ID == 0) {
@@ -173,6 +185,9 @@ void internal::heteroSetup(std::vector<unsigned>& scaleFactor) {
     }
 
     if (personality == GPU_CUDA) {
+      if (overlapSync) {
+        GALOIS_DIE("overlapSync is only supported on CPU hosts");
+      }
       gpudevice = get_gpu_device_id(personality_set, num_nodes);
     } else {
       gpudevice = -1;
@@ -208,34 +208,57 @@ struct SSSP {
       _graph.set_num_round(_num_iterations);
       dga.reset();
       work_items.reset();
-#ifdef __GALOIS_HET_CUDA__
-      if (personality == GPU_CUDA) {
-        std::string impl_str("SSSP_" + (_graph.get_run_identifier()));
-        galois::StatTimer StatTimer_cuda(impl_str.c_str(), REGION_NAME);
-        StatTimer_cuda.start();
-        unsigned int __retval = 0;
-        unsigned int __retval2 = 0;
-        SSSP_nodesWithEdges_cuda(__retval, __retval2, priority, cuda_ctx);
-        dga += __retval;
-        work_items += __retval2;
-        StatTimer_cuda.stop();
-      } else if (personality == CPU)
-#endif
-      {
+      if (overlapSync) {
+        // distances pushed to mirrors are reduced while the interior nodes
+        // relax their edges
         galois::do_all(
-            galois::iterate(nodesWithEdges), SSSP{priority, &_graph, dga, work_items},
-            galois::no_stats(),
-            galois::loopname(_graph.get_run_identifier("SSSP").c_str()),
+            galois::iterate(_graph.boundaryNodesRange<writeDestination>()),
+            SSSP{priority, &_graph, dga, work_items}, galois::no_stats(),
+            galois::loopname(
+                _graph.get_run_identifier("SSSP_Boundary").c_str()),
             galois::steal());
-      }
+        _graph.sync_boundary<writeDestination, readSource,
+                             Reduce_min_dist_current, Bitset_dist_current>(
+            "SSSP");
+        galois::do_all(
+            galois::iterate(_graph.interiorNodesRange<writeDestination>()),
+            SSSP{priority, &_graph, dga, work_items}, galois::no_stats(),
+            galois::loopname(
+                _graph.get_run_identifier("SSSP_Interior").c_str()),
+            galois::steal());
+        _graph.sync_complete<writeDestination, readSource,
+                             Reduce_min_dist_current, Bitset_dist_current>(
+            "SSSP");
+      } else {
+#ifdef __GALOIS_HET_CUDA__
+        if (personality == GPU_CUDA) {
+          std::string impl_str("SSSP_" + (_graph.get_run_identifier()));
+          galois::StatTimer StatTimer_cuda(impl_str.c_str(), REGION_NAME);
+          StatTimer_cuda.start();
+          unsigned int __retval = 0;
+          unsigned int __retval2 = 0;
+          SSSP_nodesWithEdges_cuda(__retval, __retval2, priority, cuda_ctx);
+          dga += __retval;
+          work_items += __retval2;
+          StatTimer_cuda.stop();
+        } else if (personality == CPU)
+#endif
+        {
+          galois::do_all(
+              galois::iterate(nodesWithEdges),
+              SSSP{priority, &_graph, dga, work_items}, galois::no_stats(),
+              galois::loopname(_graph.get_run_identifier("SSSP").c_str()),
+              galois::steal());
+        }
 
 #ifdef __GALOIS_HET_ASYNC__
-      _graph.sync<writeDestination, readSource, Reduce_min_dist_current,
-                  Bitset_dist_current, true>("SSSP");
+        _graph.sync<writeDestination, readSource, Reduce_min_dist_current,
+                    Bitset_dist_current, true>("SSSP");
 #else
-      _graph.sync<writeDestination, readSource, Reduce_min_dist_current,
-                  Bitset_dist_current>("SSSP");
+        _graph.sync<writeDestination, readSource, Reduce_min_dist_current,
+                    Bitset_dist_current>("SSSP");
 #endif
+      }
 
       galois::runtime::reportStat_Tsum(
           "SSSP", "NumWorkItems_" + (_graph.get_run_identifier()),
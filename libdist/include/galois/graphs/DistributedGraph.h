@@ -29,14 +29,21 @@
 
 #include <unordered_map>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <typeindex>
 
 #include "galois/runtime/GlobalObj.h"
 #include "galois/graphs/BufferedGraph.h"
 #include "galois/graphs/B_LC_CSR_Graph.h"
 #include "galois/runtime/DistStats.h"
+#include "galois/runtime/Timeline.h"
 #include "galois/graphs/OfflineGraph.h"
 #include "galois/runtime/SyncStructures.h"
 #include "galois/runtime/DataCommMode.h"
+#include "galois/runtime/DataCommEncoding.h"
+#include "galois/runtime/CheckpointWriter.h"
 #include "galois/DynamicBitset.h"
 
 #ifdef __GALOIS_HET_CUDA__
@@ -224,12 +231,65 @@ private:
   //! Like specificRanges, but for in edges
   std::vector<NodeRangeType> specificRangesIn;
 
+  //! Nodes with edges whose operator may write a mirror, indexed by
+  //! WriteLocation; see boundaryNodesRange
+  std::vector<uint32_t> boundaryNodes[3];
+  //! Nodes with edges whose operator only writes masters, indexed by
+  //! WriteLocation; see interiorNodesRange
+  std::vector<uint32_t> interiorNodes[3];
+  //! Marks which entries of boundaryNodes/interiorNodes have been computed
+  bool boundaryNodesReady[3] = {false, false, false};
+
+  //! True between sync_boundary and sync_complete if a reduce is in flight
+  bool overlapReducePending = false;
+  //! Measures the interior phase of an overlapped round
+  galois::Timer overlapInteriorTimer;
+  //! Time (usec) spent sending in sync_boundary for the current round
+  unsigned long overlapSendTime = 0;
+
 #ifdef __GALOIS_BARE_MPI_COMMUNICATION__
   std::vector<MPI_Group> mpi_identity_groups;
 #endif
 
   galois::DynamicBitSet syncBitset;
   galois::PODResizeableArray<unsigned int> syncOffsets;
+  //! Encoded metadata of a compressed data comm mode message
+  galois::runtime::EncodedBytes syncEncodedMetadata;
+  //! Encoded values of an xorDeltaData message
+  galois::runtime::EncodedBytes syncEncodedValues;
+
+  //! Type-erased xorDeltaData history of one sync structure and direction
+  struct XorHistoryBase {
+    virtual ~XorHistoryBase() {}
+  };
+  //! Values last exchanged with each host, indexed by offset into the nodes
+  //! shared with that host
+  template <typename ValTy>
+  struct XorHistory : public XorHistoryBase {
+    std::vector<galois::PODResizeableArray<ValTy>> hosts;
+  };
+  //! xorDeltaData histories keyed by sync structure, sync type and whether
+  //! they hold sent (true) or received (false) values; cleared whenever the
+  //! master/mirror lists are set up
+  std::map<std::tuple<std::type_index, SyncType, bool>,
+           std::unique_ptr<XorHistoryBase>>
+      xorHistories;
+
+#ifdef __GALOIS_CHECKPOINT__
+  //! Nodes written since the last checkpoint
+  galois::DynamicBitSet checkpointDirty;
+  //! Nodes written in the interval before the last checkpoint
+  galois::DynamicBitSet checkpointDirtyPrev;
+  //! If true, the next checkpoint has to save every node
+  bool checkpointAllDirty = true;
+  //! If true, writes outside of a sync are reported through
+  //! checkpointMarkNodeDirty, so delta checkpoints are safe
+  bool checkpointWritesTracked = false;
+  //! Number of delta checkpoints since the last full one
+  unsigned checkpointNumDeltas = 0;
+  //! Writes checkpoints in the background; created on the first checkpoint
+  std::unique_ptr<galois::runtime::CheckpointWriter> checkpointWriter;
+#endif
 
 protected:
   //! Prints graph statistics.
@@ -587,13 +647,25 @@ protected:
 
     timer.stop();
 
-    galois::runtime::reportStatCond_Tmax<MORE_DIST_STATS>(
-        GRNAME, "MasterDistTime", timer.get());
-
-    galois::gPrint(
-        "[", id, "] Master distribution time : ", timer.get_usec() / 1000000.0f,
-        " seconds to read ", g.num_bytes_read(), " bytes in ", g.num_seeks(),
-        " seeks (", g.num_bytes_read() / (float)timer.get_usec(), " MBPS)\n");
+    galois::runtime::reportParam(GRNAME, "OfflineGraphMapped",
+                                 g.isMapped() ? "1" : "0");
+    galois::runtime::reportStat_Tmax(GRNAME, "MasterDistTime", timer.get());
+    galois::runtime::reportStat_Tsum(GRNAME, "MasterDistBytesRead",
+                                     g.num_bytes_read());
+    galois::runtime::reportStat_Tsum(GRNAME, "MasterDistSeeks",
+                                     g.num_seeks());
+
+    if (g.isMapped()) {
+      galois::gPrint("[", id, "] Master distribution time : ",
+                     timer.get_usec() / 1000000.0f,
+                     " seconds reading from a file mapping\n");
+    } else {
+      galois::gPrint("[", id, "] Master distribution time : ",
+                     timer.get_usec() / 1000000.0f, " seconds to read ",
+                     g.num_bytes_read(), " bytes in ", g.num_seeks(),
+                     " seeks (", g.num_bytes_read() / (float)timer.get_usec(),
+                     " MBPS)\n");
+    }
     return numNodes_to_divide;
   }
 
@@ -674,6 +746,9 @@ public:
     numGlobalEdges = 0;
     currentBVFlag  = nullptr;
 
+    // sync bitsets are mostly sparse in late rounds
+    syncBitset.enable_summary();
+
     // report edge buffer size
     if (host == 0) {
       galois::runtime::reportStat_Single(GRNAME, "EdgePartitionBufferSize",
@@ -723,6 +798,9 @@ protected:
           galois::no_stats());
     }
 
+    // xorDeltaData histories are indexed by the old master/mirror lists
+    xorHistories.clear();
+
     Tcomm_setup.stop();
 
     maxSharedSize = 0;
@@ -1009,6 +1087,40 @@ public:
     return specificRangesIn[0];
   }
 
+  /**
+   * Returns the boundary nodes of this partition for an operator that writes
+   * at the given location: nodes with edges whose updates reach a mirror,
+   * i.e. mirrors with edges and, when writing at the destination, masters
+   * with an edge to a mirror. Local ids are in ascending order.
+   *
+   * Computing the boundary nodes first and passing them to sync_boundary
+   * lets the reduce of their results overlap with the interior phase.
+   * Computed on first use for each write location.
+   *
+   * @tparam writeLocation Location data is written (src or dst)
+   * @returns Local ids of the boundary nodes
+   */
+  template <WriteLocation writeLocation>
+  inline const std::vector<uint32_t>& boundaryNodesRange() {
+    determineBoundaryNodes<writeLocation>();
+    return boundaryNodes[writeLocation];
+  }
+
+  /**
+   * Returns the interior nodes of this partition for an operator that writes
+   * at the given location: masters with edges that are not boundary nodes,
+   * so their updates only reach masters. Together with boundaryNodesRange
+   * this covers allNodesWithEdgesRange.
+   *
+   * @tparam writeLocation Location data is written (src or dst)
+   * @returns Local ids of the interior nodes
+   */
+  template <WriteLocation writeLocation>
+  inline const std::vector<uint32_t>& interiorNodesRange() {
+    determineBoundaryNodes<writeLocation>();
+    return interiorNodes[writeLocation];
+  }
+
 protected:
   /**
    * Uses a pre-computed prefix sum to determine division of nodes among
@@ -1113,6 +1225,64 @@ protected:
    */
   void edgesEqualMasters() { specificRanges[2] = specificRanges[1]; }
 
+  /**
+   * Splits the nodes with edges into boundary and interior nodes for the
+   * given write location. Does nothing if already computed.
+   */
+  template <WriteLocation writeLocation>
+  void determineBoundaryNodes() {
+    if (boundaryNodesReady[writeLocation])
+      return;
+
+    galois::StatTimer Tboundary("BoundaryNodesTime", GRNAME);
+    Tboundary.start();
+
+    const uint32_t masterEnd = beginMaster + numOwned;
+    auto isMirror = [&](uint64_t n) {
+      return (n < beginMaster) || (n >= masterEnd);
+    };
+
+    galois::DynamicBitSet isBoundary;
+    isBoundary.resize(numNodesWithEdges);
+    galois::do_all(
+        galois::iterate((uint32_t)0, numNodesWithEdges),
+        [&](uint32_t n) {
+          if (isMirror(n)) {
+            isBoundary.set(n);
+            return;
+          }
+          if (writeLocation != writeSource) {
+            for (auto e = graph.edge_begin(n); e != graph.edge_end(n); ++e) {
+              if (isMirror(graph.getEdgeDst(e))) {
+                isBoundary.set(n);
+                return;
+              }
+            }
+          }
+        },
+        galois::no_stats(), galois::steal());
+
+    auto& boundary = boundaryNodes[writeLocation];
+    auto& interior = interiorNodes[writeLocation];
+    boundary.clear();
+    interior.clear();
+    for (uint32_t n = 0; n < numNodesWithEdges; ++n) {
+      if (isBoundary.test(n)) {
+        boundary.push_back(n);
+      } else {
+        interior.push_back(n);
+      }
+    }
+    boundaryNodesReady[writeLocation] = true;
+
+    Tboundary.stop();
+
+    galois::runtime::reportStat_Tsum(GRNAME, "BoundaryNodes",
+                                     boundary.size());
+    galois::runtime::reportStat_Tsum(GRNAME, "InteriorNodes",
+                                     interior.size());
+  }
+
   /**
    * Uses a pre-computed prefix sum to determine division of nodes among
    * threads using in-edges.
@@ -1303,24 +1473,11 @@ private:
 
     // count how many bits are set on each thread
     galois::on_each([&](unsigned tid, unsigned nthreads) {
-      // TODO use block_range instead
-      unsigned int block_size = bitset_comm.size() / nthreads;
-      if ((bitset_comm.size() % nthreads) > 0)
-        ++block_size;
-      assert((block_size * nthreads) >= bitset_comm.size());
-
-      unsigned int start = tid * block_size;
-      unsigned int end   = (tid + 1) * block_size;
-      if (end > bitset_comm.size())
-        end = bitset_comm.size();
-
-      unsigned int count = 0;
-      for (unsigned int i = start; i < end; ++i) {
-        if (bitset_comm.test(i))
-          ++count;
-      }
+      size_t start, end;
+      std::tie(start, end) =
+          galois::block_range((size_t)0, bitset_comm.size(), tid, nthreads);
 
-      t_prefix_bit_counts[tid] = count;
+      t_prefix_bit_counts[tid] = bitset_comm.count(start, end);
     });
 
     // calculate prefix sum of bits per thread
@@ -1335,18 +1492,9 @@ private:
     if (bit_set_count > 0) {
       offsets.resize(bit_set_count);
       galois::on_each([&](unsigned tid, unsigned nthreads) {
-        // TODO use block_range instead
-        // TODO this is same calculation as above; maybe refactor it
-        // into function?
-        unsigned int block_size = bitset_comm.size() / nthreads;
-        if ((bitset_comm.size() % nthreads) > 0)
-          ++block_size;
-        assert((block_size * nthreads) >= bitset_comm.size());
-
-        unsigned int start = tid * block_size;
-        unsigned int end   = (tid + 1) * block_size;
-        if (end > bitset_comm.size())
-          end = bitset_comm.size();
+        size_t start, end;
+        std::tie(start, end) =
+            galois::block_range((size_t)0, bitset_comm.size(), tid, nthreads);
 
         unsigned int count = 0;
         unsigned int t_prefix_bit_count;
@@ -1356,12 +1504,10 @@ private:
           t_prefix_bit_count = t_prefix_bit_counts[tid - 1];
         }
 
-        for (unsigned int i = start; i < end; ++i) {
-          if (bitset_comm.test(i)) {
-            offsets[t_prefix_bit_count + count] = i;
-            ++count;
-          }
-        }
+        bitset_comm.for_each_set(start, end, [&](size_t i) {
+          offsets[t_prefix_bit_count + count] = i;
+          ++count;
+        });
       });
     }
     Toffsets.stop();
@@ -1424,8 +1570,8 @@ private:
                                         bit_set_count);
     }
 
-    data_mode =
-        get_data_mode<typename FnTy::ValTy>(bit_set_count, indices.size());
+    data_mode = get_data_mode<typename FnTy::ValTy>(bit_set_count,
+                                                    indices.size(), true);
   }
 
   /**
@@ -1759,6 +1905,10 @@ private:
       if (async) FnTy::reduce(lid, getData(lid), val);
       else FnTy::setVal(lid, getData(lid), val);
     }
+#ifdef __GALOIS_CHECKPOINT__
+    if (checkpointDirty.size() != 0)
+      checkpointDirty.set(lid);
+#endif
   }
 
   /**
@@ -1790,6 +1940,10 @@ private:
       if (async) FnTy::reduce(lid, getData(lid), val, vecIndex);
       else FnTy::setVal(lid, getData(lid), val, vecIndex);
     }
+#ifdef __GALOIS_CHECKPOINT__
+    if (checkpointDirty.size() != 0)
+      checkpointDirty.set(lid);
+#endif
   }
 
   /**
@@ -1952,12 +2106,12 @@ private:
   template <typename FnTy, SyncType syncType, bool async>
   inline bool set_batch_wrapper(unsigned x, galois::runtime::RecvBuffer& b) {
     if (syncType == syncReduce) {
-      return FnTy::reduce_batch(x, b.getVec().data() + b.getOffset());
+      return FnTy::reduce_batch(x, b.r_linearData());
     } else {
       if (async) {
-        return FnTy::reduce_mirror_batch(x, b.getVec().data() + b.getOffset());
+        return FnTy::reduce_mirror_batch(x, b.r_linearData());
       } else {
-        return FnTy::setVal_batch(x, b.getVec().data() + b.getOffset());
+        return FnTy::setVal_batch(x, b.r_linearData());
       }
     }
   }
@@ -1982,12 +2136,12 @@ private:
   inline bool set_batch_wrapper(unsigned x, galois::runtime::RecvBuffer& b,
                                 DataCommMode& data_mode) {
     if (syncType == syncReduce) {
-      return FnTy::reduce_batch(x, b.getVec().data() + b.getOffset(), data_mode);
+      return FnTy::reduce_batch(x, b.r_linearData(), data_mode);
     } else {
       if (async) {
-        return FnTy::reduce_mirror_batch(x, b.getVec().data() + b.getOffset(), data_mode);
+        return FnTy::reduce_mirror_batch(x, b.r_linearData(), data_mode);
       } else {
-        return FnTy::setVal_batch(x, b.getVec().data() + b.getOffset(), data_mode);
+        return FnTy::setVal_batch(x, b.r_linearData(), data_mode);
       }
     }
   }
@@ -2237,14 +2391,82 @@ private:
     }
   }
 
+  /**
+   * Returns the values last exchanged with a host for a sync structure in
+   * xorDeltaData mode. Both ends of a message keep the same history, so
+   * values can be sent XORed against it. Histories belong to this graph and
+   * start from zero whenever its master/mirror lists are set up.
+   *
+   * @tparam SyncFnTy synchronization structure whose values are kept
+   * @tparam syncType either reduce or broadcast
+   * @tparam sending true for the history of sent values, false for the
+   * history of received values
+   *
+   * @param host host on the other end of the message
+   * @param num number of nodes shared with that host
+   * @returns history of values indexed by offset into the shared nodes
+   */
+  template <typename SyncFnTy, SyncType syncType, bool sending>
+  galois::PODResizeableArray<typename SyncFnTy::ValTy>&
+  get_xor_history(unsigned host, size_t num) {
+    using ValTy = typename SyncFnTy::ValTy;
+    auto& entry = xorHistories[std::make_tuple(
+        std::type_index(typeid(SyncFnTy)), syncType, sending)];
+    if (!entry) {
+      auto history = std::make_unique<XorHistory<ValTy>>();
+      history->hosts.resize(numHosts);
+      entry = std::move(history);
+    }
+    auto& hostHistory =
+        static_cast<XorHistory<ValTy>*>(entry.get())->hosts[host];
+    if (hostHistory.size() != num) {
+      hostHistory.resize(num);
+      std::memset(hostHistory.data(), 0, num * sizeof(ValTy));
+    }
+    return hostHistory;
+  }
+
+  /**
+   * Reports the bytes a compressed data comm mode message takes compared to
+   * the bytes the same message would take in offsetsData mode.
+   *
+   * @tparam SyncFnTy synchronization structure with info needed to synchronize
+   *
+   * @param loopName loop name used for the stat
+   * @param syncTypeStr either "Reduce" or "Broadcast"
+   * @param bitSetCount number of values in the message
+   * @param compressedSize number of bytes of the compressed message
+   */
+  template <typename SyncFnTy>
+  void reportCompressedSize(std::string loopName, std::string syncTypeStr,
+                            size_t bitSetCount, size_t compressedSize) {
+    size_t rawSize = sizeof(DataCommMode) + sizeof(bitSetCount) +
+                     sizeof(size_t) + (bitSetCount * sizeof(unsigned int)) +
+                     sizeof(size_t) +
+                     (bitSetCount * sizeof(typename SyncFnTy::ValTy));
+
+    galois::runtime::reportStat_Tsum(
+        GRNAME, syncTypeStr + "RawBytes_" + get_run_identifier(loopName),
+        rawSize);
+    galois::runtime::reportStat_Tsum(
+        GRNAME, syncTypeStr + "CompressedBytes_" + get_run_identifier(loopName),
+        compressedSize);
+  }
+
   /**
    * Given data to serialize in val_vec, serialize it into the send buffer
    * depending on the mode of data communication selected for the data.
    *
+   * @tparam async true if the message is sent asynchronously
    * @tparam syncType either reduce or broadcast
+   * @tparam SyncFnTy synchronization structure with info needed to synchronize
+   * @tparam vecSync true if val_vec holds one element of a vector field;
+   * xorDeltaData is not supported for these or for async messages and falls
+   * back to offsetsVarintData
    * @tparam VecType type of val_vec, which stores the data to send
    *
    * @param loopName loop name used for timers
+   * @param host host the message is sent to
    * @param data_mode the way that the data should be communicated
    * @param bit_set_count the number of items we are sending in this message
    * @param indices list of all nodes that we are potentially interested in
@@ -2254,8 +2476,10 @@ private:
    * @param b the buffer in which to serialize the message we are sending
    * to
    */
-  template <bool async, SyncType syncType, typename VecType>
-  void serializeMessage(std::string loopName, DataCommMode data_mode,
+  template <bool async, SyncType syncType, typename SyncFnTy,
+            bool vecSync = false, typename VecType>
+  void serializeMessage(std::string loopName, unsigned host,
+                        DataCommMode data_mode,
                         size_t bit_set_count, std::vector<size_t>& indices,
                         galois::PODResizeableArray<unsigned int>& offsets,
                         galois::DynamicBitSet& bit_set_comm, VecType& val_vec,
@@ -2289,6 +2513,34 @@ private:
       Tserialize.start();
       gSerialize(b, data_mode, bit_set_count, bit_set_comm, val_vec);
       Tserialize.stop();
+    } else if (data_mode == offsetsVarintData || data_mode == bitsetRLEData ||
+               data_mode == xorDeltaData) {
+      if (data_mode == xorDeltaData && (async || vecSync)) {
+        data_mode = offsetsVarintData;
+      }
+      size_t startSize = b.size();
+      Tserialize.start();
+      if (data_mode == bitsetRLEData) {
+        galois::runtime::encodeOffsetsRLE(offsets, bit_set_count,
+                                          syncEncodedMetadata);
+      } else {
+        galois::runtime::encodeOffsetsVarint(offsets, bit_set_count,
+                                             syncEncodedMetadata);
+      }
+      if (data_mode == xorDeltaData) {
+        auto& history =
+            get_xor_history<SyncFnTy, syncType, true>(host, indices.size());
+        galois::runtime::encodeValuesXor(val_vec, offsets, bit_set_count,
+                                         history, syncEncodedValues);
+        gSerialize(b, data_mode, bit_set_count, syncEncodedMetadata,
+                   syncEncodedValues);
+      } else {
+        val_vec.resize(bit_set_count);
+        gSerialize(b, data_mode, bit_set_count, syncEncodedMetadata, val_vec);
+      }
+      Tserialize.stop();
+      reportCompressedSize<SyncFnTy>(loopName, syncTypeStr, bit_set_count,
+                                     b.size() - startSize);
     } else { // onlyData
       Tserialize.start();
       gSerialize(b, data_mode, val_vec);
@@ -2408,8 +2660,9 @@ private:
           extract_subset<SyncFnTy, syncType, false, true>(
               loopName, indices, bit_set_count, offsets, val_vec);
         }
-        serializeMessage<async, syncType>(loopName, data_mode, bit_set_count, indices,
-                                   offsets, bit_set_comm, val_vec, b);
+        serializeMessage<async, syncType, SyncFnTy>(
+            loopName, from_id, data_mode, bit_set_count, indices, offsets,
+            bit_set_comm, val_vec, b);
       } else {
         if (data_mode == noData) {
           b.resize(0);
@@ -2547,8 +2800,9 @@ private:
 
         reportRedundantSize<SyncFnTy>(loopName, syncTypeStr, num, bit_set_count,
                                       bit_set_comm);
-        serializeMessage<async, syncType>(loopName, data_mode, bit_set_count, indices,
-                                   offsets, bit_set_comm, val_vec, b);
+        serializeMessage<async, syncType, SyncFnTy, true>(
+            loopName, from_id, data_mode, bit_set_count, indices, offsets,
+            bit_set_comm, val_vec, b);
       } else {
         if (!async) { // TODO: is this fine?
           // append noData for however many bitsets there are
@@ -2769,6 +3023,14 @@ private:
     galois::CondStatTimer<MORE_COMM_STATS> TSendTime(
         (syncTypeStr + "Send_" + get_run_identifier(loopName)).c_str(), GRNAME);
 
+    galois::runtime::TimelineSpan span(
+        galois::runtime::internal::timelineEnabled()
+            ? galois::runtime::internal::timelineIntern(
+                  (syncTypeStr + "Send_" + get_run_identifier(loopName))
+                      .c_str())
+            : nullptr,
+        "sync");
+
     TSendTime.start();
     sync_net_send<writeLocation, readLocation, syncType, SyncFnTy, BitsetFnTy, async>(
         loopName);
@@ -2779,9 +3041,11 @@ private:
    * Given the data mode, deserialize the rest of a message in a Receive Buffer.
    *
    * @tparam syncType either reduce or broadcast
+   * @tparam SyncFnTy synchronization structure with info needed to synchronize
    * @tparam VecType type of val_vec, which data will be deserialized into
    *
    * @param loopName used to name timers for statistics
+   * @param from_id host the message was received from
    * @param data_mode data mode with which the original message was sent;
    * determines how to deserialize the rest of the message
    * @param buf buffer which contains the received message to deserialize
@@ -2799,8 +3063,9 @@ private:
    * @param retval
    * @param val_vec The data proper will be deserialized into this vector
    */
-  template <SyncType syncType, typename VecType>
-  void deserializeMessage(std::string loopName, DataCommMode data_mode,
+  template <SyncType syncType, typename SyncFnTy, typename VecType>
+  void deserializeMessage(std::string loopName, uint32_t from_id,
+                       DataCommMode data_mode,
                        uint32_t num, galois::runtime::RecvBuffer& buf,
                        size_t& bit_set_count,
                        galois::PODResizeableArray<unsigned int>& offsets,
@@ -2829,11 +3094,28 @@ private:
         galois::runtime::gDeserialize(buf, buf_start);
       } else if (data_mode == dataSplitFirst) {
         galois::runtime::gDeserialize(buf, retval);
+      } else if (data_mode == offsetsVarintData ||
+                 data_mode == xorDeltaData) {
+        galois::runtime::gDeserialize(buf, syncEncodedMetadata);
+        galois::runtime::decodeOffsetsVarint(syncEncodedMetadata,
+                                             bit_set_count, offsets);
+      } else if (data_mode == bitsetRLEData) {
+        galois::runtime::gDeserialize(buf, syncEncodedMetadata);
+        galois::runtime::decodeOffsetsRLE(syncEncodedMetadata, bit_set_count,
+                                          offsets);
       }
     }
 
     // get data itself
-    galois::runtime::gDeserialize(buf, val_vec);
+    if (data_mode == xorDeltaData) {
+      galois::runtime::gDeserialize(buf, syncEncodedValues);
+      auto& history =
+          get_xor_history<SyncFnTy, syncType, false>(from_id, num);
+      galois::runtime::decodeValuesXor(syncEncodedValues, offsets,
+                                       bit_set_count, history, val_vec);
+    } else {
+      galois::runtime::gDeserialize(buf, val_vec);
+    }
 
     Tdeserialize.stop();
   }
@@ -2896,7 +3178,8 @@ private:
           
           // deserialize the rest of the data in the buffer depending on the data
           // mode; arguments passed in here are mostly output vars
-          deserializeMessage<syncType>(loopName, data_mode, num, buf, bit_set_count,
+          deserializeMessage<syncType, SyncFnTy>(loopName, from_id, data_mode,
+                                    num, buf, bit_set_count,
                                     offsets, bit_set_comm, buf_start, retval,
                                     val_vec);
 
@@ -2928,7 +3211,7 @@ private:
                       async, true, true>(
                             loopName, offsets, bit_set_count, offsets, val_vec,
                             bit_set_compute);
-          } else { // bitsetData or offsetsData
+          } else { // bitsetData, offsetsData, or a compressed mode
             set_subset<decltype(sharedNodes[from_id]), SyncFnTy, syncType,
                       async, false, true>(
                             loopName, sharedNodes[from_id], bit_set_count, 
@@ -2997,7 +3280,8 @@ private:
 
           // deserialize the rest of the data in the buffer depending on the
           // data mode; arguments passed in here are mostly output vars
-          deserializeMessage<syncType>(loopName, data_mode, num, buf,
+          deserializeMessage<syncType, SyncFnTy>(loopName, from_id,
+                                    data_mode, num, buf,
                                     bit_set_count, offsets, bit_set_comm,
                                     buf_start, retval, val_vec);
 
@@ -3031,7 +3315,7 @@ private:
                                   loopName, offsets, bit_set_count, 
                                   offsets, val_vec,
                                   bit_set_compute, i);
-          } else { // bitsetData or offsetsData
+          } else { // bitsetData, offsetsData, or a compressed mode
             set_subset<decltype(sharedNodes[from_id]), SyncFnTy, syncType,
                       async, false, true, true>(
                                   loopName, sharedNodes[from_id],
@@ -3194,6 +3478,14 @@ private:
     galois::CondStatTimer<MORE_COMM_STATS> TRecvTime(
         (syncTypeStr + "Recv_" + get_run_identifier(loopName)).c_str(), GRNAME);
 
+    galois::runtime::TimelineSpan span(
+        galois::runtime::internal::timelineEnabled()
+            ? galois::runtime::internal::timelineIntern(
+                  (syncTypeStr + "Recv_" + get_run_identifier(loopName))
+                      .c_str())
+            : nullptr,
+        "sync");
+
     TRecvTime.start();
     sync_net_recv<writeLocation, readLocation, syncType, SyncFnTy, BitsetFnTy, async>(
         loopName);
@@ -3657,6 +3949,96 @@ private:
     broadcast<writeAny, readAny, SyncFnTy, BitsetFnTy, async>(loopName);
   }
 
+  /**
+   * Determines if a sync with the given locations needs a reduce; matches
+   * the sync_*_to_* functions above.
+   */
+  template <WriteLocation writeLocation>
+  bool syncNeedsReduce() const {
+    if (partitionAgnostic || is_vertex_cut() || writeLocation == writeAny) {
+      return true;
+    }
+    return (writeLocation == writeSource) ? transposed : !transposed;
+  }
+
+  /**
+   * Determines if a sync with the given locations needs a broadcast; matches
+   * the sync_*_to_* functions above.
+   */
+  template <ReadLocation readLocation>
+  bool syncNeedsBroadcast() const {
+    if (partitionAgnostic || is_vertex_cut() || readLocation == readAny) {
+      return true;
+    }
+    return (readLocation == readSource) ? transposed : !transposed;
+  }
+
+  /**
+   * Sends the reduce of an overlapped sync; the receive is done by
+   * overlap_reduce_recv.
+   */
+  template <WriteLocation writeLocation, ReadLocation readLocation,
+            typename SyncFnTy, typename BitsetFnTy>
+  void overlap_reduce_send(std::string loopName) {
+    if (!syncNeedsReduce<writeLocation>()) {
+      return;
+    }
+    galois::Timer Tsend;
+    Tsend.start();
+    if (partitionAgnostic) {
+      sync_send<writeAny, readAny, syncReduce, SyncFnTy, BitsetFnTy, false>(
+          loopName);
+    } else {
+      sync_send<writeLocation, readLocation, syncReduce, SyncFnTy, BitsetFnTy,
+                false>(loopName);
+    }
+    Tsend.stop();
+    overlapSendTime      = Tsend.get_usec();
+    overlapReducePending = true;
+  }
+
+  /**
+   * Receives and applies the reduce of an overlapped sync, then does the
+   * broadcast if one is needed.
+   */
+  template <WriteLocation writeLocation, ReadLocation readLocation,
+            typename SyncFnTy, typename BitsetFnTy>
+  void overlap_reduce_recv_broadcast(std::string loopName) {
+    if (overlapReducePending) {
+      galois::Timer Trecv;
+      Trecv.start();
+      if (partitionAgnostic) {
+        sync_recv<writeAny, readAny, syncReduce, SyncFnTy, BitsetFnTy, false>(
+            loopName);
+      } else {
+        sync_recv<writeLocation, readLocation, syncReduce, SyncFnTy,
+                  BitsetFnTy, false>(loopName);
+      }
+      Trecv.stop();
+      overlapReducePending = false;
+
+      // overlap window: length of the interior phase, during which the
+      // reduce messages were in flight (an upper bound on the communication
+      // it could hide); exposed: time the host spent sending or waiting on
+      // the reduce
+      galois::runtime::reportStat_Tsum(
+          GRNAME, "ReduceOverlapWindowUsec_" + get_run_identifier(loopName),
+          overlapInteriorTimer.get_usec());
+      galois::runtime::reportStat_Tsum(
+          GRNAME, "ReduceExposedCommUsec_" + get_run_identifier(loopName),
+          overlapSendTime + Trecv.get_usec());
+    }
+
+    if (syncNeedsBroadcast<readLocation>()) {
+      if (partitionAgnostic) {
+        broadcast<writeAny, readAny, SyncFnTy, BitsetFnTy, false>(loopName);
+      } else {
+        broadcast<writeLocation, readLocation, SyncFnTy, BitsetFnTy, false>(
+            loopName);
+      }
+    }
+  }
+
 public:
   /**
    * Main sync call exposed to the user that calls the correct sync function
@@ -3679,6 +4061,10 @@ public:
 
     Tsync.start();
 
+#ifdef __GALOIS_CHECKPOINT__
+    checkpointMarkDirty<BitsetFnTy>();
+#endif
+
     if (partitionAgnostic) {
       sync_any_to_any<SyncFnTy, BitsetFnTy, async>(loopName);
     } else {
@@ -3712,6 +4098,95 @@ public:
     Tsync.stop();
   }
 
+  /**
+   * First half of a sync that overlaps communication with computation.
+   *
+   * A round is split into a boundary phase over boundaryNodesRange and an
+   * interior phase over interiorNodesRange. Call this after the boundary
+   * phase: it extracts the boundary results and sends the reduce without
+   * waiting for it, so the messages are in flight while the interior phase
+   * runs. Call sync_complete with the same template arguments after the
+   * interior phase to receive and apply the reduce and do the broadcast.
+   *
+   * The interior phase must not communicate, and its operator must only
+   * read the synchronized field on masters. Only bulk-synchronous syncs
+   * through the network layer are overlapped; otherwise this does nothing
+   * and sync_complete does a regular sync.
+   *
+   * @tparam writeLocation Location data is written (src or dst)
+   * @tparam readLocation Location data is read (src or dst)
+   * @tparam SyncFnTy sync structure for the field
+   * @tparam BitsetFnTy struct that has info on how to access the bitset
+   *
+   * @param loopName used to name timers for statistics
+   */
+  template <WriteLocation writeLocation, ReadLocation readLocation,
+            typename SyncFnTy, typename BitsetFnTy = galois::InvalidBitsetFnTy>
+  inline void sync_boundary(std::string loopName) {
+#ifdef __GALOIS_BARE_MPI_COMMUNICATION__
+    if (bare_mpi != noBareMPI) {
+      return;
+    }
+#endif
+    std::string timer_str("Sync_" + loopName + "_" + get_run_identifier());
+    galois::StatTimer Tsync(timer_str.c_str(), GRNAME);
+
+    Tsync.start();
+
+#ifdef __GALOIS_CHECKPOINT__
+    checkpointMarkDirty<BitsetFnTy>();
+#endif
+
+    overlap_reduce_send<writeLocation, readLocation, SyncFnTy, BitsetFnTy>(
+        loopName);
+
+    Tsync.stop();
+
+    overlapInteriorTimer.start();
+  }
+
+  /**
+   * Second half of a sync started with sync_boundary: receives and applies
+   * the reduce sent by sync_boundary, then does the broadcast if the
+   * partitioning policy needs one.
+   *
+   * Reports per round (see get_run_identifier) the length of the interior
+   * phase the reduce was in flight for and the time the reduce was exposed,
+   * i.e. spent sending or waiting for messages.
+   *
+   * @tparam writeLocation Location data is written (src or dst)
+   * @tparam readLocation Location data is read (src or dst)
+   * @tparam SyncFnTy sync structure for the field
+   * @tparam BitsetFnTy struct that has info on how to access the bitset
+   *
+   * @param loopName used to name timers for statistics
+   */
+  template <WriteLocation writeLocation, ReadLocation readLocation,
+            typename SyncFnTy, typename BitsetFnTy = galois::InvalidBitsetFnTy>
+  inline void sync_complete(std::string loopName) {
+#ifdef __GALOIS_BARE_MPI_COMMUNICATION__
+    if (bare_mpi != noBareMPI) {
+      sync<writeLocation, readLocation, SyncFnTy, BitsetFnTy>(loopName);
+      return;
+    }
+#endif
+    overlapInteriorTimer.stop();
+
+    std::string timer_str("Sync_" + loopName + "_" + get_run_identifier());
+    galois::StatTimer Tsync(timer_str.c_str(), GRNAME);
+
+    Tsync.start();
+
+#ifdef __GALOIS_CHECKPOINT__
+    checkpointMarkDirty<BitsetFnTy>();
+#endif
+
+    overlap_reduce_recv_broadcast<writeLocation, readLocation, SyncFnTy,
+                                  BitsetFnTy>(loopName);
+
+    Tsync.stop();
+  }
+
 private:
   /**
    * Generic Sync on demand handler. Should NEVER get to this (hence
@@ -3937,6 +4412,10 @@ public:
     galois::StatTimer Tsync(timer_str.c_str(), GRNAME);
     Tsync.start();
 
+#ifdef __GALOIS_CHECKPOINT__
+    checkpointMarkDirty<BitsetFnTy>();
+#endif
+
     currentBVFlag = &(fieldFlags.bitvectorStatus);
 
     // call a template-specialized function depending on the read location
@@ -3950,12 +4429,107 @@ public:
   }
 
 #ifdef __GALOIS_CHECKPOINT__
+private:
+  //! Sizes the dirty node bitsets used by checkpointing to the local graph.
+  void checkpointResizeDirty() {
+    if (checkpointDirty.size() != size()) {
+      checkpointDirty.resize(size());
+      checkpointDirtyPrev.resize(size());
+      checkpointAllDirty = true;
+    }
+  }
+
+  /**
+   * Marks the nodes set in a sync bitset as dirty for the next checkpoint.
+   * Called at the start of a sync, before the sync resets the bitset. A
+   * sync without a bitset may write any node, so it dirties the whole graph.
+   *
+   * @tparam BitsetFnTy struct that has info on how to access the bitset
+   */
+  template <typename BitsetFnTy,
+            typename std::enable_if<!BitsetFnTy::is_vector_bitset()>::type* =
+                nullptr>
+  void checkpointMarkDirty() {
+    checkpointResizeDirty();
+    const galois::DynamicBitSet& bitset = BitsetFnTy::get();
+    if (!BitsetFnTy::is_valid() || bitset.size() != checkpointDirty.size()) {
+      checkpointAllDirty = true;
+    } else {
+      checkpointDirty.bitwise_or(bitset);
+    }
+  }
+
+  /**
+   * Vector bitset variant: marks the nodes set in any of the bitsets as dirty.
+   *
+   * @tparam BitsetFnTy struct that has info on how to access the bitsets
+   */
+  template <typename BitsetFnTy,
+            typename std::enable_if<BitsetFnTy::is_vector_bitset()>::type* =
+                nullptr>
+  void checkpointMarkDirty() {
+    checkpointResizeDirty();
+    for (unsigned i = 0; i < BitsetFnTy::numBitsets(); i++) {
+      const galois::DynamicBitSet& bitset = BitsetFnTy::get(i);
+      if (bitset.size() != checkpointDirty.size()) {
+        checkpointAllDirty = true;
+      } else {
+        checkpointDirty.bitwise_or(bitset);
+      }
+    }
+  }
+
 public:
   /**
-   * Checkpoint the complete structure on the node to disk
+   * Declares that the application reports every write to node data made
+   * outside of a sync through checkpointMarkNodeDirty or
+   * checkpointMarkAllDirty. Until this is called every checkpoint is full,
+   * since a delta checkpoint would lose fields that are never synced.
    */
-  void checkpointSaveNodeData(std::string checkpointFileName = "checkpoint") {
-    using namespace boost::archive;
+  void checkpointTrackWrites() {
+    checkpointResizeDirty();
+    checkpointWritesTracked = true;
+  }
+
+  /**
+   * Marks a node dirty for the next checkpoint. Safe to call from
+   * operators running in parallel.
+   *
+   * @param lid local id of the node that was written
+   */
+  void checkpointMarkNodeDirty(uint32_t lid) {
+    // before the first checkpoint every node is saved anyway
+    if (checkpointDirty.size() != 0)
+      checkpointDirty.set(lid);
+  }
+
+  //! Marks every node dirty so that the next checkpoint saves the whole graph.
+  void checkpointMarkAllDirty() { checkpointAllDirty = true; }
+
+  /**
+   * Checkpoint node data to disk.
+   *
+   * Every checkpoint saves the whole graph unless checkpointTrackWrites was
+   * called. In that case only nodes written since the last checkpoint are
+   * saved; writes are tracked through the bitsets passed to sync, through
+   * values received in a sync and through checkpointMarkNodeDirty. Nodes
+   * written in the interval before the last checkpoint are saved again as
+   * well. Node data
+   * is copied to a buffer here and written to disk from a background thread
+   * while computation continues. Node data with a boost serialize method is
+   * saved through it; other node data must not own memory and is copied
+   * byte for byte.
+   *
+   * Files are named <checkpointFileName>_<host id>.<sequence number>, and
+   * <checkpointFileName>_<host id>.manifest lists the files to replay.
+   *
+   * @param checkpointFileName prefix of the checkpoint files
+   * @param async if false, wait for the checkpoint to reach disk
+   * @param fullInterval write a full checkpoint after this many delta
+   * checkpoints to bound the length of the replay; 0 means never
+   */
+  void checkpointSaveNodeData(std::string checkpointFileName = "checkpoint",
+                              bool async = true, unsigned fullInterval = 0) {
     galois::StatTimer TimerSaveCheckPoint(
         get_run_identifier("TimerSaveCheckpoint").c_str(), GRNAME);
 
@@ -3963,34 +4537,79 @@ public:
     std::string checkpointFileName_local =
         checkpointFileName + "_" + std::to_string(id);
 
-    std::ofstream outputStream(checkpointFileName_local, std::ios::binary);
-    if (!outputStream.is_open()) {
-      galois::gPrint("ERROR: Could not open ", checkpointFileName_local,
-                     " to save checkpoint!!!\n");
+    if (!checkpointWriter) {
+      galois::gPrint("[", id, "] Saving local checkpoints to :",
+                     checkpointFileName_local, ".*\n");
+      checkpointWriter.reset(
+          new galois::runtime::CheckpointWriter(checkpointFileName_local));
     }
-    galois::gPrint("[", id,
-                   "] Saving local checkpoint to :", checkpointFileName_local,
-                   "\n");
 
-    boost::archive::binary_oarchive ar(outputStream, boost::archive::no_header);
+    checkpointResizeDirty();
+    bool full = checkpointAllDirty || !checkpointWritesTracked ||
+                (fullInterval > 0 && checkpointNumDeltas >= fullInterval);
+
+    // the buffer returned is never the one being written, so filling it
+    // does not wait; submit below waits if the previous write is unfinished
+    galois::runtime::CheckpointWriter::Snapshot& snapshot =
+        checkpointWriter->nextSnapshot();
+    snapshot.full     = full;
+    snapshot.numNodes = size();
+
+    if (full) {
+      snapshot.nodes.clear();
+      galois::runtime::saveSnapshotNodes<NodeTy>(
+          snapshot, [&](size_t lid) -> NodeTy& { return getData(lid); });
+      checkpointNumDeltas = 0;
+    } else {
+      checkpointDirtyPrev.bitwise_or(checkpointDirty);
+      // reuse syncOffsets as the list of nodes to save
+      size_t numDirty = 0;
+      get_offsets_from_bitset<syncBroadcast>("Checkpoint", checkpointDirtyPrev,
+                                             syncOffsets, numDirty);
+      snapshot.nodes.assign(syncOffsets.begin(),
+                            syncOffsets.begin() + numDirty);
+      galois::runtime::saveSnapshotNodes<NodeTy>(
+          snapshot,
+          [&](size_t n) -> NodeTy& { return getData(snapshot.nodes[n]); });
+      ++checkpointNumDeltas;
+    }
 
-    graph.serializeNodeData(ar);
+    std::swap(checkpointDirty, checkpointDirtyPrev);
+    checkpointDirty.reset();
+    checkpointAllDirty = false;
 
-    std::string statSendBytes_str("CheckpointBytesTotal");
     constexpr static const char* const RREGION = "RECOVERY";
-    size_t cp_size                             = outputStream.tellp();
-    galois::runtime::reportStat_Tsum(RREGION, statSendBytes_str, cp_size);
+    galois::runtime::reportStat_Tsum(RREGION, "CheckpointBytesTotal",
+                                     snapshot.fileSize());
+    galois::runtime::reportStat_Tsum(
+        RREGION, "CheckpointNodesSaved",
+        full ? snapshot.numNodes : snapshot.nodes.size());
+    galois::runtime::reportStat_Tsum(
+        RREGION, full ? "CheckpointsFull" : "CheckpointsDelta", 1);
 
-    outputStream.flush();
-    outputStream.close();
+    checkpointWriter->submit(async);
+    checkpointReportWriteStats();
     TimerSaveCheckPoint.stop();
   }
 
   /**
-   * Load checkpointed data from disk.
+   * Waits for all checkpoints to reach disk and reports the time the
+   * background thread spent writing them.
+   */
+  void checkpointFlush() {
+    if (checkpointWriter) {
+      checkpointWriter->wait();
+      checkpointReportWriteStats();
+    }
+  }
+
+  /**
+   * Load checkpointed data from disk by replaying the last full checkpoint
+   * and every delta checkpoint written after it.
+   *
+   * @param checkpointFileName prefix of the checkpoint files
    */
   void checkpointApplyNodeData(std::string checkpointFileName = "checkpoint") {
-    using namespace boost::archive;
     galois::StatTimer TimerApplyCheckPoint(
         get_run_identifier("TimerApplyCheckpoint").c_str(), GRNAME);
 
@@ -3998,22 +4617,49 @@ public:
     std::string checkpointFileName_local =
         checkpointFileName + "_" + std::to_string(id);
 
-    std::ifstream inputStream(checkpointFileName_local, std::ios::binary);
+    // a checkpoint may still be in flight
+    checkpointFlush();
 
-    if (!inputStream.is_open()) {
-      galois::gPrint("ERROR: Could not open ", checkpointFileName_local,
-                     " to read checkpoint!!!\n");
-    }
     galois::gPrint("[", id, "] reading local checkpoint from: ",
-                   checkpointFileName_local, "\n");
+                   checkpointFileName_local, ".manifest\n");
 
-    boost::archive::binary_iarchive ar(inputStream, boost::archive::no_header);
+    size_t numSnapshots = galois::runtime::CheckpointWriter::replay(
+        checkpointFileName_local,
+        [&](const galois::runtime::CheckpointWriter::Snapshot& snapshot) {
+          if (snapshot.numNodes != size()) {
+            GALOIS_DIE("Checkpoint does not match the local graph");
+          }
+          if (snapshot.full) {
+            galois::runtime::applySnapshotNodes<NodeTy>(
+                snapshot, [&](size_t lid) -> NodeTy& { return getData(lid); });
+          } else {
+            galois::runtime::applySnapshotNodes<NodeTy>(
+                snapshot, [&](size_t n) -> NodeTy& {
+                  return getData(snapshot.nodes[n]);
+                });
+          }
+        });
 
-    graph.deSerializeNodeData(ar);
+    if (numSnapshots == 0) {
+      galois::gPrint("ERROR: Could not open ", checkpointFileName_local,
+                     ".manifest to read checkpoint!!!\n");
+    }
 
-    inputStream.close();
+    galois::runtime::reportStat_Tsum("RECOVERY", "CheckpointsReplayed",
+                                     numSnapshots);
     TimerApplyCheckPoint.stop();
   }
+
+private:
+  //! Reports bytes written and time spent by the checkpoint writer thread.
+  void checkpointReportWriteStats() {
+    uint64_t bytes, nanoseconds;
+    checkpointWriter->takeWriteStats(bytes, nanoseconds);
+    galois::runtime::reportStat_Tsum("RECOVERY", "CheckpointBytesWritten",
+                                     bytes);
+    galois::runtime::reportStat_Tsum("RECOVERY", "CheckpointWriteTime",
+                                     nanoseconds / 1000000);
+  }
 #endif
 
 public:
@@ -4333,6 +4979,9 @@ public:
     masterRanges.clear();
     withEdgeRanges.clear();
     specificRanges.clear();
+    for (unsigned i = 0; i < 3; ++i) {
+      boundaryNodesReady[i] = false;
+    }
 
     // find ranges again
     determineThreadRanges();
@@ -146,8 +146,7 @@ public:
 
     galois::runtime::reportParam("(NULL)", "CUSTOM EDGE CUT", "0");
 
-    galois::CondStatTimer<MORE_DIST_STATS> Tgraph_construct(
-        "GraphPartitioningTime", GRNAME);
+    galois::StatTimer Tgraph_construct("GraphPartitioningTime", GRNAME);
 
     Tgraph_construct.start();
 
@@ -182,8 +182,7 @@ class NewDistGraphGeneric : public DistGraph<NodeTy, EdgeTy> {
                    std::string localGraphFileName = "local_graph")
       : base_DistGraph(host, _numHosts) {
     galois::runtime::reportParam("dGraph", "GenericPartitioner", "0");
-    galois::CondStatTimer<MORE_DIST_STATS> Tgraph_construct(
-        "GraphPartitioningTime", GRNAME);
+    galois::StatTimer Tgraph_construct("GraphPartitioningTime", GRNAME);
     Tgraph_construct.start();
 
     if (readFromFile) {
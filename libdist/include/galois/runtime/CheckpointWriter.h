@@ -0,0 +1,285 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file CheckpointWriter.h
+ *
+ * Contains the CheckpointWriter class, which writes full and incremental
+ * snapshots of node data to disk from a background thread and keeps a
+ * manifest of the snapshots needed to restore the latest state.
+ */
+
+#ifndef GALOIS_RUNTIME_CHECKPOINTWRITER_H
+#define GALOIS_RUNTIME_CHECKPOINTWRITER_H
+
+#include "galois/Galois.h"
+#include "galois/gIO.h"
+#include "galois/runtime/ExtraTraits.h"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace galois {
+namespace runtime {
+
+/**
+ * Writes node data snapshots to files named <prefix>.<sequence number> on a
+ * background I/O thread. Snapshots are double buffered: the caller fills one
+ * buffer while the other is being written.
+ *
+ * The manifest <prefix>.manifest lists the last full snapshot followed by
+ * every delta snapshot written after it, in order. It is only updated once a
+ * snapshot file is completely written, so replaying it always gives a
+ * consistent state.
+ */
+class CheckpointWriter {
+public:
+  //! Node data of one snapshot
+  struct Snapshot {
+    //! true if this snapshot contains every node
+    bool full = false;
+    //! number of nodes in the graph
+    uint64_t numNodes = 0;
+    //! size in bytes of the data of one node; 0 if data is a boost binary
+    //! archive of the nodes
+    uint64_t nodeSize = 0;
+    //! local ids of the nodes in data; empty if full
+    std::vector<uint32_t> nodes;
+    //! node data, nodeSize bytes per node, or a boost binary archive of the
+    //! nodes in order if nodeSize is 0
+    std::vector<char> data;
+
+    //! Returns the number of bytes this snapshot takes on disk
+    uint64_t fileSize() const;
+  };
+
+private:
+  std::string prefix;
+  uint64_t sequence;
+  //! files listed in the manifest
+  std::vector<std::string> manifest;
+
+  Snapshot buffers[2];
+  //! index of the buffer the caller fills next
+  unsigned fillIndex;
+  //! true if the other buffer holds a snapshot not yet written
+  bool pending;
+  bool done;
+
+  std::mutex lock;
+  std::condition_variable cond;
+  std::thread ioThread;
+
+  std::atomic<uint64_t> bytesWritten;
+  std::atomic<uint64_t> writeNanoseconds;
+
+  void ioLoop();
+  void writeSnapshot(const Snapshot& snapshot);
+  void writeManifest();
+
+public:
+  /**
+   * Starts the I/O thread.
+   *
+   * @param _prefix prefix of the snapshot files and manifest
+   */
+  explicit CheckpointWriter(const std::string& _prefix);
+
+  //! Finishes any pending write and stops the I/O thread.
+  ~CheckpointWriter();
+
+  CheckpointWriter(const CheckpointWriter&) = delete;
+  CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+  //! Returns the buffer to fill with the next snapshot.
+  Snapshot& nextSnapshot() { return buffers[fillIndex]; }
+
+  /**
+   * Hands the filled snapshot to the I/O thread. Blocks only if the previous
+   * snapshot is still being written.
+   *
+   * @param async if false, also wait for this snapshot to be written
+   */
+  void submit(bool async = true);
+
+  //! Blocks until every submitted snapshot is written.
+  void wait();
+
+  /**
+   * Returns and clears the number of bytes written and the time spent
+   * writing since the last call.
+   *
+   * @param bytes OUTPUT: bytes written
+   * @param nanoseconds OUTPUT: time spent writing
+   */
+  void takeWriteStats(uint64_t& bytes, uint64_t& nanoseconds);
+
+  /**
+   * Reads the manifest with the given prefix and calls a function on each
+   * snapshot it lists, in the order they must be applied.
+   *
+   * @param prefix prefix of the snapshot files and manifest
+   * @param apply function to call on each snapshot
+   * @returns number of snapshots applied; 0 if there is no manifest
+   */
+  static size_t replay(const std::string& prefix,
+                       const std::function<void(const Snapshot&)>& apply);
+};
+
+namespace internal {
+
+//! Indicates if T has a boost serialize member
+template <typename T, typename = void>
+struct has_boost_serialize : public std::false_type {};
+
+template <typename T>
+struct has_boost_serialize<
+    T, decltype(std::declval<T&>().serialize(
+                    std::declval<boost::archive::binary_oarchive&>(), 0u),
+                void())> : public std::true_type {};
+
+/**
+ * Indicates if T is checkpointed by copying its bytes. Types with a boost
+ * serialize member use it instead; otherwise the type must be memory
+ * copyable or own nothing (be trivially destructible), as structs of
+ * scalars and std::atomics do.
+ */
+template <typename T>
+struct checkpoint_by_copy
+    : public std::integral_constant<
+          bool, !has_boost_serialize<T>::value &&
+                    (is_memory_copyable<T>::value ||
+                     std::is_trivially_destructible<T>::value)> {};
+
+template <typename NodeTy, typename GetDataFn>
+void saveNodes(CheckpointWriter::Snapshot& snapshot, size_t count,
+               GetDataFn& getData, std::true_type) {
+  const size_t nodeSize = sizeof(NodeTy);
+  snapshot.nodeSize     = nodeSize;
+  snapshot.data.resize(count * nodeSize);
+  galois::do_all(galois::iterate((size_t)0, count),
+                 [&](size_t n) {
+                   std::memcpy(&snapshot.data[n * nodeSize],
+                               static_cast<const void*>(&getData(n)),
+                               nodeSize);
+                 },
+                 galois::no_stats());
+}
+
+template <typename NodeTy, typename GetDataFn>
+void saveNodes(CheckpointWriter::Snapshot& snapshot, size_t count,
+               GetDataFn& getData, std::false_type) {
+  snapshot.nodeSize = 0;
+  std::ostringstream out(std::ios::binary);
+  {
+    boost::archive::binary_oarchive ar(out, boost::archive::no_header);
+    for (size_t n = 0; n < count; ++n) {
+      const NodeTy& data = getData(n);
+      ar << data;
+    }
+  }
+  const std::string& bytes = out.str();
+  snapshot.data.assign(bytes.begin(), bytes.end());
+}
+
+template <typename NodeTy, typename GetDataFn>
+void applyNodes(const CheckpointWriter::Snapshot& snapshot, size_t count,
+                GetDataFn& getData, std::true_type) {
+  const size_t nodeSize = snapshot.nodeSize;
+  galois::do_all(galois::iterate((size_t)0, count),
+                 [&](size_t n) {
+                   // through void* since atomics are not trivially copyable
+                   std::memcpy(static_cast<void*>(&getData(n)),
+                               &snapshot.data[n * nodeSize], nodeSize);
+                 },
+                 galois::no_stats());
+}
+
+template <typename NodeTy, typename GetDataFn>
+void applyNodes(const CheckpointWriter::Snapshot& snapshot, size_t count,
+                GetDataFn& getData, std::false_type) {
+  std::istringstream in(std::string(snapshot.data.begin(), snapshot.data.end()),
+                        std::ios::binary);
+  boost::archive::binary_iarchive ar(in, boost::archive::no_header);
+  for (size_t n = 0; n < count; ++n) {
+    ar >> getData(n);
+  }
+}
+
+} // namespace internal
+
+/**
+ * Copies node data into a snapshot. Node types with a boost serialize member
+ * are written through it, one node after the other; node types that own
+ * nothing are copied byte for byte in parallel.
+ *
+ * @param snapshot snapshot to fill; full, numNodes and nodes must already be
+ * set
+ * @param getData returns a reference to the data of the i-th node to save,
+ * i.e., of local id i if the snapshot is full and of nodes[i] otherwise
+ */
+template <typename NodeTy, typename GetDataFn>
+void saveSnapshotNodes(CheckpointWriter::Snapshot& snapshot,
+                       GetDataFn getData) {
+  static_assert(internal::has_boost_serialize<NodeTy>::value ||
+                    internal::checkpoint_by_copy<NodeTy>::value,
+                "node data that owns memory needs a boost serialize method "
+                "to be checkpointed");
+  size_t count = snapshot.full ? snapshot.numNodes : snapshot.nodes.size();
+  internal::saveNodes<NodeTy>(snapshot, count, getData,
+                              internal::checkpoint_by_copy<NodeTy>());
+}
+
+/**
+ * Copies node data out of a snapshot written by saveSnapshotNodes with the
+ * same node type.
+ *
+ * @param snapshot snapshot to apply
+ * @param getData returns a reference to the data of the i-th node in the
+ * snapshot
+ */
+template <typename NodeTy, typename GetDataFn>
+void applySnapshotNodes(const CheckpointWriter::Snapshot& snapshot,
+                        GetDataFn getData) {
+  const uint64_t nodeSize =
+      internal::checkpoint_by_copy<NodeTy>::value ? sizeof(NodeTy) : 0;
+  if (snapshot.nodeSize != nodeSize) {
+    GALOIS_DIE("Checkpoint was written with a different node data type");
+  }
+  size_t count = snapshot.full ? snapshot.numNodes : snapshot.nodes.size();
+  internal::applyNodes<NodeTy>(snapshot, count, getData,
+                               internal::checkpoint_by_copy<NodeTy>());
+}
+
+} // namespace runtime
+} // namespace galois
+
+#endif
@@ -0,0 +1,223 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file DataCommEncoding.h
+ *
+ * Contains the encoders and decoders used by the compressed data comm modes
+ * (offsetsVarintData, bitsetRLEData, and xorDeltaData) during
+ * synchronization.
+ */
+
+#ifndef GALOIS_RUNTIME_DATACOMMENCODING_H
+#define GALOIS_RUNTIME_DATACOMMENCODING_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "galois/PODResizeableArray.h"
+
+namespace galois {
+namespace runtime {
+
+//! Buffer type that holds encoded metadata or values
+using EncodedBytes = galois::PODResizeableArray<uint8_t>;
+
+/**
+ * Appends an unsigned LEB128 varint to a byte buffer.
+ *
+ * @param out buffer to append to
+ * @param v value to append
+ */
+inline void appendVarint(EncodedBytes& out, uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<uint8_t>(v) | 0x80);
+    v >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(v));
+}
+
+/**
+ * Reads an unsigned LEB128 varint and advances the read pointer past it.
+ *
+ * @param p read pointer; advanced past the varint
+ * @returns the decoded value
+ */
+inline uint64_t readVarint(const uint8_t*& p) {
+  uint64_t v     = 0;
+  unsigned shift = 0;
+  uint8_t byte;
+  do {
+    byte = *p++;
+    v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return v;
+}
+
+/**
+ * Encodes sorted offsets as varints of the gap to the previous offset.
+ *
+ * @param offsets sorted offsets to encode
+ * @param count number of offsets to encode
+ * @param out OUTPUT: encoded offsets
+ */
+inline void encodeOffsetsVarint(const galois::PODResizeableArray<unsigned int>& offsets,
+                                size_t count, EncodedBytes& out) {
+  out.clear();
+  out.reserve(count * 2);
+  unsigned int prev = 0;
+  for (size_t i = 0; i < count; ++i) {
+    appendVarint(out, offsets[i] - prev);
+    prev = offsets[i];
+  }
+}
+
+/**
+ * Decodes offsets encoded by encodeOffsetsVarint.
+ *
+ * @param in encoded offsets
+ * @param count number of offsets that were encoded
+ * @param offsets OUTPUT: decoded offsets
+ */
+inline void decodeOffsetsVarint(const EncodedBytes& in, size_t count,
+                                galois::PODResizeableArray<unsigned int>& offsets) {
+  offsets.resize(count);
+  const uint8_t* p  = in.data();
+  unsigned int prev = 0;
+  for (size_t i = 0; i < count; ++i) {
+    prev += static_cast<unsigned int>(readVarint(p));
+    offsets[i] = prev;
+  }
+}
+
+/**
+ * Run-length encodes the bitset described by sorted offsets: each run of set
+ * bits is written as the number of clear bits before it followed by its
+ * length.
+ *
+ * @param offsets sorted offsets of the set bits
+ * @param count number of set bits
+ * @param out OUTPUT: encoded runs
+ */
+inline void encodeOffsetsRLE(const galois::PODResizeableArray<unsigned int>& offsets,
+                             size_t count, EncodedBytes& out) {
+  out.clear();
+  unsigned int end = 0; // one past the end of the previous run
+  size_t i         = 0;
+  while (i < count) {
+    unsigned int start = offsets[i];
+    size_t j           = i + 1;
+    while (j < count && offsets[j] == offsets[j - 1] + 1) {
+      ++j;
+    }
+    appendVarint(out, start - end);
+    appendVarint(out, j - i);
+    end = start + (j - i);
+    i   = j;
+  }
+}
+
+/**
+ * Decodes runs encoded by encodeOffsetsRLE back into offsets.
+ *
+ * @param in encoded runs
+ * @param count number of set bits that were encoded
+ * @param offsets OUTPUT: decoded offsets
+ */
+inline void decodeOffsetsRLE(const EncodedBytes& in, size_t count,
+                             galois::PODResizeableArray<unsigned int>& offsets) {
+  offsets.resize(count);
+  const uint8_t* p = in.data();
+  unsigned int end = 0;
+  size_t i         = 0;
+  while (i < count) {
+    unsigned int start = end + static_cast<unsigned int>(readVarint(p));
+    size_t len         = readVarint(p);
+    for (size_t k = 0; k < len; ++k) {
+      offsets[i++] = start + k;
+    }
+    end = start + len;
+  }
+}
+
+/**
+ * XORs each value against the value last sent at the same offset and writes
+ * the result as varints, one per 8-byte word. Values that changed little
+ * (e.g. converging floating point values) have mostly zero high bits after
+ * the XOR and so encode into few bytes.
+ *
+ * @param vals values to encode
+ * @param offsets offsets the values correspond to
+ * @param count number of values to encode
+ * @param history values last sent at each offset; updated with vals
+ * @param out OUTPUT: encoded values
+ */
+template <typename ValTy>
+void encodeValuesXor(const galois::PODResizeableArray<ValTy>& vals,
+                     const galois::PODResizeableArray<unsigned int>& offsets,
+                     size_t count, galois::PODResizeableArray<ValTy>& history,
+                     EncodedBytes& out) {
+  constexpr size_t numWords = (sizeof(ValTy) + 7) / 8;
+  out.clear();
+  out.reserve(count * sizeof(ValTy));
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t cur[numWords]  = {};
+    uint64_t prev[numWords] = {};
+    std::memcpy(cur, &vals[i], sizeof(ValTy));
+    std::memcpy(prev, &history[offsets[i]], sizeof(ValTy));
+    for (size_t w = 0; w < numWords; ++w) {
+      appendVarint(out, cur[w] ^ prev[w]);
+    }
+    history[offsets[i]] = vals[i];
+  }
+}
+
+/**
+ * Decodes values encoded by encodeValuesXor.
+ *
+ * @param in encoded values
+ * @param offsets offsets the values correspond to
+ * @param count number of values that were encoded
+ * @param history values last received at each offset; updated with vals
+ * @param vals OUTPUT: decoded values
+ */
+template <typename ValTy>
+void decodeValuesXor(const EncodedBytes& in,
+                     const galois::PODResizeableArray<unsigned int>& offsets,
+                     size_t count, galois::PODResizeableArray<ValTy>& history,
+                     galois::PODResizeableArray<ValTy>& vals) {
+  constexpr size_t numWords = (sizeof(ValTy) + 7) / 8;
+  vals.resize(count);
+  const uint8_t* p = in.data();
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t cur[numWords] = {};
+    std::memcpy(cur, &history[offsets[i]], sizeof(ValTy));
+    for (size_t w = 0; w < numWords; ++w) {
+      cur[w] ^= readVarint(p);
+    }
+    std::memcpy(&vals[i], cur, sizeof(ValTy));
+    history[offsets[i]] = vals[i];
+  }
+}
+
+} // namespace runtime
+} // namespace galois
+
+#endif
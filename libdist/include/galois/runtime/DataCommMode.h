@@ -28,6 +28,10 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
 //! Enumeration of data communication modes that can be used in sychronization
 //! @todo document the enums in doxygen
 enum DataCommMode {
@@ -38,9 +42,50 @@ enum DataCommMode {
   onlyData,
   dataSplitFirst,
   dataSplit,
-  neverOnlyData
+  neverOnlyData,
+  offsetsVarintData, //!< offsets delta+varint encoded, then data
+  bitsetRLEData,     //!< bitset run-length encoded, then data
+  xorDeltaData //!< varint offsets, then data XORed against the last sent round
 };
 
+//! Estimated cost of encoding and decoding one varint, expressed in bytes of
+//! communication so that it can be weighed against the bytes it saves
+constexpr double varintCodingCost = 0.25;
+
+/**
+ * Returns the number of bytes needed to encode a value as a varint.
+ *
+ * @param v value to encode
+ * @returns number of bytes in the varint encoding of v
+ */
+inline size_t varint_size(uint64_t v) {
+  size_t bytes = 1;
+  while (v >= 0x80) {
+    v >>= 7;
+    ++bytes;
+  }
+  return bytes;
+}
+
+/**
+ * Maps a compressed data mode to the uncompressed mode with the same
+ * metadata. Other modes are returned unchanged.
+ *
+ * @param data_mode mode to map
+ * @returns uncompressed equivalent of data_mode
+ */
+inline DataCommMode uncompressed_data_mode(DataCommMode data_mode) {
+  switch (data_mode) {
+  case offsetsVarintData:
+  case xorDeltaData:
+    return offsetsData;
+  case bitsetRLEData:
+    return bitsetData;
+  default:
+    return data_mode;
+  }
+}
+
 //! If this is set, then always used the data mode it is set to
 extern DataCommMode enforce_data_mode;
 
@@ -53,11 +98,14 @@ extern DataCommMode enforce_data_mode;
  *
  * @param num_selected number of elements to send out (subset of num_total)
  * @param num_total total number of elements that exist
+ * @param compressible true if the caller can serialize the compressed modes;
+ * if false, a compressed mode is never returned
  *
  * @returns an appropriate DataCommMode to use for synchronization
  */
 template <typename DataType>
-DataCommMode get_data_mode(size_t num_selected, size_t num_total) {
+DataCommMode get_data_mode(size_t num_selected, size_t num_total,
+                           bool compressible = false) {
   DataCommMode data_mode = noData;
   // TODO clean up neverOnlyData path (integrate with main path in some way)
   if (enforce_data_mode == neverOnlyData) {
@@ -79,7 +127,8 @@ DataCommMode get_data_mode(size_t num_selected, size_t num_total) {
       }
     }
   } else if (enforce_data_mode != noData) {
-    data_mode = enforce_data_mode;
+    data_mode = compressible ? enforce_data_mode
+                             : uncompressed_data_mode(enforce_data_mode);
   } else { // no enforced mode, so find an appropriate mode
     if (num_selected == 0) {
       data_mode = noData;
@@ -107,6 +156,34 @@ DataCommMode get_data_mode(size_t num_selected, size_t num_total) {
           data_mode = onlyData;
         }
       }
+
+      // the compressed modes cost time to encode and decode, so only use
+      // them if the estimated bytes they save outweigh that cost
+      if (compressible && data_mode != onlyData) {
+        size_t rawSize = std::min(bitsetDataSize, offsetsDataSize);
+        size_t avgGap  = num_total / num_selected;
+        double offsetsVarintSize =
+            (num_selected * sizeof(DataType)) +
+            (num_selected * (varint_size(avgGap) + varintCodingCost)) +
+            sizeof(size_t) + sizeof(num_selected);
+        // expected number of runs if the selected elements are spread
+        // uniformly; each run is a gap and a length
+        size_t numRuns =
+            num_selected - (num_selected * num_selected) / num_total + 1;
+        double rleSize =
+            (num_selected * sizeof(DataType)) +
+            (numRuns * (varint_size((num_total - num_selected) / numRuns) +
+                        varint_size(num_selected / numRuns) +
+                        2 * varintCodingCost)) +
+            sizeof(size_t) + sizeof(num_selected);
+        if (rleSize < offsetsVarintSize) {
+          if (rleSize < rawSize) {
+            data_mode = bitsetRLEData;
+          }
+        } else if (offsetsVarintSize < rawSize) {
+          data_mode = offsetsVarintData;
+        }
+      }
     }
   }
   return data_mode;
@@ -269,6 +269,13 @@ void printHeader(std::ostream& out) const;
  */
 virtual void printStats(std::ostream& out);
 
+/**
+ * Gather the execution timelines of all hosts at host 0, which writes them
+ * as one trace. Clocks of other hosts are aligned to host 0 by ping-pong
+ * round trips (offset taken from the round trip with the least latency).
+ */
+virtual void writeTimeline(void);
+
 public:
 //! Dist stat manager constructor
 DistStatManager(const std::string& outfile = "");
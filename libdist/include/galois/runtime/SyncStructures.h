@@ -1700,7 +1700,9 @@ public:
  *
  * In addition, you will have to declare and appropriately resize the bitset
  * in your main program as well as set the bitset appropriately (i.e. when you
- * do a write to a particular node).
+ * do a write to a particular node). The first get() enables the bitset's
+ * summary of non-empty words, so that syncs scan and reset sparse bitsets
+ * without touching their empty regions.
  */
 #ifdef __GALOIS_HET_CUDA__
 // GPU code included
@@ -1710,9 +1712,14 @@ public:
     static bool is_valid() { return true; }                                    \
                                                                                \
     static galois::DynamicBitSet& get() {                                      \
-      if (personality == GPU_CUDA)                                             \
+      if (!bitset_##fieldname.has_summary()) {                                 \
+        bitset_##fieldname.enable_summary();                                   \
+      }                                                                        \
+      if (personality == GPU_CUDA) {                                           \
         get_bitset_##fieldname##_cuda(                                         \
             cuda_ctx, (uint64_t*)bitset_##fieldname.get_vec().data());         \
+        bitset_##fieldname.rebuild_summary();                                  \
+      }                                                                        \
       return bitset_##fieldname;                                               \
     }                                                                          \
                                                                                \
@@ -1733,7 +1740,12 @@ public:
                                                                                \
     static constexpr bool is_valid() { return true; }                          \
                                                                                \
-    static galois::DynamicBitSet& get() { return bitset_##fieldname; }         \
+    static galois::DynamicBitSet& get() {                                      \
+      if (!bitset_##fieldname.has_summary()) {                                 \
+        bitset_##fieldname.enable_summary();                                   \
+      }                                                                        \
+      return bitset_##fieldname;                                               \
+    }                                                                          \
                                                                                \
     static void reset_range(size_t begin, size_t end) {                        \
       bitset_##fieldname.reset(begin, end);                                    \
@@ -1750,7 +1762,9 @@ public:
  *
  * In addition, you will have to declare and appropriately resize the bitset
  * in your main program as well as set the bitset appropriately (i.e. when you
- * do a write to a particular node).
+ * do a write to a particular node). The first get() enables the bitset's
+ * summary of non-empty words, so that syncs scan and reset sparse bitsets
+ * without touching their empty regions.
  */
 #define GALOIS_SYNC_STRUCTURE_VECTOR_BITSET(fieldname)                         \
   struct Bitset_##fieldname {                                                  \
@@ -1761,6 +1775,9 @@ public:
     static constexpr bool is_valid() { return true; }                          \
                                                                                \
     static galois::DynamicBitSet& get(unsigned i) {                            \
+      if (!vbitset_##fieldname[i].has_summary()) {                             \
+        vbitset_##fieldname[i].enable_summary();                               \
+      }                                                                        \
       return vbitset_##fieldname[i];                                           \
     }                                                                          \
                                                                                \
@@ -0,0 +1,218 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file CheckpointWriter.cpp
+ *
+ * Implementation of CheckpointWriter: snapshot file format, manifest
+ * handling, and the background I/O thread.
+ */
+
+#include "galois/runtime/CheckpointWriter.h"
+#include "galois/gIO.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+//! "GCKPT002" read as a little endian integer
+constexpr uint64_t SNAPSHOT_MAGIC = 0x32303054504B4347ULL;
+//! Number of uint64_t fields in a snapshot file header
+constexpr uint64_t HEADER_FIELDS = 6;
+} // namespace
+
+using galois::runtime::CheckpointWriter;
+
+uint64_t CheckpointWriter::Snapshot::fileSize() const {
+  return HEADER_FIELDS * sizeof(uint64_t) + nodes.size() * sizeof(uint32_t) +
+         data.size();
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& _prefix)
+    : prefix(_prefix), sequence(0), fillIndex(0), pending(false), done(false),
+      bytesWritten(0), writeNanoseconds(0) {
+  ioThread = std::thread([this]() { ioLoop(); });
+}
+
+CheckpointWriter::~CheckpointWriter() {
+  {
+    std::unique_lock<std::mutex> lk(lock);
+    cond.wait(lk, [this]() { return !pending; });
+    done = true;
+  }
+  cond.notify_all();
+  ioThread.join();
+}
+
+void CheckpointWriter::submit(bool async) {
+  {
+    std::unique_lock<std::mutex> lk(lock);
+    cond.wait(lk, [this]() { return !pending; });
+    fillIndex = 1 - fillIndex;
+    pending   = true;
+  }
+  cond.notify_all();
+
+  if (!async) {
+    wait();
+  }
+}
+
+void CheckpointWriter::wait() {
+  std::unique_lock<std::mutex> lk(lock);
+  cond.wait(lk, [this]() { return !pending; });
+}
+
+void CheckpointWriter::takeWriteStats(uint64_t& bytes, uint64_t& nanoseconds) {
+  bytes       = bytesWritten.exchange(0);
+  nanoseconds = writeNanoseconds.exchange(0);
+}
+
+void CheckpointWriter::ioLoop() {
+  std::unique_lock<std::mutex> lk(lock);
+  while (true) {
+    cond.wait(lk, [this]() { return pending || done; });
+    if (!pending) {
+      break;
+    }
+    // the caller only touches buffers[fillIndex] while a write is pending
+    const Snapshot& snapshot = buffers[1 - fillIndex];
+    lk.unlock();
+
+    auto start = std::chrono::steady_clock::now();
+    writeSnapshot(snapshot);
+    auto end = std::chrono::steady_clock::now();
+    writeNanoseconds +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count();
+    bytesWritten += snapshot.fileSize();
+
+    lk.lock();
+    pending = false;
+    cond.notify_all();
+  }
+}
+
+void CheckpointWriter::writeSnapshot(const Snapshot& snapshot) {
+  std::string fileName = prefix + "." + std::to_string(sequence++);
+
+  std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    GALOIS_DIE("Could not open ", fileName, " to save checkpoint");
+  }
+
+  uint64_t header[HEADER_FIELDS] = {SNAPSHOT_MAGIC, snapshot.full,
+                                    snapshot.numNodes, snapshot.nodeSize,
+                                    snapshot.nodes.size(),
+                                    snapshot.data.size()};
+  out.write(reinterpret_cast<const char*>(header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(snapshot.nodes.data()),
+            snapshot.nodes.size() * sizeof(uint32_t));
+  out.write(snapshot.data.data(), snapshot.data.size());
+  out.flush();
+  if (!out) {
+    GALOIS_DIE("Failed writing checkpoint ", fileName);
+  }
+  out.close();
+
+  // a full snapshot makes every earlier file unnecessary
+  std::vector<std::string> obsolete;
+  if (snapshot.full) {
+    obsolete.swap(manifest);
+  }
+  manifest.push_back(fileName);
+  writeManifest();
+
+  for (const std::string& old : obsolete) {
+    if (old != fileName) {
+      std::remove(old.c_str());
+    }
+  }
+}
+
+void CheckpointWriter::writeManifest() {
+  std::string manifestName = prefix + ".manifest";
+  std::string tmpName      = manifestName + ".tmp";
+
+  {
+    std::ofstream out(tmpName, std::ios::trunc);
+    if (!out.is_open()) {
+      GALOIS_DIE("Could not open ", tmpName, " to save checkpoint manifest");
+    }
+    for (const std::string& fileName : manifest) {
+      out << fileName << "\n";
+    }
+    out.flush();
+    if (!out) {
+      GALOIS_DIE("Failed writing checkpoint manifest ", tmpName);
+    }
+  }
+
+  // rename is atomic, so a crash leaves either the old or the new manifest
+  if (std::rename(tmpName.c_str(), manifestName.c_str()) != 0) {
+    GALOIS_DIE("Could not replace checkpoint manifest ", manifestName);
+  }
+}
+
+size_t
+CheckpointWriter::replay(const std::string& prefix,
+                         const std::function<void(const Snapshot&)>& apply) {
+  std::ifstream manifestStream(prefix + ".manifest");
+  if (!manifestStream.is_open()) {
+    return 0;
+  }
+
+  size_t numApplied = 0;
+  Snapshot snapshot;
+  std::string fileName;
+  while (std::getline(manifestStream, fileName)) {
+    if (fileName.empty()) {
+      continue;
+    }
+
+    std::ifstream in(fileName, std::ios::binary);
+    if (!in.is_open()) {
+      GALOIS_DIE("Could not open ", fileName, " listed in checkpoint manifest");
+    }
+
+    uint64_t header[HEADER_FIELDS];
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!in || header[0] != SNAPSHOT_MAGIC) {
+      GALOIS_DIE(fileName, " is not a checkpoint snapshot");
+    }
+    snapshot.full     = header[1];
+    snapshot.numNodes = header[2];
+    snapshot.nodeSize = header[3];
+
+    snapshot.nodes.resize(header[4]);
+    snapshot.data.resize(header[5]);
+    in.read(reinterpret_cast<char*>(snapshot.nodes.data()),
+            snapshot.nodes.size() * sizeof(uint32_t));
+    in.read(snapshot.data.data(), snapshot.data.size());
+    if (!in) {
+      GALOIS_DIE("Checkpoint snapshot ", fileName, " is truncated");
+    }
+
+    apply(snapshot);
+    ++numApplied;
+  }
+
+  return numApplied;
+}
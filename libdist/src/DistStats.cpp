@@ -24,6 +24,11 @@
  */
 #include "galois/runtime/DistStats.h"
 #include "galois/runtime/Serialize.h"
+#include "galois/runtime/Timeline.h"
+
+#include <fstream>
+#include <limits>
+#include <sstream>
 
 using namespace galois::runtime;
 
@@ -186,6 +191,115 @@ void DistStatManager::combineAtHost_0(void) {
   galois::runtime::getHostFence().wait();
 }
 
+void DistStatManager::writeTimeline(void) {
+  if (timelineFile().empty()) {
+    return;
+  }
+
+  auto& net = getSystemNetworkInterface();
+  if (net.Num == 1) {
+    Base::writeTimeline();
+    return;
+  }
+
+  auto recv = [&net](void) {
+    decltype(net.recieveTagged(galois::runtime::evilPhase, nullptr)) p;
+    do {
+      net.handleReceives();
+      p = net.recieveTagged(galois::runtime::evilPhase, nullptr);
+    } while (!p);
+    return p;
+  };
+
+  auto nextPhase = [](void) {
+    ++galois::runtime::evilPhase;
+    if (galois::runtime::evilPhase >=
+        std::numeric_limits<int16_t>::max()) { // limit defined by MPI or LCI
+      galois::runtime::evilPhase = 1;
+    }
+  };
+
+  auto send = [&net](uint32_t dest, SendBuffer& b) {
+    net.sendTagged(dest, galois::runtime::evilPhase, b);
+    net.flush();
+  };
+
+  constexpr unsigned SYNC_ROUNDS = 8;
+  std::vector<std::string> remoteEvents;
+
+  if (getHostID() == 0) {
+    // one host at a time; the other hosts wait for their first ping, so
+    // every message host 0 receives in this phase comes from host h. Event
+    // strings are sent in the next phase so that a host that has its shift
+    // cannot answer in place of the one being synchronized.
+    for (unsigned h = 1; h < net.Num; ++h) {
+      uint64_t bestRTT = std::numeric_limits<uint64_t>::max();
+      int64_t offset   = 0;
+
+      for (unsigned r = 0; r < SYNC_ROUNDS; ++r) {
+        uint64_t t0 = internal::timelineNow();
+        SendBuffer b;
+        gSerialize(b, t0);
+        send(h, b);
+
+        auto p = recv();
+        assert(p->first == h);
+        uint64_t remoteNow;
+        gDeserialize(p->second, remoteNow);
+        uint64_t t1 = internal::timelineNow();
+
+        if (t1 - t0 < bestRTT) {
+          bestRTT = t1 - t0;
+          offset  = int64_t(remoteNow) - int64_t(t0 + (t1 - t0) / 2);
+        }
+      }
+
+      SendBuffer b;
+      gSerialize(b, int64_t(timelineEpoch()) + offset);
+      send(h, b);
+    }
+    nextPhase();
+
+    remoteEvents.resize(net.Num);
+    for (unsigned i = 1; i < net.Num; ++i) {
+      auto p = recv();
+      gDeserialize(p->second, remoteEvents[p->first]);
+    }
+  } else {
+    for (unsigned r = 0; r < SYNC_ROUNDS; ++r) {
+      recv();
+      SendBuffer b;
+      gSerialize(b, internal::timelineNow());
+      send(0, b);
+    }
+
+    int64_t shift;
+    auto p = recv();
+    gDeserialize(p->second, shift);
+    nextPhase();
+
+    std::ostringstream events;
+    timelineWriteEvents(events, getHostID(), shift);
+    SendBuffer b;
+    gSerialize(b, events.str());
+    send(0, b);
+  }
+  nextPhase();
+
+  if (getHostID() == 0) {
+    std::ofstream outf(timelineFile().c_str());
+    if (outf.good()) {
+      timelineWriteTrace(outf, remoteEvents);
+    } else {
+      gWarn("Could not open timeline file for writing, file provided:",
+            timelineFile());
+    }
+  }
+
+  // keep the other hosts alive until the trace is on disk
+  getHostBarrier().wait();
+}
+
 bool DistStatManager::printingHostVals(void) {
   return galois::substrate::EnvCheck(DistStatManager::HSTAT_ENV_VAR);
 }
@@ -54,6 +54,13 @@ cll::opt<DataCommMode> enforce_metadata(
                 clEnumValN(onlyData, "none",
                            "Do not use any metadata (sends "
                            "non-updated values)"),
+                clEnumValN(offsetsVarintData, "offsetsVarint",
+                           "Use delta+varint encoded offsets metadata always"),
+                clEnumValN(bitsetRLEData, "bitsetRLE",
+                           "Use run-length encoded bitset metadata always"),
+                clEnumValN(xorDeltaData, "xorDelta",
+                           "Use varint offsets metadata and XOR the data "
+                           "against the previously sent round always"),
                 //clEnumValN(neverOnlyData, "neverOnlyData",
                 //           "Never send onlyData"),
                 clEnumValEnd),
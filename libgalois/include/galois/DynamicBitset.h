@@ -33,6 +33,7 @@
 #include "galois/Galois.h"
 #include <boost/iterator/counting_iterator.hpp>
 #include <boost/mpl/has_xxx.hpp>
+#include <algorithm>
 #include <climits> // CHAR_BIT
 #include <vector>
 #include <assert.h>
@@ -40,6 +41,13 @@
 namespace galois {
 /**
  * Concurrent dynamically allocated bitset
+ *
+ * The bitset can optionally keep a summary: a second-level bitmap with one
+ * bit per 64-bit word that is set whenever the word may be non-zero. With a
+ * summary, scanning and resetting a sparse bitset only touches the words
+ * that have bits set. The summary is maintained by set and by the bitwise
+ * operations; code that writes words through get_vec must call
+ * rebuild_summary afterwards.
  **/
 class DynamicBitSet {
 protected:
@@ -47,9 +55,152 @@ protected:
   size_t num_bits;
   static constexpr uint32_t bits_uint64 = sizeof(uint64_t) * CHAR_BIT;
 
+  //! Bit w is set if word w of bitvec may be non-zero; see enable_summary
+  galois::PODResizeableArray<galois::CopyableAtomic<uint64_t>> summary;
+  //! True if summary is maintained
+  bool use_summary;
+
+  //! Number of set bits in a word
+  static unsigned popcount(uint64_t n) {
+#ifdef __GNUC__
+    return __builtin_popcountll(n);
+#else
+    n = n - ((n >> 1) & 0x5555555555555555UL);
+    n = (n & 0x3333333333333333UL) + ((n >> 2) & 0x3333333333333333UL);
+    return (((n + (n >> 4)) & 0xF0F0F0F0F0F0F0FUL) * 0x101010101010101UL) >>
+           56;
+#endif
+  }
+
+  //! Index of the lowest set bit of a non-zero word
+  static unsigned ctz(uint64_t n) {
+    assert(n != 0);
+#ifdef __GNUC__
+    return __builtin_ctzll(n);
+#else
+    return popcount((n & -n) - 1);
+#endif
+  }
+
+  //! Mask of the bits of word w that lie in the bit range [begin, end)
+  static uint64_t range_mask(size_t w, size_t begin, size_t end) {
+    uint64_t mask = ~(uint64_t)0;
+    if (w == begin / bits_uint64) {
+      mask &= mask << (begin % bits_uint64);
+    }
+    if (w == (end - 1) / bits_uint64) {
+      mask &= ~(uint64_t)0 >> (bits_uint64 - 1 - (end - 1) % bits_uint64);
+    }
+    return mask;
+  }
+
+  /**
+   * Zeroes the words in [wbegin, wend). With a summary, only the words
+   * marked in it are written and their summary bits are cleared.
+   */
+  void clear_words(size_t wbegin, size_t wend) {
+    if (wbegin >= wend) {
+      return;
+    }
+    if (!use_summary) {
+      std::fill(bitvec.begin() + wbegin, bitvec.begin() + wend, 0);
+      return;
+    }
+    for (size_t s = wbegin / bits_uint64; s <= (wend - 1) / bits_uint64; ++s) {
+      uint64_t mask  = range_mask(s, wbegin, wend);
+      uint64_t marks = summary[s].load(std::memory_order_relaxed) & mask;
+      if (marks == 0) {
+        continue;
+      }
+      while (marks) {
+        bitvec[s * bits_uint64 + ctz(marks)].store(0,
+                                                   std::memory_order_relaxed);
+        marks &= marks - 1;
+      }
+      summary[s].fetch_and(~mask, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Calls fn(w, word) for each non-zero word w that overlaps the bit range
+   * [begin, end); bits of the word outside the range are masked off. With a
+   * summary, words that are not marked in it are skipped without being read.
+   */
+  template <typename FnTy>
+  void for_each_word(size_t begin, size_t end, FnTy fn) const {
+    if (begin >= end) {
+      return;
+    }
+    size_t wbegin = begin / bits_uint64;
+    size_t wend   = (end + bits_uint64 - 1) / bits_uint64;
+
+    auto visit = [&](size_t w) {
+      uint64_t word = bitvec[w].load(std::memory_order_relaxed);
+      if (word != 0) {
+        word &= range_mask(w, begin, end);
+        if (word != 0) {
+          fn(w, word);
+        }
+      }
+    };
+
+    if (use_summary) {
+      for (size_t s = wbegin / bits_uint64; s <= (wend - 1) / bits_uint64;
+           ++s) {
+        uint64_t marks = summary[s].load(std::memory_order_relaxed) &
+                         range_mask(s, wbegin, wend);
+        while (marks) {
+          visit(s * bits_uint64 + ctz(marks));
+          marks &= marks - 1;
+        }
+      }
+    } else {
+      for (size_t w = wbegin; w < wend; ++w) {
+        visit(w);
+      }
+    }
+  }
+
 public:
   //! Constructor which initializes to an empty bitset.
-  DynamicBitSet() : num_bits(0) {}
+  DynamicBitSet() : num_bits(0), use_summary(false) {}
+
+  /**
+   * Starts maintaining the summary of non-empty words. Not thread safe.
+   */
+  void enable_summary() {
+    use_summary = true;
+    rebuild_summary();
+  }
+
+  /**
+   * Returns true if the summary of non-empty words is maintained.
+   */
+  bool has_summary() const { return use_summary; }
+
+  /**
+   * Recomputes the summary from the words of the bitset; needed after the
+   * words were written through get_vec. Does nothing without a summary.
+   */
+  void rebuild_summary() {
+    if (!use_summary) {
+      return;
+    }
+    size_t numWords = bitvec.size();
+    summary.resize((numWords + bits_uint64 - 1) / bits_uint64);
+    galois::do_all(galois::iterate((size_t)0, summary.size()),
+                   [&](size_t s) {
+                     uint64_t marks = 0;
+                     size_t wend    = std::min(numWords, (s + 1) * bits_uint64);
+                     for (size_t w = s * bits_uint64; w < wend; ++w) {
+                       if (bitvec[w].load(std::memory_order_relaxed) != 0) {
+                         marks |= (uint64_t)1 << (w % bits_uint64);
+                       }
+                     }
+                     summary[s].store(marks, std::memory_order_relaxed);
+                   },
+                   galois::no_stats());
+  }
 
   /**
    * Returns the underlying bitset representation to the user
@@ -76,6 +227,20 @@ public:
    */
   void resize(uint64_t n) {
     assert(bits_uint64 == 64); // compatibility with other devices
+    if (use_summary) {
+      // clear the marked words while the summary still describes them, so
+      // only words that are new to the array need a full fill
+      reset();
+      size_t oldWords = bitvec.size();
+      num_bits        = n;
+      bitvec.resize((n + bits_uint64 - 1) / bits_uint64);
+      if (bitvec.size() > oldWords) {
+        std::fill(bitvec.begin() + oldWords, bitvec.end(), 0);
+      }
+      summary.resize((bitvec.size() + bits_uint64 - 1) / bits_uint64);
+      std::fill(summary.begin(), summary.end(), 0);
+      return;
+    }
     num_bits = n;
     bitvec.resize((n + bits_uint64 - 1) / bits_uint64);
     reset();
@@ -106,7 +271,7 @@ public:
   /**
    * Unset every bit in the bitset.
    */
-  void reset() { std::fill(bitvec.begin(), bitvec.end(), 0); }
+  void reset() { clear_words(0, bitvec.size()); }
 
   /**
    * Unset a range of bits given an inclusive range
@@ -139,7 +304,7 @@ public:
       vec_end = (end + 1) / bits_uint64; // floor
 
     if (vec_begin < vec_end) {
-      std::fill(bitvec.begin() + vec_begin, bitvec.begin() + vec_end, 0);
+      clear_words(vec_begin, vec_end);
     }
 
     vec_begin *= bits_uint64;
@@ -206,6 +371,12 @@ public:
       while (!bitvec[bit_index].compare_exchange_weak(
           old_val, old_val | bit_offset, std::memory_order_relaxed))
         ;
+      // only the thread that makes the word non-zero marks the summary
+      if (use_summary && old_val == 0) {
+        uint64_t mark = (uint64_t)1 << (bit_index % bits_uint64);
+        summary[bit_index / bits_uint64].fetch_or(mark,
+                                                  std::memory_order_relaxed);
+      }
     }
   }
 
@@ -228,6 +399,7 @@ public:
     galois::do_all(galois::iterate(0ul, bitvec.size()),
                    [&](size_t i) { bitvec[i] |= other_bitvec[i]; },
                    galois::no_stats());
+    rebuild_summary();
   }
 
   // assumes bit_vector is not updated (set) in parallel
@@ -243,6 +415,7 @@ public:
     galois::do_all(galois::iterate(0ul, bitvec.size()),
                    [&](size_t i) { bitvec[i] &= other_bitvec[i]; },
                    galois::no_stats());
+    rebuild_summary();
   }
 
   /**
@@ -263,6 +436,7 @@ public:
                      bitvec[i] = other_bitvec1[i] & other_bitvec2[i];
                    },
                    galois::no_stats());
+    rebuild_summary();
   }
 
   /**
@@ -276,6 +450,7 @@ public:
     galois::do_all(galois::iterate(0ul, bitvec.size()),
                    [&](size_t i) { bitvec[i] ^= other_bitvec[i]; },
                    galois::no_stats());
+    rebuild_summary();
   }
 
   /**
@@ -296,6 +471,7 @@ public:
                      bitvec[i] = other_bitvec1[i] ^ other_bitvec2[i];
                    },
                    galois::no_stats());
+    rebuild_summary();
   }
 
 
@@ -307,22 +483,67 @@ public:
   uint64_t count() const {
     galois::GAccumulator<uint64_t> ret;
     galois::do_all(galois::iterate(bitvec.begin(), bitvec.end()),
-                   [&](uint64_t n) {
-  #ifdef __GNUC__
-                     ret += __builtin_popcountll(n);
-  #else
-                     n = n - ((n >> 1) & 0x5555555555555555UL);
-                     n = (n & 0x3333333333333333UL) +
-                         ((n >> 2) & 0x3333333333333333UL);
-                     ret += (((n + (n >> 4)) & 0xF0F0F0F0F0F0F0FUL) *
-                             0x101010101010101UL) >>
-                            56;
-  #endif
-                   },
+                   [&](uint64_t n) { ret += popcount(n); },
                    galois::no_stats());
     return ret.reduce();
   }
 
+  /**
+   * Count how many bits are set in a range of the bitset. Works a word at a
+   * time and skips empty words (and, with a summary, empty regions).
+   *
+   * @param begin first bit of the range
+   * @param end one past the last bit of the range
+   * @returns number of set bits in [begin, end)
+   */
+  uint64_t count(size_t begin, size_t end) const {
+    uint64_t ret = 0;
+    for_each_word(begin, end,
+                  [&](size_t, uint64_t word) { ret += popcount(word); });
+    return ret;
+  }
+
+  /**
+   * Calls fn on the index of each set bit in a range of the bitset, in
+   * increasing order. Works a word at a time and skips empty words (and,
+   * with a summary, empty regions).
+   *
+   * @param begin first bit of the range
+   * @param end one past the last bit of the range
+   * @param fn function called with the index of each set bit
+   */
+  template <typename FnTy>
+  void for_each_set(size_t begin, size_t end, FnTy fn) const {
+    for_each_word(begin, end, [&](size_t w, uint64_t word) {
+      while (word) {
+        fn(w * bits_uint64 + ctz(word));
+        word &= word - 1;
+      }
+    });
+  }
+
+  /**
+   * Calls fn on the index of each set bit of the bitset from a do_all. Each
+   * iteration covers the bits of one summary word (4096 bits), so with a
+   * summary an empty region costs a single load. Do NOT call in a parallel
+   * region.
+   *
+   * @param fn function called with the index of each set bit; must be safe
+   * to call concurrently
+   */
+  template <typename FnTy>
+  void parallel_for_each_set(FnTy fn) const {
+    const size_t regionBits = bits_uint64 * bits_uint64;
+    const size_t numRegions = (num_bits + regionBits - 1) / regionBits;
+    galois::do_all(galois::iterate((size_t)0, numRegions),
+                   [&](size_t r) {
+                     for_each_set(r * regionBits,
+                                  std::min(num_bits, (r + 1) * regionBits),
+                                  fn);
+                   },
+                   galois::no_stats(), galois::steal());
+  }
+
   /**
    * Returns a vector containing the set bits in this bitset in order
    * from left to right.
@@ -343,12 +564,7 @@ public:
         std::tie(start, end) = galois::block_range((size_t)0, this->size(), tid,
                                                    nthreads);
 
-        unsigned int count = 0;
-        for (unsigned int i = start; i < end; ++i) {
-          if (this->test(i)) ++count;
-        }
-
-        tPrefixBitCounts[tid] = count;
+        tPrefixBitCounts[tid] = this->count(start, end);
     });
 
     // calculate prefix sum of bits per thread
@@ -378,12 +594,10 @@ public:
             tPrefixBitCount = tPrefixBitCounts[tid - 1];
           }
 
-          for (unsigned int i = start; i < end; ++i) {
-            if (this->test(i)) {
-              offsets[tPrefixBitCount + count] = i;
-              ++count;
-            }
-          }
+          this->for_each_set(start, end, [&](size_t i) {
+            offsets[tPrefixBitCount + count] = i;
+            ++count;
+          });
         }
       );
     }
@@ -133,9 +133,12 @@ static inline void reportPageAlloc(const char* label) {
  * Operator should conform to <code>fn(item, UserContext<T>&)</code> where item
  * is a value from the iteration range and T is the type of item. Comparison
  * function should conform to <code>bool r = cmp(item1, item2)</code> where r is
- * true if item1 is less than or equal to item2. Neighborhood function should
- * conform to <code>nhFunc(item)</code> and should visit every element in the
- * neighborhood of active element item.
+ * true if item1 has strictly higher priority than (i.e., is less than) item2.
+ * Neighborhood function should conform to
+ * <code>nhFunc(item, UserContext<T>&)</code> and should acquire every element
+ * in the neighborhood of active element item; the operator may only touch that
+ * neighborhood. Items pushed by the operator must not precede any item they
+ * conflict with.
  *
  * @param b begining of range of initial items
  * @param e end of range of initial items
@@ -156,11 +159,13 @@ void for_each_ordered(Iter b, Iter e, const Cmp& cmp, const NhFunc& nhFunc,
  * Operator should conform to <code>fn(item, UserContext<T>&)</code> where item
  * is a value from the iteration range and T is the type of item. Comparison
  * function should conform to <code>bool r = cmp(item1, item2)</code> where r is
- * true if item1 is less than or equal to item2. Neighborhood function should
- * conform to <code>nhFunc(item)</code> and should visit every element in the
- * neighborhood of active element item. The stability test should conform to
- * <code>bool r = stabilityTest(item)</code> where r is true if item is a stable
- * source.
+ * true if item1 has strictly higher priority than (i.e., is less than) item2.
+ * Neighborhood function should conform to
+ * <code>nhFunc(item, UserContext<T>&)</code> and should acquire every element
+ * in the neighborhood of active element item. The stability test should
+ * conform to <code>bool r = stabilityTest(item)</code> where r is true if item
+ * is a stable source. Sources that are not stable are retried later; the
+ * earliest pending item is always considered stable.
  *
  * @param b begining of range of initial items
  * @param e end of range of initial items
@@ -0,0 +1,226 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef GALOIS_SETINTERSECTION_H
+#define GALOIS_SETINTERSECTION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace galois {
+/**
+ * Kernels for intersecting sorted, duplicate-free sets of 32-bit ids, such as
+ * the sorted adjacency lists used by triangle, clique and motif counting.
+ * Inputs are plain pointer ranges, so graph edge ranges can be intersected in
+ * place (see LC_CSR_Graph::getEdgeDstPtr).
+ */
+namespace intersection {
+
+//! Size ratio above which the smaller set is galloped through the larger one
+constexpr size_t gallopRatio = 32;
+
+//! Branch-light scalar merge
+inline size_t countMerge(const uint32_t* a, size_t na, const uint32_t* b,
+                         size_t nb) {
+  size_t i = 0, j = 0, count = 0;
+  while (i < na && j < nb) {
+    uint32_t x = a[i];
+    uint32_t y = b[j];
+    count += (x == y);
+    i += (x <= y);
+    j += (y <= x);
+  }
+  return count;
+}
+
+/**
+ * First element in [first, last) not less than x, found by doubling the
+ * search window before a binary search; cheap when x is near first.
+ */
+inline const uint32_t* gallop(const uint32_t* first, const uint32_t* last,
+                              uint32_t x) {
+  if (first == last || *first >= x)
+    return first;
+  size_t bound = 1;
+  size_t n     = last - first;
+  while (bound < n && first[bound] < x)
+    bound *= 2;
+  return std::lower_bound(first + bound / 2, first + std::min(bound + 1, n),
+                          x);
+}
+
+//! Looks up each element of the small set in the large one
+inline size_t countGallop(const uint32_t* small, size_t ns,
+                          const uint32_t* large, size_t nl) {
+  const uint32_t* p   = large;
+  const uint32_t* end = large + nl;
+  size_t count        = 0;
+  for (size_t i = 0; i < ns && p != end; ++i) {
+    p = gallop(p, end, small[i]);
+    if (p != end && *p == small[i]) {
+      ++count;
+      ++p;
+    }
+  }
+  return count;
+}
+
+/**
+ * Block merge: compares a block of a against every rotation of a block of b,
+ * then advances whichever block has the smaller maximum (both on a tie).
+ * Uses 16-wide AVX-512 or 8-wide AVX2 blocks when compiled for them and
+ * finishes the tail with countMerge.
+ */
+inline size_t countSIMD(const uint32_t* a, size_t na, const uint32_t* b,
+                        size_t nb) {
+  size_t i = 0, j = 0, count = 0;
+#if defined(__AVX512F__)
+  const __m512i rotate =
+      _mm512_set_epi32(0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+  while (i + 16 <= na && j + 16 <= nb) {
+    __m512i va    = _mm512_loadu_si512(a + i);
+    __m512i vb    = _mm512_loadu_si512(b + j);
+    __mmask16 hit = _mm512_cmpeq_epi32_mask(va, vb);
+    for (int r = 1; r < 16; ++r) {
+      // zero-masked form: the unmasked intrinsic passes an undefined vector
+      // through and trips -Wmaybe-uninitialized on GCC
+      vb = _mm512_maskz_permutexvar_epi32(0xFFFF, rotate, vb);
+      hit |= _mm512_cmpeq_epi32_mask(va, vb);
+    }
+    count += __builtin_popcount(hit);
+    uint32_t amax = a[i + 15];
+    uint32_t bmax = b[j + 15];
+    i += (amax <= bmax) ? 16 : 0;
+    j += (bmax <= amax) ? 16 : 0;
+  }
+#elif defined(__AVX2__)
+  const __m256i rotate = _mm256_set_epi32(0, 7, 6, 5, 4, 3, 2, 1);
+  while (i + 8 <= na && j + 8 <= nb) {
+    __m256i va  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    __m256i vb  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+    __m256i hit = _mm256_cmpeq_epi32(va, vb);
+    for (int r = 1; r < 8; ++r) {
+      vb  = _mm256_permutevar8x32_epi32(vb, rotate);
+      hit = _mm256_or_si256(hit, _mm256_cmpeq_epi32(va, vb));
+    }
+    count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(hit)));
+    uint32_t amax = a[i + 7];
+    uint32_t bmax = b[j + 7];
+    i += (amax <= bmax) ? 8 : 0;
+    j += (bmax <= amax) ? 8 : 0;
+  }
+#endif
+  return count + countMerge(a + i, na - i, b + j, nb - j);
+}
+
+//! Picks a kernel from the size ratio of the two sets
+inline size_t count(const uint32_t* a, size_t na, const uint32_t* b,
+                    size_t nb) {
+  if (na > nb) {
+    std::swap(a, b);
+    std::swap(na, nb);
+  }
+  if (na == 0)
+    return 0;
+  if (nb / na >= gallopRatio)
+    return countGallop(a, na, b, nb);
+  return countSIMD(a, na, b, nb);
+}
+
+/**
+ * Writes the intersection to out (which must have room for min(na, nb)
+ * elements) and returns its size.
+ */
+inline size_t intersect(const uint32_t* a, size_t na, const uint32_t* b,
+                        size_t nb, uint32_t* out) {
+  if (na > nb) {
+    std::swap(a, b);
+    std::swap(na, nb);
+  }
+  uint32_t* o = out;
+  if (na && nb / na >= gallopRatio) {
+    const uint32_t* p   = b;
+    const uint32_t* end = b + nb;
+    for (size_t i = 0; i < na && p != end; ++i) {
+      p = gallop(p, end, a[i]);
+      if (p != end && *p == a[i]) {
+        *o++ = a[i];
+        ++p;
+      }
+    }
+  } else {
+    size_t i = 0, j = 0;
+    while (i < na && j < nb) {
+      uint32_t x = a[i];
+      uint32_t y = b[j];
+      *o         = x;
+      o += (x == y);
+      i += (x <= y);
+      j += (y <= x);
+    }
+  }
+  return o - out;
+}
+
+/**
+ * Membership bitmap over the id universe for intersecting one large set (a
+ * hub's neighborhood) with many others: mark it once, count each partner with
+ * a scan, then unmark. Intended to be kept per thread.
+ */
+class Bitmap {
+  std::vector<uint64_t> bits;
+
+public:
+  explicit Bitmap(size_t universe = 0) : bits((universe + 63) / 64, 0) {}
+
+  void resize(size_t universe) { bits.assign((universe + 63) / 64, 0); }
+
+  bool empty() const { return bits.empty(); }
+
+  void mark(const uint32_t* a, size_t na) {
+    for (size_t i = 0; i < na; ++i)
+      bits[a[i] / 64] |= uint64_t(1) << (a[i] % 64);
+  }
+
+  void unmark(const uint32_t* a, size_t na) {
+    for (size_t i = 0; i < na; ++i)
+      bits[a[i] / 64] = 0;
+  }
+
+  bool test(uint32_t x) const { return (bits[x / 64] >> (x % 64)) & 1; }
+
+  //! Number of elements of b that are marked
+  size_t count(const uint32_t* b, size_t nb) const {
+    size_t c = 0;
+    for (size_t i = 0; i < nb; ++i)
+      c += test(b[i]);
+    return c;
+  }
+};
+
+} // namespace intersection
+} // namespace galois
+
+#endif
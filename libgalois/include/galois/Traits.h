@@ -175,6 +175,18 @@ struct loopname : public trait_has_value<const char*>, loopname_tag {
 struct steal_tag {};
 struct steal : public trait_has_type<bool>, steal_tag {};
 
+/**
+ * Indicate that work-stealing {@link do_all()} loops should size chunks per
+ * thread at runtime instead of using a fixed chunk size. Chunks grow while
+ * they finish quickly and shrink when they run long or when other threads
+ * steal from the owner; stolen ranges are split in halves. The
+ * {@link chunk_size} argument gives the initial chunk size. Implies
+ * {@link steal}.
+ */
+struct adaptive_chunk_size_tag {};
+struct adaptive_chunk_size : public trait_has_type<bool>,
+                             adaptive_chunk_size_tag {};
+
 /**
  * Indicates worklist to use. Optional argument to {@link for_each()} loops.
  */
@@ -229,6 +241,17 @@ struct more_stats : public trait_has_type<bool>, more_stats_tag {};
 struct no_conflicts_tag {};
 struct no_conflicts : public trait_has_type<bool>, no_conflicts_tag {};
 
+/**
+ * Indicates the operator should use optimistic conflict detection: the
+ * neighborhood is locked only at the cautious point, after validating that
+ * it has not changed, and lockables acquired with MethodFlag::READ are never
+ * locked. The operator must call UserContext::cautiousPoint() before its
+ * first write.
+ */
+struct optimistic_conflicts_tag {};
+struct optimistic_conflicts : public trait_has_type<bool>,
+                              optimistic_conflicts_tag {};
+
 /**
  * Indicates that the neighborhood set does not change through out i.e. is not
  * dependent on computed values. Examples of such fixed neighborhood is e.g.
@@ -80,6 +80,35 @@ public:
     return rep;
   }
 
+  //! Lock-free find with path splitting: every node on the path is pointed
+  //! at its grandparent. Links only ever move toward the root, so this is
+  //! safe to run concurrently with merges.
+  T* findAndSplit() {
+    UnionFindNode* node = this;
+    T* parent           = m_component.load(std::memory_order_relaxed);
+    while (true) {
+      T* grand = parent->m_component.load(std::memory_order_relaxed);
+      if (grand == parent)
+        return parent;
+      T* expected = parent;
+      node->m_component.compare_exchange_weak(expected, grand,
+                                              std::memory_order_relaxed);
+      node   = parent;
+      parent = grand;
+    }
+  }
+
+  //! Points this node directly at its representative (pointer jumping).
+  //! The link is only replaced if it is unchanged, so concurrent merges are
+  //! not lost.
+  void compress() {
+    T* parent = m_component.load(std::memory_order_relaxed);
+    T* rep    = findImpl();
+    if (parent != rep)
+      m_component.compare_exchange_strong(parent, rep,
+                                          std::memory_order_relaxed);
+  }
+
   //! Lock-free merge. Returns if merge was done.
   T* merge(T* b) {
     T* a = m_component.load(std::memory_order_relaxed);
@@ -96,6 +125,24 @@ public:
       }
     }
   }
+
+  //! Lock-free merge using path splitting for the finds. Returns if merge
+  //! was done.
+  T* mergeAndSplit(T* b) {
+    T* a = m_component.load(std::memory_order_relaxed);
+    while (true) {
+      a = a->findAndSplit();
+      b = b->findAndSplit();
+      if (a == b)
+        return 0;
+      // Avoid cycles by directing edges consistently
+      if (a < b)
+        std::swap(a, b);
+      if (a->m_component.compare_exchange_strong(a, b)) {
+        return b;
+      }
+    }
+  }
 };
 } // namespace galois
 #endif
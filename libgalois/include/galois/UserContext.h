@@ -157,11 +157,13 @@ public:
 
   //! declare that the operator has crossed the cautious point.  This
   //! implies all data has been touched thus no new locks will be
-  //! acquired.
+  //! acquired. Under optimistic conflict detection, the neighborhood is
+  //! validated and locked here.
   void cautiousPoint() {
     if (isFirstPass()) {
       galois::runtime::signalFailSafe();
     }
+    galois::runtime::signalCautiousPoint();
   }
 };
 
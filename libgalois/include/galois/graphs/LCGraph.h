@@ -26,6 +26,7 @@
 #include "LC_Morph_Graph.h"
 #include "LC_InOut_Graph.h"
 #include "LC_Adaptor_Graph.h"
+#include "LC_Compressed_CSR_Graph.h"
 #include "Util.h"
 
 #endif
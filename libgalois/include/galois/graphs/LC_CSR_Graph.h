@@ -24,8 +24,12 @@
 #include "galois/graphs/Details.h"
 #include "galois/graphs/FileGraph.h"
 #include "galois/graphs/GraphHelpers.h"
+#include "galois/substrate/NumaMem.h"
 
 #include <type_traits>
+#include <vector>
+
+#include <unistd.h>
 
 /*
  * Headers for boost serialization
@@ -60,7 +64,8 @@ namespace graphs {
 template <typename NodeTy, typename EdgeTy, bool HasNoLockable = false,
           bool UseNumaAlloc =
               false, // true => numa-blocked, false => numa-interleaved
-          bool HasOutOfLineLockable = false, typename FileEdgeTy = EdgeTy>
+          bool HasOutOfLineLockable = false, typename FileEdgeTy = EdgeTy,
+          bool UseReplicatedTopology = false>
 class LC_CSR_Graph :
     //! [doxygennuma]
     private boost::noncopyable,
@@ -79,21 +84,24 @@ public:
   template <typename _node_data>
   struct with_node_data {
     typedef LC_CSR_Graph<_node_data, EdgeTy, HasNoLockable, UseNumaAlloc,
-                         HasOutOfLineLockable, FileEdgeTy>
+                         HasOutOfLineLockable, FileEdgeTy,
+                         UseReplicatedTopology>
         type;
   };
 
   template <typename _edge_data>
   struct with_edge_data {
     typedef LC_CSR_Graph<NodeTy, _edge_data, HasNoLockable, UseNumaAlloc,
-                         HasOutOfLineLockable, FileEdgeTy>
+                         HasOutOfLineLockable, FileEdgeTy,
+                         UseReplicatedTopology>
         type;
   };
 
   template <typename _file_edge_data>
   struct with_file_edge_data {
     typedef LC_CSR_Graph<NodeTy, EdgeTy, HasNoLockable, UseNumaAlloc,
-                         HasOutOfLineLockable, _file_edge_data>
+                         HasOutOfLineLockable, _file_edge_data,
+                         UseReplicatedTopology>
         type;
   };
 
@@ -101,31 +109,44 @@ public:
   template <bool _has_no_lockable>
   struct with_no_lockable {
     typedef LC_CSR_Graph<NodeTy, EdgeTy, _has_no_lockable, UseNumaAlloc,
-                         HasOutOfLineLockable, FileEdgeTy>
+                         HasOutOfLineLockable, FileEdgeTy,
+                         UseReplicatedTopology>
         type;
   };
   template <bool _has_no_lockable>
   using _with_no_lockable =
       LC_CSR_Graph<NodeTy, EdgeTy, _has_no_lockable, UseNumaAlloc,
-                   HasOutOfLineLockable, FileEdgeTy>;
+                   HasOutOfLineLockable, FileEdgeTy, UseReplicatedTopology>;
 
   //! If true, use NUMA-aware graph allocation
   template <bool _use_numa_alloc>
   struct with_numa_alloc {
     typedef LC_CSR_Graph<NodeTy, EdgeTy, HasNoLockable, _use_numa_alloc,
-                         HasOutOfLineLockable, FileEdgeTy>
+                         HasOutOfLineLockable, FileEdgeTy,
+                         UseReplicatedTopology>
         type;
   };
   template <bool _use_numa_alloc>
   using _with_numa_alloc =
       LC_CSR_Graph<NodeTy, EdgeTy, HasNoLockable, _use_numa_alloc,
-                   HasOutOfLineLockable, FileEdgeTy>;
+                   HasOutOfLineLockable, FileEdgeTy, UseReplicatedTopology>;
 
   //! If true, store abstract locks separate from nodes
   template <bool _has_out_of_line_lockable>
   struct with_out_of_line_lockable {
     typedef LC_CSR_Graph<NodeTy, EdgeTy, HasNoLockable, UseNumaAlloc,
-                         _has_out_of_line_lockable, FileEdgeTy>
+                         _has_out_of_line_lockable, FileEdgeTy,
+                         UseReplicatedTopology>
+        type;
+  };
+
+  //! If true, topology reads are served from a per-socket replica once
+  //! replicateTopology() has been called
+  template <bool _use_replicated_topology>
+  struct with_replicated_topology {
+    typedef LC_CSR_Graph<NodeTy, EdgeTy, HasNoLockable, UseNumaAlloc,
+                         HasOutOfLineLockable, FileEdgeTy,
+                         _use_replicated_topology>
         type;
   };
 
@@ -166,16 +187,34 @@ protected:
   uint64_t numNodes;
   uint64_t numEdges;
 
+  //! per-socket views of edgeIndData/edgeDst; empty until replicated
+  std::vector<uint64_t*> socketEdgeInd;
+  std::vector<uint32_t*> socketEdgeDst;
+  //! backing memory of the replicas, one allocation per socket
+  std::vector<substrate::LAptr> topologyReplicas;
+
+  const uint64_t* localEdgeInd() const {
+    if (UseReplicatedTopology && !socketEdgeInd.empty())
+      return socketEdgeInd[substrate::ThreadPool::getSocket()];
+    return edgeIndData.data();
+  }
+
+  const uint32_t* localEdgeDst() const {
+    if (UseReplicatedTopology && !socketEdgeDst.empty())
+      return socketEdgeDst[substrate::ThreadPool::getSocket()];
+    return edgeDst.data();
+  }
+
   typedef internal::EdgeSortIterator<
       GraphNode, typename EdgeIndData::value_type, EdgeDst, EdgeData>
       edge_sort_iterator;
 
   edge_iterator raw_begin(GraphNode N) const {
-    return edge_iterator((N == 0) ? 0 : edgeIndData[N - 1]);
+    return edge_iterator((N == 0) ? 0 : localEdgeInd()[N - 1]);
   }
 
   edge_iterator raw_end(GraphNode N) const {
-    return edge_iterator(edgeIndData[N]);
+    return edge_iterator(localEdgeInd()[N]);
   }
 
   edge_sort_iterator edge_sort_begin(GraphNode N) {
@@ -389,6 +428,9 @@ public:
     swap(lhs.edgeData, rhs.edgeData);
     std::swap(lhs.numNodes, rhs.numNodes);
     std::swap(lhs.numEdges, rhs.numEdges);
+    std::swap(lhs.socketEdgeInd, rhs.socketEdgeInd);
+    std::swap(lhs.socketEdgeDst, rhs.socketEdgeDst);
+    std::swap(lhs.topologyReplicas, rhs.topologyReplicas);
   }
 
   node_data_reference getData(GraphNode N,
@@ -405,7 +447,16 @@ public:
     return edgeData[*ni];
   }
 
-  GraphNode getEdgeDst(edge_iterator ni) { return edgeDst[*ni]; }
+  GraphNode getEdgeDst(edge_iterator ni) { return localEdgeDst()[*ni]; }
+
+  /**
+   * Pointer to the destination of edge ni. Destinations of a node's edges are
+   * contiguous, so [getEdgeDstPtr(edge_begin(n)), getEdgeDstPtr(edge_end(n)))
+   * is its adjacency list without copying.
+   */
+  const GraphNode* getEdgeDstPtr(edge_iterator ni) const {
+    return localEdgeDst() + *ni;
+  }
 
   size_t size() const { return numNodes; }
   size_t sizeEdges() const { return numEdges; }
@@ -576,6 +627,8 @@ public:
   }
 
   void deallocate() {
+    dropTopologyReplicas();
+
     nodeData.destroy();
     nodeData.deallocate();
 
@@ -741,6 +794,101 @@ public:
     }
   }
 
+  /**
+   * Copies the read-only topology (edge index and destination arrays) into
+   * memory local to each socket that has active threads. Afterwards,
+   * edge_begin/edge_end/getEdgeDst executed on a thread read its socket's
+   * copy; node and edge data remain a single shared copy. The topology must
+   * not be modified (e.g., sorted) while replicas exist.
+   *
+   * If the replicas would exceed budgetBytes (default: half of the currently
+   * available physical memory) or only one socket is in use, the graph keeps
+   * its existing (interleaved or blocked) layout.
+   *
+   * @param budgetBytes upper bound on memory used for replicas; 0 selects the
+   * default
+   * @returns true if the topology was replicated
+   */
+  bool replicateTopology(size_t budgetBytes = 0) {
+    static_assert(UseReplicatedTopology,
+                  "replicateTopology requires with_replicated_topology<true>");
+    dropTopologyReplicas();
+
+    auto& pool              = substrate::getThreadPool();
+    unsigned activeThreads  = galois::getActiveThreads();
+    unsigned numSockets     = pool.getCumulativeMaxSocket(activeThreads - 1) + 1;
+    size_t indBytes         = numNodes * sizeof(uint64_t);
+    size_t dstBytes         = numEdges * sizeof(uint32_t);
+    size_t replicaBytes     = numSockets * (indBytes + dstBytes);
+
+    if (!budgetBytes) {
+      budgetBytes = static_cast<size_t>(sysconf(_SC_AVPHYS_PAGES)) *
+                    static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 2;
+    }
+
+    if (numSockets < 2 || numNodes == 0 || replicaBytes > budgetBytes) {
+      galois::runtime::reportStat_Single("LC_CSR_Graph", "TopologyReplicas",
+                                         0);
+      return false;
+    }
+
+    // rank of each thread among the active threads of its socket
+    std::vector<unsigned> socketThreads(pool.getMaxSockets(), 0);
+    std::vector<unsigned> socketRank(activeThreads);
+    for (unsigned t = 0; t < activeThreads; ++t) {
+      socketRank[t] = socketThreads[pool.getSocket(t)]++;
+    }
+
+    socketEdgeInd.assign(pool.getMaxSockets(), edgeIndData.data());
+    socketEdgeDst.assign(pool.getMaxSockets(), edgeDst.data());
+    topologyReplicas.resize(pool.getMaxSockets());
+
+    // leaders fault in the replica of their socket
+    galois::on_each(
+        [&](unsigned, unsigned) {
+          if (!substrate::ThreadPool::isLeader())
+            return;
+          unsigned s          = substrate::ThreadPool::getSocket();
+          topologyReplicas[s] = substrate::largeMallocLocal(indBytes + dstBytes);
+          char* base          = static_cast<char*>(topologyReplicas[s].get());
+          socketEdgeInd[s]    = reinterpret_cast<uint64_t*>(base);
+          socketEdgeDst[s]    = reinterpret_cast<uint32_t*>(base + indBytes);
+        },
+        galois::no_stats());
+
+    // all threads of a socket then fill its replica cooperatively
+    galois::on_each(
+        [&](unsigned tid, unsigned) {
+          unsigned s     = substrate::ThreadPool::getSocket();
+          unsigned rank  = socketRank[tid];
+          unsigned count = socketThreads[s];
+
+          uint64_t nBegin = numNodes * rank / count;
+          uint64_t nEnd   = numNodes * (rank + 1) / count;
+          std::copy(edgeIndData.data() + nBegin, edgeIndData.data() + nEnd,
+                    socketEdgeInd[s] + nBegin);
+
+          uint64_t eBegin = numEdges * rank / count;
+          uint64_t eEnd   = numEdges * (rank + 1) / count;
+          std::copy(edgeDst.data() + eBegin, edgeDst.data() + eEnd,
+                    socketEdgeDst[s] + eBegin);
+        },
+        galois::no_stats());
+
+    galois::runtime::reportStat_Single("LC_CSR_Graph", "TopologyReplicas",
+                                       numSockets);
+    galois::runtime::reportStat_Single("LC_CSR_Graph", "TopologyReplicaBytes",
+                                       replicaBytes);
+    return true;
+  }
+
+  //! Releases per-socket topology replicas; reads go back to the primary copy
+  void dropTopologyReplicas() {
+    socketEdgeInd.clear();
+    socketEdgeDst.clear();
+    topologyReplicas.clear();
+  }
+
   /**
    * Returns the reference to the edgeIndData LargeArray
    * (a prefix sum of edges)
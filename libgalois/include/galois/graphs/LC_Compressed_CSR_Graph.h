@@ -0,0 +1,602 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef GALOIS_GRAPH_LC_COMPRESSED_CSR_GRAPH_H
+#define GALOIS_GRAPH_LC_COMPRESSED_CSR_GRAPH_H
+
+#include "galois/Galois.h"
+#include "galois/gIO.h"
+#include "galois/graphs/Details.h"
+#include "galois/graphs/FileGraph.h"
+
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace galois {
+namespace graphs {
+
+namespace internal {
+
+//! Number of bytes of LEB128 varint needed for v
+inline unsigned varintSize(uint64_t v) {
+  unsigned n = 1;
+  while (v >= 0x80) {
+    v >>= 7;
+    ++n;
+  }
+  return n;
+}
+
+//! Writes v as LEB128 varint at p; returns the position after it
+inline uint8_t* encodeVarint(uint8_t* p, uint64_t v) {
+  while (v >= 0x80) {
+    *p++ = uint8_t(v) | 0x80;
+    v >>= 7;
+  }
+  *p++ = uint8_t(v);
+  return p;
+}
+
+/**
+ * Reads a LEB128 varint of at most 8 bytes at p and advances p past it.
+ * Always loads 8 bytes, so p must have 8 readable bytes. Branch-free: the
+ * length comes from the first byte without a continuation bit.
+ */
+inline uint64_t decodeVarint(const uint8_t*& p) {
+  uint64_t w;
+  std::memcpy(&w, p, sizeof(w));
+  uint64_t stops = ~w & 0x8080808080808080ULL;
+  assert(stops && "varint longer than 8 bytes");
+  unsigned bits = __builtin_ctzll(stops) + 1; // 8 * length
+  p += bits / 8;
+  w &= (bits == 64) ? ~uint64_t(0) : ((uint64_t(1) << bits) - 1);
+  return (w & 0x7FULL) | ((w >> 1) & (0x7FULL << 7)) |
+         ((w >> 2) & (0x7FULL << 14)) | ((w >> 3) & (0x7FULL << 21)) |
+         ((w >> 4) & (0x7FULL << 28)) | ((w >> 5) & (0x7FULL << 35)) |
+         ((w >> 6) & (0x7FULL << 42)) | ((w >> 7) & (0x7FULL << 49));
+}
+
+inline uint64_t zigzagEncode(int64_t v) { return (v << 1) ^ (v >> 63); }
+
+inline int64_t zigzagDecode(uint64_t v) {
+  return int64_t(v >> 1) ^ -int64_t(v & 1);
+}
+
+} // namespace internal
+
+struct read_lc_compressed_graph_tag {};
+
+/**
+ * Read-only local computation graph whose adjacency lists are compressed.
+ * Each list is sorted by destination and stored as byte-aligned varint gaps:
+ * the first destination relative to the source node (zigzag encoded), the
+ * rest relative to the previous destination. Edge data, if any, is stored
+ * uncompressed in the sorted edge order.
+ *
+ * The graph has the same edges(n)/edge_begin(n)/getEdgeDst(e)/getEdgeData(e)
+ * surface as {@link LC_CSR_Graph}, so algorithms written against that
+ * interface run unchanged. Edge iterators decode as they are incremented;
+ * they are forward iterators with constant-time differences and ordering,
+ * and advancing by k decodes k gaps.
+ *
+ * The graph is read with {@link readGraph} either from a binary gr file,
+ * which is compressed while loading, or from the compressed on-disk form
+ * written by {@link toFile} (graph-convert -gr2vgr).
+ *
+ * @tparam NodeTy data on nodes
+ * @tparam EdgeTy data on out edges
+ */
+template <typename NodeTy, typename EdgeTy, bool HasNoLockable = false,
+          bool UseNumaAlloc = false, typename FileEdgeTy = EdgeTy>
+class LC_Compressed_CSR_Graph
+    : private boost::noncopyable,
+      private internal::LocalIteratorFeature<UseNumaAlloc> {
+public:
+  template <bool _has_id>
+  struct with_id {
+    typedef LC_Compressed_CSR_Graph type;
+  };
+
+  template <typename _node_data>
+  struct with_node_data {
+    typedef LC_Compressed_CSR_Graph<_node_data, EdgeTy, HasNoLockable,
+                                    UseNumaAlloc, FileEdgeTy>
+        type;
+  };
+
+  template <typename _edge_data>
+  struct with_edge_data {
+    typedef LC_Compressed_CSR_Graph<NodeTy, _edge_data, HasNoLockable,
+                                    UseNumaAlloc, FileEdgeTy>
+        type;
+  };
+
+  template <typename _file_edge_data>
+  struct with_file_edge_data {
+    typedef LC_Compressed_CSR_Graph<NodeTy, EdgeTy, HasNoLockable,
+                                    UseNumaAlloc, _file_edge_data>
+        type;
+  };
+
+  //! If true, do not use abstract locks in graph
+  template <bool _has_no_lockable>
+  struct with_no_lockable {
+    typedef LC_Compressed_CSR_Graph<NodeTy, EdgeTy, _has_no_lockable,
+                                    UseNumaAlloc, FileEdgeTy>
+        type;
+  };
+
+  //! If true, use NUMA-aware graph allocation
+  template <bool _use_numa_alloc>
+  struct with_numa_alloc {
+    typedef LC_Compressed_CSR_Graph<NodeTy, EdgeTy, HasNoLockable,
+                                    _use_numa_alloc, FileEdgeTy>
+        type;
+  };
+
+  typedef read_lc_compressed_graph_tag read_tag;
+
+  //! Magic number at the start of the compressed on-disk form
+  constexpr static const uint64_t FILE_MAGIC = 0x3152475620534C47ULL; // "GLS VGR1"
+
+protected:
+  typedef LargeArray<EdgeTy> EdgeData;
+  typedef LargeArray<uint8_t> EdgeBytes;
+  typedef LargeArray<uint64_t> EdgeIndData;
+  typedef internal::NodeInfoBaseTypes<NodeTy, !HasNoLockable> NodeInfoTypes;
+  typedef internal::NodeInfoBase<NodeTy, !HasNoLockable> NodeInfo;
+  typedef LargeArray<NodeInfo> NodeData;
+
+  //! Slack after the last list so that iterators may decode one varint past
+  //! the end of any list without bounds checks
+  constexpr static const size_t PADDING = 16;
+
+public:
+  typedef uint32_t GraphNode;
+  typedef EdgeTy edge_data_type;
+  typedef FileEdgeTy file_edge_data_type;
+  typedef NodeTy node_data_type;
+  typedef typename EdgeData::reference edge_data_reference;
+  typedef typename NodeInfoTypes::reference node_data_reference;
+  using iterator = boost::counting_iterator<GraphNode>;
+  typedef iterator const_iterator;
+  typedef iterator local_iterator;
+  typedef iterator const_local_iterator;
+
+  /**
+   * Decoding iterator over the out edges of one node. The decoded
+   * destination lives in the iterator, so dereferencing yields the iterator
+   * itself; code that loops over a raw [edge_begin, edge_end) range and calls
+   * getEdgeDst on the elements works as it does with LC_CSR_Graph.
+   */
+  class edge_iterator
+      : public boost::iterator_facade<edge_iterator, edge_iterator,
+                                      boost::forward_traversal_tag,
+                                      const edge_iterator&> {
+    friend class boost::iterator_core_access;
+    friend class LC_Compressed_CSR_Graph;
+
+    const uint8_t* ptr;
+    uint64_t idx;
+    GraphNode dst;
+
+    edge_iterator(const uint8_t* p, uint64_t i, GraphNode src, bool decode)
+        : ptr(p), idx(i), dst(src) {
+      if (decode)
+        dst = GraphNode(int64_t(src) +
+                        internal::zigzagDecode(internal::decodeVarint(ptr)));
+    }
+
+    void increment() {
+      ++idx;
+      dst += GraphNode(internal::decodeVarint(ptr));
+    }
+
+    bool equal(const edge_iterator& o) const { return idx == o.idx; }
+
+    const edge_iterator& dereference() const { return *this; }
+
+  public:
+    edge_iterator() : ptr(nullptr), idx(0), dst(0) {}
+
+    typedef std::ptrdiff_t difference_type;
+
+    friend difference_type operator-(const edge_iterator& a,
+                                     const edge_iterator& b) {
+      return difference_type(a.idx) - difference_type(b.idx);
+    }
+
+    friend edge_iterator operator+(edge_iterator a, difference_type n) {
+      assert(n >= 0 && "compressed edges can only be decoded forward");
+      for (; n > 0; --n)
+        a.increment();
+      return a;
+    }
+
+    friend bool operator<(const edge_iterator& a, const edge_iterator& b) {
+      return a.idx < b.idx;
+    }
+    friend bool operator<=(const edge_iterator& a, const edge_iterator& b) {
+      return a.idx <= b.idx;
+    }
+  };
+
+protected:
+  NodeData nodeData;
+  EdgeIndData edgeIndData;
+  EdgeIndData byteIndData;
+  EdgeBytes edgeBytes;
+  EdgeData edgeData;
+
+  uint64_t numNodes;
+  uint64_t numEdges;
+  uint64_t numBytes;
+
+  uint64_t edgeStart(GraphNode N) const {
+    return (N == 0) ? 0 : edgeIndData[N - 1];
+  }
+
+  uint64_t byteStart(GraphNode N) const {
+    return (N == 0) ? 0 : byteIndData[N - 1];
+  }
+
+  edge_iterator raw_begin(GraphNode N) const {
+    uint64_t b = edgeStart(N);
+    return edge_iterator(&edgeBytes[byteStart(N)], b, N, b != edgeIndData[N]);
+  }
+
+  edge_iterator raw_end(GraphNode N) const {
+    return edge_iterator(nullptr, edgeIndData[N], N, false);
+  }
+
+  template <bool _A1 = HasNoLockable>
+  void acquireNode(GraphNode N, MethodFlag mflag,
+                   typename std::enable_if<!_A1>::type* = 0) {
+    galois::runtime::acquire(&nodeData[N], mflag);
+  }
+
+  template <bool _A1 = HasNoLockable>
+  void acquireNode(GraphNode N, MethodFlag mflag,
+                   typename std::enable_if<_A1>::type* = 0) {}
+
+  template <bool _A1 = EdgeData::has_value,
+            bool _A2 = LargeArray<FileEdgeTy>::has_value>
+  void constructEdgeValue(FileGraph& graph, uint64_t e, uint64_t fe,
+                          typename std::enable_if<!_A1 || _A2>::type* = 0) {
+    typedef LargeArray<FileEdgeTy> FED;
+    if (EdgeData::has_value)
+      edgeData.set(e, graph.getEdgeData<typename FED::value_type>(
+                          FileGraph::edge_iterator(fe)));
+  }
+
+  template <bool _A1 = EdgeData::has_value,
+            bool _A2 = LargeArray<FileEdgeTy>::has_value>
+  void constructEdgeValue(FileGraph& graph, uint64_t e, uint64_t fe,
+                          typename std::enable_if<_A1 && !_A2>::type* = 0) {
+    edgeData.set(e, {});
+  }
+
+  typedef std::vector<std::pair<GraphNode, uint64_t>> Scratch;
+
+  //! Fills scratch with (dst, file edge) of node n sorted by dst
+  static void sortedNeighbors(FileGraph& graph, GraphNode n, Scratch& scratch) {
+    scratch.clear();
+    for (auto ii = graph.edge_begin(n), ei = graph.edge_end(n); ii != ei;
+         ++ii) {
+      scratch.emplace_back(graph.getEdgeDst(ii), *ii);
+    }
+    std::sort(scratch.begin(), scratch.end());
+  }
+
+  static uint64_t encodedSize(GraphNode n, const Scratch& scratch) {
+    uint64_t bytes = 0;
+    GraphNode prev = n;
+    bool first     = true;
+    for (auto& p : scratch) {
+      if (first) {
+        bytes += internal::varintSize(
+            internal::zigzagEncode(int64_t(p.first) - int64_t(n)));
+        first = false;
+      } else {
+        bytes += internal::varintSize(p.first - prev);
+      }
+      prev = p.first;
+    }
+    return bytes;
+  }
+
+  void allocateArrays() {
+    if (UseNumaAlloc) {
+      nodeData.allocateBlocked(numNodes);
+      edgeIndData.allocateBlocked(numNodes);
+      byteIndData.allocateBlocked(numNodes);
+      edgeBytes.allocateBlocked(numBytes + PADDING);
+      edgeData.allocateBlocked(numEdges);
+    } else {
+      nodeData.allocateInterleaved(numNodes);
+      edgeIndData.allocateInterleaved(numNodes);
+      byteIndData.allocateInterleaved(numNodes);
+      edgeBytes.allocateInterleaved(numBytes + PADDING);
+      edgeData.allocateInterleaved(numEdges);
+    }
+    std::fill(&edgeBytes[numBytes], &edgeBytes[numBytes] + PADDING, 0);
+  }
+
+public:
+  LC_Compressed_CSR_Graph() : numNodes(0), numEdges(0), numBytes(0) {}
+
+  node_data_reference getData(GraphNode N,
+                              MethodFlag mflag = MethodFlag::WRITE) {
+    NodeInfo& NI = nodeData[N];
+    acquireNode(N, mflag);
+    return NI.getData();
+  }
+
+  edge_data_reference getEdgeData(edge_iterator ni,
+                                  MethodFlag mflag = MethodFlag::UNPROTECTED) {
+    return edgeData[ni.idx];
+  }
+
+  GraphNode getEdgeDst(edge_iterator ni) { return ni.dst; }
+
+  size_t size() const { return numNodes; }
+  size_t sizeEdges() const { return numEdges; }
+
+  //! Bytes used by the encoded adjacency lists
+  size_t sizeEdgeBytes() const { return numBytes; }
+
+  //! Out degree of N without decoding its list
+  size_t getDegree(GraphNode N) const {
+    return edgeIndData[N] - edgeStart(N);
+  }
+
+  iterator begin() const { return iterator(0); }
+  iterator end() const { return iterator(numNodes); }
+
+  const_local_iterator local_begin() const {
+    return const_local_iterator(this->localBegin(numNodes));
+  }
+
+  const_local_iterator local_end() const {
+    return const_local_iterator(this->localEnd(numNodes));
+  }
+
+  local_iterator local_begin() {
+    return local_iterator(this->localBegin(numNodes));
+  }
+
+  local_iterator local_end() {
+    return local_iterator(this->localEnd(numNodes));
+  }
+
+  edge_iterator edge_begin(GraphNode N, MethodFlag mflag = MethodFlag::WRITE) {
+    acquireNode(N, mflag);
+    if (galois::runtime::shouldLock(mflag)) {
+      for (edge_iterator ii = raw_begin(N), ee = raw_end(N); ii != ee; ++ii) {
+        acquireNode(getEdgeDst(ii), mflag);
+      }
+    }
+    return raw_begin(N);
+  }
+
+  edge_iterator edge_end(GraphNode N, MethodFlag mflag = MethodFlag::WRITE) {
+    acquireNode(N, mflag);
+    return raw_end(N);
+  }
+
+  edge_iterator findEdge(GraphNode N1, GraphNode N2) {
+    edge_iterator ii = edge_begin(N1), ee = edge_end(N1);
+    for (; ii != ee && getEdgeDst(ii) < N2; ++ii)
+      ;
+    return (ii != ee && getEdgeDst(ii) == N2) ? ii : ee;
+  }
+
+  //! Edges are always sorted by destination
+  edge_iterator findEdgeSortedByDst(GraphNode N1, GraphNode N2) {
+    return findEdge(N1, N2);
+  }
+
+  runtime::iterable<NoDerefIterator<edge_iterator>>
+  edges(GraphNode N, MethodFlag mflag = MethodFlag::WRITE) {
+    return internal::make_no_deref_range(edge_begin(N, mflag),
+                                         edge_end(N, mflag));
+  }
+
+  runtime::iterable<NoDerefIterator<edge_iterator>>
+  out_edges(GraphNode N, MethodFlag mflag = MethodFlag::WRITE) {
+    return edges(N, mflag);
+  }
+
+  /**
+   * Compresses a binary gr graph into this graph. Each thread encodes the
+   * nodes that LC_CSR_Graph would construct on it, in two passes: one to
+   * size the lists and one to encode them.
+   */
+  void constructFrom(FileGraph& graph) {
+    numNodes = graph.size();
+    numEdges = graph.sizeEdges();
+
+    substrate::PerThreadStorage<Scratch> scratches;
+    LargeArray<uint64_t> sizes;
+    sizes.create(numNodes);
+
+    auto nodeRange = [&](unsigned tid, unsigned total) {
+      return graph
+          .divideByNode(NodeData::size_of::value + 2 * sizeof(uint64_t),
+                        sizeof(uint32_t) + EdgeData::size_of::value, tid,
+                        total)
+          .first;
+    };
+
+    galois::on_each([&](unsigned tid, unsigned total) {
+      auto r           = nodeRange(tid, total);
+      Scratch& scratch = *scratches.getLocal();
+      for (auto ii = r.first, ei = r.second; ii != ei; ++ii) {
+        sortedNeighbors(graph, *ii, scratch);
+        sizes[*ii] = encodedSize(*ii, scratch);
+      }
+    });
+
+    numBytes = 0;
+    for (size_t n = 0; n < numNodes; ++n) {
+      numBytes += sizes[n];
+      sizes[n] = numBytes;
+    }
+
+    allocateArrays();
+
+    galois::on_each([&](unsigned tid, unsigned total) {
+      auto r           = nodeRange(tid, total);
+      Scratch& scratch = *scratches.getLocal();
+
+      this->setLocalRange(*r.first, *r.second);
+
+      for (auto ii = r.first, ei = r.second; ii != ei; ++ii) {
+        GraphNode n = *ii;
+        nodeData.constructAt(n);
+        edgeIndData[n] = *graph.edge_end(n);
+        byteIndData[n] = sizes[n];
+
+        sortedNeighbors(graph, n, scratch);
+
+        // neighbors' index entries may not be written yet; use the file
+        uint8_t* p     = &edgeBytes[(n == 0) ? 0 : sizes[n - 1]];
+        uint64_t e     = *graph.edge_begin(n);
+        GraphNode prev = n;
+        bool first     = true;
+        for (auto& s : scratch) {
+          if (first) {
+            p = internal::encodeVarint(
+                p, internal::zigzagEncode(int64_t(s.first) - int64_t(n)));
+            first = false;
+          } else {
+            p = internal::encodeVarint(p, s.first - prev);
+          }
+          prev = s.first;
+          constructEdgeValue(graph, e++, s.second);
+        }
+        assert(p == &edgeBytes[0] + byteIndData[n]);
+      }
+    });
+  }
+
+  /**
+   * Writes the graph in its compressed on-disk form: a header of magic,
+   * sizeof(edge data), |V|, |E| and number of encoded bytes (all uint64_t),
+   * followed by the edge index array, the byte index array, the encoded bytes
+   * and the edge data.
+   */
+  void toFile(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out)
+      GALOIS_DIE("unable to open ", filename);
+
+    uint64_t header[5] = {FILE_MAGIC, EdgeData::size_of::value, numNodes,
+                          numEdges, numBytes};
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(edgeIndData.data()),
+              numNodes * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char*>(byteIndData.data()),
+              numNodes * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char*>(edgeBytes.data()), numBytes);
+    if (EdgeData::has_value)
+      out.write(reinterpret_cast<const char*>(edgeData.data()),
+                numEdges * EdgeData::size_of::value);
+    if (!out)
+      GALOIS_DIE("failed writing ", filename);
+  }
+
+  //! Returns true if filename starts with the compressed on-disk header
+  static bool isCompressedFile(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    uint64_t magic = 0;
+    in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    return in && magic == FILE_MAGIC;
+  }
+
+  //! Reads the compressed on-disk form written by {@link toFile}
+  void fromCompressedFile(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in)
+      GALOIS_DIE("unable to open ", filename);
+
+    uint64_t header[5];
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!in || header[0] != FILE_MAGIC)
+      GALOIS_DIE("not a compressed graph: ", filename);
+    // edge data in the file is ignored by graphs without edge data
+    if (EdgeData::has_value && header[1] != EdgeData::size_of::value)
+      GALOIS_DIE("edge data size mismatch: file has ", header[1],
+                 " bytes, graph expects ", EdgeData::size_of::value);
+
+    numNodes = header[2];
+    numEdges = header[3];
+    numBytes = header[4];
+
+    allocateArrays();
+
+    in.read(reinterpret_cast<char*>(edgeIndData.data()),
+            numNodes * sizeof(uint64_t));
+    in.read(reinterpret_cast<char*>(byteIndData.data()),
+            numNodes * sizeof(uint64_t));
+    in.read(reinterpret_cast<char*>(edgeBytes.data()), numBytes);
+    if (EdgeData::has_value)
+      in.read(reinterpret_cast<char*>(edgeData.data()),
+              numEdges * EdgeData::size_of::value);
+    if (!in)
+      GALOIS_DIE("truncated compressed graph: ", filename);
+
+    galois::on_each([&](unsigned tid, unsigned total) {
+      auto r = galois::block_range(uint64_t(0), numNodes, tid, total);
+      this->setLocalRange(r.first, r.second);
+      for (uint64_t n = r.first; n < r.second; ++n)
+        nodeData.constructAt(n);
+    });
+  }
+};
+
+template <typename GraphTy>
+void readGraphDispatch(GraphTy& graph, read_lc_compressed_graph_tag,
+                       FileGraph& f) {
+  graph.constructFrom(f);
+}
+
+template <typename GraphTy>
+void readGraphDispatch(GraphTy& graph, read_lc_compressed_graph_tag tag,
+                       const std::string& filename) {
+  if (GraphTy::isCompressedFile(filename)) {
+    graph.fromCompressedFile(filename);
+  } else {
+    FileGraph f;
+    f.fromFileInterleaved<typename GraphTy::file_edge_data_type>(filename);
+    readGraphDispatch(graph, tag, f);
+  }
+}
+
+} // namespace graphs
+} // namespace galois
+
+#endif
@@ -306,8 +306,8 @@ protected:
 
 public:
   /**
-   * Destructor. If edges have some value, destory all of it (i.e. free up
-   * memory).
+   * Destructor. If edges have some value, destory all of it, then free the
+   * memory the edges were allocated in.
    */
   ~LC_Morph_Graph() {
     for (typename Nodes::iterator ii = nodes.begin(), ei = nodes.end();
@@ -323,6 +323,16 @@ public:
         }
       }
     }
+
+    // return the edge blocks to the page pool
+    for (unsigned i = 0; i < edgesL.size(); ++i) {
+      EdgeHolder* h = *edgesL.getRemote(i);
+      while (h) {
+        EdgeHolder* next = h->next;
+        runtime::pagePoolFree(h);
+        h = next;
+      }
+    }
   }
 
   /**
@@ -433,7 +443,6 @@ public:
     if (!local_edges ||
         std::distance(local_edges->begin, local_edges->end) < nedges) {
       EdgeHolder* old = local_edges;
-      // FIXME: this seems to leak
       char* newblock    = (char*)runtime::pagePoolAlloc();
       local_edges       = (EdgeHolder*)newblock;
       local_edges->next = old;
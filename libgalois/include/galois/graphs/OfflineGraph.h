@@ -20,17 +20,24 @@
 #ifndef _GALOIS_DIST_OFFLINE_GRAPH_
 #define _GALOIS_DIST_OFFLINE_GRAPH_
 
-#include "galois/substrate/SimpleLock.h"
+#include "galois/gIO.h"
+#include "galois/substrate/PerThreadStorage.h"
 #include "galois/graphs/Details.h"
 #include "galois/graphs/GraphHelpers.h"
 
+#include <atomic>
+#include <cerrno>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <fstream>
-#include <mutex>
+#include <memory>
 #include <numeric>
+#include <vector>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 #include <boost/iterator/counting_iterator.hpp>
 
@@ -59,132 +66,127 @@ namespace graphs {
 // EdgeType[numEdges] {EdgeType size}
 
 class OfflineGraph {
-  std::ifstream fileEdgeDst, fileIndex, fileEdgeData;
-  std::streamoff locEdgeDst, locIndex, locEdgeData;
+  //! Size of a block fetched by the pread fallback during a sequential scan
+  static constexpr size_t blockSize = 1 << 20;
+  //! Size of a block fetched on a random access, e.g. a binary search
+  static constexpr size_t pageSize = 1 << 12;
+
+  //! One cached block of a file region; used only when mmap is unavailable
+  struct Block {
+    uint64_t start = ~uint64_t(0); //!< file offset of data[0]
+    uint64_t valid = 0;            //!< bytes of data that were read
+    std::vector<char> data;
+  };
+
+  //! A thread's cached blocks. Separate blocks per region so that
+  //! interleaved index and edge reads do not evict each other.
+  struct Blocks {
+    Block index, edgeDst, edgeData;
+  };
+
+  int fd;
+  //! Entire file when mapped; nullptr if reads go through the block cache
+  char* mapping;
+  size_t length;
 
   uint64_t numNodes;
   uint64_t numEdges;
   uint64_t sizeEdgeData;
-  size_t length;
   bool v2;
-  uint64_t numSeeksEdgeDst, numSeeksIndex, numSeeksEdgeData;
-  uint64_t numBytesReadEdgeDst, numBytesReadIndex, numBytesReadEdgeData;
-
-  galois::substrate::SimpleLock lock;
-
-  uint64_t outIndexs(uint64_t node) {
-    std::lock_guard<decltype(lock)> lg(lock);
-    std::streamoff pos = (4 + node) * sizeof(uint64_t);
-
-    // move to correct position in file
-    if (locEdgeDst != pos) {
-      numSeeksEdgeDst++;
-      fileEdgeDst.seekg(pos, fileEdgeDst.beg);
-      locEdgeDst = pos;
+  //! File offsets of the index, edge destination and edge data regions
+  uint64_t offIndex, offEdgeDst, offEdgeData;
+
+  //! Per-thread block caches; only allocated when the file is not mapped.
+  //! Each thread scans its own range, so private blocks need no lock and
+  //! are not evicted by other readers.
+  std::unique_ptr<galois::substrate::PerThreadStorage<Blocks>> blocks;
+
+  std::atomic<uint64_t> numSeeks, numBytesRead;
+
+  //! Fetches a block of the file containing offset pos into b
+  void fillBlock(Block& b, uint64_t pos) {
+    // A miss within a few values past the cached block is a sequential
+    // scan: continue it with a large block and ask the kernel to start
+    // reading the one after it in the background. Any other miss reads a
+    // single page so that binary searches over the index do not pull in
+    // whole blocks.
+    uint64_t end    = b.start + b.valid;
+    bool sequential =
+        b.start != ~uint64_t(0) && pos >= end && pos < end + 64;
+    uint64_t start  = sequential ? end : pos & ~uint64_t(pageSize - 1);
+    size_t toRead =
+        std::min<uint64_t>(sequential ? blockSize : pageSize, length - start);
+
+    b.data.resize(blockSize);
+    size_t done = 0;
+    while (done < toRead) {
+      ssize_t r =
+          pread(fd, b.data.data() + done, toRead - done, start + done);
+      if (r < 0 && errno == EINTR)
+        continue;
+      if (r <= 0)
+        GALOIS_SYS_DIE("failed reading offline graph");
+      done += r;
     }
+    b.start = start;
+    b.valid = done;
+
+    if (!sequential)
+      numSeeks.fetch_add(1, std::memory_order_relaxed);
+    else if (start + blockSize < length)
+      posix_fadvise(fd, start + blockSize, blockSize, POSIX_FADV_WILLNEED);
+    numBytesRead.fetch_add(done, std::memory_order_relaxed);
+  }
 
-    // read the value
-    uint64_t retval;
-    try {
-      fileEdgeDst.read(reinterpret_cast<char*>(&retval), sizeof(uint64_t));
-    } catch (std::ifstream::failure e) {
-      std::cerr << "Exception while reading edge destinations:" << e.what()
-                << "\n";
-      std::cerr << "IO error flags: EOF " << fileEdgeDst.eof() << " FAIL "
-                << fileEdgeDst.fail() << " BAD " << fileEdgeDst.bad() << "\n";
+  //! Copies sizeof(T) bytes at file offset pos from the calling thread's
+  //! block of a region; safe for concurrent Galois threads
+  template <typename T>
+  T readAt(Block Blocks::*region, uint64_t pos) {
+    assert(pos + sizeof(T) <= length);
+    T retval;
+    // Mapped reads are not counted: a shared counter would cost more than
+    // the load itself.
+    if (mapping) {
+      std::memcpy(&retval, mapping + pos, sizeof(T));
+      return retval;
     }
 
-    // metadata update
-    auto numBytesRead = fileEdgeDst.gcount();
-    assert(numBytesRead == sizeof(uint64_t));
-    locEdgeDst += numBytesRead;
-    numBytesReadEdgeDst += numBytesRead;
+    Block& b = blocks->getLocal()->*region;
+    if (pos < b.start || pos >= b.start + b.valid)
+      fillBlock(b, pos);
+    size_t inBlock = pos - b.start;
+    if (inBlock + sizeof(T) <= b.valid) {
+      std::memcpy(&retval, b.data.data() + inBlock, sizeof(T));
+      return retval;
+    }
 
+    // The value straddles the end of the block
+    size_t head = b.valid - inBlock;
+    char* dst   = reinterpret_cast<char*>(&retval);
+    std::memcpy(dst, b.data.data() + inBlock, head);
+    fillBlock(b, b.start + b.valid);
+    std::memcpy(dst + head, b.data.data(), sizeof(T) - head);
     return retval;
   }
 
-  uint64_t outEdges(uint64_t edge) {
-    std::lock_guard<decltype(lock)> lg(lock);
-    std::streamoff pos = (4 + numNodes) * sizeof(uint64_t) +
-                         edge * (v2 ? sizeof(uint64_t) : sizeof(uint32_t));
-
-    // move to correct position
-    if (locIndex != pos) {
-      numSeeksIndex++;
-      fileIndex.seekg(pos, fileEdgeDst.beg);
-      locIndex = pos;
-    }
+  uint64_t outIndexs(uint64_t node) {
+    return readAt<uint64_t>(&Blocks::index,
+                            offIndex + node * sizeof(uint64_t));
+  }
 
-    // v2 reads 64 bits, v1 reads 32 bits
-    if (v2) {
-      uint64_t retval;
-      try {
-        fileIndex.read(reinterpret_cast<char*>(&retval), sizeof(uint64_t));
-      } catch (std::ifstream::failure e) {
-        std::cerr << "Exception while reading index:" << e.what() << "\n";
-        std::cerr << "IO error flags: EOF " << fileIndex.eof() << " FAIL "
-                  << fileIndex.fail() << " BAD " << fileIndex.bad() << "\n";
-      }
-
-      auto numBytesRead = fileIndex.gcount();
-      assert(numBytesRead == sizeof(uint64_t));
-      locIndex += numBytesRead;
-      numBytesReadIndex += numBytesRead;
-      return retval;
-    } else {
-      uint32_t retval;
-      try {
-        fileIndex.read(reinterpret_cast<char*>(&retval), sizeof(uint32_t));
-      } catch (std::ifstream::failure e) {
-        std::cerr << "Exception while reading index:" << e.what() << "\n";
-        std::cerr << "IO error flags: EOF " << fileIndex.eof() << " FAIL "
-                  << fileIndex.fail() << " BAD " << fileIndex.bad() << "\n";
-      }
-
-      auto numBytesRead = fileIndex.gcount();
-      assert(numBytesRead == sizeof(uint32_t));
-      locIndex += numBytesRead;
-      numBytesReadIndex += numBytesRead;
-      return retval;
-    }
+  uint64_t outEdges(uint64_t edge) {
+    // v2 stores 64 bit destinations, v1 32 bit
+    if (v2)
+      return readAt<uint64_t>(&Blocks::edgeDst,
+                              offEdgeDst + edge * sizeof(uint64_t));
+    return readAt<uint32_t>(&Blocks::edgeDst,
+                            offEdgeDst + edge * sizeof(uint32_t));
   }
 
   template <typename T>
   T edgeData(uint64_t edge) {
     assert(sizeof(T) <= sizeEdgeData);
-    std::lock_guard<decltype(lock)> lg(lock);
-    std::streamoff pos = (4 + numNodes) * sizeof(uint64_t) +
-                         numEdges * (v2 ? sizeof(uint64_t) : sizeof(uint32_t));
-
-    // align + move to correct position
-    pos = (pos + 7) & ~7;
-    pos += edge * sizeEdgeData;
-
-    if (locEdgeData != pos) {
-      numSeeksEdgeData++;
-      fileEdgeData.seekg(pos, fileEdgeDst.beg);
-      locEdgeData = pos;
-    }
-
-    T retval;
-    try {
-      fileEdgeData.read(reinterpret_cast<char*>(&retval), sizeof(T));
-    } catch (std::ifstream::failure e) {
-      std::cerr << "Exception while reading edge data:" << e.what() << "\n";
-      std::cerr << "IO error flags: EOF " << fileEdgeData.eof() << " FAIL "
-                << fileEdgeData.fail() << " BAD " << fileEdgeData.bad() << "\n";
-    }
-
-    auto numBytesRead = fileEdgeData.gcount();
-    assert(numBytesRead == sizeof(T));
-    locEdgeData += numBytesRead;
-    numBytesReadEdgeData += numBytesRead;
-    /*fprintf(stderr, "READ:: %ld[", edge);
-    for(int i=0; i<sizeof(T); ++i){
-       fprintf(stderr, "%c", reinterpret_cast<char*>(&retval)[i]);
-    }
-    fprintf(stderr, "]");*/
-    return retval;
+    return readAt<T>(&Blocks::edgeData, offEdgeData + edge * sizeEdgeData);
   }
 
 public:
@@ -192,80 +194,103 @@ public:
   typedef boost::counting_iterator<uint64_t> edge_iterator;
   typedef uint64_t GraphNode;
 
-  OfflineGraph(const std::string& name)
-      : fileEdgeDst(name, std::ios_base::binary),
-        fileIndex(name, std::ios_base::binary),
-        fileEdgeData(name, std::ios_base::binary), locEdgeDst(0), locIndex(0),
-        locEdgeData(0), numSeeksEdgeDst(0), numSeeksIndex(0),
-        numSeeksEdgeData(0), numBytesReadEdgeDst(0), numBytesReadIndex(0),
-        numBytesReadEdgeData(0) {
-    if (!fileEdgeDst.is_open() || !fileEdgeDst.good())
-      throw "Bad filename";
-    if (!fileIndex.is_open() || !fileIndex.good())
+  /**
+   * Opens a graph file for reading without loading it into memory.
+   *
+   * The file is mapped read-only when possible so that lookups are plain
+   * loads and any number of threads may read concurrently. If mapping fails
+   * (or useMmap is false), reads go through per-thread, per-region block
+   * caches filled with pread; the Galois runtime must be initialized then.
+   */
+  OfflineGraph(const std::string& name, bool useMmap = true)
+      : mapping(nullptr), numSeeks(0), numBytesRead(0) {
+    fd = open(name.c_str(), O_RDONLY);
+    if (fd == -1)
       throw "Bad filename";
-    if (!fileEdgeData.is_open() || !fileEdgeData.good())
+
+    struct stat buf;
+    if (fstat(fd, &buf) == -1) {
+      close(fd);
       throw "Bad filename";
+    }
+    length = buf.st_size;
 
-    fileEdgeDst.exceptions(std::ifstream::eofbit | std::ifstream::failbit |
-                           std::ifstream::badbit);
-    fileIndex.exceptions(std::ifstream::eofbit | std::ifstream::failbit |
-                         std::ifstream::badbit);
-    fileEdgeData.exceptions(std::ifstream::eofbit | std::ifstream::failbit |
-                            std::ifstream::badbit);
-
-    uint64_t ver = 0;
-
-    try {
-      fileEdgeDst.read(reinterpret_cast<char*>(&ver), sizeof(uint64_t));
-      fileEdgeDst.read(reinterpret_cast<char*>(&sizeEdgeData),
-                       sizeof(uint64_t));
-      fileEdgeDst.read(reinterpret_cast<char*>(&numNodes), sizeof(uint64_t));
-      fileEdgeDst.read(reinterpret_cast<char*>(&numEdges), sizeof(uint64_t));
-    } catch (std::ifstream::failure e) {
-      std::cerr << "Exception while reading graph header:" << e.what() << "\n";
-      std::cerr << "IO error flags: EOF " << fileEdgeDst.eof() << " FAIL "
-                << fileEdgeDst.fail() << " BAD " << fileEdgeDst.bad() << "\n";
+    uint64_t header[4];
+    if (length < sizeof(header) ||
+        pread(fd, header, sizeof(header), 0) != sizeof(header)) {
+      close(fd);
+      throw "Out of data";
     }
 
-    if (ver == 0 || ver > 2)
+    uint64_t ver = header[0];
+    sizeEdgeData = header[1];
+    numNodes     = header[2];
+    numEdges     = header[3];
+
+    if (ver == 0 || ver > 2) {
+      close(fd);
       throw "Bad Version";
+    }
 
     v2 = ver == 2;
 
-    if (!fileEdgeDst)
-      throw "Out of data";
-
-    // File length
-    fileEdgeDst.seekg(0, fileEdgeDst.end);
-    length = fileEdgeDst.tellg();
-    if (length < sizeof(uint64_t) * (4 + numNodes) +
-                     (v2 ? sizeof(uint64_t) : sizeof(uint32_t)) * numEdges)
+    offIndex   = 4 * sizeof(uint64_t);
+    offEdgeDst = offIndex + numNodes * sizeof(uint64_t);
+    // edge data is re-aligned to 64 bits after the destinations
+    offEdgeData =
+        (offEdgeDst + numEdges * (v2 ? sizeof(uint64_t) : sizeof(uint32_t)) +
+         7) &
+        ~uint64_t(7);
+
+    if (length < offEdgeDst + (v2 ? sizeof(uint64_t) : sizeof(uint32_t)) *
+                                  numEdges) {
+      close(fd);
       throw "File too small";
+    }
 
-    fileEdgeDst.seekg(0, std::ios_base::beg);
-    fileEdgeData.seekg(0, std::ios_base::beg);
-    fileIndex.seekg(0, std::ios_base::beg);
+    if (useMmap) {
+      void* m = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+      if (m != MAP_FAILED)
+        mapping = static_cast<char*>(m);
+    }
+    if (!mapping)
+      blocks.reset(new galois::substrate::PerThreadStorage<Blocks>());
   }
 
-  uint64_t num_seeks() {
-    // std::cout << "Seeks :: " << numSeeksEdgeDst << " , " << numSeeksEdgeData
-    //          << " , " << numSeeksIndex << " \n";
-    return numSeeksEdgeDst + numSeeksEdgeData + numSeeksIndex;
+  OfflineGraph(OfflineGraph&& o)
+      : fd(o.fd), mapping(o.mapping), length(o.length), numNodes(o.numNodes),
+        numEdges(o.numEdges), sizeEdgeData(o.sizeEdgeData), v2(o.v2),
+        offIndex(o.offIndex), offEdgeDst(o.offEdgeDst),
+        offEdgeData(o.offEdgeData), blocks(std::move(o.blocks)),
+        numSeeks(o.numSeeks.load()),
+        numBytesRead(o.numBytesRead.load()) {
+    o.fd      = -1;
+    o.mapping = nullptr;
   }
 
+  ~OfflineGraph() {
+    if (mapping)
+      munmap(mapping, length);
+    if (fd != -1)
+      close(fd);
+  }
+
+  //! True if reads are served from a memory mapping of the file
+  bool isMapped() const { return mapping != nullptr; }
+
+  //! Number of non-sequential block reads issued; 0 when mapped
+  uint64_t num_seeks() { return numSeeks.load(std::memory_order_relaxed); }
+
+  //! Bytes read with pread; 0 when mapped
   uint64_t num_bytes_read() {
-    // std::cout << "Bytes read :: " << numBytesReadEdgeDst << " , " <<
-    // numBytesReadEdgeData << " , " << numBytesReadIndex << " \n";
-    return numBytesReadEdgeDst + numBytesReadEdgeData + numBytesReadIndex;
+    return numBytesRead.load(std::memory_order_relaxed);
   }
 
   void reset_seek_counters() {
-    numSeeksEdgeDst = numSeeksEdgeData = numSeeksIndex = 0;
-    numBytesReadEdgeDst = numBytesReadEdgeData = numBytesReadIndex = 0;
+    numSeeks.store(0, std::memory_order_relaxed);
+    numBytesRead.store(0, std::memory_order_relaxed);
   }
 
-  OfflineGraph(OfflineGraph&&) = default;
-
   size_t size() const { return numNodes; }
   size_t sizeEdges() const { return numEdges; }
   size_t edgeSize() const { return sizeEdgeData; }
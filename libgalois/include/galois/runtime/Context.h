@@ -28,6 +28,8 @@
 
 #include <cassert>
 #include <cstdlib>
+#include <utility>
+#include <vector>
 
 #ifdef GALOIS_USE_LONGJMP_ABORT
 #include <setjmp.h>
@@ -108,10 +110,45 @@ protected:
   }
 };
 
+/**
+ * Conflict detection for speculative loops.
+ *
+ * By default every acquire locks the lockable until the iteration ends. In
+ * optimistic mode, acquires before the cautious point only record the
+ * version of the lockable; at the cautious point, the lockables acquired with
+ * MethodFlag::WRITE are locked and the recorded versions are validated, and
+ * the iteration aborts if any of them changed. Committing bumps the version
+ * of every lock released; aborting does not. Lockables acquired with
+ * MethodFlag::READ are never locked, so the operator must not touch them
+ * after the cautious point.
+ *
+ * Other iterations change items in place while a reader walks them, so each
+ * optimistic acquire first revalidates everything read so far, before the
+ * reader follows a pointer it got from that data. The revalidation is
+ * skipped while no optimistic iteration has locked or committed anything.
+ */
 class SimpleRuntimeContext : public LockManagerBase {
   //! The locks we hold
   Lockable* locks;
   bool customAcquire;
+  bool optimistic;
+  //! Optimistic mode: set once the cautious point is passed
+  bool validated;
+  //! Optimistic mode: lockables acquired and the versions seen
+  std::vector<std::pair<Lockable*, unsigned>> readSet;
+  //! Optimistic mode: lockables to lock at the cautious point
+  std::vector<Lockable*> writeSet;
+  //! Optimistic mode: lock clock when the read set was last validated
+  unsigned readClock;
+  size_t numValidationFailures;
+
+  void optimisticAcquire(Lockable* lockable, galois::MethodFlag m);
+  void validate();
+  void validateReads();
+  void clearOptimistic();
+  //! Releases every lock held; in optimistic mode, bumpVersions marks the
+  //! items as changed for concurrent readers
+  unsigned releaseLocks(bool bumpVersions);
 
 protected:
   friend void doAcquire(Lockable*, galois::MethodFlag);
@@ -133,14 +170,32 @@ protected:
   void release(Lockable* lockable);
 
 public:
-  SimpleRuntimeContext(bool child = false) : locks(0), customAcquire(child) {}
+  SimpleRuntimeContext(bool child = false, bool _optimistic = false)
+      : locks(0), customAcquire(child), optimistic(_optimistic),
+        validated(false), readClock(0), numValidationFailures(0) {}
   virtual ~SimpleRuntimeContext() {}
 
-  void startIteration() { assert(!locks); }
+  void startIteration() {
+    assert(!locks);
+    assert(readSet.empty() && writeSet.empty());
+  }
 
   unsigned cancelIteration();
   unsigned commitIteration();
 
+  //! In optimistic mode, locks the write set and validates the versions
+  //! read so far; aborts the iteration on failure
+  void cautiousPoint() {
+    if (optimistic && !validated)
+      validate();
+  }
+
+  //! In optimistic mode before the cautious point, aborts the iteration if
+  //! anything read so far has changed
+  void checkReads();
+
+  size_t getValidationFailures() const { return numValidationFailures; }
+
 #ifdef GALOIS_USE_EXP
   virtual bool owns(Lockable* lockable, galois::MethodFlag m) const;
 #endif
@@ -202,6 +257,15 @@ struct CheckedLockObj {
 
 void signalConflict(Lockable* = nullptr);
 
+//! Tells the conflict detection of the current thread, if any, that the
+//! operator has reached its cautious point
+void signalCautiousPoint();
+
+//! Aborts the current iteration if it is optimistic and something it has read
+//! changed since. Call before trusting an invariant of data that was only
+//! read, e.g., before asserting on it.
+void checkOptimisticReads();
+
 #ifdef GALOIS_USE_EXP
 bool owns(Lockable* lockable, MethodFlag m);
 #endif
@@ -22,6 +22,8 @@
 
 #include "galois/gIO.h"
 #include "galois/Timer.h"
+#include "galois/runtime/PerfEvents.h"
+#include "galois/runtime/Timeline.h"
 
 #include "galois/runtime/Executor_OnEach.h"
 #include "galois/runtime/Statistics.h"
@@ -32,6 +34,8 @@
 #include "galois/substrate/PaddedLock.h"
 #include "galois/substrate/CompilerSpecific.h"
 
+#include <chrono>
+
 namespace galois {
 namespace runtime {
 
@@ -49,7 +53,17 @@ class DoAllStealingExec {
       galois::internal::NeedStats<ArgsTuple>::value;
   constexpr static const bool MORE_STATS =
       NEED_STATS && exists_by_supertype<more_stats_tag, ArgsTuple>::value;
+  constexpr static const bool NEED_TRACE =
+      exists_by_supertype<loopname_tag, ArgsTuple>::value;
   constexpr static const bool USE_TERM = false;
+  constexpr static const bool ADAPTIVE =
+      exists_by_supertype<adaptive_chunk_size_tag, ArgsTuple>::value;
+
+  typedef std::chrono::steady_clock clockTy;
+
+  //! Target duration of one chunk in adaptive mode. Long enough to amortize
+  //! the lock in getWork, short enough to keep the tail balanced
+  constexpr static const int64_t ADAPTIVE_TARGET_NS = 10000;
 
   struct ThreadContext {
 
@@ -61,18 +75,28 @@ class DoAllStealingExec {
     Diff_ty m_size;
     size_t num_iter;
 
+    // Adaptive chunk sizing; chunk is only touched by the owner, stolenFrom is
+    // set by thieves under work_mutex
+    Diff_ty chunk;
+    bool stolenFrom;
+
     // Stats
+    size_t num_chunks;
+    size_t num_steals;
+    Diff_ty max_chunk;
 
     ThreadContext()
         : work_mutex(),
           id(substrate::getThreadPool()
                  .getMaxThreads()), // TODO: fix this initialization problem,
                                     // see initThread
-          shared_beg(), shared_end(), m_size(0), num_iter(0) {}
+          shared_beg(), shared_end(), m_size(0), num_iter(0), chunk(0),
+          stolenFrom(false), num_chunks(0), num_steals(0), max_chunk(0) {}
 
-    ThreadContext(unsigned id, Iter beg, Iter end)
+    ThreadContext(unsigned id, Iter beg, Iter end, Diff_ty chunk)
         : work_mutex(), id(id), shared_beg(beg), shared_end(end),
-          m_size(std::distance(beg, end)), num_iter(0) {}
+          m_size(std::distance(beg, end)), num_iter(0), chunk(chunk),
+          stolenFrom(false), num_chunks(0), num_steals(0), max_chunk(chunk) {}
 
     bool doWork(F& func, const unsigned chunk_size) {
       Iter beg(shared_beg);
@@ -80,16 +104,25 @@ class DoAllStealingExec {
 
       bool didwork = false;
 
-      while (getWork(beg, end, chunk_size)) {
+      while (getWork(beg, end, ADAPTIVE ? chunk : chunk_size)) {
 
         didwork = true;
 
+        clockTy::time_point start;
+        if (ADAPTIVE) {
+          start = clockTy::now();
+        }
+
         for (; beg != end; ++beg) {
           if (NEED_STATS) {
             ++num_iter;
           }
           func(*beg);
         }
+
+        if (ADAPTIVE) {
+          adaptChunk(clockTy::now() - start);
+        }
       }
 
       return didwork;
@@ -114,7 +147,20 @@ class DoAllStealingExec {
     }
 
   private:
-    bool getWork(Iter& priv_beg, Iter& priv_end, const unsigned chunk_size) {
+    void adaptChunk(const clockTy::duration& elapsed) {
+      const int64_t ns =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+              .count();
+
+      if (ns > 2 * ADAPTIVE_TARGET_NS) {
+        chunk = std::max(chunk / 2, Diff_ty(chunk_size_tag::MIN));
+      } else if (ns < ADAPTIVE_TARGET_NS / 2) {
+        chunk = std::min(chunk * 2, Diff_ty(chunk_size_tag::MAX));
+      }
+      max_chunk = std::max(max_chunk, chunk);
+    }
+
+    bool getWork(Iter& priv_beg, Iter& priv_end, Diff_ty chunk_size) {
       bool succ = false;
 
       work_mutex.lock();
@@ -122,6 +168,18 @@ class DoAllStealingExec {
         if (hasWorkWeak()) {
           succ = true;
 
+          if (ADAPTIVE) {
+            // Someone ran out of work and came here; expose more of our range
+            if (stolenFrom) {
+              chunk      = std::max(chunk / 2, Diff_ty(chunk_size_tag::MIN));
+              stolenFrom = false;
+            }
+            // Lazy binary splitting: near the end of the range only take half
+            // of what is left so that the rest can still be stolen
+            chunk_size = std::min(chunk, std::max(m_size / 2, Diff_ty(1)));
+            ++num_chunks;
+          }
+
           Iter nbeg = shared_beg;
           if (m_size <= chunk_size) {
             nbeg   = shared_end;
@@ -184,7 +242,10 @@ class DoAllStealingExec {
         if (hasWorkWeak()) {
           succ = true;
 
-          if (amount == HALF && m_size > (decltype(m_size))chunk_size) {
+          if (ADAPTIVE) {
+            stolenFrom = true;
+            steal_size = std::max(m_size / 2, Diff_ty(1));
+          } else if (amount == HALF && m_size > (decltype(m_size))chunk_size) {
             steal_size = m_size / 2;
           } else {
             steal_size = m_size;
@@ -250,6 +311,10 @@ private:
       assert(std::distance(steal_beg, steal_end) == steal_size);
 
       poor.assignWork(steal_beg, steal_end, steal_size);
+
+      if (NEED_STATS) {
+        ++poor.num_steals;
+      }
     }
 
     return succ;
@@ -421,6 +486,7 @@ private:
   R range;
   F func;
   const char* loopname;
+  const char* traceName;
   Diff_ty chunk_size;
   substrate::PerThreadStorage<ThreadContext> workers;
 
@@ -437,6 +503,7 @@ public:
   DoAllStealingExec(const R& _range, const F& _func, const ArgsTuple& argsTuple)
       : range(_range), func(_func),
         loopname(galois::internal::getLoopName(argsTuple)),
+        traceName(NEED_TRACE ? timelineIntern(loopname) : nullptr),
         chunk_size(get_by_supertype<chunk_size_tag>(argsTuple).value),
         term(substrate::getSystemTermination(activeThreads)),
         totalTime(loopname, "Total"), initTime(loopname, "Init"),
@@ -457,7 +524,7 @@ public:
     unsigned id = substrate::ThreadPool::getTID();
 
     *workers.getLocal(id) =
-        ThreadContext(id, range.local_begin(), range.local_end());
+        ThreadContext(id, range.local_begin(), range.local_end(), chunk_size);
 
     initTime.stop();
   }
@@ -477,6 +544,7 @@ public:
   void operator()(void) {
 
     ThreadContext& ctx = *workers.getLocal();
+    TimelineSpan span(traceName, "do_all");
     totalTime.start();
 
     while (true) {
@@ -493,7 +561,12 @@ public:
       assert(!ctx.hasWork());
 
       stealTime.start();
-      bool stole = trySteal(ctx);
+      bool stole;
+      {
+        TimelineSpan stealSpan(traceName ? "steal" : nullptr, traceName);
+        stole = trySteal(ctx);
+        stealSpan.setArg(stole);
+      }
       stealTime.stop();
 
       if (stole) {
@@ -504,6 +577,8 @@ public:
         assert(!ctx.hasWork());
         if (USE_TERM) {
           termTime.start();
+          TimelineSpan termSpan(traceName ? "termination" : nullptr,
+                                traceName);
           term.localTermination(workHappened);
 
           bool quit = term.globalTermination();
@@ -523,6 +598,13 @@ public:
 
     if (NEED_STATS) {
       galois::runtime::reportStat_Tsum(loopname, "Iterations", ctx.num_iter);
+
+      if (ADAPTIVE) {
+        galois::runtime::reportStat_Tsum(loopname, "Chunks", ctx.num_chunks);
+        galois::runtime::reportStat_Tsum(loopname, "Steals", ctx.num_steals);
+        galois::runtime::reportStat_Tmax(loopname, "MaxChunkSize",
+                                         ctx.max_chunk);
+      }
     }
   }
 };
@@ -549,6 +631,11 @@ struct ChooseDoAllImpl<false> {
   template <typename R, typename F, typename ArgsT>
   static void call(const R& range, const F& func, const ArgsT& argsTuple) {
 
+    const char* const traceName =
+        exists_by_supertype<loopname_tag, ArgsT>::value
+            ? timelineIntern(galois::internal::getLoopName(argsTuple))
+            : nullptr;
+
     runtime::on_each_gen(
         [&](const unsigned tid, const unsigned numT) {
           static constexpr bool NEED_STATS =
@@ -558,6 +645,8 @@ struct ChooseDoAllImpl<false> {
 
           const char* const loopname = galois::internal::getLoopName(argsTuple);
 
+          TimelineSpan span(traceName, "do_all");
+
           PerThreadTimer<MORE_STATS> totalTime(loopname, "Total");
           PerThreadTimer<MORE_STATS> initTime(loopname, "Init");
           PerThreadTimer<MORE_STATS> execTime(loopname, "Work");
@@ -611,14 +700,19 @@ void do_all_gen(const R& range, const F& func, const ArgsTuple& argsTuple) {
 
   constexpr bool TIME_IT = exists_by_supertype<loopname_tag, ArgsT>::value;
   CondStatTimer<TIME_IT> timer(galois::internal::getLoopName(argsT));
+  CondPerfEvents<TIME_IT> perfEvents(galois::internal::getLoopName(argsT));
 
+  perfEvents.start();
   timer.start();
 
-  constexpr bool STEAL = exists_by_supertype<steal_tag, ArgsT>::value;
+  constexpr bool STEAL =
+      exists_by_supertype<steal_tag, ArgsT>::value ||
+      exists_by_supertype<adaptive_chunk_size_tag, ArgsT>::value;
 
   internal::ChooseDoAllImpl<STEAL>::call(range, func, argsT);
 
   timer.stop();
+  perfEvents.stop();
 }
 
 } // end namespace runtime
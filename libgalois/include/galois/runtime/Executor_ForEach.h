@@ -24,6 +24,8 @@
 #include "galois/gtuple.h"
 #include "galois/Mem.h"
 #include "galois/Timer.h"
+#include "galois/runtime/PerfEvents.h"
+#include "galois/runtime/Timeline.h"
 #include "galois/Threads.h"
 #include "galois/Traits.h"
 #include "galois/runtime/Substrate.h"
@@ -153,6 +155,9 @@ public:
       !exists_by_supertype<no_pushes_tag, ArgsTy>::value;
   static constexpr bool needsAborts =
       !exists_by_supertype<no_conflicts_tag, ArgsTy>::value;
+  static constexpr bool needsOptimistic =
+      needsAborts &&
+      exists_by_supertype<optimistic_conflicts_tag, ArgsTy>::value;
   static constexpr bool needsPia =
       exists_by_supertype<per_iter_alloc_tag, ArgsTy>::value;
   static constexpr bool needsBreak =
@@ -170,7 +175,7 @@ protected:
     SimpleRuntimeContext ctx;
 
     explicit ThreadLocalBasics(const FunctionTy& fn)
-        : facing(), function(fn), ctx() {}
+        : facing(), function(fn), ctx(false, needsOptimistic) {}
   };
 
   using LoopStat = LoopStatistics<needStats>;
@@ -191,12 +196,17 @@ protected:
   WorkListTy wl;
   FunctionTy origFunction;
   const char* loopname;
+  const char* traceName;
   bool broke;
 
   PerThreadTimer<MORE_STATS> initTime;
   PerThreadTimer<MORE_STATS> execTime;
 
   inline void commitIteration(ThreadLocalData& tld) {
+    // Validate operators that never reached a cautious point (e.g., read-only
+    // ones) before their pushes become visible
+    if (needsOptimistic)
+      tld.ctx.cautiousPoint();
     if (needsPush) {
       // auto ii = tld.facing.getPushBuffer().begin();
       // auto ee = tld.facing.getPushBuffer().end();
@@ -296,10 +306,23 @@ protected:
     return wl.empty();
   }
 
+  void recordIdle(bool didWork, uint64_t& idleBegin, int64_t& idleRounds) {
+    if (!didWork) {
+      if (!idleRounds++) {
+        idleBegin = internal::timelineNow();
+      }
+    } else if (idleRounds) {
+      internal::timelineRecord("termination", traceName, idleBegin,
+                               internal::timelineNow(), idleRounds);
+      idleRounds = 0;
+    }
+  }
+
   template <bool couldAbort, bool isLeader>
   void go() {
 
     execTime.start();
+    TimelineSpan span(traceName, "for_each");
 
     // Thread-local data goes on the local stack to be NUMA friendly
     ThreadLocalData tld(origFunction, loopname);
@@ -311,6 +334,10 @@ protected:
       tld.facing.setFastPushBack(std::bind(&ForEachExecutor::fastPushBack, this,
                                            std::placeholders::_1));
 
+    // Consecutive rounds without work form one idle span on the timeline
+    uint64_t idleBegin = 0;
+    int64_t idleRounds = 0;
+
     while (true) {
       do {
         bool didWork = false;
@@ -330,11 +357,19 @@ protected:
           didWork = b || didWork;
         }
 
+        if (traceName) {
+          recordIdle(didWork, idleBegin, idleRounds);
+        }
+
         // Update node color and prop token
         term.localTermination(didWork);
         substrate::asmPause(); // Let token propagate
       } while (!term.globalTermination() && (!needsBreak || !broke));
 
+      if (traceName) {
+        recordIdle(true, idleBegin, idleRounds);
+      }
+
       if (checkEmpty(wl, tld, 0)) {
         execTime.stop();
         break;
@@ -346,9 +381,13 @@ protected:
       }
 
       term.initializeThread();
+      TimelineSpan barrierSpan(traceName ? "barrier" : nullptr, traceName);
       barrier.wait();
     }
 
+    if (needStats && needsOptimistic)
+      reportStat_Tsum(loopname, "ValidationFailures",
+                      tld.ctx.getValidationFailures());
     if (couldAbort)
       setThreadContext(0);
   }
@@ -361,6 +400,9 @@ protected:
       : term(substrate::getSystemTermination(activeThreads)),
         barrier(getBarrier(activeThreads)), wl(std::forward<WArgsTy>(wargs)...),
         origFunction(f), loopname(galois::internal::getLoopName(args)),
+        traceName(exists_by_supertype<loopname_tag, ArgsTy>::value
+                      ? internal::timelineIntern(loopname)
+                      : nullptr),
         broke(false), initTime(loopname, "Init"),
         execTime(loopname, "Execute") {}
 
@@ -560,12 +602,15 @@ void for_each_gen(const RangeTy& r, const FunctionTy& fn, const TupleTy& tpl) {
     constexpr bool TIME_IT =
         exists_by_supertype<loopname_tag, decltype(xtpl)>::value;
     CondStatTimer<TIME_IT> timer(galois::internal::getLoopName(xtpl));
+    CondPerfEvents<TIME_IT> perfEvents(galois::internal::getLoopName(xtpl));
 
+    perfEvents.start();
     timer.start();
 
     runtime::for_each_impl(r, fn, xtpl);
 
     timer.stop();
+    perfEvents.stop();
 
   } else {
     // TODO: not needed any more? Remove once sure
@@ -585,12 +630,15 @@ void for_each_gen(const RangeTy& r, const FunctionTy& fn, const TupleTy& tpl) {
     constexpr bool TIME_IT =
         exists_by_supertype<loopname_tag, decltype(xtpl)>::value;
     CondStatTimer<TIME_IT> timer(galois::internal::getLoopName(xtpl));
+    CondPerfEvents<TIME_IT> perfEvents(galois::internal::getLoopName(xtpl));
 
+    perfEvents.start();
     timer.start();
 
     runtime::for_each_impl(r, fn, xtpl);
 
     timer.stop();
+    perfEvents.stop();
   }
 }
 
@@ -23,6 +23,8 @@
 #include "galois/gtuple.h"
 #include "galois/Traits.h"
 #include "galois/Timer.h"
+#include "galois/runtime/PerfEvents.h"
+#include "galois/runtime/Timeline.h"
 #include "galois/runtime/Statistics.h"
 #include "galois/Threads.h"
 #include "galois/gIO.h"
@@ -50,12 +52,17 @@ inline void on_each_impl(FunctionTy& fn, const ArgsTy& argsTuple) {
   const char* const loopname = galois::internal::getLoopName(argsTuple);
 
   CondStatTimer<NEEDS_STATS> timer(loopname);
+  CondPerfEvents<NEEDS_STATS> perfEvents(loopname);
 
   PerThreadTimer<MORE_STATS> execTime(loopname, "Execute");
 
   const auto numT = getActiveThreads();
 
+  const char* const traceName =
+      NEEDS_STATS ? timelineIntern(loopname) : nullptr;
+
   auto runFun = [&] {
+    TimelineSpan span(traceName, "on_each");
     execTime.start();
 
     fn(substrate::ThreadPool::getTID(), numT);
@@ -63,9 +70,11 @@ inline void on_each_impl(FunctionTy& fn, const ArgsTy& argsTuple) {
     execTime.stop();
   };
 
+  perfEvents.start();
   timer.start();
   substrate::getThreadPool().run(numT, runFun);
   timer.stop();
+  perfEvents.stop();
 }
 
 } // namespace internal
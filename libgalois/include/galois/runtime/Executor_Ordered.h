@@ -20,36 +20,502 @@
 #ifndef GALOIS_RUNTIME_EXECUTOR_ORDERED_H
 #define GALOIS_RUNTIME_EXECUTOR_ORDERED_H
 
+#include "galois/Reduction.h"
+#include "galois/Threads.h"
+#include "galois/Timer.h"
+#include "galois/gIO.h"
+#include "galois/runtime/Context.h"
+#include "galois/runtime/Executor_OnEach.h"
+#include "galois/runtime/ForEachTraits.h"
+#include "galois/runtime/Statistics.h"
+#include "galois/runtime/UserContextAccess.h"
+#include "galois/substrate/CompilerSpecific.h"
+#include "galois/substrate/PerThreadStorage.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <vector>
+
 namespace galois {
 namespace runtime {
 
-// TODO(ddn): Pull in and integrate in executors from exp
+//! Implementation of the speculative ordered executor (KDG-style)
+namespace internal {
+
+/**
+ * Per-item context of the ordered executor. During the neighborhood expansion
+ * phase every acquire marks the Lockable with the highest priority (smallest
+ * according to Cmp) context in the current window. Contexts that lose any of
+ * their locks are not sources and are retried in a later round.
+ *
+ * Held-back pushes expand while window items execute, so a context can lose a
+ * lock to another thread at any time; its state is therefore atomic, and a
+ * source must claim its execution before running.
+ */
+template <typename T, typename Cmp>
+class OrderedContext : public SimpleRuntimeContext {
+  enum State { SOURCE, NOT_SOURCE, STARTED };
+
+  const Cmp* cmp;
+  std::atomic<int> state;
+  bool expanding;
+
+public:
+  T item;
+
+  //! @param held true for a pushed item that only claims its neighborhood in
+  //! the current round
+  OrderedContext(const T& x, const Cmp& c, bool held = false)
+      : SimpleRuntimeContext(true), cmp(&c), state(held ? NOT_SOURCE : SOURCE),
+        expanding(true), item(x) {}
+
+  bool isSrc() const { return state.load(std::memory_order_relaxed) == SOURCE; }
+
+  bool isStarted() const {
+    return state.load(std::memory_order_relaxed) == STARTED;
+  }
+
+  //! @returns false if the context already started executing
+  bool disableSrc() {
+    int s = SOURCE;
+    return state.compare_exchange_strong(s, NOT_SOURCE,
+                                         std::memory_order_relaxed) ||
+           s == NOT_SOURCE;
+  }
 
-#if 0
-template <typename NhFunc, typename OpFunc>
-struct OrderedTraits {
-  static const bool NeedsPush = !galois::DEPRECATED::does_not_need_push<OpFunc>::value;
-  static const bool HasFixedNeighborhood = galois::DEPRECATED::has_fixed_neighborhood<NhFunc>::value;
+  //! Claims a source for execution; fails if it lost a lock first
+  bool tryStart() {
+    int s = SOURCE;
+    return state.compare_exchange_strong(s, STARTED,
+                                         std::memory_order_acq_rel);
+  }
+
+  //! Executes regardless of lost locks; only for the minimum item
+  void forceStart() { state.store(STARTED, std::memory_order_relaxed); }
+
+  //! The operator aborted; retry the item in a later round
+  void abortStart() { state.store(NOT_SOURCE, std::memory_order_relaxed); }
+
+  void finishExpansion() { expanding = false; }
+
+  //! Strict total order on contexts; ties between equal priorities are broken
+  //! by address so that every conflict has exactly one winner
+  bool precedes(const OrderedContext* that) const {
+    if ((*cmp)(item, that->item))
+      return true;
+    if ((*cmp)(that->item, item))
+      return false;
+    return this < that;
+  }
+
+  virtual void subAcquire(Lockable* lockable, galois::MethodFlag) {
+    // Only the neighborhood function acquires; the operator is cautious and
+    // runs with the neighborhood that was already won
+    if (!expanding)
+      return;
+
+    if (this->tryLock(lockable))
+      this->addToNhood(lockable);
+
+    OrderedContext* other;
+    do {
+      other = static_cast<OrderedContext*>(this->getOwner(lockable));
+      if (other == this)
+        return;
+      if (other && other->precedes(this)) {
+        // A lock that I want but can't get
+        disableSrc();
+        return;
+      }
+    } while (!this->stealByCAS(lockable, other));
+
+    // Disable loser. Only a held-back push can find it already executing; if
+    // the push strictly precedes it, the two ran out of order.
+    if (other && !other->disableSrc() && (*cmp)(item, other->item)) {
+      GALOIS_DIE("ordered executor: a pushed item precedes and conflicts with "
+                 "an item executed in the same round; the loop is not "
+                 "stable-source, pass a stability test that rules this out");
+    }
+  }
 };
-#endif
 
-template <typename Iter, typename Cmp, typename NhFunc, typename OpFunc>
-void for_each_ordered_impl(Iter beg, Iter end, const Cmp& cmp,
-                           const NhFunc& nhFunc, const OpFunc& opFunc,
-                           const char* loopname) {
-#if 0
-  if (!OrderedTraits<NhFunc, OpFunc>::NeedsPush && OrderedTraits<NhFunc, OpFunc>::HasFixedNeighborhood) {
-    // TODO: Remove-only/DAG executor
-    GALOIS_DIE("Remove-only executor not implemented yet");
-  } else if (OrderedTraits<NhFunc, OpFunc>::HasFixedNeighborhood) {
-    for_each_ordered_lc (beg, end, cmp, nhFunc, opFunc, loopname);
-  } else {
-    for_each_ordered_2p (beg, end, cmp, nhFunc, opFunc, loopname);
+//! Stability test for stable-source algorithms: every source may execute
+struct AlwaysStable {
+  template <typename T>
+  bool operator()(const T&) const {
+    return true;
   }
+};
+
+/**
+ * Kinetic dependence graph (KDG) executor for ordered algorithms.
+ *
+ * Pending items are kept in per-thread min-heaps. Each round takes a window of
+ * the globally smallest items, expands their neighborhoods speculatively with
+ * nhFunc, applies opFunc to every window item that won all of its locks
+ * (i.e., is a source in the KDG), and aborts the rest back into the pending
+ * set. Items pushed by opFunc must not precede the item that pushed them.
+ * The window grows or shrinks to keep the commit ratio near a target.
+ *
+ * A pushed item that precedes some item of the current window is held back:
+ * it expands its neighborhood right away as a non-source of the round, so the
+ * window items it conflicts with that have not run yet are retried after it.
+ * A push that precedes and conflicts with an item that already ran in the same
+ * round cannot be put back in order, and the executor dies; loops that can
+ * produce one must pass a stability test that rules it out (e.g., the ready
+ * test of discrete-event simulation).
+ */
+template <typename T, typename Cmp, typename NhFunc, typename OpFunc,
+          typename StableTest>
+class OrderedExecutor {
+  typedef OrderedContext<T, Cmp> Ctxt;
+  typedef UserContextAccess<T> UserCtxt;
+
+  static const bool needsPush =
+      DEPRECATED::ForEachTraits<OpFunc>::NeedsPush;
+
+  static const size_t MIN_WINDOW = 2;
+  static const size_t MAX_WINDOW = 1 << 20;
+
+  struct HeapCmp {
+    const Cmp* cmp;
+    bool operator()(const T& left, const T& right) const {
+      return (*cmp)(right, left);
+    }
+  };
+
+  struct ThreadData {
+    std::vector<T> heap;
+    std::vector<T> popped;
+    std::deque<Ctxt> window;
+    //! pushes of this round that claim their neighborhoods in it
+    std::deque<Ctxt> held;
+    std::vector<T> pushed;
+    //! last item of window in priority order
+    const T* maxItem = nullptr;
+    UserCtxt uhand;
+    //! whether popped.back() bounds the pending items of this thread
+    bool hasLimit = false;
+    size_t pushes = 0;
+  };
+
+  Cmp cmp;
+  NhFunc nhFunc;
+  OpFunc opFunc;
+  StableTest stabilityTest;
+  const char* loopname;
+  HeapCmp heapCmp;
+
+  substrate::PerThreadStorage<ThreadData> data;
+  GAccumulator<size_t> roundCommits;
+  GAccumulator<size_t> roundTasks;
+
+  double targetCommitRatio = 0.80;
+  size_t windowPerThread   = 32;
+
+  size_t rounds       = 0;
+  size_t totalTasks   = 0;
+  size_t totalCommits = 0;
+  size_t forcedMin    = 0;
+  //! last item of the current window in priority order
+  const T* windowMax = nullptr;
+
+  template <typename F>
+  static ConflictFlag runCatching(F& func, Ctxt& c, UserCtxt& uhand) {
+    setThreadContext(&c);
+    ConflictFlag flag = NO_CONFLICT;
+#ifdef GALOIS_USE_LONGJMP_ABORT
+    int result = setjmp(execFrame);
+    if (result == 0) {
+      func(c.item, uhand.data());
+    } else {
+      clearConflictLock();
+      flag = ConflictFlag(result);
+    }
 #else
-  GALOIS_DIE("not yet implemented");
+    try {
+      func(c.item, uhand.data());
+    } catch (ConflictFlag f) {
+      clearConflictLock();
+      flag = f;
+    }
 #endif
-}
+    setThreadContext(nullptr);
+    return flag;
+  }
+
+  void pushPending(ThreadData& tld, const T& x) {
+    tld.heap.push_back(x);
+    std::push_heap(tld.heap.begin(), tld.heap.end(), heapCmp);
+  }
+
+  GALOIS_ATTRIBUTE_PROF_NOINLINE bool fillWindow() {
+    const size_t k = windowPerThread;
+
+    on_each_gen(
+        [&, this](const unsigned, const unsigned) {
+          ThreadData& tld = *data.getLocal();
+          tld.popped.clear();
+          while (!tld.heap.empty() && tld.popped.size() < k) {
+            std::pop_heap(tld.heap.begin(), tld.heap.end(), heapCmp);
+            tld.popped.push_back(tld.heap.back());
+            tld.heap.pop_back();
+          }
+          tld.hasLimit = !tld.heap.empty() && !tld.popped.empty();
+        },
+        std::make_tuple());
+
+    // All pending items of a thread are no smaller than the last item it
+    // popped, so the smallest such item bounds the window from above
+    const T* limit = nullptr;
+    bool empty     = true;
+    for (unsigned i = 0; i < data.size(); ++i) {
+      ThreadData& tld = *data.getRemote(i);
+      empty           = empty && tld.popped.empty();
+      if (tld.hasLimit && (!limit || cmp(tld.popped.back(), *limit)))
+        limit = &tld.popped.back();
+    }
+
+    if (empty)
+      return false;
+
+    // copy so that threads can modify their popped lists
+    std::vector<T> lim;
+    if (limit)
+      lim.push_back(*limit);
+
+    on_each_gen(
+        [&, this](const unsigned, const unsigned) {
+          ThreadData& tld = *data.getLocal();
+          tld.maxItem     = nullptr;
+          for (const T& x : tld.popped) {
+            if (lim.empty() || !cmp(lim[0], x)) {
+              tld.window.emplace_back(x, cmp);
+              roundTasks += 1;
+              if (!tld.maxItem || cmp(*tld.maxItem, x))
+                tld.maxItem = &tld.window.back().item;
+            } else {
+              pushPending(tld, x);
+            }
+          }
+          tld.popped.clear();
+        },
+        std::make_tuple());
+
+    windowMax = nullptr;
+    for (unsigned i = 0; i < data.size(); ++i) {
+      const T* m = data.getRemote(i)->maxItem;
+      if (m && (!windowMax || cmp(*windowMax, *m)))
+        windowMax = m;
+    }
+
+    return true;
+  }
+
+  GALOIS_ATTRIBUTE_PROF_NOINLINE void expandNhood() {
+    on_each_gen(
+        [this](const unsigned, const unsigned) {
+          ThreadData& tld = *data.getLocal();
+          tld.uhand.setFirstPass();
+          for (Ctxt& c : tld.window) {
+            tld.uhand.resetPushBuffer();
+            ConflictFlag f = runCatching(nhFunc, c, tld.uhand);
+            if (f == CONFLICT)
+              c.disableSrc();
+            c.finishExpansion();
+          }
+          tld.uhand.resetFirstPass();
+          tld.uhand.resetPushBuffer();
+          tld.uhand.resetAlloc();
+        },
+        std::make_tuple());
+  }
+
+  //! Expands a pushed item in the current round without executing it
+  void holdBack(ThreadData& tld, const T& x) {
+    tld.held.emplace_back(x, cmp, true);
+    Ctxt& h = tld.held.back();
+    tld.uhand.setFirstPass();
+    runCatching(nhFunc, h, tld.uhand);
+    h.finishExpansion();
+    tld.uhand.resetFirstPass();
+    tld.uhand.resetPushBuffer();
+    tld.uhand.resetAlloc();
+  }
+
+  //! Runs opFunc on a context that was claimed with tryStart or forceStart
+  bool applyOne(ThreadData& tld, Ctxt& c) {
+    tld.uhand.resetPushBuffer();
+    ConflictFlag f = runCatching(opFunc, c, tld.uhand);
+    tld.uhand.resetAlloc();
+    if (f == CONFLICT) {
+      c.abortStart();
+      return false;
+    }
+    auto& pb = tld.uhand.getPushBuffer();
+    assert(needsPush || pb.begin() == pb.end());
+    tld.pushed.assign(pb.begin(), pb.end());
+    tld.uhand.resetPushBuffer();
+    for (const T& x : tld.pushed) {
+      assert(!cmp(x, c.item) && "ordered executor: pushed item precedes its parent");
+      ++tld.pushes;
+      if (windowMax && cmp(x, *windowMax))
+        holdBack(tld, x);
+      else
+        pushPending(tld, x);
+    }
+    return true;
+  }
+
+  GALOIS_ATTRIBUTE_PROF_NOINLINE void applyOperator() {
+    on_each_gen(
+        [this](const unsigned, const unsigned) {
+          ThreadData& tld = *data.getLocal();
+          for (Ctxt& c : tld.window) {
+            if (!c.isSrc())
+              continue;
+            if (!stabilityTest(c.item)) {
+              c.disableSrc();
+              continue;
+            }
+            if (c.tryStart() && applyOne(tld, c))
+              roundCommits += 1;
+          }
+        },
+        std::make_tuple());
+  }
+
+  //! If nothing committed (e.g., every source failed the stability test), the
+  //! smallest window item is safe to execute because it precedes every
+  //! pending item
+  GALOIS_ATTRIBUTE_NOINLINE void executeMin() {
+    Ctxt* min           = nullptr;
+    ThreadData* minData = nullptr;
+    for (unsigned i = 0; i < data.size(); ++i) {
+      ThreadData& tld = *data.getRemote(i);
+      for (Ctxt& c : tld.window) {
+        if (!min || c.precedes(min)) {
+          min     = &c;
+          minData = &tld;
+        }
+      }
+    }
+    assert(min);
+
+    min->forceStart();
+    if (!applyOne(*minData, *min)) {
+      GALOIS_DIE("ordered executor: minimum item aborted; no progress possible");
+    }
+    roundCommits += 1;
+    ++forcedMin;
+  }
+
+  GALOIS_ATTRIBUTE_PROF_NOINLINE void endRound() {
+    on_each_gen(
+        [this](const unsigned, const unsigned) {
+          ThreadData& tld = *data.getLocal();
+          for (Ctxt& c : tld.window) {
+            c.commitIteration();
+            if (!c.isStarted())
+              pushPending(tld, c.item);
+          }
+          for (Ctxt& h : tld.held) {
+            h.commitIteration();
+            pushPending(tld, h.item);
+          }
+          tld.window.clear();
+          tld.held.clear();
+        },
+        std::make_tuple());
+
+    size_t commits = roundCommits.reduce();
+    size_t tasks   = roundTasks.reduce();
+    roundCommits.reset();
+    roundTasks.reset();
+
+    ++rounds;
+    totalTasks += tasks;
+    totalCommits += commits;
+
+    // Adapt window to keep the commit ratio near the target
+    double ratio = double(commits) / double(tasks);
+    size_t next  = size_t(windowPerThread * ratio / targetCommitRatio);
+    next         = std::min(next, 2 * windowPerThread);
+    windowPerThread = std::max(MIN_WINDOW, std::min(MAX_WINDOW, next));
+  }
+
+public:
+  OrderedExecutor(const Cmp& cmp, const NhFunc& nhFunc, const OpFunc& opFunc,
+                  const StableTest& stabilityTest, const char* ln)
+      : cmp(cmp), nhFunc(nhFunc), opFunc(opFunc),
+        stabilityTest(stabilityTest), loopname(ln ? ln : "(NULL)") {
+    heapCmp.cmp = &this->cmp;
+  }
+
+  ~OrderedExecutor() {
+    size_t totalPushes = 0;
+    for (unsigned i = 0; i < data.size(); ++i)
+      totalPushes += data.getRemote(i)->pushes;
+
+    reportStat_Single(loopname, "Rounds", rounds);
+    reportStat_Single(loopname, "Iterations", totalTasks);
+    reportStat_Single(loopname, "Commits", totalCommits);
+    reportStat_Single(loopname, "Aborts", totalTasks - totalCommits);
+    reportStat_Single(loopname, "Pushes", totalPushes);
+    reportStat_Single(loopname, "ForcedMinCommits", forcedMin);
+    reportStat_Single(loopname, "CommitRatio %",
+                      totalTasks ? 100.0 * totalCommits / totalTasks : 0.0);
+    reportStat_Single(loopname, "AvgParallelism",
+                      rounds ? double(totalCommits) / rounds : 0.0);
+  }
+
+  template <typename Iter>
+  void initFill(Iter b, Iter e) {
+    on_each_gen(
+        [&, this](const unsigned tid, const unsigned numT) {
+          ThreadData& tld = *data.getLocal();
+          auto dist       = std::distance(b, e);
+          auto block      = (dist + numT - 1) / numT;
+          auto start      = std::min<decltype(dist)>(dist, block * tid);
+          auto stop       = std::min<decltype(dist)>(dist, start + block);
+          Iter ii         = b;
+          std::advance(ii, start);
+          for (auto i = start; i < stop; ++i, ++ii) {
+            tld.heap.push_back(*ii);
+          }
+          std::make_heap(tld.heap.begin(), tld.heap.end(), heapCmp);
+        },
+        std::make_tuple());
+  }
+
+  void execute() {
+    StatTimer t_fill("FillWindowTime", loopname);
+    StatTimer t_expand("ExpandNhoodTime", loopname);
+    StatTimer t_apply("ApplyOperatorTime", loopname);
+
+    while (true) {
+      t_fill.start();
+      bool more = fillWindow();
+      t_fill.stop();
+      if (!more)
+        break;
+
+      t_expand.start();
+      expandNhood();
+      t_expand.stop();
+
+      t_apply.start();
+      applyOperator();
+      if (roundCommits.reduce() == 0)
+        executeMin();
+      endRound();
+      t_apply.stop();
+    }
+  }
+};
+
+} // namespace internal
 
 template <typename Iter, typename Cmp, typename NhFunc, typename OpFunc,
           typename StableTest>
@@ -57,19 +523,27 @@ void for_each_ordered_impl(Iter beg, Iter end, const Cmp& cmp,
                            const NhFunc& nhFunc, const OpFunc& opFunc,
                            const StableTest& stabilityTest,
                            const char* loopname) {
-#if 0
-  if (!OrderedTraits<NhFunc, OpFunc>::NeedsPush && OrderedTraits<NhFunc, OpFunc>::HasFixedNeighborhood) {
-    GALOIS_DIE("no-adds + fixed-neighborhood == stable-source");
-  } else if (OrderedTraits<NhFunc, OpFunc>::HasFixedNeighborhood) {
-    for_each_ordered_lc (beg, end, cmp, nhFunc, opFunc, stabilityTest, loopname);
-  } else {
-    GALOIS_DIE("two-phase executor for unstable-source algorithms not implemented yet");
-    // TODO: implement following
-    // for_each_ordered_2p (beg, end, cmp, nhFunc, opFunc, stabilityTest, loopname); 
-  }
-#else
-  GALOIS_DIE("not yet implemented");
-#endif
+  typedef typename std::iterator_traits<Iter>::value_type T;
+  typedef internal::OrderedExecutor<T, Cmp, NhFunc, OpFunc, StableTest> Exec;
+
+  CondStatTimer<true> timer(loopname ? loopname : "(NULL)");
+  timer.start();
+
+  Exec e(cmp, nhFunc, opFunc, stabilityTest, loopname);
+  substrate::getThreadPool().burnPower(galois::getActiveThreads());
+  e.initFill(beg, end);
+  e.execute();
+  substrate::getThreadPool().beKind();
+
+  timer.stop();
+}
+
+template <typename Iter, typename Cmp, typename NhFunc, typename OpFunc>
+void for_each_ordered_impl(Iter beg, Iter end, const Cmp& cmp,
+                           const NhFunc& nhFunc, const OpFunc& opFunc,
+                           const char* loopname) {
+  for_each_ordered_impl(beg, end, cmp, nhFunc, opFunc, internal::AlwaysStable(),
+                        loopname);
 }
 
 } // end namespace runtime
@@ -0,0 +1,87 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef GALOIS_RUNTIME_PERFEVENTS_H
+#define GALOIS_RUNTIME_PERFEVENTS_H
+
+#include "galois/Threads.h"
+#include "galois/substrate/ThreadPool.h"
+
+namespace galois {
+namespace runtime {
+
+namespace internal {
+
+//! True if GALOIS_PERF_EVENTS selects at least one hardware event
+bool perfEventsEnabled();
+
+//! Snapshot the counters of the first numT threads
+void perfEventsStart(unsigned numT);
+
+//! Report per-thread counter deltas since perfEventsStart as loop stats
+void perfEventsStop(const char* loopname, unsigned numT);
+
+} // namespace internal
+
+/**
+ * Collects hardware counters (via Linux perf_event_open) for a named parallel
+ * loop when the environment variable GALOIS_PERF_EVENTS is set. Its value is
+ * either "all" or a comma separated subset of cycles, instructions,
+ * llc-misses, dtlb-misses, branch-misses and page-faults. Counts are reported
+ * per thread with reportStat_Tsum under the loop name and are scaled when the
+ * kernel multiplexes events.
+ */
+template <bool Enabled>
+class CondPerfEvents {
+  const char* loopname;
+  unsigned numThreads;
+
+public:
+  explicit CondPerfEvents(const char* ln) : loopname(ln), numThreads(0) {}
+
+  void start() {
+    if (!internal::perfEventsEnabled() ||
+        substrate::getThreadPool().isRunning()) {
+      return;
+    }
+    numThreads = getActiveThreads();
+    internal::perfEventsStart(numThreads);
+  }
+
+  void stop() {
+    if (numThreads) {
+      internal::perfEventsStop(loopname, numThreads);
+      numThreads = 0;
+    }
+  }
+};
+
+template <>
+class CondPerfEvents<false> {
+public:
+  explicit CondPerfEvents(const char*) {}
+
+  void start() const {}
+  void stop() const {}
+};
+
+} // namespace runtime
+} // namespace galois
+
+#endif
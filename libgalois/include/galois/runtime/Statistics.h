@@ -517,6 +517,9 @@ protected:
 
   virtual void printStats(std::ostream& out);
 
+  //! Writes the execution timeline (see Timeline.h) if one was requested
+  virtual void writeTimeline(void);
+
   void printHeader(std::ostream& out) const;
 
 public:
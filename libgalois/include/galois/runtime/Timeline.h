@@ -0,0 +1,108 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef GALOIS_RUNTIME_TIMELINE_H
+#define GALOIS_RUNTIME_TIMELINE_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace galois {
+namespace runtime {
+
+/**
+ * Per-thread execution timeline. When the environment variable
+ * GALOIS_TIMELINE names an output file, every named parallel loop records
+ * one span per thread, together with steal attempts, termination detection,
+ * barrier waits and communication phases. Spans go into a fixed-size ring
+ * buffer owned by the recording thread (GALOIS_TIMELINE_EVENTS entries,
+ * oldest overwritten first) and are written as a Chrome/Perfetto JSON trace
+ * when statistics are printed at exit.
+ *
+ * Only threads of the thread pool (including the main thread) may record.
+ */
+namespace internal {
+
+//! True if GALOIS_TIMELINE is set
+bool timelineEnabled();
+
+//! Returns a copy of name that lives until exit, or nullptr if the timeline
+//! is disabled. Loop names are often temporaries, so executors intern them
+//! once before starting the threads.
+const char* timelineIntern(const char* name);
+
+//! Current time in nanoseconds on the timeline clock
+uint64_t timelineNow();
+
+//! Appends a completed span to the calling thread's buffer. name and cat
+//! must be literals or interned strings.
+void timelineRecord(const char* name, const char* cat, uint64_t begin,
+                    uint64_t end, int64_t arg);
+
+} // namespace internal
+
+/**
+ * Records the lifetime of the object as a span on the calling thread. A
+ * null name disables the span, so callers pass the interned loop name (which
+ * is null when the timeline is off) or a literal guarded by it.
+ */
+class TimelineSpan {
+  const char* name;
+  const char* cat;
+  uint64_t begin;
+  int64_t arg;
+
+public:
+  TimelineSpan(const char* n, const char* c)
+      : name(n), cat(c), begin(n ? internal::timelineNow() : 0), arg(-1) {}
+
+  TimelineSpan(const TimelineSpan&) = delete;
+  TimelineSpan& operator=(const TimelineSpan&) = delete;
+
+  //! Attaches an integer argument (e.g., number of rounds) to the span
+  void setArg(int64_t a) { arg = a; }
+
+  ~TimelineSpan() {
+    if (name) {
+      internal::timelineRecord(name, cat, begin, internal::timelineNow(), arg);
+    }
+  }
+};
+
+//! Output file of the timeline; empty if disabled
+const std::string& timelineFile();
+
+//! Timeline clock value at startup; used as time zero of the trace
+uint64_t timelineEpoch();
+
+//! Writes the events of this process as comma-separated JSON objects with
+//! process id pid and timestamps shifted by -shift nanoseconds
+void timelineWriteEvents(std::ostream& out, unsigned pid, int64_t shift);
+
+//! Writes a complete trace made of this process' events (as process pid 0)
+//! followed by already formatted event lists of other processes
+void timelineWriteTrace(std::ostream& out,
+                        const std::vector<std::string>& remoteEvents);
+
+} // namespace runtime
+} // namespace galois
+
+#endif
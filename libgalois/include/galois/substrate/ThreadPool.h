@@ -59,6 +59,9 @@ protected:
   struct fastmode_ty {
     bool mode;
   }; //! type for setting fastmode
+  struct spinbudget_ty {
+    unsigned usec;
+  }; //! type for setting the adaptive spin budget
   struct dedicated_ty {
     std::function<void(void)> fn;
   }; //! type to switch to dedicated mode
@@ -70,12 +73,16 @@ protected:
     unsigned wbegin, wend;
     std::atomic<int> done;
     std::atomic<int> fastRelease;
+    std::atomic<int> parked;
     threadTopoInfo topo;
 
-    void wakeup(bool fastmode) {
-      if (fastmode) {
-        done        = 0;
-        fastRelease = 1;
+    //! release is true if the thread waits on fastRelease rather than cv
+    void wakeup(bool release) {
+      if (release) {
+        done = 0;
+        fastRelease.store(1, std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_seq_cst))
+          unpark();
       } else {
         std::lock_guard<std::mutex> lg(m);
         done = 0;
@@ -84,18 +91,31 @@ protected:
       }
     }
 
-    void wait(bool fastmode) {
+    //! Spins while in fastmode; otherwise spins for up to spinUsec
+    //! microseconds before parking, or blocks on cv if spinUsec is 0
+    void wait(bool fastmode, unsigned spinUsec) {
       if (fastmode) {
         while (!fastRelease.load(std::memory_order_relaxed)) {
           asmPause();
         }
         fastRelease = 0;
+      } else if (spinUsec) {
+        if (!spinFor(spinUsec))
+          park();
+        fastRelease = 0;
       } else {
         std::unique_lock<std::mutex> lg(m);
         cv.wait(lg, [=] { return !done; });
         // start.acquire();
       }
     }
+
+    //! Spins until released or spinUsec elapses; returns if released
+    bool spinFor(unsigned spinUsec);
+    //! Sleeps on fastRelease until released
+    void park();
+    //! Wakes a thread sleeping in park
+    void unpark();
   };
 
   thread_local static per_signal my_box;
@@ -105,6 +125,8 @@ protected:
   std::vector<std::thread> threads;
   unsigned reserved;
   unsigned masterFastmode;
+  //! Microseconds idle threads spin before parking; 0 blocks on a cv
+  unsigned spinBudget;
   bool running;
   std::function<void(void)> work;
 
@@ -118,7 +140,7 @@ protected:
   void threadLoop(unsigned tid);
 
   //! spin up for run
-  void cascade(bool fastmode);
+  void cascade(bool release);
 
   //! spin down after run
   void decascade();
@@ -164,6 +186,11 @@ public:
   // experimental: leave busy wait
   void beKind();
 
+  //! Sets how long idle threads spin waiting for the next parallel region
+  //! before they sleep; 0 restores blocking on a condition variable
+  void setSpinBudget(unsigned usec);
+  unsigned getSpinBudget() const { return spinBudget; }
+
   bool isRunning() const { return running; }
 
   //! return the number of non-reserved threads in the pool
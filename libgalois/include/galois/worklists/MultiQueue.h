@@ -0,0 +1,325 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef GALOIS_WORKLIST_MULTIQUEUE_H
+#define GALOIS_WORKLIST_MULTIQUEUE_H
+
+#include "galois/optional.h"
+#include "galois/runtime/Substrate.h"
+#include "galois/substrate/CompilerSpecific.h"
+#include "galois/substrate/PerThreadStorage.h"
+#include "galois/substrate/SimpleLock.h"
+#include "galois/substrate/ThreadPool.h"
+#include "galois/worklists/WLCompileCheck.h"
+#include "galois/worklists/WorkListHelpers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace galois {
+namespace runtime {
+extern unsigned int activeThreads;
+}
+
+namespace worklists {
+
+/**
+ * Relaxed concurrent priority scheduler (MultiQueue). Keeps
+ * QueuesPerThread * activeThreads sequential min-heaps, each behind its own
+ * lock. A pop samples two random heaps and takes the better top; a push
+ * appends to a thread-local batch that is flushed into one random heap. There
+ * is no global bucket structure, so arbitrary (e.g., floating-point or
+ * unbounded integer) priorities cost the same as a few distinct ones.
+ *
+ * Indexer is a default-constructable class whose instances conform to
+ * <code>R r = indexer(item)</code> where R is a trivially copyable type with a
+ * total order defined by <code>operator&lt;</code>; smaller values are
+ * scheduled first.
+ *
+ * An example:
+ * \code
+ * struct Indexer {
+ *   float operator()(Item i) const { return i.priority; }
+ * };
+ *
+ * galois::for_each(galois::iterate(items), Fn,
+ *   galois::wl<galois::worklists::MultiQueue<Indexer>>());
+ * \endcode
+ *
+ * @tparam Indexer         Indexer class
+ * @tparam QueuesPerThread Number of heaps per active thread (c in c*T)
+ * @tparam StickyPops      Number of consecutive pops served by the same heap
+ *                         before resampling
+ * @tparam BatchSize       Number of pushes buffered per thread before they
+ *                         are inserted into a heap under a single lock
+ */
+template <class Indexer = DummyIndexer<int>, unsigned QueuesPerThread = 2,
+          unsigned StickyPops = 8, unsigned BatchSize = 16, typename T = int,
+          typename Index = int, bool Concurrent = true>
+struct MultiQueue : private boost::noncopyable {
+
+  template <typename _T>
+  using retype =
+      MultiQueue<Indexer, QueuesPerThread, StickyPops, BatchSize, _T,
+                 typename std::result_of<Indexer(_T)>::type, Concurrent>;
+
+  template <bool _b>
+  using rethread = MultiQueue<Indexer, QueuesPerThread, StickyPops, BatchSize,
+                              T, Index, _b>;
+
+  template <typename _indexer>
+  struct with_indexer {
+    typedef MultiQueue<_indexer, QueuesPerThread, StickyPops, BatchSize, T,
+                       Index, Concurrent>
+        type;
+  };
+
+  template <unsigned _queues>
+  struct with_queues_per_thread {
+    typedef MultiQueue<Indexer, _queues, StickyPops, BatchSize, T, Index,
+                       Concurrent>
+        type;
+  };
+
+  template <unsigned _sticky>
+  struct with_sticky_pops {
+    typedef MultiQueue<Indexer, QueuesPerThread, _sticky, BatchSize, T, Index,
+                       Concurrent>
+        type;
+  };
+
+  template <unsigned _batch>
+  struct with_batch_size {
+    typedef MultiQueue<Indexer, QueuesPerThread, StickyPops, _batch, T, Index,
+                       Concurrent>
+        type;
+  };
+
+  typedef T value_type;
+  typedef Index index_type;
+
+private:
+  static_assert(QueuesPerThread > 0, "need at least one queue per thread");
+  static_assert(std::is_trivially_copyable<Index>::value,
+                "index type must be trivially copyable");
+
+  typedef std::pair<Index, T> Entry;
+
+  struct EntryCmp {
+    bool operator()(const Entry& a, const Entry& b) const {
+      return b.first < a.first;
+    }
+  };
+
+  // Heaps are padded by hand rather than cache-line aligned so that the array
+  // can be allocated with plain new
+  struct Queue {
+    substrate::CondLock<Concurrent> lock;
+    std::vector<Entry> heap;
+    //! copy of the top index so that pops can compare heaps without locking
+    std::atomic<Index> top;
+    std::atomic<bool> empty;
+    char pad[GALOIS_CACHE_LINE_SIZE];
+
+    Queue() : empty(true) {}
+
+    void push(const Entry& e) {
+      heap.push_back(e);
+      std::push_heap(heap.begin(), heap.end(), EntryCmp());
+      publish();
+    }
+
+    T pop() {
+      std::pop_heap(heap.begin(), heap.end(), EntryCmp());
+      T item = heap.back().second;
+      heap.pop_back();
+      publish();
+      return item;
+    }
+
+    void publish() {
+      if (!heap.empty())
+        top.store(heap.front().first, std::memory_order_relaxed);
+      empty.store(heap.empty(), std::memory_order_release);
+    }
+  };
+
+  struct ThreadData {
+    std::vector<Entry> batch;
+    uint64_t seed;
+    unsigned sticky;
+    unsigned current;
+
+    ThreadData() : seed(0), sticky(0), current(0) {}
+
+    unsigned next(unsigned n) {
+      // xorshift64*
+      seed ^= seed >> 12;
+      seed ^= seed << 25;
+      seed ^= seed >> 27;
+      return unsigned((seed * 2685821657736338717ULL) >> 32) % n;
+    }
+  };
+
+  substrate::PerThreadStorage<ThreadData> data;
+  std::unique_ptr<Queue[]> queues;
+  unsigned numQueues;
+  Indexer indexer;
+
+  ThreadData& local() {
+    ThreadData& p = *data.getLocal();
+    if (!p.seed)
+      p.seed = 0x9E3779B97F4A7C15ULL * (substrate::ThreadPool::getTID() + 1);
+    return p;
+  }
+
+  void flush(ThreadData& p) {
+    if (p.batch.empty())
+      return;
+    Queue* q;
+    do {
+      q = &queues[p.next(numQueues)];
+    } while (!q->lock.try_lock());
+    for (const Entry& e : p.batch)
+      q->push(e);
+    q->lock.unlock();
+    p.batch.clear();
+  }
+
+  galois::optional<value_type> popFrom(Queue& q) {
+    galois::optional<value_type> item;
+    if (q.empty.load(std::memory_order_acquire))
+      return item;
+    q.lock.lock();
+    if (!q.heap.empty())
+      item = q.pop();
+    q.lock.unlock();
+    return item;
+  }
+
+  GALOIS_ATTRIBUTE_NOINLINE
+  galois::optional<value_type> slowPop(ThreadData& p) {
+    // Sampling can miss work when few heaps are non-empty; scan all heaps
+    // before reporting failure so that termination detection stays sound
+    unsigned start = p.next(numQueues);
+    for (unsigned i = 0; i < numQueues; ++i) {
+      unsigned idx = (start + i) % numQueues;
+      galois::optional<value_type> item = popFrom(queues[idx]);
+      if (item) {
+        p.current = idx;
+        p.sticky  = StickyPops;
+        return item;
+      }
+    }
+    return galois::optional<value_type>();
+  }
+
+public:
+  MultiQueue(const Indexer& x = Indexer())
+      : numQueues(QueuesPerThread *
+                  std::max(runtime::activeThreads, 1U)),
+        indexer(x) {
+    queues.reset(new Queue[numQueues]);
+  }
+
+  void push(const value_type& val) {
+    ThreadData& p = local();
+    p.batch.emplace_back(indexer(val), val);
+    if (p.batch.size() >= BatchSize)
+      flush(p);
+  }
+
+  template <typename Iter>
+  void push(Iter b, Iter e) {
+    ThreadData& p = local();
+    while (b != e) {
+      p.batch.emplace_back(indexer(*b), *b);
+      ++b;
+      if (p.batch.size() >= BatchSize)
+        flush(p);
+    }
+    flush(p);
+  }
+
+  template <typename RangeTy>
+  void push_initial(const RangeTy& range) {
+    auto rp = range.local_pair();
+    push(rp.first, rp.second);
+  }
+
+  galois::optional<value_type> pop() {
+    ThreadData& p = local();
+    // Make buffered pushes visible before this thread looks for work
+    flush(p);
+
+    if (p.sticky) {
+      --p.sticky;
+      Queue& q = queues[p.current];
+      if (!q.empty.load(std::memory_order_acquire) && q.lock.try_lock()) {
+        galois::optional<value_type> item;
+        if (!q.heap.empty())
+          item = q.pop();
+        q.lock.unlock();
+        if (item)
+          return item;
+      }
+    }
+
+    for (int tries = 0; tries < 4; ++tries) {
+      unsigned i = p.next(numQueues);
+      unsigned j = p.next(numQueues);
+      Queue& qi  = queues[i];
+      Queue& qj  = queues[j];
+      bool ei    = qi.empty.load(std::memory_order_acquire);
+      bool ej    = qj.empty.load(std::memory_order_acquire);
+      if (ei && ej)
+        continue;
+
+      unsigned best = i;
+      if (ei || (!ej && qj.top.load(std::memory_order_relaxed) <
+                            qi.top.load(std::memory_order_relaxed)))
+        best = j;
+
+      Queue& q = queues[best];
+      if (!q.lock.try_lock())
+        continue;
+      galois::optional<value_type> item;
+      if (!q.heap.empty())
+        item = q.pop();
+      q.lock.unlock();
+      if (item) {
+        p.current = best;
+        p.sticky  = StickyPops;
+        return item;
+      }
+    }
+
+    return slowPop(p);
+  }
+};
+GALOIS_WLCOMPILECHECK(MultiQueue)
+
+} // end namespace worklists
+} // end namespace galois
+
+#endif
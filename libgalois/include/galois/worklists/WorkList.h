@@ -28,6 +28,7 @@
 #include "Simple.h"
 #include "LocalQueue.h"
 #include "Obim.h"
+#include "MultiQueue.h"
 #include "OrderedList.h"
 #include "OwnerComputes.h"
 #include "StableIterator.h"
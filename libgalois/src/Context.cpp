@@ -21,6 +21,8 @@
 #include "galois/substrate/SimpleLock.h"
 #include "galois/substrate/CacheLineStorage.h"
 
+#include <atomic>
+#include <cstdint>
 #include <stdio.h>
 
 //! Global thread context for each active thread
@@ -59,6 +61,39 @@ galois::runtime::SimpleRuntimeContext* galois::runtime::getThreadContext() {
   return thread_ctx;
 }
 
+void galois::runtime::signalCautiousPoint() {
+  SimpleRuntimeContext* ctx = getThreadContext();
+  if (ctx)
+    ctx->cautiousPoint();
+}
+
+void galois::runtime::checkOptimisticReads() {
+  SimpleRuntimeContext* ctx = getThreadContext();
+  if (ctx)
+    ctx->checkReads();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Versions for optimistic conflict detection
+////////////////////////////////////////////////////////////////////////////////
+
+// Versions are striped over a fixed table rather than stored in each
+// Lockable, so that lockables do not grow. Two lockables sharing a stripe
+// can only cause spurious validation failures.
+static const unsigned versionBits = 20;
+static std::atomic<unsigned> versionTable[1 << versionBits];
+
+static std::atomic<unsigned>& getVersion(galois::runtime::Lockable* lockable) {
+  uint64_t h = reinterpret_cast<uintptr_t>(lockable) * 0x9E3779B97F4A7C15ull;
+  return versionTable[h >> (64 - versionBits)];
+}
+
+// Bumped whenever an optimistic iteration locks items it is about to change
+// and when it commits. Readers revalidate only when it has moved.
+static galois::substrate::CacheLineStorage<std::atomic<unsigned>> lockClock;
+
+static void tickLockClock() { lockClock.get().fetch_add(1); }
+
 #ifdef GALOIS_USE_EXP
 bool galois::runtime::owns(Lockable* lockable, MethodFlag m) {
   SimpleRuntimeContext* ctx = getThreadContext();
@@ -101,15 +136,108 @@ void galois::runtime::SimpleRuntimeContext::acquire(
   AcquireStatus i;
   if (customAcquire) {
     subAcquire(lockable, m);
+  } else if (optimistic && !validated) {
+    optimisticAcquire(lockable, m);
   } else if ((i = tryAcquire(lockable)) != AcquireStatus::FAIL) {
     if (i == AcquireStatus::NEW_OWNER) {
       addToNhood(lockable);
+      if (optimistic) {
+        // past the cautious point: readers of this item must recheck
+        tickLockClock();
+      }
     }
   } else {
     galois::runtime::signalConflict(lockable);
   }
 }
 
+void galois::runtime::SimpleRuntimeContext::optimisticAcquire(
+    galois::runtime::Lockable* lockable, galois::MethodFlag m) {
+  bool write =
+      (m & galois::MethodFlag::INTERNAL_MASK) == galois::MethodFlag::WRITE;
+  // The caller got lockable out of data read earlier; make sure none of it
+  // has changed before anything is dereferenced. The fence orders those
+  // reads before the clock load.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  unsigned clock = lockClock.get().load(std::memory_order_relaxed);
+  if (clock != readClock) {
+    readClock = clock;
+    validateReads();
+  }
+
+  // Graphs acquire the same item several times in a row (e.g., MorphGraph
+  // for a node, its edges and its data); the first entry already holds the
+  // version to validate
+  if (!readSet.empty() && readSet.back().first == lockable) {
+    if (write && (writeSet.empty() || writeSet.back() != lockable)) {
+      writeSet.push_back(lockable);
+    }
+    return;
+  }
+
+  // Version first: a writer bumps it before unlocking
+  unsigned version = getVersion(lockable).load(std::memory_order_acquire);
+  if (lockable->owner.is_locked() && getOwner(lockable) != this) {
+    // being written by another iteration
+    galois::runtime::signalConflict(lockable);
+  }
+  readSet.emplace_back(lockable, version);
+  if (write) {
+    writeSet.push_back(lockable);
+  }
+}
+
+void galois::runtime::SimpleRuntimeContext::validateReads() {
+  for (auto& entry : readSet) {
+    Lockable* lockable = entry.first;
+    // Lock before version: a writer that has unlocked has bumped the version.
+    // The acquire load of the lock word pairs with the release store that
+    // unlocks it, which follows the release bump in releaseLocks().
+    bool lockedByOther =
+        lockable->owner.is_locked() && getOwner(lockable) != this;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (lockedByOther ||
+        getVersion(lockable).load(std::memory_order_acquire) != entry.second) {
+      ++numValidationFailures;
+      galois::runtime::signalConflict(lockable);
+    }
+  }
+}
+
+void galois::runtime::SimpleRuntimeContext::checkReads() {
+  if (optimistic && !validated)
+    validateReads();
+}
+
+void galois::runtime::SimpleRuntimeContext::validate() {
+  bool locked = false;
+  for (Lockable* lockable : writeSet) {
+    AcquireStatus i = tryAcquire(lockable);
+    if (i == AcquireStatus::FAIL) {
+      ++numValidationFailures;
+      galois::runtime::signalConflict(lockable);
+    }
+    if (i == AcquireStatus::NEW_OWNER) {
+      addToNhood(lockable);
+      locked = true;
+    }
+  }
+  // The writes start once validation passes; walkers must see the tick
+  // before they can see any of them
+  if (locked)
+    tickLockClock();
+
+  validateReads();
+
+  validated = true;
+}
+
+void galois::runtime::SimpleRuntimeContext::clearOptimistic() {
+  readSet.clear();
+  writeSet.clear();
+  validated = false;
+}
+
 void galois::runtime::SimpleRuntimeContext::release(
     galois::runtime::Lockable* lockable) {
   assert(lockable);
@@ -120,7 +248,8 @@ void galois::runtime::SimpleRuntimeContext::release(
   lockable->owner.unlock_and_clear();
 }
 
-unsigned galois::runtime::SimpleRuntimeContext::commitIteration() {
+unsigned
+galois::runtime::SimpleRuntimeContext::releaseLocks(bool bumpVersions) {
   unsigned numLocks = 0;
   while (locks) {
     // ORDER MATTERS!
@@ -128,15 +257,32 @@ unsigned galois::runtime::SimpleRuntimeContext::commitIteration() {
     locks              = lockable->next;
     lockable->next     = 0;
     substrate::compilerBarrier();
+    if (bumpVersions) {
+      getVersion(lockable).fetch_add(1, std::memory_order_release);
+    }
     release(lockable);
     ++numLocks;
   }
 
+  if (bumpVersions && numLocks) {
+    tickLockClock();
+  }
+
+  if (optimistic) {
+    clearOptimistic();
+  }
+
   return numLocks;
 }
 
+unsigned galois::runtime::SimpleRuntimeContext::commitIteration() {
+  return releaseLocks(optimistic);
+}
+
 unsigned galois::runtime::SimpleRuntimeContext::cancelIteration() {
-  return commitIteration();
+  // An aborted iteration has not changed what it locked, so optimistic
+  // readers of those items stay valid
+  return releaseLocks(false);
 }
 
 void galois::runtime::SimpleRuntimeContext::subAcquire(
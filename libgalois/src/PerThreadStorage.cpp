@@ -21,6 +21,8 @@
 
 //#include "galois/runtime/Mem.h"
 #include "galois/gIO.h"
+#include <algorithm>
+#include <cstdlib>
 #include <mutex>
 
 thread_local char* galois::substrate::ptsBase;
@@ -41,7 +43,8 @@ galois::substrate::PerBackend& galois::substrate::getPPSBackend() {
 #ifdef MORE_MEM_HACK
 const size_t allocSize =
     16 * (2 << 20); // galois::runtime::MM::hugePageSize * 16;
-inline void* alloc() { return malloc(allocSize); }
+// page aligned so that offsets aligned by allocOffset stay aligned
+inline void* alloc() { return aligned_alloc(4096, allocSize); }
 
 #else
 const size_t allocSize = galois::runtime::MM::hugePageSize;
@@ -65,10 +68,23 @@ unsigned galois::substrate::PerBackend::allocOffset(const unsigned sz) {
   unsigned ll     = nextLog2(sz);
   unsigned size   = (1 << ll);
 
-  if ((nextLoc + size) <= allocSize) {
+  // Types are constructed in place, and the compiler may use aligned vector
+  // stores up to a cache line wide to initialize them
+  unsigned align = std::min(size, 64U);
+
+  unsigned cur   = nextLoc;
+  unsigned start = (cur + align - 1) & ~(align - 1);
+  while (start + size <= allocSize) {
     // simple path, where we allocate bump ptr style
-    retval = __sync_fetch_and_add(&nextLoc, size);
-  } else if (!invalid) {
+    if (__sync_bool_compare_and_swap(&nextLoc, cur, start + size)) {
+      retval = start;
+      break;
+    }
+    cur   = nextLoc;
+    start = (cur + align - 1) & ~(align - 1);
+  }
+
+  if (retval == allocSize && !invalid) {
     // find a free offset
     std::lock_guard<Lock> llock(freeOffsetsLock);
 
@@ -90,12 +106,12 @@ unsigned galois::substrate::PerBackend::allocOffset(const unsigned sz) {
         retval = freeOffsets[index].back();
         freeOffsets[index].pop_back();
 
-        // remaining chunk
-        unsigned end   = retval + (1 << index);
-        unsigned start = retval + size;
-        for (unsigned i = index - 1; start < end; --i) {
-          freeOffsets[i].push_back(start);
-          start += (1 << i);
+        // remaining chunk; pieces grow in size so that each one is aligned
+        // to its size
+        unsigned piece = retval + size;
+        for (unsigned i = ll; i < index; ++i) {
+          freeOffsets[i].push_back(piece);
+          piece += (1 << i);
         }
       }
     }
@@ -0,0 +1,204 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/runtime/PerfEvents.h"
+#include "galois/runtime/Statistics.h"
+#include "galois/substrate/EnvCheck.h"
+#include "galois/gIO.h"
+#include "galois/util.h"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct PerfEventDesc {
+  const char* name;
+  const char* statName;
+  uint32_t type;
+  uint64_t config;
+};
+
+constexpr uint64_t cacheMissConfig(uint64_t cache) {
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+const PerfEventDesc perfEventTable[] = {
+    {"cycles", "PerfCycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", "PerfInstructions", PERF_TYPE_HARDWARE,
+     PERF_COUNT_HW_INSTRUCTIONS},
+    {"llc-misses", "PerfLLCMisses", PERF_TYPE_HW_CACHE,
+     cacheMissConfig(PERF_COUNT_HW_CACHE_LL)},
+    {"dtlb-misses", "PerfDTLBMisses", PERF_TYPE_HW_CACHE,
+     cacheMissConfig(PERF_COUNT_HW_CACHE_DTLB)},
+    {"branch-misses", "PerfBranchMisses", PERF_TYPE_HARDWARE,
+     PERF_COUNT_HW_BRANCH_MISSES},
+    // software event; available even where the PMU is not exposed (VMs)
+    {"page-faults", "PerfPageFaults", PERF_TYPE_SOFTWARE,
+     PERF_COUNT_SW_PAGE_FAULTS},
+};
+
+constexpr size_t numPerfEvents =
+    sizeof(perfEventTable) / sizeof(perfEventTable[0]);
+
+//! value, time enabled, time running (PERF_FORMAT_TOTAL_TIME_*)
+struct PerfReading {
+  uint64_t value   = 0;
+  uint64_t enabled = 0;
+  uint64_t running = 0;
+};
+
+//! Events selected by GALOIS_PERF_EVENTS; parsed once
+const std::vector<const PerfEventDesc*>& selectedEvents() {
+  static std::vector<const PerfEventDesc*> events = [] {
+    std::vector<const PerfEventDesc*> ret;
+    std::string eventNamesCSV;
+
+    if (!galois::substrate::EnvCheck("GALOIS_PERF_EVENTS", eventNamesCSV) ||
+        eventNamesCSV.empty()) {
+      return ret;
+    }
+
+    if (eventNamesCSV == "all" || eventNamesCSV == "1") {
+      for (size_t i = 0; i < numPerfEvents; ++i) {
+        ret.push_back(&perfEventTable[i]);
+      }
+      return ret;
+    }
+
+    std::vector<std::string> eventNames;
+    galois::splitCSVstr(eventNamesCSV, eventNames);
+    for (const auto& name : eventNames) {
+      const PerfEventDesc* found = nullptr;
+      for (size_t i = 0; i < numPerfEvents; ++i) {
+        if (name == perfEventTable[i].name) {
+          found = &perfEventTable[i];
+        }
+      }
+      if (!found) {
+        GALOIS_DIE("Failed to recognize perf event name = ", name);
+      }
+      ret.push_back(found);
+    }
+    return ret;
+  }();
+  return events;
+}
+
+/**
+ * Counters of one thread. Each event is opened as its own (ungrouped) counter
+ * for the calling thread only, so the kernel can multiplex them
+ * independently when there are fewer hardware counters than events.
+ */
+struct PerfThreadState {
+  bool opened = false;
+  std::vector<int> fds;
+  std::vector<PerfReading> begin;
+
+  void open() {
+    const auto& events = selectedEvents();
+    opened             = true;
+    fds.assign(events.size(), -1);
+    begin.resize(events.size());
+
+    for (size_t i = 0; i < events.size(); ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size           = sizeof(attr);
+      attr.type           = events[i]->type;
+      attr.config         = events[i]->config;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      attr.read_format =
+          PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+      if (fds[i] < 0 && galois::substrate::ThreadPool::getTID() == 0) {
+        galois::gWarn("perf_event_open failed for ", events[i]->name, ": ",
+                      std::strerror(errno));
+      }
+    }
+  }
+
+  ~PerfThreadState() {
+    for (int fd : fds) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  }
+
+  bool read(size_t i, PerfReading& r) const {
+    return fds[i] >= 0 && ::read(fds[i], &r, sizeof(r)) == sizeof(r);
+  }
+};
+
+thread_local PerfThreadState perfThreadState;
+
+} // namespace
+
+bool galois::runtime::internal::perfEventsEnabled() {
+  return !selectedEvents().empty();
+}
+
+void galois::runtime::internal::perfEventsStart(unsigned numT) {
+  substrate::getThreadPool().run(numT, [] {
+    auto& state = perfThreadState;
+    if (!state.opened) {
+      state.open();
+    }
+    for (size_t i = 0; i < state.fds.size(); ++i) {
+      state.read(i, state.begin[i]);
+    }
+  });
+}
+
+void galois::runtime::internal::perfEventsStop(const char* loopname,
+                                               unsigned numT) {
+  substrate::getThreadPool().run(numT, [loopname] {
+    auto& state        = perfThreadState;
+    const auto& events = selectedEvents();
+
+    for (size_t i = 0; i < state.fds.size(); ++i) {
+      PerfReading end;
+      if (!state.read(i, end)) {
+        continue;
+      }
+      const PerfReading& begin = state.begin[i];
+      uint64_t value   = end.value - begin.value;
+      uint64_t enabled = end.enabled - begin.enabled;
+      uint64_t running = end.running - begin.running;
+
+      // extrapolate if the event was multiplexed for part of the loop
+      if (running && running < enabled) {
+        value = static_cast<uint64_t>(static_cast<double>(value) * enabled /
+                                      running);
+      }
+      reportStat_Tsum(loopname, events[i]->statName, value);
+    }
+  });
+}
@@ -19,6 +19,7 @@
 
 #include "galois/runtime/Statistics.h"
 #include "galois/runtime/Executor_OnEach.h"
+#include "galois/runtime/Timeline.h"
 
 #include <iostream>
 #include <fstream>
@@ -60,6 +61,20 @@ void StatManager::print(void) {
       printStats(std::cerr);
     }
   }
+  writeTimeline();
+}
+
+void StatManager::writeTimeline(void) {
+  const std::string& file = timelineFile();
+  if (file.empty()) {
+    return;
+  }
+  std::ofstream outf(file.c_str());
+  if (outf.good()) {
+    timelineWriteTrace(outf, {});
+  } else {
+    gWarn("Could not open timeline file for writing, file provided:", file);
+  }
 }
 
 void StatManager::printStats(std::ostream& out) {
@@ -23,8 +23,13 @@
 #include "galois/gIO.h"
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 // Forward declare this to avoid including PerThreadStorage.
 // We avoid this to stress that the thread Pool MUST NOT depend on PTS.
 namespace galois {
@@ -40,7 +45,11 @@ thread_local ThreadPool::per_signal ThreadPool::my_box;
 
 ThreadPool::ThreadPool()
     : mi(getHWTopo().first), reserved(0), masterFastmode(false),
-      running(false) {
+      spinBudget(100), running(false) {
+  int usec;
+  if (EnvCheck("GALOIS_SPIN_BUDGET_USEC", usec))
+    spinBudget = std::max(usec, 0);
+
   signals.resize(mi.maxThreads);
   initThread(0);
 
@@ -84,6 +93,42 @@ void ThreadPool::beKind() {
   }
 }
 
+void ThreadPool::setSpinBudget(unsigned usec) {
+  beKind();
+  run(mi.maxThreads, [usec]() { throw spinbudget_ty{usec}; });
+  spinBudget = usec;
+}
+
+bool ThreadPool::per_signal::spinFor(unsigned spinUsec) {
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::microseconds(spinUsec);
+  do {
+    // amortize reading the clock over a few polls
+    for (int i = 0; i < 64; ++i) {
+      if (fastRelease.load(std::memory_order_acquire))
+        return true;
+      asmPause();
+    }
+  } while (std::chrono::steady_clock::now() < deadline);
+  return false;
+}
+
+void ThreadPool::per_signal::park() {
+  // Pairs with wakeup: either the waker sees parked and issues a wake, or
+  // we see fastRelease before sleeping (or the futex sees it changed)
+  parked.store(1, std::memory_order_seq_cst);
+  while (!fastRelease.load(std::memory_order_seq_cst)) {
+    syscall(SYS_futex, reinterpret_cast<int*>(&fastRelease),
+            FUTEX_WAIT_PRIVATE, 0, nullptr, nullptr, 0);
+  }
+  parked.store(0, std::memory_order_relaxed);
+}
+
+void ThreadPool::per_signal::unpark() {
+  syscall(SYS_futex, reinterpret_cast<int*>(&fastRelease), FUTEX_WAKE_PRIVATE,
+          1, nullptr, nullptr, 0);
+}
+
 // inefficient append
 template <typename T>
 static void atomic_append(std::atomic<T*>& headptr, T* newnode) {
@@ -113,8 +158,10 @@ static T* getNth(std::atomic<T*>& headptr, unsigned off) {
 }
 
 void ThreadPool::initThread(unsigned tid) {
-  signals[tid] = &my_box;
-  my_box.topo  = getHWTopo().second[tid];
+  signals[tid]       = &my_box;
+  my_box.topo        = getHWTopo().second[tid];
+  my_box.fastRelease = 0;
+  my_box.parked      = 0;
   // Initialize
   substrate::initPTS(mi.maxThreads);
 
@@ -125,18 +172,22 @@ void ThreadPool::initThread(unsigned tid) {
 }
 
 void ThreadPool::threadLoop(unsigned tid) {
+  // spinBudget is set before any worker is created
+  unsigned spinUsec = spinBudget;
   initThread(tid);
   bool fastmode = false;
   auto& me      = my_box;
   do {
-    me.wait(fastmode);
-    cascade(fastmode);
+    me.wait(fastmode, spinUsec);
+    cascade(fastmode || spinUsec);
     try {
       work();
     } catch (const shutdown_ty&) {
       return;
     } catch (const fastmode_ty& fm) {
       fastmode = fm.mode;
+    } catch (const spinbudget_ty& sb) {
+      spinUsec = sb.usec;
     } catch (const dedicated_ty dt) {
       me.done = 1;
       dt.fn();
@@ -171,7 +222,7 @@ void ThreadPool::decascade() {
   me.done = 1;
 }
 
-void ThreadPool::cascade(bool fastmode) {
+void ThreadPool::cascade(bool release) {
   auto& me = my_box;
   assert(me.wbegin <= me.wend);
 
@@ -191,13 +242,13 @@ void ThreadPool::cascade(bool fastmode) {
   auto child1    = signals[me.wbegin];
   child1->wbegin = me.wbegin + 1;
   child1->wend   = midpoint;
-  child1->wakeup(fastmode);
+  child1->wakeup(release);
 
   if (midpoint < me.wend) {
     auto child2    = signals[midpoint];
     child2->wbegin = midpoint + 1;
     child2->wend   = me.wend;
-    child2->wakeup(fastmode);
+    child2->wakeup(release);
   }
 }
 
@@ -212,15 +263,17 @@ void ThreadPool::runInternal(unsigned num) {
   me.wbegin = 1;
   me.wend   = num;
 
-  assert(!masterFastmode || masterFastmode == num);
+  // blocking threads outside of a fastmode set would miss a release wakeup
+  assert(!masterFastmode || masterFastmode == num || spinBudget);
   // launch threads
-  cascade(masterFastmode);
+  cascade(masterFastmode || spinBudget);
   // Do master thread work
   try {
     work();
   } catch (const shutdown_ty&) {
     return;
   } catch (const fastmode_ty& fm) {
+  } catch (const spinbudget_ty& sb) {
   }
   // wait for children
   decascade();
@@ -239,7 +292,7 @@ void ThreadPool::runDedicated(std::function<void(void)>& f) {
   child->wbegin = 0;
   child->wend   = 0;
   child->done   = 0;
-  child->wakeup(masterFastmode);
+  child->wakeup(masterFastmode || spinBudget);
   while (!child->done) {
     asmPause();
   }
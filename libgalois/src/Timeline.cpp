@@ -0,0 +1,219 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#include "galois/runtime/Timeline.h"
+#include "galois/substrate/EnvCheck.h"
+#include "galois/substrate/SimpleLock.h"
+#include "galois/substrate/ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+
+namespace {
+
+struct TimelineEvent {
+  uint64_t begin;
+  uint64_t end;
+  const char* name;
+  const char* cat;
+  int64_t arg;
+};
+
+//! Ring buffer written only by its owning thread; read at exit once the
+//! threads are idle
+struct ThreadBuffer {
+  std::vector<TimelineEvent> events;
+  uint64_t recorded = 0;
+
+  explicit ThreadBuffer(size_t capacity) : events(capacity) {}
+};
+
+uint64_t clockNow() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+const uint64_t startTime = clockNow();
+
+struct TimelineState {
+  std::string file;
+  size_t capacity = 1 << 16;
+  std::unique_ptr<std::atomic<ThreadBuffer*>[]> buffers;
+  unsigned numBuffers = 0;
+
+  galois::substrate::SimpleLock internLock;
+  std::unordered_set<std::string> names;
+
+  TimelineState() {
+    if (!galois::substrate::EnvCheck("GALOIS_TIMELINE", file) ||
+        file.empty()) {
+      file.clear();
+      return;
+    }
+    int events = 0;
+    if (galois::substrate::EnvCheck("GALOIS_TIMELINE_EVENTS", events) &&
+        events > 0) {
+      capacity = events;
+    }
+    numBuffers = galois::substrate::getThreadPool().getMaxThreads();
+    buffers.reset(new std::atomic<ThreadBuffer*>[numBuffers]);
+    for (unsigned i = 0; i < numBuffers; ++i) {
+      buffers[i] = nullptr;
+    }
+  }
+
+  // buffers are leaked on purpose: the trace is written from StatManager,
+  // which may outlive static objects of this file
+};
+
+TimelineState& state() {
+  static TimelineState* s = new TimelineState();
+  return *s;
+}
+
+void writeEscaped(std::ostream& out, const char* s) {
+  out << '"';
+  for (; *s; ++s) {
+    if (*s == '"' || *s == '\\') {
+      out << '\\' << *s;
+    } else if (static_cast<unsigned char>(*s) < 0x20) {
+      out << ' ';
+    } else {
+      out << *s;
+    }
+  }
+  out << '"';
+}
+
+} // namespace
+
+bool galois::runtime::internal::timelineEnabled() {
+  return !state().file.empty();
+}
+
+const char* galois::runtime::internal::timelineIntern(const char* name) {
+  auto& s = state();
+  if (s.file.empty()) {
+    return nullptr;
+  }
+  std::lock_guard<substrate::SimpleLock> lg(s.internLock);
+  return s.names.emplace(name ? name : "(NULL)").first->c_str();
+}
+
+uint64_t galois::runtime::internal::timelineNow() { return clockNow(); }
+
+void galois::runtime::internal::timelineRecord(const char* name,
+                                               const char* cat, uint64_t begin,
+                                               uint64_t end, int64_t arg) {
+  auto& s      = state();
+  unsigned tid = substrate::ThreadPool::getTID();
+  if (tid >= s.numBuffers) {
+    return;
+  }
+  ThreadBuffer* buf = s.buffers[tid].load(std::memory_order_relaxed);
+  if (!buf) {
+    buf = new ThreadBuffer(s.capacity);
+    s.buffers[tid].store(buf, std::memory_order_release);
+  }
+  buf->events[buf->recorded % s.capacity] =
+      TimelineEvent{begin, end, name, cat, arg};
+  ++buf->recorded;
+}
+
+const std::string& galois::runtime::timelineFile() { return state().file; }
+
+uint64_t galois::runtime::timelineEpoch() { return startTime; }
+
+void galois::runtime::timelineWriteEvents(std::ostream& out, unsigned pid,
+                                          int64_t shift) {
+  auto& s    = state();
+  bool first = true;
+
+  std::ios::fmtflags flags = out.flags();
+  std::streamsize precision = out.precision();
+  out.setf(std::ios::fixed, std::ios::floatfield);
+  out.precision(3);
+
+  auto sep = [&] {
+    if (!first) {
+      out << ",\n";
+    }
+    first = false;
+  };
+
+  sep();
+  out << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << pid
+      << ",\"tid\":0,\"args\":{\"name\":\"host " << pid << "\"}}";
+
+  for (unsigned tid = 0; tid < s.numBuffers; ++tid) {
+    ThreadBuffer* buf = s.buffers[tid].load(std::memory_order_acquire);
+    if (!buf) {
+      continue;
+    }
+    uint64_t dropped =
+        buf->recorded > s.capacity ? buf->recorded - s.capacity : 0;
+
+    sep();
+    out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid
+        << ",\"tid\":" << tid << ",\"args\":{\"name\":\"thread " << tid;
+    if (dropped) {
+      out << " (" << dropped << " dropped)";
+    }
+    out << "\"}}";
+
+    for (uint64_t i = dropped; i < buf->recorded; ++i) {
+      const TimelineEvent& e = buf->events[i % s.capacity];
+      // microseconds with nanosecond resolution, as Chrome expects
+      double ts  = (static_cast<int64_t>(e.begin) - shift) / 1e3;
+      double dur = (e.end - e.begin) / 1e3;
+
+      sep();
+      out << "{\"ph\":\"X\",\"name\":";
+      writeEscaped(out, e.name);
+      out << ",\"cat\":";
+      writeEscaped(out, e.cat);
+      out << ",\"pid\":" << pid << ",\"tid\":" << tid << ",\"ts\":" << ts
+          << ",\"dur\":" << dur;
+      if (e.arg >= 0) {
+        out << ",\"args\":{\"n\":" << e.arg << "}";
+      }
+      out << "}";
+    }
+  }
+
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void galois::runtime::timelineWriteTrace(
+    std::ostream& out, const std::vector<std::string>& remoteEvents) {
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  timelineWriteEvents(out, 0, timelineEpoch());
+  for (const auto& events : remoteEvents) {
+    if (!events.empty()) {
+      out << ",\n" << events;
+    }
+  }
+  out << "\n]}\n";
+}
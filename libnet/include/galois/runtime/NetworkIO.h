@@ -28,6 +28,8 @@
 #ifndef GALOIS_RUNTIME_NETWORKTHREAD_H
 #define GALOIS_RUNTIME_NETWORKTHREAD_H
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <vector>
 #include <tuple>
@@ -41,10 +43,57 @@
 #include <mpi.h>
 #include "galois/runtime/MemUsage.h"
 #include "galois/PODResizeableArray.h"
+#include "galois/substrate/SimpleLock.h"
 
 namespace galois {
 namespace runtime {
 
+/**
+ * Pool of message buffers recycled between the buffered network interface and
+ * the network IO layer so that send staging buffers and receive buffers are
+ * not reallocated on every communication round. Buffers are kept in
+ * power-of-two capacity classes (the growth policy of PODResizeableArray);
+ * the pool holds a bounded number of bytes and frees anything beyond that.
+ */
+class NetworkBufferPool {
+  using vTy = galois::PODResizeableArray<uint8_t>;
+
+  //! buffers smaller than this are cheaper to malloc than to pool
+  static const size_t MIN_POOLED = 1 << 10;
+  //! upper bound on the bytes held by the pool
+  static const size_t MAX_POOLED_BYTES = size_t(1) << 28;
+  //! upper bound on the buffers held per capacity class
+  static const size_t MAX_PER_CLASS = 64;
+
+  std::array<std::vector<vTy>, 64> classes;
+  size_t pooledBytes;
+  substrate::SimpleLock lock;
+
+  static unsigned classOf(size_t capacity) {
+    return 63 - __builtin_clzll(capacity);
+  }
+
+public:
+  //! number of requests served from / not served from the pool
+  std::atomic<size_t> hits, misses;
+
+  NetworkBufferPool() : pooledBytes(0), hits(0), misses(0) {}
+
+  /**
+   * Returns a buffer of size n, reusing a pooled allocation if one of the
+   * right capacity class is available.
+   */
+  vTy get(size_t n);
+
+  /**
+   * Returns a buffer to the pool. Its contents are discarded.
+   */
+  void put(vTy&& v);
+};
+
+//! The pool shared by the network layers of this host
+NetworkBufferPool& getNetworkBufferPool();
+
 /**
  * Class for the network IO layer which is responsible for doing sends/receives
  * of data. Used by the network interface to do the actual communication.
@@ -81,6 +130,10 @@ public:
     uint32_t host; //!< destination of this message
     uint32_t tag;  //!< tag on message indicating distinct communication phases
     vTy data; //!< data portion of message
+    //! Buffers to be sent in place without copying them into data. Each is
+    //! spliced into the outgoing byte stream just before the given offset of
+    //! data; offsets are non-decreasing.
+    std::vector<std::pair<size_t, vTy>> segments;
 
     //! Default constructor initializes host and tag to large numbers.
     message() : host(~0), tag(~0) {}
@@ -93,6 +146,14 @@ public:
     //! A message is valid if there is data to be sent
     //! @returns true if data is non-empty
     bool valid() const { return !data.empty(); }
+
+    //! @returns number of bytes on the wire including segments
+    size_t size() const {
+      size_t s = data.size();
+      for (auto& seg : segments)
+        s += seg.second.size();
+      return s;
+    }
   };
 
   //! The default constructor takes a memory usage tracker and saves it
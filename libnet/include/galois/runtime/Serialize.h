@@ -34,6 +34,8 @@
 #include <string>
 #include <cassert>
 #include <tuple>
+#include <memory>
+#include <stdexcept>
 
 #include <boost/mpl/has_xxx.hpp>
 #include "galois/runtime/ExtraTraits.h"
@@ -155,21 +157,42 @@ class DeSerializeBuffer {
   //! the actual data stored in this buffer
   vTy bufdata;
   int offset;
+  //! When set, this buffer is a view of [viewBegin, viewBegin + viewLen) of a
+  //! receive buffer shared with other deserialize buffers, and bufdata is
+  //! unused; this lets the network layer hand out aggregated messages
+  //! without copying them.
+  std::shared_ptr<vTy> view;
+  size_t viewBegin;
+  size_t viewLen;
+
+  uint8_t* base() { return view ? view->data() + viewBegin : bufdata.data(); }
+  const uint8_t* base() const {
+    return view ? view->data() + viewBegin : bufdata.data();
+  }
 
 public:
   //! Constructor initializes offset into buffer to 0
-  DeSerializeBuffer() : offset(0) {}
+  DeSerializeBuffer() : offset(0), viewBegin(0), viewLen(0) {}
   //! Disable copy constructor
   DeSerializeBuffer(DeSerializeBuffer&&) = default;
   //! Move constructor
   //! @param v vector to act as deserialize buffer
   //! @param start offset to start saving data into
   DeSerializeBuffer(vTy&& v, uint32_t start = 0)
-      : bufdata(std::move(v)), offset(start) {}
+      : bufdata(std::move(v)), offset(start), viewBegin(0), viewLen(0) {}
+
+  //! Constructor that makes this buffer a view of part of a shared buffer
+  //! @param v shared buffer
+  //! @param begin offset of the view into v
+  //! @param len length of the view
+  DeSerializeBuffer(std::shared_ptr<vTy> v, size_t begin, size_t len)
+      : offset(0), view(std::move(v)), viewBegin(begin), viewLen(len) {
+    assert(begin + len <= view->size());
+  }
 
   //! Constructor that takes an existing vector to use as the deserialize
   //! buffer
-  explicit DeSerializeBuffer(vTy& data) {
+  explicit DeSerializeBuffer(vTy& data) : viewBegin(0), viewLen(0) {
     bufdata.swap(data);
     offset = 0;
   }
@@ -178,19 +201,22 @@ public:
    * Initializes the deserialize buffer with a certain size
    * @param [in] count size to initialize buffer to
    */
-  explicit DeSerializeBuffer(int count) : bufdata(count), offset(0) {}
+  explicit DeSerializeBuffer(int count)
+      : bufdata(count), offset(0), viewBegin(0), viewLen(0) {}
 
   /**
    * Initializes the deserialize buffer using vector initialization from
    * 2 iterators.
    */
   template <typename Iter>
-  DeSerializeBuffer(Iter b, Iter e) : bufdata(b, e), offset{0} {}
+  DeSerializeBuffer(Iter b, Iter e)
+      : bufdata(b, e), offset{0}, viewBegin(0), viewLen(0) {}
 
   /**
    * Initialize a deserialize buffer from a serialize buffer
    */
-  explicit DeSerializeBuffer(SerializeBuffer&& buf) : offset(0) {
+  explicit DeSerializeBuffer(SerializeBuffer&& buf)
+      : offset(0), viewBegin(0), viewLen(0) {
     bufdata.swap(buf.bufdata);
   }
 
@@ -205,6 +231,7 @@ public:
    */
   void reset(int count) {
     offset = 0;
+    view.reset();
     bufdata.resize(count);
   }
 
@@ -217,18 +244,27 @@ public:
   }
 
   //! Gets the size of the deserialize buffer
-  unsigned size() const { return bufdata.size(); }
+  unsigned size() const { return view ? viewLen : bufdata.size(); }
 
   //! Returns true if the deserialize buffer is empty
   //! @returns true if the deserialize buffer is empty
-  bool empty() const { return bufdata.empty(); }
+  bool empty() const { return size() == 0; }
 
   //! Get the next character in the deserialize buffer
-  unsigned char pop() { return bufdata.at(offset++); }
+  unsigned char pop() {
+    if ((unsigned)offset >= size())
+      throw std::out_of_range("DeSerializeBuffer::pop");
+    return base()[offset++];
+  }
 
   //! Clears the last x bytes of the deserialize buffer, resizing it as well
   //! @param x How many bytes from the end to clear
-  void pop_back(unsigned x) { bufdata.resize(bufdata.size() - x); }
+  void pop_back(unsigned x) {
+    if (view)
+      viewLen -= x;
+    else
+      bufdata.resize(bufdata.size() - x);
+  }
 
   /**
    * Extracts a certain amount of data from the deserialize buffer
@@ -237,23 +273,34 @@ public:
    * @param num Amount of data to get from deserialize buffer
    */
   void extract(uint8_t* dst, size_t num) {
-    memcpy(dst, &bufdata[offset], num);
+    memcpy(dst, base() + offset, num);
     offset += num;
   }
 
   //! Get the underlying vector storing the data of the deserialize
-  //! buffer
-  vTy& getVec() { return bufdata; }
+  //! buffer. A view of a shared buffer is copied out first; prefer
+  //! r_linearData on hot paths.
+  vTy& getVec() {
+    if (view) {
+      const uint8_t* b = base();
+      vTy copy(b, b + viewLen);
+      bufdata = std::move(copy);
+      view.reset();
+    }
+    return bufdata;
+  }
 
   //! Get a pointer to the underlying data of the deserialize buffer
-  void* linearData() { return &bufdata[0]; }
+  void* linearData() { return base(); }
 
   //! Get a pointer to the remaining data of the deserialize buffer
   //! (as determined by offset)
-  const uint8_t* r_linearData() const { return &bufdata[offset]; }
+  const uint8_t* r_linearData() const { return base() + offset; }
+  //! Get a mutable pointer to the remaining data of the deserialize buffer
+  uint8_t* r_linearData() { return base() + offset; }
   //! Get the remaining size of the deserialize buffer (as determined
   //! by offset)
-  size_t r_size() const { return bufdata.size() - offset; }
+  size_t r_size() const { return size() - offset; }
 
   //! Checks if the current location in the deserialize buffer is aligned
   //! to some size a
@@ -263,7 +310,7 @@ public:
   //! @param o stream to print to
   void print(std::ostream& o) const {
     o << "<{(" << offset << ") " << std::hex;
-    for (auto ii = bufdata.begin(), ee = bufdata.end(); ii != ee; ++ii)
+    for (auto ii = base(), ee = base() + size(); ii != ee; ++ii)
       o << (unsigned int)*ii << " ";
     o << std::dec << "}>";
   }
@@ -984,6 +1031,7 @@ inline void gDeserializeObj(DeSerializeBuffer& buf,
   gDeserializeObj(buf, size);
   data.resize(size);
   gDeserializeObj(buf, data.get_vec());
+  data.rebuild_summary();
 }
 
 } // namespace internal
@@ -32,6 +32,7 @@
 #include "galois/substrate/CompilerSpecific.h"
 #include "galois/runtime/Network.h"
 #include "galois/runtime/LWCI.h"
+#include "galois/runtime/Timeline.h"
 
 #include <cstdlib>
 #include <cstdio>
@@ -50,6 +51,9 @@ public:
   //! control-flow barrier across distributed hosts
   //! acts as a distributed-memory fence as well (flushes send and receives)
   virtual void wait() {
+    galois::runtime::TimelineSpan span(
+        galois::runtime::internal::timelineEnabled() ? "HostFence" : nullptr,
+        "net");
     auto& net = galois::runtime::getSystemNetworkInterface();
 
     for (unsigned h = 0; h < net.Num; ++h) {
@@ -89,6 +93,9 @@ public:
 
   //! Control-flow barrier across distributed hosts
   virtual void wait() {
+    galois::runtime::TimelineSpan span(
+        galois::runtime::internal::timelineEnabled() ? "HostBarrier" : nullptr,
+        "net");
 #ifdef GALOIS_USE_LWCI
     lc_barrier(lc_col_ep);
 #else
@@ -42,6 +42,46 @@ uint32_t galois::runtime::getHostID() { return NetworkInterface::ID; }
 
 galois::runtime::NetworkIO::~NetworkIO() {}
 
+NetworkBufferPool::vTy NetworkBufferPool::get(size_t n) {
+  if (n >= MIN_POOLED) {
+    // smallest power of two that holds n bytes
+    unsigned c = classOf(n) + ((n & (n - 1)) ? 1 : 0);
+    std::lock_guard<substrate::SimpleLock> lg(lock);
+    auto& bucket = classes[c];
+    if (!bucket.empty()) {
+      vTy v(std::move(bucket.back()));
+      bucket.pop_back();
+      pooledBytes -= v.max_size();
+      ++hits;
+      v.resize(n);
+      return v;
+    }
+  }
+  ++misses;
+  return vTy(n);
+}
+
+void NetworkBufferPool::put(vTy&& v) {
+  size_t cap = v.max_size();
+  if (cap < MIN_POOLED || (cap & (cap - 1))) {
+    return;
+  }
+  std::lock_guard<substrate::SimpleLock> lg(lock);
+  auto& bucket = classes[classOf(cap)];
+  // otherwise the caller's buffer is freed as usual
+  if (bucket.size() < MAX_PER_CLASS && pooledBytes + cap <= MAX_POOLED_BYTES) {
+    v.clear();
+    pooledBytes += cap;
+    bucket.push_back(std::move(v));
+  }
+}
+
+NetworkBufferPool& galois::runtime::getNetworkBufferPool() {
+  // never destroyed: receive buffers may be released during static destruction
+  static NetworkBufferPool* pool = new NetworkBufferPool;
+  return *pool;
+}
+
 void NetworkInterface::initializeMPI() {
   int supportProvided;
   int initSuccess =
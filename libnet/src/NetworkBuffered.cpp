@@ -55,6 +55,8 @@ class NetworkInterfaceBuffered : public NetworkInterface {
   static const int COMM_MIN =
       1400; //! bytes (sligtly smaller than an ethernet packet)
   static const int COMM_DELAY = 100; //! microseconds delay
+  static const size_t ZERO_COPY_MIN =
+      8192; //! bytes; larger messages are sent without being copied
 
   unsigned long statSendNum;
   unsigned long statSendBytes;
@@ -71,7 +73,23 @@ class NetworkInterfaceBuffered : public NetworkInterface {
    * Receive buffers for the buffered network interface
    */
   class recvBuffer {
-    std::deque<NetworkIO::message> data;
+    /**
+     * A received MPI message. The buffer is shared with the deserialize
+     * buffers handed out for the messages aggregated in it and goes back to
+     * the buffer pool once all of them are gone.
+     */
+    struct recvMsg {
+      uint32_t tag;
+      std::shared_ptr<vTy> data;
+
+      recvMsg(NetworkIO::message&& m)
+          : tag(m.tag), data(new vTy(std::move(m.data)), [](vTy* v) {
+              getNetworkBufferPool().put(std::move(*v));
+              delete v;
+            }) {}
+    };
+
+    std::deque<recvMsg> data;
     size_t frontOffset;
     SimpleLock qlock;
     // tag of head of queue
@@ -81,7 +99,7 @@ class NetworkInterfaceBuffered : public NetworkInterface {
       size_t tot = -frontOffset;
       for (auto& v : data) {
         if (v.tag == tag) {
-          tot += v.data.size();
+          tot += v.data->size();
           if (tot >= n)
             return true;
         } else {
@@ -96,13 +114,13 @@ class NetworkInterfaceBuffered : public NetworkInterface {
       // assert(sizeAtLeast(n));
       // fast path is first buffer
       { // limit scope
-        auto& f0data = data[0].data;
+        auto& f0data = *data[0].data;
         for (int k = frontOffset, ke = f0data.size(); k < ke && n; ++k, --n)
           *it++ = f0data[k];
       }
       if (n) { // more data (slow path)
         for (int j = 1, je = data.size(); j < je && n; ++j) {
-          auto& vdata = data[j].data;
+          auto& vdata = *data[j].data;
           for (int k = 0, ke = vdata.size(); k < ke && n; ++k, --n) {
             *it++ = vdata[k];
           }
@@ -110,31 +128,10 @@ class NetworkInterfaceBuffered : public NetworkInterface {
       }
     }
 
-    /**
-     * Return a (moved) vector if the len bytes requested are the last len
-     * bytes of the front of the buffer queue
-     */
-    optional_t<vTy> popVec(uint32_t len, std::atomic<size_t>& inflightRecvs) {
-      if (data[0].data.size() == frontOffset + len) {
-        vTy retval(std::move(data[0].data));
-        data.pop_front();
-        --inflightRecvs;
-        frontOffset = 0;
-        if (data.size()) {
-          dataPresent = data.front().tag;
-        } else {
-          dataPresent = ~0;
-        }
-        return optional_t<vTy>(std::move(retval));
-      } else {
-        return optional_t<vTy>();
-      }
-    }
-
     void erase(size_t n, std::atomic<size_t>& inflightRecvs) {
       frontOffset += n;
-      while (frontOffset && frontOffset >= data.front().data.size()) {
-        frontOffset -= data.front().data.size();
+      while (frontOffset && frontOffset >= data.front().data->size()) {
+        frontOffset -= data.front().data->size();
         data.pop_front();
         --inflightRecvs;
       }
@@ -170,16 +167,15 @@ class NetworkInterfaceBuffered : public NetworkInterface {
         return optional_t<RecvBuffer>();
       erase(4, inflightRecvs);
 
-      // Try just using the buffer
-      if (auto r = popVec(len, inflightRecvs)) {
-        auto start = r->size() - len;
-        //        std::cerr << "FP " << r->size() << " " << len << " " << start
-        //        << "\n";
-        return optional_t<RecvBuffer>(RecvBuffer(std::move(*r), start));
+      // Messages are never split across MPI messages by the sender, so the
+      // message can be deserialized in place from the front buffer
+      if (data[0].data->size() >= frontOffset + len) {
+        RecvBuffer buf(data[0].data, frontOffset, len);
+        erase(len, inflightRecvs);
+        return optional_t<RecvBuffer>(std::move(buf));
       }
 
       RecvBuffer buf(len);
-      // FIXME: This is slows things down 25%
       copyOut((char*)buf.linearData(), len);
       erase(len, inflightRecvs);
       // std::cerr << "p " << tag << " " << len << "\n";
@@ -188,7 +184,8 @@ class NetworkInterfaceBuffered : public NetworkInterface {
       if (data.empty() || data.front().tag != tag)
         return optional_t<RecvBuffer>();
 
-      vTy vec(std::move(data.front().data));
+      auto vec = std::move(data.front().data);
+      size_t len = vec->size();
 
       data.pop_front();
       --inflightRecvs;
@@ -198,7 +195,7 @@ class NetworkInterfaceBuffered : public NetworkInterface {
         dataPresent = ~0;
       }
 
-      return optional_t<RecvBuffer>(RecvBuffer(std::move(vec), 0));
+      return optional_t<RecvBuffer>(RecvBuffer(std::move(vec), 0, len));
 #endif
     }
 
@@ -219,11 +216,11 @@ class NetworkInterfaceBuffered : public NetworkInterface {
       // std::cerr << "A " << m.host << " " << m.tag << " " << m.data.size() <<
       // "\n";
 
-      data.push_back(std::move(m));
+      data.emplace_back(std::move(m));
 
-      assert(data.back().data.size() !=
-             (unsigned int)std::count(data.back().data.begin(),
-                                      data.back().data.end(), 0));
+      assert(data.back().data->size() !=
+             (unsigned int)std::count(data.back().data->begin(),
+                                      data.back().data->end(), 0));
     }
 
     bool hasData(uint32_t tag) { return dataPresent == tag; }
@@ -298,15 +295,24 @@ class NetworkInterfaceBuffered : public NetworkInterface {
 #endif
     }
 
-    std::pair<uint32_t, vTy> assemble(std::atomic<size_t>& inflightSends) {
+    /**
+     * Aggregates the queued messages with the same tag as the head of the
+     * queue into one network message: a length header per message followed
+     * by its bytes. Small messages and headers are copied into a pooled
+     * staging buffer; messages of at least ZERO_COPY_MIN bytes are handed to
+     * the network IO layer as segments and gathered without copying.
+     */
+    NetworkIO::message assemble(uint32_t host,
+                                std::atomic<size_t>& inflightSends) {
       std::unique_lock<SimpleLock> lg(lock);
       if (messages.empty())
-        return std::make_pair(~0, vTy());
+        return NetworkIO::message();
 #ifndef NO_AGG
       // compute message size
-      uint32_t len = 0;
-      int num      = 0;
-      uint32_t tag = messages.front().tag;
+      uint32_t len    = 0;
+      int num         = 0;
+      uint32_t staged = 0;
+      uint32_t tag    = messages.front().tag;
       for (auto& m : messages) {
         if (m.tag != tag) {
           break;
@@ -319,12 +325,17 @@ class NetworkInterfaceBuffered : public NetworkInterface {
           }
           len += m.data.size();
           num += sizeof(uint32_t);
+          if (m.data.size() < ZERO_COPY_MIN)
+            staged += m.data.size();
         }
       }
       lg.unlock();
       // construct message
-      vTy vec;
-      vec.reserve(len + num);
+      auto& pool = getNetworkBufferPool();
+      NetworkIO::message msg(host, tag, pool.get(staged + num));
+      vTy& vec = msg.data;
+      vec.clear();
+      size_t total = 0;
       // go out of our way to avoid locking out senders when making messages
       lg.lock();
       do {
@@ -336,21 +347,28 @@ class NetworkInterfaceBuffered : public NetworkInterface {
         } foo;
         foo.a = m.data.size();
         vec.insert(vec.end(), &foo.b[0], &foo.b[sizeof(uint32_t)]);
-        vec.insert(vec.end(), m.data.begin(), m.data.end());
+        total += sizeof(uint32_t) + m.data.size();
+        if (m.data.size() >= ZERO_COPY_MIN) {
+          msg.segments.emplace_back(vec.size(), std::move(m.data));
+        } else {
+          vec.insert(vec.end(), m.data.begin(), m.data.end());
+          pool.put(std::move(m.data));
+        }
         if (urgent)
           --urgent;
         lg.lock();
         messages.pop_front();
         --inflightSends;
-      } while (vec.size() < len + num);
+      } while (total < len + num);
       ++inflightSends;
       numBytes -= len;
+      return msg;
 #else
       uint32_t tag = messages.front().tag;
       vTy vec(std::move(messages.front().data));
       messages.pop_front();
+      return NetworkIO::message(host, tag, std::move(vec));
 #endif
-      return std::make_pair(tag, std::move(vec));
     }
 
     void add(uint32_t tag, vTy& b) {
@@ -400,9 +418,7 @@ class NetworkInterfaceBuffered : public NetworkInterface {
         // handle send queue i
         auto& sd = sendData[i];
         if (sd.ready()) {
-          NetworkIO::message msg;
-          msg.host                    = i;
-          std::tie(msg.tag, msg.data) = sd.assemble(inflightSends);
+          NetworkIO::message msg = sd.assemble(i, inflightSends);
           galois::runtime::trace("BufferedSending", msg.host, msg.tag,
                                  galois::runtime::printVec(msg.data));
           ++statSendEnqueued;
@@ -69,13 +69,25 @@ private:
     uint32_t host;
     uint32_t tag;
     vTy data;
+    std::vector<std::pair<size_t, vTy>> segments;
     MPI_Request req;
     // mpiMessage(message&& _m, MPI_Request _req) : m(std::move(_m)), req(_req)
     // {}
     mpiMessage(uint32_t host, uint32_t tag, vTy&& data)
         : host(host), tag(tag), data(std::move(data)) {}
     mpiMessage(uint32_t host, uint32_t tag, size_t len)
-        : host(host), tag(tag), data(len) {}
+        : host(host), tag(tag),
+          data(galois::runtime::getNetworkBufferPool().get(len)) {}
+    mpiMessage(message&& m)
+        : host(m.host), tag(m.tag), data(std::move(m.data)),
+          segments(std::move(m.segments)) {}
+
+    size_t size() const {
+      size_t s = data.size();
+      for (auto& seg : segments)
+        s += seg.second.size();
+      return s;
+    }
   };
 
   /**
@@ -100,7 +112,11 @@ private:
         int rv  = MPI_Test(&f.req, &flag, &status);
         handleError(rv);
         if (flag) {
-          memUsageTracker.decrementMemUsage(f.data.size());
+          memUsageTracker.decrementMemUsage(f.size());
+          auto& pool = galois::runtime::getNetworkBufferPool();
+          pool.put(std::move(f.data));
+          for (auto& seg : f.segments)
+            pool.put(std::move(seg.second));
           inflight.pop_front();
           --inflightSends;
         } else
@@ -108,19 +124,58 @@ private:
       }
     }
 
-    void send(message m) {
-      inflight.emplace_back(m.host, m.tag, std::move(m.data));
-      auto& f = inflight.back();
-      galois::runtime::trace("MPI SEND", f.host, f.tag, f.data.size(),
-                             galois::runtime::printVec(f.data));
+    /**
+     * Sends f as a single MPI message. Segments are gathered in place by a
+     * derived datatype describing the data/segment pieces in wire order.
+     */
+    void isend(mpiMessage& f) {
+      const void* buf  = f.data.data();
+      int count        = f.data.size();
+      MPI_Datatype dty = MPI_BYTE;
+      if (!f.segments.empty()) {
+        std::vector<int> lens;
+        std::vector<MPI_Aint> displs;
+        auto addBlock = [&](const uint8_t* p, size_t n) {
+          if (n) {
+            MPI_Aint a;
+            handleError(MPI_Get_address(p, &a));
+            displs.push_back(a);
+            lens.push_back(n);
+          }
+        };
+        size_t pos = 0;
+        for (auto& seg : f.segments) {
+          addBlock(f.data.data() + pos, seg.first - pos);
+          addBlock(seg.second.data(), seg.second.size());
+          pos = seg.first;
+        }
+        addBlock(f.data.data() + pos, f.data.size() - pos);
+        handleError(MPI_Type_create_hindexed(lens.size(), lens.data(),
+                                             displs.data(), MPI_BYTE, &dty));
+        handleError(MPI_Type_commit(&dty));
+        buf   = MPI_BOTTOM;
+        count = 1;
+      }
 #ifdef __GALOIS_HET_ASYNC__
-      int rv = MPI_Issend(f.data.data(), f.data.size(), MPI_BYTE, f.host, f.tag,
-                         MPI_COMM_WORLD, &f.req);
+      int rv = MPI_Issend(buf, count, dty, f.host, f.tag, MPI_COMM_WORLD,
+                          &f.req);
 #else
-      int rv = MPI_Isend(f.data.data(), f.data.size(), MPI_BYTE, f.host, f.tag,
-                         MPI_COMM_WORLD, &f.req);
+      int rv = MPI_Isend(buf, count, dty, f.host, f.tag, MPI_COMM_WORLD,
+                         &f.req);
 #endif
       handleError(rv);
+      if (dty != MPI_BYTE) {
+        // freed by MPI once the pending send is done with it
+        handleError(MPI_Type_free(&dty));
+      }
+    }
+
+    void send(message m) {
+      inflight.emplace_back(std::move(m));
+      auto& f = inflight.back();
+      galois::runtime::trace("MPI SEND", f.host, f.tag, f.size(),
+                             galois::runtime::printVec(f.data));
+      isend(f);
     }
   };
 
@@ -208,7 +263,7 @@ public:
    * Adds a message to the send queue
    */
   virtual void enqueue(message m) {
-    memUsageTracker.incrementMemUsage(m.data.size());
+    memUsageTracker.incrementMemUsage(m.size());
     sendQueue.send(std::move(m));
   }
 
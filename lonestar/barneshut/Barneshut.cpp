@@ -27,12 +27,15 @@
 #include <boost/math/constants/constants.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <limits>
 #include <iostream>
 #include <fstream>
 #include <random>
 #include <deque>
+#include <vector>
 
 #include <strings.h>
 
@@ -54,6 +57,24 @@ static llvm::cl::opt<int> seed("seed",
                                llvm::cl::desc("Random seed (default value 7)"),
                                llvm::cl::init(7));
 
+enum Algo { Pointer, Linear };
+
+static llvm::cl::opt<Algo> algo(
+    "algo", llvm::cl::desc("Choose an algorithm (default value Pointer):"),
+    llvm::cl::values(clEnumValN(Pointer, "Pointer",
+                                "Pointer-based octree built by concurrent "
+                                "insertion"),
+                     clEnumValN(Linear, "Linear",
+                                "Flat octree over bodies sorted by Morton "
+                                "code; forces computed per leaf"),
+                     clEnumValEnd),
+    llvm::cl::init(Pointer));
+static llvm::cl::opt<unsigned>
+    leafSize("leafSize",
+             llvm::cl::desc("Maximum number of bodies in a leaf of the "
+                            "Linear octree (default value 16)"),
+             llvm::cl::init(16));
+
 struct Node {
   Point pos;
   double mass;
@@ -162,7 +183,7 @@ struct BuildOctree {
 
     // go through the tree lock-free while we can
     if (child && !child->Leaf) {
-      insert(b, static_cast<Octree*>(child), radius);
+      insert(b, static_cast<Octree*>(child), radius * 0.5);
       return;
     }
 
@@ -338,6 +359,387 @@ struct ComputeForces {
   }
 };
 
+/**
+ * Spreads the low 21 bits of v so that there are two zero bits between
+ * consecutive bits.
+ */
+inline uint64_t spreadBits(uint64_t v) {
+  v &= 0x1fffff;
+  v = (v | v << 32) & 0x1f00000000ffffull;
+  v = (v | v << 16) & 0x1f0000ff0000ffull;
+  v = (v | v << 8) & 0x100f00f00f00f00full;
+  v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+  v = (v | v << 2) & 0x1249249249249249ull;
+  return v;
+}
+
+/**
+ * Adds the force of n point masses on the body at (px, py, pz) to acc. Works
+ * on plain arrays so that the loop is vectorized.
+ */
+inline void accumulateForces(double px, double py, double pz, const double* x,
+                             const double* y, const double* z,
+                             const double* m, size_t n, double epssq,
+                             double* acc) {
+  double ax = 0.0;
+  double ay = 0.0;
+  double az = 0.0;
+
+  for (size_t k = 0; k < n; ++k) {
+    double dx    = px - x[k];
+    double dy    = py - y[k];
+    double dz    = pz - z[k];
+    double psq   = dx * dx + dy * dy + dz * dz;
+    double idr   = 1 / sqrt((float)(psq + epssq));
+    double scale = m[k] * idr * idr * idr;
+    ax += dx * scale;
+    ay += dy * scale;
+    az += dz * scale;
+  }
+
+  acc[0] += ax;
+  acc[1] += ay;
+  acc[2] += az;
+}
+
+/**
+ * Octree stored as flat arrays in level order (the Linear algorithm).
+ *
+ * Bodies are sorted by Morton code, so the bodies of every cell are
+ * contiguous and nearby bodies are close in memory; the children of a cell
+ * are contiguous in the next level. The tree is built top-down one level at
+ * a time, and centers of mass are computed bottom-up one level at a time.
+ * Forces are computed per leaf: the bodies of a leaf share one interaction
+ * list of far cells and near bodies.
+ */
+struct LinearOctree {
+  static const unsigned maxDepth = 21; // bits per dimension of a Morton code
+
+  struct MortonKey {
+    uint64_t code;
+    uint32_t index;
+
+    bool operator<(const MortonKey& other) const {
+      return code < other.code;
+    }
+  };
+
+  //! Interaction list of one leaf: far cells and near bodies as point masses
+  struct Interactions {
+    std::vector<double> x, y, z, mass;
+    std::vector<uint32_t> stack;
+
+    void push(double px, double py, double pz, double m) {
+      x.push_back(px);
+      y.push_back(py);
+      z.push_back(pz);
+      mass.push_back(m);
+    }
+  };
+
+  std::vector<MortonKey> keys;
+
+  // bodies in Morton order
+  std::vector<uint64_t> codes;
+  std::vector<double> bx, by, bz, bmass;
+  std::vector<Body*> body;
+
+  // cells; the position is the center of mass
+  std::vector<double> cx, cy, cz, cmass;
+  std::vector<double> cdsq; // cell is far if farther than this (squared)
+  std::vector<uint32_t> bodyBegin, bodyEnd;
+  std::vector<uint32_t> firstChild;
+  std::vector<uint8_t> numChildren;
+
+  std::vector<uint32_t> levelBegin; // first cell of each level, then the end
+  std::vector<uint32_t> leaves;
+  std::vector<uint32_t> childOffset;
+
+  galois::substrate::PerThreadStorage<Interactions> interactions;
+
+  size_t size() const { return cx.size(); }
+
+  void resizeCells(size_t n) {
+    cx.resize(n);
+    cy.resize(n);
+    cz.resize(n);
+    cmass.resize(n);
+    cdsq.resize(n);
+    bodyBegin.resize(n);
+    bodyEnd.resize(n);
+    firstChild.resize(n);
+    numChildren.resize(n);
+  }
+
+  /**
+   * Calls fn(begin, end) for each nonempty child of the cell holding bodies
+   * [begin, end), given the shift that exposes the children's prefix.
+   */
+  template <typename F>
+  void forEachChild(uint32_t begin, uint32_t end, unsigned shift, F fn) const {
+    auto codeBegin = codes.begin();
+
+    while (begin < end) {
+      uint64_t prefix = codes[begin] >> shift;
+      uint32_t next   = std::partition_point(
+                          codeBegin + begin, codeBegin + end,
+                          [=](uint64_t c) { return (c >> shift) == prefix; }) -
+                      codeBegin;
+      fn(begin, next);
+      begin = next;
+    }
+  }
+
+  /**
+   * Sorts the bodies by Morton code and copies them out in that order.
+   */
+  void sortBodies(const std::vector<Body*>& bodies, const BoundingBox& box) {
+    size_t n = bodies.size();
+    keys.resize(n);
+    codes.resize(n);
+    bx.resize(n);
+    by.resize(n);
+    bz.resize(n);
+    bmass.resize(n);
+    body.resize(n);
+
+    Point extent = box.max - box.min;
+    double side  = std::max(extent[0], std::max(extent[1], extent[2]));
+    double scale = side > 0.0 ? (1 << maxDepth) / side : 0.0;
+    Point origin = box.min;
+
+    galois::StatTimer T_morton("MortonTime");
+    T_morton.start();
+    galois::do_all(
+        galois::iterate(size_t{0}, n),
+        [&](size_t i) {
+          uint64_t code = 0;
+          for (int d = 0; d < 3; ++d) {
+            uint64_t q = std::min<uint64_t>(
+                (bodies[i]->pos[d] - origin[d]) * scale, (1 << maxDepth) - 1);
+            code |= spreadBits(q) << d;
+          }
+          keys[i] = MortonKey{code, (uint32_t)i};
+        },
+        galois::loopname("mortonCodes"));
+    T_morton.stop();
+
+    galois::StatTimer T_sort("SortTime");
+    T_sort.start();
+    galois::ParallelSTL::sort(keys.begin(), keys.end());
+    galois::do_all(
+        galois::iterate(size_t{0}, n),
+        [&](size_t i) {
+          Body* b  = bodies[keys[i].index];
+          codes[i] = keys[i].code;
+          bx[i]    = b->pos[0];
+          by[i]    = b->pos[1];
+          bz[i]    = b->pos[2];
+          bmass[i] = b->mass;
+          body[i]  = b;
+        },
+        galois::loopname("permuteBodies"));
+    T_sort.stop();
+
+    // root cell; same opening criterion as ComputeForces
+    resizeCells(1);
+    bodyBegin[0]   = 0;
+    bodyEnd[0]     = n;
+    cdsq[0]        = box.diameter() * box.diameter() * config.itolsq;
+    numChildren[0] = 0;
+  }
+
+  /**
+   * Splits cells with more than leafSize bodies, one level at a time.
+   */
+  void build() {
+    levelBegin.assign(1, 0);
+    leaves.clear();
+
+    for (unsigned depth = 0; levelBegin.back() < size(); ++depth) {
+      uint32_t lb    = levelBegin.back();
+      uint32_t le    = size();
+      unsigned shift = 3 * (maxDepth - 1 - depth);
+      levelBegin.push_back(le);
+
+      if (depth == maxDepth) {
+        break;
+      }
+
+      childOffset.resize(le - lb);
+      galois::do_all(
+          galois::iterate(lb, le),
+          [&](uint32_t c) {
+            uint32_t num = 0;
+            if (bodyEnd[c] - bodyBegin[c] > leafSize) {
+              forEachChild(bodyBegin[c], bodyEnd[c], shift,
+                           [&](uint32_t, uint32_t) { ++num; });
+            }
+            childOffset[c - lb] = num;
+          },
+          galois::loopname("countChildren"));
+
+      uint32_t total = 0;
+      for (auto& offset : childOffset) {
+        uint32_t num = offset;
+        offset       = total;
+        total += num;
+      }
+      resizeCells(le + total);
+
+      galois::do_all(
+          galois::iterate(lb, le),
+          [&](uint32_t c) {
+            if (bodyEnd[c] - bodyBegin[c] <= leafSize) {
+              return;
+            }
+            uint32_t child = le + childOffset[c - lb];
+            firstChild[c]  = child;
+            forEachChild(bodyBegin[c], bodyEnd[c], shift,
+                         [&](uint32_t begin, uint32_t end) {
+                           bodyBegin[child]   = begin;
+                           bodyEnd[child]     = end;
+                           cdsq[child]        = cdsq[c] * 0.25;
+                           numChildren[child] = 0;
+                           ++child;
+                         });
+            numChildren[c] = child - firstChild[c];
+          },
+          galois::loopname("createChildren"));
+    }
+
+    for (uint32_t c = 0; c < size(); ++c) {
+      if (numChildren[c] == 0) {
+        leaves.push_back(c);
+      }
+    }
+  }
+
+  /**
+   * Computes centers of mass, deepest level first.
+   */
+  void summarize() {
+    for (size_t level = levelBegin.size() - 1; level-- > 0;) {
+      galois::do_all(
+          galois::iterate(levelBegin[level], levelBegin[level + 1]),
+          [&](uint32_t c) {
+            double mass = 0.0;
+            double x    = 0.0;
+            double y    = 0.0;
+            double z    = 0.0;
+
+            if (numChildren[c] == 0) {
+              for (uint32_t i = bodyBegin[c]; i < bodyEnd[c]; ++i) {
+                mass += bmass[i];
+                x += bx[i] * bmass[i];
+                y += by[i] * bmass[i];
+                z += bz[i] * bmass[i];
+              }
+            } else {
+              for (uint32_t k = firstChild[c];
+                   k < firstChild[c] + numChildren[c]; ++k) {
+                mass += cmass[k];
+                x += cx[k] * cmass[k];
+                y += cy[k] * cmass[k];
+                z += cz[k] * cmass[k];
+              }
+            }
+
+            cmass[c] = mass;
+            if (mass > 0.0) {
+              cx[c] = x / mass;
+              cy[c] = y / mass;
+              cz[c] = z / mass;
+            }
+          },
+          galois::loopname("summarize"));
+    }
+  }
+
+  /**
+   * Builds the interaction list of a leaf. A cell is far for the whole leaf
+   * if it is far from the bounding box of the leaf's bodies, which implies it
+   * is far for each of them. The bodies of near leaves are copied into the
+   * list so that every body of the leaf makes one pass over one array.
+   */
+  void interactionList(uint32_t leaf, Interactions& list) const {
+    double lo[3] = {bx[bodyBegin[leaf]], by[bodyBegin[leaf]],
+                    bz[bodyBegin[leaf]]};
+    double hi[3] = {lo[0], lo[1], lo[2]};
+    for (uint32_t i = bodyBegin[leaf]; i < bodyEnd[leaf]; ++i) {
+      lo[0] = std::min(lo[0], bx[i]);
+      lo[1] = std::min(lo[1], by[i]);
+      lo[2] = std::min(lo[2], bz[i]);
+      hi[0] = std::max(hi[0], bx[i]);
+      hi[1] = std::max(hi[1], by[i]);
+      hi[2] = std::max(hi[2], bz[i]);
+    }
+
+    list.x.clear();
+    list.y.clear();
+    list.z.clear();
+    list.mass.clear();
+    list.stack.assign(1, 0);
+
+    while (!list.stack.empty()) {
+      uint32_t c = list.stack.back();
+      list.stack.pop_back();
+
+      double pos[3] = {cx[c], cy[c], cz[c]};
+      double psq    = 0.0;
+      for (int d = 0; d < 3; ++d) {
+        double delta = std::max(0.0, std::max(lo[d] - pos[d], pos[d] - hi[d]));
+        psq += delta * delta;
+      }
+
+      if (psq >= cdsq[c]) {
+        list.push(pos[0], pos[1], pos[2], cmass[c]);
+      } else if (numChildren[c] == 0) {
+        for (uint32_t i = bodyBegin[c]; i < bodyEnd[c]; ++i) {
+          list.push(bx[i], by[i], bz[i], bmass[i]);
+        }
+      } else {
+        for (uint32_t k = firstChild[c]; k < firstChild[c] + numChildren[c];
+             ++k) {
+          list.stack.push_back(k);
+        }
+      }
+    }
+  }
+
+  /**
+   * Computes the acceleration of every body and updates its velocity.
+   */
+  void computeForces() {
+    galois::do_all(
+        galois::iterate(leaves),
+        [&](uint32_t leaf) {
+          Interactions& list = *interactions.getLocal();
+          interactionList(leaf, list);
+
+          for (uint32_t i = bodyBegin[leaf]; i < bodyEnd[leaf]; ++i) {
+            double acc[3] = {0.0, 0.0, 0.0};
+
+            // a body's pull on itself is zero since the distance is zero
+            accumulateForces(bx[i], by[i], bz[i], list.x.data(),
+                             list.y.data(), list.z.data(), list.mass.data(),
+                             list.x.size(), config.epssq, acc);
+
+            Body* b = body[i];
+            Point p = b->acc;
+            b->acc  = Point(acc[0], acc[1], acc[2]);
+            b->vel += (b->acc - p) * config.dthf;
+          }
+        },
+        galois::steal(), galois::loopname("computeLinear"));
+  }
+
+  /**
+   * @returns center of mass of all bodies
+   */
+  Point centerOfMass() const { return Point(cx[0], cy[0], cz[0]); }
+};
+
 struct centerXCmp {
   template <typename T>
   bool operator()(const T& lhs, const T& rhs) const {
@@ -475,11 +877,20 @@ void run(Bodies& bodies, BodyPtrs& pBodies, size_t nbodies) {
   typedef galois::worklists::PerThreadChunkLIFO<32> WL;
   typedef galois::worklists::StableIterator<true> WLL;
 
-  galois::preAlloc(galois::getActiveThreads() +
-                   (3 * sizeof(Octree) + 2 * sizeof(Body)) * nbodies /
-                       galois::runtime::pagePoolSize());
+  // the Linear octree is kept in vectors and does not use the page pool
+  if (algo == Pointer) {
+    galois::preAlloc(galois::getActiveThreads() +
+                     (3 * sizeof(Octree) + 2 * sizeof(Body)) * nbodies /
+                         galois::runtime::pagePoolSize());
+  }
   galois::reportPageAlloc("MeminfoPre");
 
+  LinearOctree linear;
+  std::vector<Body*> bodyVec;
+  if (algo == Linear) {
+    bodyVec.assign(pBodies.begin(), pBodies.end());
+  }
+
   for (int step = 0; step < ntimesteps; step++) {
 
     auto MB = [](BoundingBox& lhs, const Point& rhs) { lhs.merge(rhs); };
@@ -494,37 +905,62 @@ void run(Bodies& bodies, BodyPtrs& pBodies, size_t nbodies) {
     BoundingBox box = boxes.reduce(
         [](BoundingBox& lhs, BoundingBox& rhs) { lhs.merge(rhs); });
 
-    Tree t;
-    BuildOctree treeBuilder{t};
-    Octree& top = t.emplace(box.center());
+    Point centerOfMass;
+    if (algo == Linear) {
+      linear.sortBodies(bodyVec, box);
 
-    galois::StatTimer T_build("BuildTime");
-    T_build.start();
-    galois::do_all(
-        galois::iterate(pBodies),
-        [&](Body* body) { treeBuilder.insert(body, &top, box.radius()); },
-        galois::loopname("BuildTree"));
-    T_build.stop();
-
-    // update centers of mass in tree
-    galois::timeThis(
-        [&](void) {
-          unsigned size = computeCenterOfMass(&top);
-          // printTree(&top);
-          std::cout << "Tree Size: " << size << "\n";
-        },
-        "summarize-Serial");
+      galois::StatTimer T_build("BuildTime");
+      T_build.start();
+      linear.build();
+      T_build.stop();
+
+      galois::StatTimer T_summarize("SummarizeTime");
+      T_summarize.start();
+      linear.summarize();
+      T_summarize.stop();
+      std::cout << "Tree Size: " << linear.size() << "\n";
+
+      galois::StatTimer T_compute("ComputeTime");
+      T_compute.start();
+      linear.computeForces();
+      T_compute.stop();
+
+      centerOfMass = linear.centerOfMass();
+    } else {
+      Tree t;
+      BuildOctree treeBuilder{t};
+      Octree& top = t.emplace(box.center());
+
+      galois::StatTimer T_build("BuildTime");
+      T_build.start();
+      galois::do_all(
+          galois::iterate(pBodies),
+          [&](Body* body) { treeBuilder.insert(body, &top, box.radius()); },
+          galois::loopname("BuildTree"));
+      T_build.stop();
+
+      // update centers of mass in tree
+      galois::timeThis(
+          [&](void) {
+            unsigned size = computeCenterOfMass(&top);
+            // printTree(&top);
+            std::cout << "Tree Size: " << size << "\n";
+          },
+          "summarize-Serial");
 
-    ComputeForces cf(&top, box.diameter());
+      ComputeForces cf(&top, box.diameter());
 
-    galois::StatTimer T_compute("ComputeTime");
-    T_compute.start();
-    galois::for_each(galois::iterate(pBodies),
-                     [&](Body* b, auto& cnx) { cf.computeForce(b, cnx); },
-                     galois::loopname("compute"), galois::wl<WLL>(),
-                     galois::no_conflicts(), galois::no_pushes(),
-                     galois::per_iter_alloc());
-    T_compute.stop();
+      galois::StatTimer T_compute("ComputeTime");
+      T_compute.start();
+      galois::for_each(galois::iterate(pBodies),
+                       [&](Body* b, auto& cnx) { cf.computeForce(b, cnx); },
+                       galois::loopname("compute"), galois::wl<WLL>(),
+                       galois::no_conflicts(), galois::no_pushes(),
+                       galois::per_iter_alloc());
+      T_compute.stop();
+
+      centerOfMass = top.pos;
+    }
 
     if (!skipVerify) {
       galois::timeThis(
@@ -551,7 +987,7 @@ void run(Bodies& bodies, BodyPtrs& pBodies, size_t nbodies) {
     std::ios::fmtflags flags =
         std::cout.setf(std::ios::showpos | std::ios::right |
                        std::ios::scientific | std::ios::showpoint);
-    std::cout << top.pos;
+    std::cout << centerOfMass;
     std::cout.flags(flags);
     std::cout << "\n";
   }
@@ -19,6 +19,7 @@
 
 constexpr static const char* const REGION_NAME = "BC";
 
+#include <algorithm>
 #include <limits>
 #include <fstream>
 #include "galois/gstl.h"
@@ -29,6 +30,8 @@ constexpr static const char* const REGION_NAME = "BC";
 #include "llvm/Support/CommandLine.h"
 #include "Lonestar/BoilerPlate.h"
 
+#include "MultiSourceBFS.h"
+
 // type of the num shortest paths variable
 using ShortPathType = double;
 
@@ -62,6 +65,27 @@ static cll::opt<bool> verify("verify",
                              cll::desc("Flag to verify (default: false)"),
                              cll::init(false));
 
+enum Algo { Level, MultiSource };
+
+static cll::opt<Algo> algo(
+    "algo", cll::desc("Choose an algorithm:"),
+    cll::values(clEnumVal(Level, "One BFS and Brandes pass per source "
+                                 "(default)"),
+                clEnumVal(MultiSource, "Bit-parallel BFS and Brandes pass "
+                                       "for a batch of sources at a time"),
+                clEnumValEnd),
+    cll::init(Level));
+static cll::opt<unsigned int>
+    batchSize("batchSize",
+              cll::desc("Sources per batch for MultiSource: 64, 128, 256 "
+                        "or 512 (default 64)"),
+              cll::init(64));
+static cll::opt<bool>
+    closeness("closeness",
+              cll::desc("Also compute closeness centrality of the sources; "
+                        "MultiSource only (default off)"),
+              cll::init(false));
+
 /******************************************************************************/
 /* Graph structure declarations */
 /******************************************************************************/
@@ -143,8 +167,11 @@ void InitializeIteration(Graph& graph) {
  *
  * Worklist-based push. Save worklists on a stack for reuse in backward
  * Brandes dependency propagation.
+ *
+ * @param edges accumulates the number of edges traversed
  */
-galois::gstl::Vector<WorklistType> SSSP(Graph& graph) {
+galois::gstl::Vector<WorklistType> SSSP(Graph& graph,
+                                        galois::GAccumulator<uint64_t>& edges) {
   galois::gstl::Vector<WorklistType> stackOfWorklists;
   uint32_t currentLevel = 0;
 
@@ -164,6 +191,7 @@ galois::gstl::Vector<WorklistType> SSSP(Graph& graph) {
         NodeData& curData = graph.getData(n);
         GALOIS_ASSERT(curData.currentDistance == currentLevel);
 
+        edges += std::distance(graph.edge_begin(n), graph.edge_end(n));
         for (auto e : graph.edges(n)) {
           GNode dest = graph.getEdgeDst(e);
           NodeData& destData = graph.getData(dest);
@@ -250,6 +278,73 @@ void BackwardBrandes(Graph& graph,
   }
 }
 
+/**
+ * Multi-source version: runs the BFS and the Brandes pass for batches of
+ * sources at once with MultiSourceBFS, optionally computing closeness
+ * centrality of the sources along the way.
+ *
+ * @tparam NumWords 64-source words per batch
+ * @param graph Graph to compute BC on; BC is accumulated into node data
+ * @param sources sources to use
+ * @param runtimeTimer timer to run the computation under
+ * @param scanned filled with adjacency entries actually read
+ * @returns edges traversed, counted as if each source ran on its own
+ */
+template <unsigned NumWords>
+uint64_t MultiSourceBC(Graph& graph, const std::vector<GNode>& sources,
+                       galois::StatTimer& runtimeTimer, uint64_t& scanned) {
+  using Engine = MultiSourceBFS<Graph, NumWords>;
+  Engine engine(graph, true);
+  uint64_t traversed = 0;
+  scanned            = 0;
+
+  std::vector<GNode> batch;
+  std::vector<uint64_t> distances;
+  std::vector<uint64_t> reached;
+  std::vector<std::pair<GNode, double>> closenessOf;
+
+  for (size_t first = 0; first < sources.size(); first += Engine::NUM_LANES) {
+    size_t last = std::min(sources.size(), first + Engine::NUM_LANES);
+    batch.assign(sources.begin() + first, sources.begin() + last);
+
+    runtimeTimer.start();
+    engine.search(batch);
+    engine.accumulateDependencies(
+        [&](GNode n, float dependency) { graph.getData(n).bc += dependency; });
+    runtimeTimer.stop();
+
+    traversed += engine.getEdgesTraversed();
+    scanned += engine.getEdgesScanned();
+
+    if (closeness) {
+      engine.distanceSums(distances, reached);
+      for (size_t lane = 0; lane < batch.size(); ++lane) {
+        // reached vertices over the sum of their distances, so that sources
+        // reaching little of the graph do not look central
+        double c = distances[lane]
+                       ? (double)reached[lane] * reached[lane] /
+                             ((double)(graph.size() - 1) * distances[lane])
+                       : 0.0;
+        closenessOf.emplace_back(batch[lane], c);
+      }
+    }
+  }
+
+  if (closeness && !closenessOf.empty()) {
+    auto best = std::max_element(
+        closenessOf.begin(), closenessOf.end(),
+        [](const std::pair<GNode, double>& a,
+           const std::pair<GNode, double>& b) { return a.second < b.second; });
+    galois::gPrint("Max closeness is ", best->second, " at node ", best->first,
+                   "\n");
+    if (verify) {
+      for (auto& c : closenessOf)
+        galois::gPrint("closeness ", c.first, " ", c.second, "\n");
+    }
+  }
+  return traversed;
+}
+
 /******************************************************************************/
 /* Sanity check */
 /******************************************************************************/
@@ -354,37 +449,88 @@ int main(int argc, char** argv) {
     }
   }
 
-  // graph initialization, then main loop
-  InitializeGraph(graph);
-
-  galois::gInfo("Beginning main computation");
-  galois::StatTimer runtimeTimer;
-
-  // loop over all specified sources for SSSP/Brandes calculation
+  // sources to work on, in order
+  std::vector<GNode> sources;
   for (uint64_t i = 0; i < loop_end; i++) {
     if (singleSourceBC) {
       // only 1 source; specified start source in command line
       assert(loop_end == 1);
       galois::gDebug("This is single source node BC");
-      currentSrcNode = startSource;
+      sources.push_back(startSource);
     } else if (sSources) {
-      currentSrcNode = sourceVector[i];
+      sources.push_back(sourceVector[i]);
     } else {
       // all sources
-      currentSrcNode = i;
+      sources.push_back(i);
     }
+  }
 
-    // here begins main computation
-    runtimeTimer.start();
-    InitializeIteration(graph);
-    // worklist; last one will be empty
-    galois::gstl::Vector<WorklistType> worklists = SSSP(graph);
-    BackwardBrandes(graph, worklists);
-    runtimeTimer.stop();
+  if (closeness && algo != MultiSource) {
+    GALOIS_DIE("closeness is only computed with -algo=MultiSource");
+  }
+
+  // graph initialization, then main loop
+  InitializeGraph(graph);
+
+  galois::gInfo("Beginning main computation");
+  galois::StatTimer runtimeTimer;
+  uint64_t traversedEdges = 0;
+
+  if (algo == Level) {
+    galois::GAccumulator<uint64_t> edges;
+    // loop over all specified sources for SSSP/Brandes calculation
+    for (GNode src : sources) {
+      currentSrcNode = src;
+
+      // here begins main computation
+      runtimeTimer.start();
+      InitializeIteration(graph);
+      // worklist; last one will be empty
+      galois::gstl::Vector<WorklistType> worklists = SSSP(graph, edges);
+      BackwardBrandes(graph, worklists);
+      runtimeTimer.stop();
+    }
+    traversedEdges = edges.reduce();
+  } else {
+    uint64_t scannedEdges = 0;
+    switch (batchSize) {
+    case 64:
+      traversedEdges =
+          MultiSourceBC<1>(graph, sources, runtimeTimer, scannedEdges);
+      break;
+    case 128:
+      traversedEdges =
+          MultiSourceBC<2>(graph, sources, runtimeTimer, scannedEdges);
+      break;
+    case 256:
+      traversedEdges =
+          MultiSourceBC<4>(graph, sources, runtimeTimer, scannedEdges);
+      break;
+    case 512:
+      traversedEdges =
+          MultiSourceBC<8>(graph, sources, runtimeTimer, scannedEdges);
+      break;
+    default:
+      GALOIS_DIE("batch size must be 64, 128, 256 or 512");
+    }
+    galois::runtime::reportStat_Single(REGION_NAME, "BatchSize",
+                                       (unsigned)batchSize);
+    galois::runtime::reportStat_Single(REGION_NAME, "EdgesScanned",
+                                       scannedEdges);
   }
   totalTimer.stop();
   galois::reportPageAlloc("MemAllocPost");
 
+  // edges that one BFS per source would have traversed, so both algorithms
+  // report the same count for the same sources
+  galois::runtime::reportStat_Single(REGION_NAME, "TraversedEdges",
+                                     traversedEdges);
+  if (runtimeTimer.get_usec()) {
+    galois::runtime::reportStat_Single(
+        REGION_NAME, "TEPS",
+        (uint64_t)(traversedEdges * 1e6 / runtimeTimer.get_usec()));
+  }
+
   // sanity checking numbers
   Sanity(graph);
 
@@ -0,0 +1,366 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef _MULTI_SOURCE_BFS_H_
+#define _MULTI_SOURCE_BFS_H_
+
+#include "galois/Galois.h"
+#include "galois/AtomicHelpers.h"
+#include "galois/LargeArray.h"
+#include "galois/Reduction.h"
+#include "galois/gstl.h"
+#include "galois/substrate/PerThreadStorage.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Breadth-first searches from up to NUM_LANES sources at once (MS-BFS). Each
+ * source owns one bit, or lane, of the per-vertex masks, so the adjacency list
+ * of a vertex is read once per level for all the sources that reach it at
+ * that level instead of once per source.
+ *
+ * A search leaves the vertices it reached in one bag per level, each with the
+ * lanes that reached it there. On top of that, the Brandes dependency
+ * accumulation for betweenness centrality runs on all lanes at once, and
+ * per-source distance sums give closeness centrality.
+ *
+ * @tparam Graph graph with out edges; searches follow out edges
+ * @tparam NumWords number of 64-bit words per mask
+ */
+template <typename Graph, unsigned NumWords>
+class MultiSourceBFS {
+public:
+  using GNode                            = typename Graph::GraphNode;
+  using PathCount                        = double;
+  constexpr static const unsigned NUM_LANES = 64 * NumWords;
+
+  //! One bit per source
+  struct Lanes {
+    uint64_t words[NumWords];
+
+    bool any() const {
+      uint64_t acc = 0;
+      for (unsigned i = 0; i < NumWords; ++i)
+        acc |= words[i];
+      return acc != 0;
+    }
+
+    //! Calls fn with the index of every set lane
+    template <typename Fn>
+    void forEach(Fn fn) const {
+      for (unsigned i = 0; i < NumWords; ++i) {
+        for (uint64_t w = words[i]; w; w &= w - 1)
+          fn(i * 64 + __builtin_ctzll(w));
+      }
+    }
+
+    unsigned count() const {
+      unsigned num = 0;
+      for (unsigned i = 0; i < NumWords; ++i)
+        num += __builtin_popcountll(words[i]);
+      return num;
+    }
+  };
+
+  //! A vertex and the lanes that reached it at one level
+  struct Entry {
+    GNode node;
+    Lanes lanes;
+  };
+  using LevelBag = galois::InsertBag<Entry>;
+
+private:
+  constexpr static const unsigned CHUNK_SIZE = 64u;
+
+  Graph& graph;
+  bool countPaths;
+
+  galois::LargeArray<Lanes> seen;
+  //! lanes reaching a vertex at the next level, or at the level after the
+  //! current one during dependency accumulation
+  galois::LargeArray<Lanes> next;
+  //! last level that queued a vertex; levels are numbered across searches
+  galois::LargeArray<uint32_t> queuedAt;
+  uint32_t epoch;
+  //! per vertex and lane
+  galois::LargeArray<std::atomic<PathCount>> numPaths;
+  galois::LargeArray<float> dependency;
+
+  galois::gstl::Vector<LevelBag> levels;
+  uint64_t edgesScanned;
+  uint64_t edgesTraversed;
+
+  static Lanes clearLanes() {
+    Lanes lanes;
+    for (unsigned i = 0; i < NumWords; ++i)
+      lanes.words[i] = 0;
+    return lanes;
+  }
+
+  size_t slot(GNode n, unsigned lane) const {
+    return (size_t)n * NUM_LANES + lane;
+  }
+
+  //! Clears the state of the vertices reached by the last search
+  void reset() {
+    for (LevelBag& level : levels) {
+      galois::do_all(
+          galois::iterate(level),
+          [&](const Entry& e) {
+            seen[e.node] = clearLanes();
+            if (countPaths) {
+              e.lanes.forEach([&](unsigned lane) {
+                numPaths[slot(e.node, lane)] = 0;
+                dependency[slot(e.node, lane)] = 0;
+              });
+            }
+          },
+          galois::no_stats(), galois::loopname("MultiSourceBFSReset"));
+    }
+    levels.clear();
+  }
+
+public:
+  /**
+   * @param g graph to search
+   * @param _countPaths count shortest paths during the search, which is
+   * needed for betweenness centrality only
+   */
+  MultiSourceBFS(Graph& g, bool _countPaths)
+      : graph(g), countPaths(_countPaths), epoch(0), edgesScanned(0),
+        edgesTraversed(0) {
+    seen.allocateInterleaved(graph.size());
+    next.allocateInterleaved(graph.size());
+    queuedAt.allocateInterleaved(graph.size());
+    if (countPaths) {
+      numPaths.allocateInterleaved(graph.size() * NUM_LANES);
+      dependency.allocateInterleaved(graph.size() * NUM_LANES);
+    }
+
+    galois::do_all(
+        galois::iterate(graph),
+        [&](GNode n) {
+          seen[n]     = clearLanes();
+          next[n]     = clearLanes();
+          queuedAt[n] = 0;
+          if (countPaths) {
+            for (unsigned lane = 0; lane < NUM_LANES; ++lane) {
+              numPaths[slot(n, lane)] = 0;
+              dependency[slot(n, lane)] = 0;
+            }
+          }
+        },
+        galois::no_stats(), galois::loopname("MultiSourceBFSInit"));
+  }
+
+  /**
+   * Searches from the given sources; sources[i] gets lane i.
+   *
+   * @param sources at most NUM_LANES sources
+   */
+  void search(const std::vector<GNode>& sources) {
+    assert(sources.size() <= NUM_LANES);
+    reset();
+
+    levels.emplace_back();
+    ++epoch;
+    std::vector<GNode> distinct;
+    for (unsigned lane = 0; lane < sources.size(); ++lane) {
+      GNode src = sources[lane];
+      seen[src].words[lane / 64] |= uint64_t(1) << (lane % 64);
+      if (countPaths)
+        numPaths[slot(src, lane)] = 1;
+      if (queuedAt[src] != epoch) {
+        queuedAt[src] = epoch;
+        distinct.push_back(src);
+      }
+    }
+    for (GNode src : distinct)
+      levels[0].push(Entry{src, seen[src]});
+
+    galois::GAccumulator<uint64_t> scanned;
+    galois::GAccumulator<uint64_t> traversed;
+
+    for (uint32_t level = 0; !levels[level].empty(); ++level) {
+      levels.emplace_back();
+      LevelBag& current = levels[level];
+      LevelBag& following = levels[level + 1];
+      uint32_t mark = ++epoch;
+      galois::InsertBag<GNode> queued;
+
+      // push the lanes of the frontier to the neighbors that they have not
+      // reached yet
+      galois::do_all(
+          galois::iterate(current),
+          [&](const Entry& e) {
+            uint64_t degree = 0;
+            for (auto ii : graph.edges(e.node)) {
+              GNode dst = graph.getEdgeDst(ii);
+              ++degree;
+
+              Lanes fresh;
+              for (unsigned i = 0; i < NumWords; ++i)
+                fresh.words[i] = e.lanes.words[i] & ~seen[dst].words[i];
+              if (!fresh.any())
+                continue;
+
+              for (unsigned i = 0; i < NumWords; ++i) {
+                if (fresh.words[i])
+                  __sync_fetch_and_or(&next[dst].words[i], fresh.words[i]);
+              }
+              if (countPaths) {
+                fresh.forEach([&](unsigned lane) {
+                  galois::atomicAdd(numPaths[slot(dst, lane)],
+                                    numPaths[slot(e.node, lane)].load());
+                });
+              }
+              if (queuedAt[dst] != mark &&
+                  __sync_lock_test_and_set(&queuedAt[dst], mark) != mark) {
+                queued.push(dst);
+              }
+            }
+            scanned += degree;
+            traversed += degree * e.lanes.count();
+          },
+          galois::steal(), galois::chunk_size<CHUNK_SIZE>(),
+          galois::no_stats(), galois::loopname("MultiSourceBFS"));
+
+      galois::do_all(
+          galois::iterate(queued),
+          [&](GNode n) {
+            Lanes reached = next[n];
+            next[n]       = clearLanes();
+            for (unsigned i = 0; i < NumWords; ++i)
+              seen[n].words[i] |= reached.words[i];
+            following.push(Entry{n, reached});
+          },
+          galois::no_stats(), galois::loopname("MultiSourceBFSAdvance"));
+    }
+
+    edgesScanned   = scanned.reduce();
+    edgesTraversed = traversed.reduce();
+  }
+
+  /**
+   * Brandes backward propagation for every lane of the last search, which
+   * must have counted paths.
+   *
+   * @param addBC called once per vertex and level with the sum of the
+   * dependencies of the vertex on the lanes that reached it at that level;
+   * calls for the same vertex never overlap
+   */
+  template <typename Fn>
+  void accumulateDependencies(Fn addBC) {
+    assert(countPaths);
+    // the last level is empty, the one before holds leaves, and level 0
+    // holds the sources, which get no dependency
+    if (levels.size() < 3)
+      return;
+
+    for (uint32_t level = levels.size() - 3; level > 0; --level) {
+      galois::do_all(
+          galois::iterate(levels[level + 1]),
+          [&](const Entry& e) { next[e.node] = e.lanes; },
+          galois::no_stats(), galois::loopname("MultiSourceBrandesMark"));
+
+      galois::do_all(
+          galois::iterate(levels[level]),
+          [&](const Entry& e) {
+            float sum[NUM_LANES];
+            e.lanes.forEach([&](unsigned lane) { sum[lane] = 0; });
+
+            for (auto ii : graph.edges(e.node)) {
+              GNode dst = graph.getEdgeDst(ii);
+              Lanes succ;
+              for (unsigned i = 0; i < NumWords; ++i)
+                succ.words[i] = e.lanes.words[i] & next[dst].words[i];
+              succ.forEach([&](unsigned lane) {
+                size_t d = slot(dst, lane);
+                sum[lane] += (1.0f + dependency[d]) / numPaths[d];
+              });
+            }
+
+            float total = 0;
+            e.lanes.forEach([&](unsigned lane) {
+              size_t s      = slot(e.node, lane);
+              dependency[s] = sum[lane] * numPaths[s];
+              total += dependency[s];
+            });
+            addBC(e.node, total);
+          },
+          galois::steal(), galois::chunk_size<CHUNK_SIZE>(),
+          galois::no_stats(), galois::loopname("MultiSourceBrandes"));
+
+      galois::do_all(
+          galois::iterate(levels[level + 1]),
+          [&](const Entry& e) { next[e.node] = clearLanes(); },
+          galois::no_stats(), galois::loopname("MultiSourceBrandesMark"));
+    }
+  }
+
+  /**
+   * Distances from every source of the last search to the vertices it
+   * reached.
+   *
+   * @param sum filled with the sum of distances per lane
+   * @param reached filled with the number of vertices reached per lane, not
+   * counting the source itself
+   */
+  void distanceSums(std::vector<uint64_t>& sum, std::vector<uint64_t>& reached) {
+    galois::substrate::PerThreadStorage<std::vector<uint64_t>> localSum;
+    galois::substrate::PerThreadStorage<std::vector<uint64_t>> localReached;
+    galois::on_each([&](unsigned, unsigned) {
+      localSum.getLocal()->assign(NUM_LANES, 0);
+      localReached.getLocal()->assign(NUM_LANES, 0);
+    });
+
+    for (uint32_t level = 1; level < levels.size(); ++level) {
+      galois::do_all(
+          galois::iterate(levels[level]),
+          [&](const Entry& e) {
+            std::vector<uint64_t>& s = *localSum.getLocal();
+            std::vector<uint64_t>& r = *localReached.getLocal();
+            e.lanes.forEach([&](unsigned lane) {
+              s[lane] += level;
+              r[lane] += 1;
+            });
+          },
+          galois::no_stats(), galois::loopname("MultiSourceDistances"));
+    }
+
+    sum.assign(NUM_LANES, 0);
+    reached.assign(NUM_LANES, 0);
+    for (unsigned t = 0; t < localSum.size(); ++t) {
+      for (unsigned lane = 0; lane < NUM_LANES; ++lane) {
+        sum[lane] += (*localSum.getRemote(t))[lane];
+        reached[lane] += (*localReached.getRemote(t))[lane];
+      }
+    }
+  }
+
+  //! Adjacency entries read by the last search
+  uint64_t getEdgesScanned() const { return edgesScanned; }
+
+  //! Edges that the last search would have read with one source at a time
+  uint64_t getEdgesTraversed() const { return edgesTraversed; }
+};
+
+#endif
@@ -18,6 +18,7 @@
  */
 
 #include "galois/Galois.h"
+#include "galois/DynamicBitset.h"
 #include "galois/gstl.h"
 #include "galois/Reduction.h"
 #include "galois/Timer.h"
@@ -32,6 +33,7 @@
 
 #include <iostream>
 #include <deque>
+#include <string>
 #include <type_traits>
 
 namespace cll = llvm::cl;
@@ -55,16 +57,40 @@ static cll::opt<unsigned int>
     reportNode("reportNode",
                cll::desc("Node to report distance to (default value 1)"),
                cll::init(1));
+static cll::opt<std::string> transposeGraphName(
+    "graphTranspose",
+    cll::desc("Transpose of input graph (needed by DirOpt unless the input "
+              "is symmetric)"));
+static cll::opt<bool>
+    symmetricGraph("symmetricGraph", cll::desc("Input graph is symmetric"));
+static cll::opt<unsigned int>
+    alpha("alpha",
+          cll::desc("DirOpt: go bottom-up when frontier edges exceed "
+                    "unexplored edges / alpha (default value 15)"),
+          cll::init(15));
+static cll::opt<unsigned int>
+    beta("beta",
+         cll::desc("DirOpt: go back top-down when frontier nodes drop below "
+                   "nodes / beta (default value 18)"),
+         cll::init(18));
 // static cll::opt<unsigned int> stepShiftw("delta",
 // cll::desc("Shift value for the deltastep"),
 // cll::init(10));
 
 enum Exec { SERIAL, PARALLEL };
 
-enum Algo { AsyncTile = 0, Async, SyncTile, Sync, Sync2pTile, Sync2p };
+enum Algo {
+  AsyncTile = 0,
+  Async,
+  SyncTile,
+  Sync,
+  Sync2pTile,
+  Sync2p,
+  DirOpt
+};
 
-const char* const ALGO_NAMES[] = {"AsyncTile", "Async",      "SyncTile",
-                                  "Sync",      "Sync2pTile", "Sync2p"};
+const char* const ALGO_NAMES[] = {"AsyncTile",  "Async",  "SyncTile", "Sync",
+                                  "Sync2pTile", "Sync2p", "DirOpt"};
 
 static cll::opt<Exec> execution(
     "exec",
@@ -78,11 +104,14 @@ static cll::opt<Algo> algo(
     cll::values(clEnumVal(AsyncTile, "AsyncTile"), clEnumVal(Async, "Async"),
                 clEnumVal(SyncTile, "SyncTile"), clEnumVal(Sync, "Sync"),
                 clEnumVal(Sync2pTile, "Sync2pTile"),
-                clEnumVal(Sync2p, "Sync2p"), clEnumValEnd),
+                clEnumVal(Sync2p, "Sync2p"),
+                clEnumVal(DirOpt, "DirOpt (direction-optimizing, needs in-edges)"),
+                clEnumValEnd),
     cll::init(SyncTile));
 
-using Graph =
-    galois::graphs::LC_CSR_Graph<unsigned, void>::with_no_lockable<true>::type;
+// In-edges are only read by DirOpt; without a transpose they alias out-edges
+using Graph = galois::graphs::LC_InOut_Graph<
+    galois::graphs::LC_CSR_Graph<unsigned, void>::with_no_lockable<true>::type>;
 //::with_numa_alloc<true>::type;
 
 using GNode = Graph::GraphNode;
@@ -355,6 +384,151 @@ void sync2phaseAlgo(Graph& graph, GNode source, const P& pushWrap,
   }
 }
 
+/**
+ * Direction-optimizing BFS (Beamer et al.). Levels are expanded top-down from
+ * a sparse frontier until the frontier's out-edges exceed 1/alpha of the edges
+ * still unexplored; then unvisited nodes search their in-edges for a parent in
+ * a bitmap frontier, until the frontier shrinks below 1/beta of the nodes.
+ */
+template <bool CONCURRENT>
+void dirOptAlgo(Graph& graph, GNode source) {
+
+  using Cont = typename std::conditional<CONCURRENT, galois::InsertBag<GNode>,
+                                         galois::SerStack<GNode>>::type;
+  using Loop = typename std::conditional<CONCURRENT, galois::DoAll,
+                                         galois::StdForEach>::type;
+
+  constexpr galois::MethodFlag flag = galois::MethodFlag::UNPROTECTED;
+
+  Loop loop;
+
+  auto degree = [&](GNode n) {
+    return uint64_t(graph.edge_end(n, flag) - graph.edge_begin(n, flag));
+  };
+
+  Cont* curr = new Cont();
+  Cont* next = new Cont();
+  galois::DynamicBitSet currBits;
+  galois::DynamicBitSet nextBits;
+  currBits.resize(graph.size());
+  nextBits.resize(graph.size());
+
+  galois::GAccumulator<uint64_t> nextNodes;
+  galois::GAccumulator<uint64_t> nextEdges;
+  galois::GAccumulator<uint64_t> examined;
+
+  uint64_t frontierNodes   = 1;
+  uint64_t frontierEdges   = degree(source);
+  uint64_t unexploredEdges = graph.sizeEdges() - frontierEdges;
+  uint64_t totalExamined   = 0;
+  unsigned topDownSteps    = 0;
+  unsigned bottomUpSteps   = 0;
+  bool bottomUp            = false;
+
+  Dist nextLevel              = 0u;
+  graph.getData(source, flag) = 0u;
+  next->push(source);
+
+  while (frontierNodes > 0) {
+    ++nextLevel;
+    nextNodes.reset();
+    nextEdges.reset();
+    examined.reset();
+
+    // Switch direction before expanding the level
+    if (!bottomUp && frontierEdges > unexploredEdges / alpha) {
+      bottomUp = true;
+      currBits.reset();
+      loop(galois::iterate(*next), [&](GNode n) { currBits.set(n); },
+           galois::no_stats());
+    } else if (bottomUp && frontierNodes < graph.size() / beta) {
+      bottomUp = false;
+      next->clear();
+      loop(galois::iterate(graph),
+           [&](GNode n) {
+             if (currBits.test(n))
+               next->push(n);
+           },
+           galois::no_stats());
+    }
+
+    if (bottomUp) {
+      ++bottomUpSteps;
+      nextBits.reset();
+
+      loop(galois::iterate(graph),
+           [&](GNode n) {
+             auto& ndata = graph.getData(n, flag);
+             if (ndata != BFS::DIST_INFINITY)
+               return;
+
+             uint64_t scanned = 0;
+             for (auto ii = graph.in_edge_begin(n, flag),
+                       ei = graph.in_edge_end(n, flag);
+                  ii != ei; ++ii) {
+               ++scanned;
+               if (currBits.test(graph.getInEdgeDst(ii))) {
+                 ndata = nextLevel;
+                 nextBits.set(n);
+                 nextNodes += 1;
+                 nextEdges += degree(n);
+                 break;
+               }
+             }
+             examined += scanned;
+           },
+           galois::steal(), galois::chunk_size<CHUNK_SIZE>(),
+           galois::loopname("BottomUp"));
+
+      std::swap(currBits, nextBits);
+    } else {
+      ++topDownSteps;
+      std::swap(curr, next);
+      next->clear();
+
+      loop(galois::iterate(*curr),
+           [&](GNode src) {
+             for (auto e : graph.edges(src, flag)) {
+               GNode dst   = graph.getEdgeDst(e);
+               auto& ddata = graph.getData(dst, flag);
+
+               if (ddata == BFS::DIST_INFINITY &&
+                   (!CONCURRENT || __sync_bool_compare_and_swap(
+                                       &ddata, BFS::DIST_INFINITY, nextLevel))) {
+                 ddata = nextLevel;
+                 next->push(dst);
+                 nextNodes += 1;
+                 nextEdges += degree(dst);
+               }
+             }
+             examined += degree(src);
+           },
+           galois::steal(), galois::chunk_size<CHUNK_SIZE>(),
+           galois::loopname("TopDown"));
+    }
+
+    frontierNodes = nextNodes.reduce();
+    frontierEdges = nextEdges.reduce();
+    unexploredEdges -= std::min(unexploredEdges, frontierEdges);
+    totalExamined += examined.reduce();
+
+    std::string level = "Level" + std::to_string(nextLevel);
+    galois::runtime::reportStat_Single("DirOpt", level + "BottomUp",
+                                       bottomUp ? 1 : 0);
+    galois::runtime::reportStat_Single("DirOpt", level + "EdgesExamined",
+                                       examined.reduce());
+    galois::runtime::reportStat_Single("DirOpt", level + "Frontier",
+                                       frontierNodes);
+  }
+
+  galois::runtime::reportStat_Single("DirOpt", "TopDownSteps", topDownSteps);
+  galois::runtime::reportStat_Single("DirOpt", "BottomUpSteps", bottomUpSteps);
+  galois::runtime::reportStat_Single("DirOpt", "EdgesExamined", totalExamined);
+
+  delete curr;
+  delete next;
+}
+
 template <bool CONCURRENT>
 void runAlgo(Graph& graph, const GNode& source) {
 
@@ -383,6 +557,9 @@ void runAlgo(Graph& graph, const GNode& source) {
     sync2phaseAlgo<CONCURRENT>(graph, source, OneTilePushWrap{graph},
                                TileRangeFn());
     break;
+  case DirOpt:
+    dirOptAlgo<CONCURRENT>(graph, source);
+    break;
   default:
     std::cerr << "ERROR: unkown algo type" << std::endl;
   }
@@ -396,7 +573,14 @@ int main(int argc, char** argv) {
   GNode source, report;
 
   std::cout << "Reading from file: " << filename << std::endl;
-  galois::graphs::readGraph(graph, filename);
+  if (transposeGraphName.size()) {
+    galois::graphs::readGraph(graph, filename, transposeGraphName);
+  } else {
+    if (algo == DirOpt && !symmetricGraph) {
+      GALOIS_DIE("DirOpt requires -graphTranspose or -symmetricGraph");
+    }
+    galois::graphs::readGraph(graph, filename);
+  }
   std::cout << "Read " << graph.size() << " nodes, " << graph.sizeEdges()
             << " edges" << std::endl;
 
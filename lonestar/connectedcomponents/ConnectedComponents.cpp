@@ -31,6 +31,8 @@
 #include "Lonestar/BoilerPlate.h"
 #include "galois/runtime/Profile.h"
 
+#include <random>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <algorithm>
@@ -50,7 +52,8 @@ enum Algo {
   blockedasync,
   labelProp,
   serial,
-  synchronous
+  synchronous,
+  afforest
 };
 
 enum OutputEdgeType { void_, int32_, int64_ };
@@ -90,6 +93,8 @@ static cll::opt<Algo> algo(
                            "Using label propagation algorithm"),
                 clEnumValN(Algo::serial, "Serial", "Serial"),
                 clEnumValN(Algo::synchronous, "Sync", "Synchronous"),
+                clEnumValN(Algo::afforest, "Afforest",
+                           "Sampled neighbor linking (Afforest)"),
 
                 clEnumValEnd),
     cll::init(Algo::edgetiledasync));
@@ -108,6 +113,10 @@ struct Node : public galois::UnionFindNode<Node> {
 
   component_type component() { return this->findAndCompress(); }
   bool isRepComp(unsigned int x) { return false; }
+  //! Current link, without following it to the representative
+  component_type parent() {
+    return this->m_component.load(std::memory_order_relaxed);
+  }
 };
 
 const unsigned int LABEL_INF = std::numeric_limits<unsigned int>::max();
@@ -538,6 +547,110 @@ struct BlockedAsyncAlgo {
   }
 };
 
+/**
+ * Afforest: link only the first few neighbors of every node, which is enough
+ * to form most of the largest component, then find that component by
+ * sampling and process the remaining edges only of nodes outside it. Since
+ * the graph is symmetric, an edge between a node in the largest component and
+ * one outside is still seen from the outside node. Union-find uses path
+ * splitting, and pointer jumping flattens the trees between phases.
+ */
+struct AfforestAlgo {
+  using Graph =
+      galois::graphs::LC_CSR_Graph<Node, void>::with_no_lockable<true>::type;
+  using GNode = Graph::GraphNode;
+
+  template <typename G>
+  void readGraph(G& graph) {
+    galois::graphs::readGraph(graph, inputFilename);
+  }
+
+  const unsigned NEIGHBOR_SAMPLES  = 2;
+  const unsigned COMPONENT_SAMPLES = 1024;
+
+  void compress(Graph& graph, const char* loopname) {
+    galois::do_all(galois::iterate(graph),
+                   [&](const GNode& src) {
+                     graph.getData(src, galois::MethodFlag::UNPROTECTED)
+                         .compress();
+                   },
+                   galois::loopname(loopname));
+  }
+
+  //! Most frequent representative among randomly sampled nodes
+  Node* approxLargestComponent(Graph& graph) {
+    std::unordered_map<Node*, unsigned> counts;
+    std::minstd_rand rng(0);
+    std::uniform_int_distribution<size_t> dist(0, graph.size() - 1);
+    for (unsigned i = 0; i < COMPONENT_SAMPLES; ++i) {
+      GNode n = *std::next(graph.begin(), dist(rng));
+      ++counts[graph.getData(n, galois::MethodFlag::UNPROTECTED).find()];
+    }
+    auto largest = std::max_element(
+        counts.begin(), counts.end(),
+        [](const std::pair<Node* const, unsigned>& a,
+           const std::pair<Node* const, unsigned>& b) {
+          return a.second < b.second;
+        });
+    return largest->first;
+  }
+
+  void operator()(Graph& graph) {
+    if (graph.size() == 0)
+      return;
+
+    for (unsigned r = 0; r < NEIGHBOR_SAMPLES; ++r) {
+      galois::do_all(
+          galois::iterate(graph),
+          [&](const GNode& src) {
+            auto ii = graph.edge_begin(src, galois::MethodFlag::UNPROTECTED);
+            auto ei = graph.edge_end(src, galois::MethodFlag::UNPROTECTED);
+            if (ii + r >= ei)
+              return;
+            GNode dst   = graph.getEdgeDst(ii + r);
+            Node& sdata = graph.getData(src, galois::MethodFlag::UNPROTECTED);
+            Node& ddata = graph.getData(dst, galois::MethodFlag::UNPROTECTED);
+            sdata.mergeAndSplit(&ddata);
+          },
+          galois::loopname("CC-AfforestSample"), galois::steal());
+      compress(graph, "CC-AfforestSampleCompress");
+    }
+
+    Node* largest = approxLargestComponent(graph);
+
+    galois::GAccumulator<size_t> skippedEdges;
+    galois::do_all(
+        galois::iterate(graph),
+        [&](const GNode& src) {
+          Node& sdata = graph.getData(src, galois::MethodFlag::UNPROTECTED);
+          auto ii     = graph.edge_begin(src, galois::MethodFlag::UNPROTECTED);
+          auto ei     = graph.edge_end(src, galois::MethodFlag::UNPROTECTED);
+          if (ei - ii <= NEIGHBOR_SAMPLES)
+            return;
+          ii += NEIGHBOR_SAMPLES;
+          // after compression, nodes of the largest component link to its
+          // sampled representative even if it is since merged into another
+          if (sdata.parent() == largest) {
+            skippedEdges += ei - ii;
+            return;
+          }
+          for (; ii != ei; ++ii) {
+            GNode dst   = graph.getEdgeDst(ii);
+            Node& ddata = graph.getData(dst, galois::MethodFlag::UNPROTECTED);
+            sdata.mergeAndSplit(&ddata);
+          }
+        },
+        galois::loopname("CC-AfforestFinish"), galois::steal());
+    compress(graph, "CC-AfforestCompress");
+
+    size_t skipped = skippedEdges.reduce();
+    galois::runtime::reportStat_Single("CC-Afforest", "SkippedEdges", skipped);
+    galois::runtime::reportStat_Single(
+        "CC-Afforest", "SkippedEdgeFraction",
+        graph.sizeEdges() ? (double)skipped / graph.sizeEdges() : 0.0);
+  }
+};
+
 template <typename Graph>
 bool verify(
     Graph& graph,
@@ -719,6 +832,9 @@ int main(int argc, char** argv) {
   case Algo::synchronous:
     run<SynchronousAlgo>();
     break;
+  case Algo::afforest:
+    run<AfforestAlgo>();
+    break;
 
   default:
     std::cerr << "Unknown algorithm\n";
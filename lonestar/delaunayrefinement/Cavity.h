@@ -44,23 +44,31 @@ class Cavity {
    * find the node that is opposite the obtuse angle of the element
    */
   GNode getOpposite(GNode node) {
-    assert(std::distance(graph->edge_begin(node), graph->edge_end(node)) == 3);
-    Element& element   = graph->getData(node, galois::MethodFlag::WRITE);
+    // elements on the way to the cavity are only read, and another iteration
+    // may be rewiring this one; recheck before trusting what was seen
+    auto degree =
+        std::distance(graph->edge_begin(node, galois::MethodFlag::READ),
+                      graph->edge_end(node, galois::MethodFlag::READ));
+    if (degree != 3)
+      galois::runtime::checkOptimisticReads();
+    assert(degree == 3);
+    Element& element   = graph->getData(node, galois::MethodFlag::READ);
     Tuple elementTuple = element.getObtuse();
     Edge ObtuseEdge    = element.getOppositeObtuse();
     for (Graph::edge_iterator
-             ii = graph->edge_begin(node, galois::MethodFlag::WRITE),
-             ee = graph->edge_end(node, galois::MethodFlag::WRITE);
+             ii = graph->edge_begin(node, galois::MethodFlag::READ),
+             ee = graph->edge_end(node, galois::MethodFlag::READ);
          ii != ee; ++ii) {
       GNode neighbor = graph->getEdgeDst(ii);
       // Edge& edgeData = graph->getEdgeData(node, neighbor);
       Edge edgeData = element.getRelatedEdge(
-          graph->getData(neighbor, galois::MethodFlag::WRITE));
+          graph->getData(neighbor, galois::MethodFlag::READ));
       if (elementTuple != edgeData.getPoint(0) &&
           elementTuple != edgeData.getPoint(1)) {
         return neighbor;
       }
     }
+    galois::runtime::checkOptimisticReads();
     GALOIS_DIE("unreachable");
     return node;
   }
@@ -104,11 +112,11 @@ public:
     connections.clear();
     frontier.clear();
     centerNode    = node;
-    centerElement = &graph->getData(centerNode, galois::MethodFlag::WRITE);
-    while (graph->containsNode(centerNode, galois::MethodFlag::WRITE) &&
+    centerElement = &graph->getData(centerNode, galois::MethodFlag::READ);
+    while (graph->containsNode(centerNode, galois::MethodFlag::READ) &&
            centerElement->isObtuse()) {
       centerNode    = getOpposite(centerNode);
-      centerElement = &graph->getData(centerNode, galois::MethodFlag::WRITE);
+      centerElement = &graph->getData(centerNode, galois::MethodFlag::READ);
     }
     center = centerElement->getCenter();
     dim    = centerElement->dim();
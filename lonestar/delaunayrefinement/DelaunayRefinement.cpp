@@ -53,8 +53,16 @@ static cll::opt<DetAlgo> detAlgo(
                 clEnumVal(detDisjoint, "Disjoint execution"), clEnumValEnd),
     cll::init(nondet));
 
-template <typename WL, int Version = detBase>
-void refine(galois::InsertBag<GNode>& initialBad, Graph& graph) {
+static cll::opt<bool>
+    optimistic("optimistic",
+               cll::desc("Validate cavities at the cautious point instead "
+                         "of locking them while they are built (nondet "
+                         "only)"),
+               cll::init(false));
+
+template <typename WL, int Version = detBase, typename... Args>
+void refine(galois::InsertBag<GNode>& initialBad, Graph& graph,
+            Args... args) {
 
   struct LocalState {
     Cavity cav;
@@ -97,7 +105,7 @@ void refine(galois::InsertBag<GNode>& initialBad, Graph& graph) {
         }
       },
       galois::loopname("refine"), galois::wl<WL>(), galois::per_iter_alloc(),
-      galois::local_state<LocalState>());
+      galois::local_state<LocalState>(), args...);
 
   //! [for_each example]
 }
@@ -175,7 +183,10 @@ int main(int argc, char** argv) {
 
   switch (detAlgo) {
   case nondet:
-    refine<Chunk>(initialBad, graph);
+    if (optimistic)
+      refine<Chunk>(initialBad, graph, galois::optimistic_conflicts());
+    else
+      refine<Chunk>(initialBad, graph);
     break;
   case detBase:
     refine<DWL>(initialBad, graph);
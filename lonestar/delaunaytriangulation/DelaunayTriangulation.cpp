@@ -56,6 +56,11 @@ static cll::opt<std::string>
     doWriteMesh("writemesh",
                 cll::desc("Write the mesh out to files with basename"),
                 cll::value_desc("basename"));
+static cll::opt<bool>
+    optimistic("optimistic",
+               cll::desc("Validate cavities at the cautious point instead "
+                         "of locking the walk to them"),
+               cll::init(false));
 
 using Tree = typename galois::graphs::SpatialTree2d<Point*>;
 
@@ -131,7 +136,7 @@ struct Process {
   }
 
   GNode findCorrespondingNode(GNode start, const Point* p1, const Point* p2) {
-    for (auto ii : graph.edges(start)) {
+    for (auto ii : graph.edges(start, galois::MethodFlag::READ)) {
       GNode dst  = graph.getEdgeDst(ii);
       Element& e = graph.getData(dst, galois::MethodFlag::UNPROTECTED);
       int count  = 0;
@@ -142,6 +147,8 @@ struct Process {
         }
       }
     }
+    // the elements were only read; a concurrent rewire is the likely cause
+    galois::runtime::checkOptimisticReads();
     GALOIS_DIE("unreachable");
     return start;
   }
@@ -149,15 +156,20 @@ struct Process {
   bool planarSearch(const Point* p, GNode start, GNode& node) {
     // Try simple hill climbing instead
     ContainsTuple contains(graph, p->t());
+    // elements on the way to the containing one are only read
     while (!contains(start)) {
-      Element& element = graph.getData(start, galois::MethodFlag::WRITE);
+      Element& element = graph.getData(start, galois::MethodFlag::READ);
       if (element.boundary()) {
         // Should only happen when quad tree returns a boundary point which is
         // rare There's only one way to go from here
-        assert(std::distance(graph.edge_begin(start), graph.edge_end(start)) ==
-               1);
+        auto degree =
+            std::distance(graph.edge_begin(start, galois::MethodFlag::READ),
+                          graph.edge_end(start, galois::MethodFlag::READ));
+        if (degree != 1)
+          galois::runtime::checkOptimisticReads();
+        assert(degree == 1);
         start = graph.getEdgeDst(
-            graph.edge_begin(start, galois::MethodFlag::WRITE));
+            graph.edge_begin(start, galois::MethodFlag::READ));
       } else {
         // Find which neighbor will get us to point fastest by computing normal
         // vectors
@@ -176,7 +188,7 @@ struct Process {
     if (!rp)
       return false;
 
-    (*rp)->get(galois::MethodFlag::WRITE);
+    (*rp)->get(galois::MethodFlag::READ);
 
     GNode someNode = (*rp)->someElement();
 
@@ -189,7 +201,8 @@ struct Process {
     return planarSearch(p, someNode, node);
   }
 
-  void generateMesh() {
+  template <typename... Args>
+  void generateMesh(Args... args) {
     typedef galois::worklists::PerThreadChunkLIFO<32> CA;
     galois::for_each(galois::iterate(ptrPoints),
                      [&, self = this](Point* p, auto& ctx) {
@@ -212,11 +225,12 @@ struct Process {
                        Cavity<Alloc> cav(self->graph, ctx.getPerIterAlloc());
                        cav.init(node, p);
                        cav.build();
+                       ctx.cautiousPoint();
                        cav.update();
                        self->tree.insert(p->t().x(), p->t().y(), p);
                      },
                      galois::no_pushes(), galois::per_iter_alloc(),
-                     galois::loopname("Main"), galois::wl<CA>());
+                     galois::loopname("Main"), galois::wl<CA>(), args...);
   }
 };
 
@@ -522,7 +536,13 @@ int main(int argc, char** argv) {
   galois::StatTimer T;
   T.start();
   galois::runtime::profileVtune(
-      [&]() { Process(graph, tree, ptrPoints).generateMesh(); },
+      [&]() {
+        if (optimistic)
+          Process(graph, tree, ptrPoints)
+              .generateMesh(galois::optimistic_conflicts());
+        else
+          Process(graph, tree, ptrPoints).generateMesh();
+      },
       "MeshGeneration");
   T.stop();
   std::cout << "mesh size: " << graph.size() << "\n";
@@ -0,0 +1,115 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Timer.h"
+#include "galois/graphs/LCGraph.h"
+#include "galois/graphs/Util.h"
+#include "llvm/Support/CommandLine.h"
+#include "Lonestar/BoilerPlate.h"
+
+#include <iostream>
+
+const char* name = "Micro Benchmark for Compressed Graph Decoding";
+const char* desc = "Compares edge scan throughput and memory of LC_CSR_Graph "
+                   "and LC_Compressed_CSR_Graph";
+const char* url  = 0;
+
+namespace cll = llvm::cl;
+static cll::opt<std::string>
+    filename(cll::Positional, cll::desc("<input graph (gr or vgr)>"),
+             cll::Required);
+static cll::opt<unsigned int> rounds("rounds",
+                                     cll::desc("number of timed scans"),
+                                     cll::init(5));
+
+typedef galois::graphs::LC_CSR_Graph<uint32_t, void>::with_no_lockable<
+    true>::type CSRGraph;
+typedef galois::graphs::LC_Compressed_CSR_Graph<uint32_t, void>::
+    with_no_lockable<true>::type CompressedGraph;
+
+//! Pull-style scan: every node reads the data of all of its neighbors
+template <typename Graph>
+uint64_t scan(Graph& graph, const char* loopname) {
+  galois::GAccumulator<uint64_t> sum;
+  galois::StatTimer timer(loopname);
+
+  galois::do_all(galois::iterate(graph),
+                 [&](typename Graph::GraphNode n) {
+                   graph.getData(n) = n;
+                 },
+                 galois::no_stats());
+
+  for (unsigned r = 0; r < rounds; ++r) {
+    timer.start();
+    galois::do_all(galois::iterate(graph),
+                   [&](typename Graph::GraphNode n) {
+                     uint64_t local = 0;
+                     for (auto e : graph.edges(
+                              n, galois::MethodFlag::UNPROTECTED)) {
+                       local += graph.getData(graph.getEdgeDst(e),
+                                              galois::MethodFlag::UNPROTECTED);
+                     }
+                     sum += local;
+                   },
+                   galois::steal(), galois::no_stats(),
+                   galois::loopname(loopname));
+    timer.stop();
+  }
+
+  double secs = timer.get() / 1000.0;
+  std::cout << loopname << ": " << timer.get() / rounds << " ms/scan, "
+            << (secs > 0 ? graph.sizeEdges() * double(rounds) / secs / 1e6
+                         : 0)
+            << " Medges/s\n";
+  return sum.reduce();
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url);
+
+  CompressedGraph cgraph;
+  galois::graphs::readGraph(cgraph, filename);
+
+  size_t cBytes = cgraph.sizeEdgeBytes() + cgraph.size() * sizeof(uint64_t);
+  size_t rawBytes = cgraph.sizeEdges() * sizeof(uint32_t);
+  std::cout << "|V| = " << cgraph.size() << ", |E| = " << cgraph.sizeEdges()
+            << "\n";
+  std::cout << "Edge destinations: CSR " << rawBytes << " bytes, compressed "
+            << cBytes << " bytes (incl. byte index), "
+            << (cgraph.sizeEdges() ? 8.0 * cBytes / cgraph.sizeEdges() : 0)
+            << " bits/edge\n";
+  galois::runtime::reportStat_Single("CompressedGraph", "EdgeBytes", cBytes);
+  galois::runtime::reportStat_Single("CompressedGraph", "RawEdgeBytes",
+                                     rawBytes);
+
+  uint64_t cSum = scan(cgraph, "CompressedScan");
+
+  if (!CompressedGraph::isCompressedFile(filename)) {
+    CSRGraph graph;
+    galois::graphs::readGraph(graph, filename);
+    uint64_t sum = scan(graph, "CSRScan");
+    if (sum != cSum && !skipVerify) {
+      GALOIS_DIE("scan results differ: ", sum, " vs ", cSum);
+    }
+  }
+
+  return 0;
+}
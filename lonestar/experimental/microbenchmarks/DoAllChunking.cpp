@@ -0,0 +1,176 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Timer.h"
+#include "llvm/Support/CommandLine.h"
+#include "Lonestar/BoilerPlate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+const char* name = "Micro Benchmark for do_all Chunking";
+const char* desc = "Compares fixed and adaptive chunk sizes of work-stealing "
+                   "do_all loops on skewed iteration costs";
+const char* url  = 0;
+
+enum Dist { uniform, powerlaw, hotspot };
+
+enum Schedule { fixedChunk, adaptiveChunk, both };
+
+namespace cll = llvm::cl;
+static cll::opt<unsigned int>
+    numItems("numItems", cll::desc("number of loop iterations"),
+             cll::init(1U << 22));
+static cll::opt<unsigned int>
+    baseWork("baseWork", cll::desc("work units of the cheapest iteration"),
+             cll::init(16));
+static cll::opt<double>
+    alpha("alpha", cll::desc("exponent of the power-law cost distribution"),
+          cll::init(1.0));
+static cll::opt<bool>
+    shuffle("shuffle", cll::desc("scatter expensive iterations over the range"),
+            cll::init(false));
+static cll::opt<unsigned int>
+    chunkSize("chunkSize",
+              cll::desc("fixed chunk size, initial size if adaptive"),
+              cll::init(32));
+static cll::opt<unsigned int> rounds("rounds",
+                                     cll::desc("number of timed loops"),
+                                     cll::init(5));
+static cll::opt<Dist> dist(
+    "dist", cll::desc("Distribution of iteration costs:"),
+    cll::values(clEnumValN(Dist::uniform, "uniform", "equal cost"),
+                clEnumValN(Dist::powerlaw, "powerlaw",
+                           "cost of item i ~ (n/(i+1))^alpha (default)"),
+                clEnumValN(Dist::hotspot, "hotspot",
+                           "first 1% of the range is 1000x more expensive"),
+                clEnumValEnd),
+    cll::init(Dist::powerlaw));
+static cll::opt<Schedule> schedule(
+    "schedule", cll::desc("Chunking policy:"),
+    cll::values(clEnumValN(Schedule::fixedChunk, "fixed", "fixed chunk size"),
+                clEnumValN(Schedule::adaptiveChunk, "adaptive",
+                           "adaptive chunk size"),
+                clEnumValN(Schedule::both, "both", "run both (default)"),
+                clEnumValEnd),
+    cll::init(Schedule::both));
+
+//! Cap on a single iteration so that the largest hub stays splittable
+static const uint32_t MAX_COST = 1U << 20;
+
+static std::vector<uint32_t> makeCosts() {
+  std::vector<uint32_t> costs(numItems);
+
+  for (size_t i = 0; i < costs.size(); ++i) {
+    double c = baseWork;
+    switch (dist) {
+    case Dist::uniform:
+      break;
+    case Dist::powerlaw:
+      c *= std::pow(double(costs.size()) / double(i + 1), alpha) /
+           std::pow(double(costs.size()), alpha / 2);
+      break;
+    case Dist::hotspot:
+      if (i < costs.size() / 100) {
+        c *= 1000;
+      }
+      break;
+    }
+    costs[i] = uint32_t(std::min(std::max(c, 1.0), double(MAX_COST)));
+  }
+
+  if (shuffle) {
+    std::mt19937 gen(0);
+    std::shuffle(costs.begin(), costs.end(), gen);
+  }
+  return costs;
+}
+
+static uint64_t spin(uint32_t units) {
+  uint64_t x = units;
+  for (uint32_t i = 0; i < units; ++i) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  return x;
+}
+
+template <typename... Args>
+void run(const std::vector<uint32_t>& costs, const char* loopname,
+         const Args&... args) {
+  galois::substrate::PerThreadStorage<uint64_t> busy;
+  galois::GAccumulator<uint64_t> sink;
+  galois::StatTimer timer(loopname);
+
+  uint64_t total = 0;
+  for (uint32_t c : costs) {
+    total += c;
+  }
+
+  for (unsigned r = 0; r < rounds; ++r) {
+    galois::on_each(
+        [&](unsigned tid, unsigned) { *busy.getLocal(tid) = 0; });
+
+    timer.start();
+    galois::do_all(galois::iterate(size_t(0), costs.size()),
+                   [&](size_t i) {
+                     sink += spin(costs[i]);
+                     *busy.getLocal() += costs[i];
+                   },
+                   galois::loopname(loopname), args...);
+    timer.stop();
+  }
+
+  // load balance of the last round, in work units per thread
+  unsigned numT = galois::getActiveThreads();
+  uint64_t maxW = 0;
+  for (unsigned i = 0; i < numT; ++i) {
+    maxW = std::max(maxW, *busy.getRemote(i));
+  }
+  double imbalance = maxW * double(numT) / double(total);
+
+  double secs = timer.get() / 1000.0;
+  std::cout << loopname << ": " << timer.get() / rounds << " ms/loop, "
+            << (double(costs.size()) * rounds / secs) / 1e6
+            << " Miter/s, imbalance (max/avg work) " << imbalance
+            << " (sink " << sink.reduce() << ")\n";
+  galois::runtime::reportStat_Single(loopname, "Imbalance%",
+                                     uint64_t(imbalance * 100));
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url);
+
+  std::vector<uint32_t> costs = makeCosts();
+
+  if (schedule != Schedule::adaptiveChunk) {
+    run(costs, "FixedChunk", galois::steal(),
+        galois::chunk_size<32>(chunkSize));
+  }
+  if (schedule != Schedule::fixedChunk) {
+    run(costs, "AdaptiveChunk", galois::adaptive_chunk_size(),
+        galois::chunk_size<32>(chunkSize));
+  }
+
+  return 0;
+}
@@ -0,0 +1,68 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#include "DESordered.h"
+
+namespace des_ord {
+
+/**
+ * Same simulation as DESordered, but scheduled by the speculative ordered
+ * executor behind galois::for_each_ordered. Compare against DESorderedSerial
+ * and DESunordered.
+ */
+class DESkdg : public DESordered {
+protected:
+  virtual std::string getVersion() const {
+    return "Speculative KDG executor (for_each_ordered)";
+  }
+
+  virtual void runLoop(const SimInit_ty& simInit, Graph& graph) {
+
+    for (std::vector<Event_ty>::const_iterator
+             e    = simInit.getInitEvents().begin(),
+             ende = simInit.getInitEvents().end();
+         e != ende; ++e) {
+
+      SimObjInfo& sinfo = sobjInfoVec[e->getRecvObj()->getID()];
+      sinfo.recv(*e);
+    }
+
+    AddList_ty newEvents;
+    Accumulator_ty nevents;
+
+    galois::for_each_ordered(simInit.getInitEvents().begin(),
+                             simInit.getInitEvents().end(), Cmp_ty(),
+                             NhoodVisitor(graph, sobjInfoVec),
+                             OpFunc(graph, sobjInfoVec, newEvents, nevents),
+                             ReadyTest(sobjInfoVec), "des_kdg_loop");
+
+    std::cout << "Number of events processed= " << nevents.reduce()
+              << std::endl;
+  }
+};
+
+} // namespace des_ord
+
+int main(int argc, char* argv[]) {
+
+  des_ord::DESkdg s;
+  s.run(argc, argv);
+  return 0;
+}
@@ -125,7 +125,7 @@ struct SimObjInfo : public TypeHelper<> {
 
 class DESordered : public des::AbstractMain<TypeHelper<>::SimInit_ty>,
                    public TypeHelper<> {
-
+protected:
   struct NhoodVisitor {
     typedef int tt_has_fixed_neighborhood;
 
@@ -0,0 +1,216 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2019, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#include "galois/Galois.h"
+#include "galois/Reduction.h"
+#include "galois/Timer.h"
+#include "galois/UnionFind.h"
+#include "galois/graphs/LCGraph.h"
+#include "galois/runtime/Context.h"
+#include "Lonestar/BoilerPlate.h"
+#include "llvm/Support/CommandLine.h"
+
+#include <algorithm>
+#include <vector>
+
+constexpr static const char* const REGION_NAME = "KruskalKDG";
+
+namespace cll = llvm::cl;
+
+enum Algo { serial = 0, det, kdg };
+
+static cll::opt<std::string> inputFilename(cll::Positional,
+                                           cll::desc("<input file>"),
+                                           cll::Required);
+
+static cll::opt<Algo>
+    algo("algo", cll::desc("Choose an algorithm (default kdg):"),
+         cll::values(clEnumVal(serial, "Serial union-find"),
+                     clEnumVal(det, "Deterministic window executor (for_each)"),
+                     clEnumVal(kdg, "Speculative ordered executor "
+                                    "(for_each_ordered)"),
+                     clEnumValEnd),
+         cll::init(kdg));
+
+using Graph = galois::graphs::LC_CSR_Graph<unsigned, int>::with_no_lockable<
+    true>::type;
+using GNode = Graph::GraphNode;
+
+struct UFNode : public galois::UnionFindNode<UFNode>,
+                public galois::runtime::Lockable {
+  UFNode() : galois::UnionFindNode<UFNode>(this) {}
+};
+
+struct Edge {
+  GNode src;
+  GNode dst;
+  int weight;
+};
+
+struct EdgeCmp {
+  bool operator()(const Edge& a, const Edge& b) const {
+    if (a.weight != b.weight)
+      return a.weight < b.weight;
+    if (a.src != b.src)
+      return a.src < b.src;
+    return a.dst < b.dst;
+  }
+};
+
+using WeightAccum = galois::GAccumulator<size_t>;
+
+/**
+ * Acquire the representatives of both endpoints. Finds compress concurrently
+ * but never link, so reps are stable until the operator runs.
+ */
+struct FindReps {
+  std::vector<UFNode>& nodes;
+
+  void operator()(const Edge& e, galois::UserContext<Edge>&) const {
+    UFNode* r1 = nodes[e.src].findAndCompress();
+    UFNode* r2 = nodes[e.dst].findAndCompress();
+    galois::runtime::acquire(r1, galois::MethodFlag::WRITE);
+    galois::runtime::acquire(r2, galois::MethodFlag::WRITE);
+  }
+};
+
+struct LinkUp {
+  std::vector<UFNode>& nodes;
+  WeightAccum& weight;
+  WeightAccum& mstEdges;
+
+  void operator()(const Edge& e, galois::UserContext<Edge>&) const {
+    if (nodes[e.src].merge(&nodes[e.dst])) {
+      weight += e.weight;
+      mstEdges += 1;
+    }
+  }
+};
+
+void runSerial(std::vector<Edge>& edges, std::vector<UFNode>& nodes,
+               WeightAccum& weight, WeightAccum& mstEdges) {
+  for (const Edge& e : edges) {
+    if (nodes[e.src].merge(&nodes[e.dst])) {
+      weight += e.weight;
+      mstEdges += 1;
+    }
+  }
+}
+
+void runDet(std::vector<Edge>& edges, std::vector<UFNode>& nodes,
+            WeightAccum& weight, WeightAccum& mstEdges) {
+  // Deterministic ids follow priority order, but the window manager only
+  // orders items inside a window, so the result is a spanning forest that
+  // need not be minimal
+  auto detID = [&edges](const Edge& e) -> uintptr_t {
+    return std::lower_bound(edges.begin(), edges.end(), e, EdgeCmp()) -
+           edges.begin();
+  };
+
+  galois::for_each(galois::iterate(edges),
+                   [&](const Edge& e, auto& ctx) {
+                     FindReps{nodes}(e, ctx);
+                     ctx.cautiousPoint();
+                     LinkUp{nodes, weight, mstEdges}(e, ctx);
+                   },
+                   galois::no_pushes(),
+                   galois::wl<galois::worklists::Deterministic<>>(),
+                   galois::det_id<decltype(detID)>(detID),
+                   galois::loopname("KruskalDet"));
+}
+
+void runKDG(std::vector<Edge>& edges, std::vector<UFNode>& nodes,
+            WeightAccum& weight, WeightAccum& mstEdges) {
+  galois::for_each_ordered(edges.begin(), edges.end(), EdgeCmp(),
+                           FindReps{nodes}, LinkUp{nodes, weight, mstEdges},
+                           "KruskalKDG");
+}
+
+constexpr static const char* const name = "Kruskal ordered benchmark";
+constexpr static const char* const desc =
+    "Computes a minimum spanning forest with the serial, deterministic and "
+    "speculative ordered executors";
+constexpr static const char* const url = 0;
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url);
+
+  galois::StatTimer totalTimer("TotalTime", REGION_NAME);
+  totalTimer.start();
+
+  Graph graph;
+  galois::graphs::readGraph(graph, inputFilename);
+
+  std::vector<Edge> edges;
+  for (GNode n : graph) {
+    for (auto ii : graph.edges(n)) {
+      GNode dst = graph.getEdgeDst(ii);
+      if (n < dst)
+        edges.push_back(Edge{n, dst, graph.getEdgeData(ii)});
+    }
+  }
+  std::sort(edges.begin(), edges.end(), EdgeCmp());
+
+  std::vector<UFNode> nodes(graph.size());
+  WeightAccum weight;
+  WeightAccum mstEdges;
+
+  galois::StatTimer execTime("Timer_0");
+  execTime.start();
+  switch (algo) {
+  case serial:
+    runSerial(edges, nodes, weight, mstEdges);
+    break;
+  case det:
+    runDet(edges, nodes, weight, mstEdges);
+    break;
+  case kdg:
+    runKDG(edges, nodes, weight, mstEdges);
+    break;
+  default:
+    GALOIS_DIE("Unknown algorithm");
+  }
+  execTime.stop();
+
+  galois::runtime::reportStat_Single(REGION_NAME, "MSTWeight", weight.reduce());
+  galois::runtime::reportStat_Single(REGION_NAME, "MSTEdges",
+                                     mstEdges.reduce());
+  galois::gPrint("MST weight: ", weight.reduce(), " (", mstEdges.reduce(),
+                 " edges)\n");
+
+  if (!skipVerify && algo != serial) {
+    std::vector<UFNode> check(graph.size());
+    WeightAccum checkWeight;
+    WeightAccum checkEdges;
+    runSerial(edges, check, checkWeight, checkEdges);
+    if (checkWeight.reduce() != weight.reduce()) {
+      galois::gPrint("Weight differs from serial: ", checkWeight.reduce(),
+                     "\n");
+      if (algo == kdg)
+        GALOIS_DIE("Verification failed");
+    } else {
+      galois::gPrint("Verification successful.\n");
+    }
+  }
+
+  totalTimer.stop();
+  return 0;
+}
@@ -23,7 +23,10 @@
 #include "galois/substrate/PerThreadStorage.h"
 #include "galois/gstl.h"
 
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <unordered_map>
 
 namespace {
 
@@ -94,6 +97,17 @@ GNode TwoHopMatcher(GNode node, GGraph* graph) {
 
 typedef galois::GAccumulator<unsigned> Pcounter;
 
+//! Scratch space shared by all coarsening levels instead of being
+//! reallocated for each one
+struct CoarsenScratch {
+  typedef galois::gstl::Vector<std::pair<GNode, unsigned>> VecTy;
+  typedef std::unordered_map<GNode, unsigned> SlotMap;
+  galois::substrate::PerThreadStorage<VecTy> edges;
+  //! position of each destination in edges
+  galois::substrate::PerThreadStorage<SlotMap> slots;
+  GNodeBag loners;
+};
+
 /*
  *This function is responsible for matching.
  1. There are two types of matching. Random and Heavy Edge matching
@@ -104,6 +118,11 @@ typedef galois::GAccumulator<unsigned> Pcounter;
  4. This function can also create the multinode, i.e. the node which is created
  on combining two matched nodes.
  5. You can enable/disable 4th by changing variantMetis::mergeMatching
+
+ Matching is lock-free: a node is claimed with a CAS on its matched flag
+ instead of acquiring the node lock, so the loop never aborts. An iteration
+ claims its own node before the partner; the claim on its own node is only
+ released by that same iteration, so no node is lost to a failed race.
 */
 template <MatchingPolicy matcher, typename WL>
 void parallelMatchAndCreateNodes(MetisGraph* graph, Pcounter& pc,
@@ -111,67 +130,58 @@ void parallelMatchAndCreateNodes(MetisGraph* graph, Pcounter& pc,
   GGraph* fineGGraph   = graph->getFinerGraph()->getGraph();
   GGraph* coarseGGraph = graph->getGraph();
   assert(fineGGraph != coarseGGraph);
+  constexpr auto flag = galois::MethodFlag::UNPROTECTED;
 
   galois::for_each(
       galois::iterate(*fineGGraph),
       [&](GNode item, galois::UserContext<GNode>& lwl) {
-        if (fineGGraph->getData(item).isMatched())
+        MetisNode& itemData = fineGGraph->getData(item, flag);
+        if (itemData.isMatched())
           return;
 
-        if (fineGGraph->edge_begin(item, galois::MethodFlag::UNPROTECTED) ==
-            fineGGraph->edge_end(item, galois::MethodFlag::UNPROTECTED)) {
+        if (fineGGraph->edge_begin(item, flag) ==
+            fineGGraph->edge_end(item, flag)) {
           noEdgeBag.push(item);
           return;
         }
 
+        if (!itemData.tryMatch())
+          return; // taken as someone else's partner
+
         GNode ret;
-        do {
+        while (true) {
           ret = matcher(item, fineGGraph);
-          // lock ret, since we found it lock-free it may be matched, so try
-          // again
-        } while (fineGGraph->getData(ret).isMatched());
-
-        // at this point both ret and item (and failed matches) are locked.
-        // We do not leave the above loop until we both have the lock on
-        // the node and check the matched status of the locked node.  the
-        // lock before (final) read ensures that we will see any write to
-        // matched
-
-        unsigned numEdges = std::distance(
-            fineGGraph->edge_begin(item, galois::MethodFlag::UNPROTECTED),
-            fineGGraph->edge_end(item, galois::MethodFlag::UNPROTECTED));
-        // assert(numEdges == std::distance(fineGGraph->edge_begin(item),
-        // fineGGraph->edge_end(item)));
+          // the candidate was found without synchronization and may have
+          // been claimed since; a failed claim is seen by the next search
+          if (ret == item || fineGGraph->getData(ret, flag).tryMatch())
+            break;
+        }
+
+        unsigned numEdges = std::distance(fineGGraph->edge_begin(item, flag),
+                                          fineGGraph->edge_end(item, flag));
 
         GNode N;
         if (ret != item) {
           // match found
-          numEdges += std::distance(
-              fineGGraph->edge_begin(ret, galois::MethodFlag::UNPROTECTED),
-              fineGGraph->edge_end(ret, galois::MethodFlag::UNPROTECTED));
-          // Cautious point
-          N = coarseGGraph->createNode(numEdges,
-                                       fineGGraph->getData(item).getWeight() +
-                                           fineGGraph->getData(ret).getWeight(),
-                                       item, ret);
-          fineGGraph->getData(item).setMatched();
-          fineGGraph->getData(ret).setMatched();
-          fineGGraph->getData(item).setParent(N);
-          fineGGraph->getData(ret).setParent(N);
-        } else {
-          // assertAllMatched(item, fineGGraph);
-          // Cautious point
+          MetisNode& retData = fineGGraph->getData(ret, flag);
+          numEdges += std::distance(fineGGraph->edge_begin(ret, flag),
+                                    fineGGraph->edge_end(ret, flag));
+          N = coarseGGraph->createNode(
+              numEdges, itemData.getWeight() + retData.getWeight(), item, ret);
+          itemData.setParent(N);
+          retData.setParent(N);
+        } else if (selfMatch) {
           // no match
-          if (selfMatch) {
-            pc.update(1U);
-            N = coarseGGraph->createNode(
-                numEdges, fineGGraph->getData(item).getWeight(), item);
-            fineGGraph->getData(item).setMatched();
-            fineGGraph->getData(item).setParent(N);
-          }
+          pc.update(1U);
+          N = coarseGGraph->createNode(numEdges, itemData.getWeight(), item);
+          itemData.setParent(N);
+        } else {
+          // left for the two hop pass
+          itemData.unMatch();
         }
       },
-      galois::wl<WL>(), galois::no_pushes(), galois::loopname("match"));
+      galois::wl<WL>(), galois::no_pushes(), galois::no_conflicts(),
+      galois::loopname("match"));
 }
 
 /*
@@ -179,14 +189,12 @@ void parallelMatchAndCreateNodes(MetisGraph* graph, Pcounter& pc,
  * between matched nodes and populate the edges in the coarser graph
  * node.
  */
-void createCoarseEdges(MetisGraph* graph) {
+void createCoarseEdges(MetisGraph* graph, CoarsenScratch& scratch) {
   GGraph* coarseGGraph = graph->getGraph();
   GGraph* fineGGraph   = graph->getFinerGraph()->getGraph();
   assert(fineGGraph != coarseGGraph);
 
-  typedef galois::gstl::Vector<std::pair<GNode, unsigned>> VecTy;
-  typedef galois::substrate::PerThreadStorage<VecTy> ThreadLocalData;
-  ThreadLocalData edgesThreadLocal;
+  auto& edgesThreadLocal = scratch.edges;
 
   galois::do_all(
       galois::iterate(*coarseGGraph),
@@ -197,36 +205,54 @@ void createCoarseEdges(MetisGraph* graph) {
             coarseGGraph->getData(node, galois::MethodFlag::UNPROTECTED);
 
         auto& edges = *edgesThreadLocal.getLocal();
+        auto& slots = *scratch.slots.getLocal();
         edges.clear();
+        size_t fineEdges = 0;
+        for (unsigned x = 0; x < nodeData.numChildren(); ++x)
+          fineEdges += std::distance(
+              fineGGraph->edge_begin(nodeData.getChild(x),
+                                     galois::MethodFlag::UNPROTECTED),
+              fineGGraph->edge_end(nodeData.getChild(x),
+                                   galois::MethodFlag::UNPROTECTED));
+        // short lists are searched, long ones (hubs) go through slots
+        bool useSlots = fineEdges > 32;
         for (unsigned x = 0; x < nodeData.numChildren(); ++x) {
           for (auto ii : fineGGraph->edges(nodeData.getChild(x),
                                            galois::MethodFlag::UNPROTECTED)) {
             GNode dst = fineGGraph->getEdgeDst(ii);
             GNode p = fineGGraph->getData(dst, galois::MethodFlag::UNPROTECTED)
                           .getParent();
-            edges.emplace_back(p, fineGGraph->getEdgeData(
-                                      ii, galois::MethodFlag::UNPROTECTED));
+            if (p == node) // no self edges
+              continue;
+            unsigned weight =
+                fineGGraph->getEdgeData(ii, galois::MethodFlag::UNPROTECTED);
+            // merge parallel edges; without this hubs keep all of their
+            // edges and coarse levels of skewed graphs barely shrink
+            auto pos = edges.end();
+            if (useSlots) {
+              auto slot = slots.emplace(p, edges.size());
+              if (!slot.second)
+                pos = edges.begin() + slot.first->second;
+            } else {
+              pos = std::find_if(edges.begin(), edges.end(),
+                                 [p](const std::pair<GNode, unsigned>& e) {
+                                   return e.first == p;
+                                 });
+            }
+            if (pos == edges.end())
+              edges.emplace_back(p, weight);
+            else
+              pos->second += weight;
           }
         }
 
-        // slightly faster not ordering by edge weight
-        // std::sort(edges.begin(), edges.end(), [] (const std::pair<GNode,
-        // unsigned>& lhs, const std::pair<GNode, unsigned>& rhs) { return
-        // lhs.first < rhs.first; } );
-
-        // insert edges
-        for (auto pp = edges.begin(), ep = edges.end(); pp != ep;) {
-          GNode dst    = pp->first;
-          unsigned sum = pp->second;
-          ++pp;
-          if (node != dst) { // no self edges
-            while (pp != ep && pp->first == dst) {
-              sum += pp->second;
-              ++pp;
-            }
-            coarseGGraph->addMultiEdge(node, dst,
-                                       galois::MethodFlag::UNPROTECTED, sum);
-          }
+        // insert edges in first seen order
+        for (auto& e : edges) {
+          coarseGGraph->addMultiEdge(node, e.first,
+                                     galois::MethodFlag::UNPROTECTED, e.second);
+          // erase instead of clear: clear touches every bucket
+          if (useSlots)
+            slots.erase(e.first);
         }
         //    assert(e);
         // nodeData.setNumEdges(e);
@@ -309,8 +335,8 @@ unsigned fixupLoners(GNodeBag& b, GGraph* coarseGGraph, GGraph* fineGGraph) {
   return count;
 }
 
-unsigned findMatching(MetisGraph* coarseMetisGraph, bool useRM, bool use2Hop,
-                      bool verbose) {
+unsigned findMatching(MetisGraph* coarseMetisGraph, CoarsenScratch& scratch,
+                      bool useRM, bool use2Hop, bool verbose) {
   MetisGraph* fineMetisGraph = coarseMetisGraph->getFinerGraph();
 
   /*
@@ -321,7 +347,8 @@ unsigned findMatching(MetisGraph* coarseMetisGraph, bool useRM, bool use2Hop,
   // typedef
   // galois::worklists::LazyIter<decltype(fineGGraph->local_begin()),false> WL;
 
-  GNodeBag bagOfLoners;
+  GNodeBag& bagOfLoners = scratch.loners;
+  bagOfLoners.clear();
   Pcounter pc;
 
   bool useOBIM = true;
@@ -374,23 +401,28 @@ unsigned findMatching(MetisGraph* coarseMetisGraph, bool useRM, bool use2Hop,
   return pc.reduce();
 }
 
-MetisGraph* coarsenOnce(MetisGraph* fineMetisGraph, unsigned& rem, bool useRM,
+MetisGraph* coarsenOnce(MetisGraph* fineMetisGraph, CoarsenScratch& scratch,
+                        unsigned level, unsigned& rem, bool useRM,
                         bool with2Hop, bool verbose) {
   MetisGraph* coarseMetisGraph = new MetisGraph(fineMetisGraph);
   galois::Timer t, t2;
+  t.start();
+  rem = findMatching(coarseMetisGraph, scratch, useRM, with2Hop, verbose);
+  t.stop();
   if (verbose)
-    t.start();
-  rem = findMatching(coarseMetisGraph, useRM, with2Hop, verbose);
-  if (verbose) {
-    t.stop();
     std::cout << "\n\tTime Matching " << t.get() << "\n";
-    t2.start();
-  }
-  createCoarseEdges(coarseMetisGraph);
-  if (verbose) {
-    t2.stop();
+  t2.start();
+  createCoarseEdges(coarseMetisGraph, scratch);
+  t2.stop();
+  if (verbose)
     std::cout << "\tTime Creating " << t2.get() << "\n";
-  }
+
+  std::string suffix = "_" + std::to_string(level);
+  galois::runtime::reportStat_Single("Coarsen", "MatchTime" + suffix, t.get());
+  galois::runtime::reportStat_Single("Coarsen", "CreateTime" + suffix,
+                                     t2.get());
+  galois::runtime::reportStat_Single("Coarsen", "Nodes" + suffix,
+                                     coarseMetisGraph->getNumNodes());
   return coarseMetisGraph;
 }
 
@@ -404,13 +436,16 @@ MetisGraph* coarsen(MetisGraph* fineMetisGraph, unsigned coarsenTo,
   unsigned iterNum        = 0;
   bool with2Hop           = false;
   unsigned stat           = 0;
+  CoarsenScratch scratch;
   while (true) { // overflow
     if (verbose) {
       std::cout << "Coarsening " << iterNum << "\t";
       stat = graphStat(*coarseGraph->getGraph());
     }
     unsigned rem     = 0;
-    coarseGraph      = coarsenOnce(coarseGraph, rem, false, with2Hop, verbose);
+    coarseGraph =
+        coarsenOnce(coarseGraph, scratch, iterNum + 1, rem, false, with2Hop,
+                    verbose);
     unsigned newSize = size / 2 + rem / 2;
     if (verbose) {
       std::cout << "\tTO\t";
@@ -52,6 +52,7 @@ static cll::opt<refinementMode> refineMode(
     cll::desc("Choose a refinement mode:"),
     cll::values(clEnumVal(BKL, "BKL"), clEnumVal(BKL2, "BKL2 (default)"),
                 clEnumVal(ROBO, "ROBO"), clEnumVal(GRACLUS, "GRACLUS"),
+                clEnumVal(KWAY, "KWAY (label propagation + FM)"),
                 clEnumValEnd),
     cll::init(BKL2));
 
@@ -67,6 +68,11 @@ static cll::opt<bool>
             cll::init(false));
 static cll::opt<std::string> outfile("output",
                                      cll::desc("output partition file name"));
+static cll::opt<std::string>
+    cecOutfile("cecOutput",
+               cll::desc("output partition file name in the binary "
+                         "vertexIDMap format of the distributed cec "
+                         "partitioner"));
 static cll::opt<std::string>
     orderedfile("ordered", cll::desc("output ordered graph file name"));
 static cll::opt<std::string>
@@ -131,6 +137,9 @@ void Partition(MetisGraph* metisGraph, unsigned nparts) {
     case GRACLUS:
       std::cout << "Sorting refinnement with GRACLUS\n";
       break;
+    case KWAY:
+      std::cout << "Sorting refinnement with KWAY\n";
+      break;
     default:
       abort();
     }
@@ -222,6 +231,19 @@ int main(int argc, char** argv) {
     }
   }
 
+  // graph iterates nodes in file order, so entry i is the part of node i
+  if (cecOutfile != "") {
+    std::vector<int32_t> hostOf;
+    hostOf.reserve(metisGraph.getNumNodes());
+    for (auto n : graph)
+      hostOf.push_back(graph.getData(n).getPart());
+    std::ofstream outFile(cecOutfile.c_str(), std::ios::binary);
+    outFile.write(reinterpret_cast<const char*>(hostOf.data()),
+                  hostOf.size() * sizeof(int32_t));
+    if (!outFile)
+      GALOIS_DIE("failed to write ", cecOutfile);
+  }
+
   if (orderedfile != "" || permutationfile != "") {
     galois::graphs::FileGraph g;
     g.fromFile(filename);
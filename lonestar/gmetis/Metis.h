@@ -29,13 +29,13 @@ using GNodeBag = galois::InsertBag<GNode>;
 
 // algorithms
 enum InitialPartMode { GGP, GGGP, MGGGP };
-enum refinementMode { BKL, BKL2, ROBO, GRACLUS };
+enum refinementMode { BKL, BKL2, ROBO, GRACLUS, KWAY };
 // Nodes in the metis graph
 class MetisNode {
 
   struct coarsenData {
-    int matched : 1;
-    int failedmatch : 1;
+    unsigned matched; // claimed with CAS during lock-free matching
+    bool failedmatch;
     GNode parent;
   };
   struct refineData {
@@ -93,6 +93,12 @@ public:
 
   void setMatched() { data.cd.matched = true; }
   bool isMatched() const { return data.cd.matched; }
+  //! Atomically claims an unmatched node; returns false if already claimed
+  bool tryMatch() {
+    return __sync_bool_compare_and_swap(&data.cd.matched, 0u, 1u);
+  }
+  //! Releases a claim taken with tryMatch
+  void unMatch() { data.cd.matched = false; }
 
   void setFailedMatch() { data.cd.failedmatch = true; }
   bool isFailedMatch() const { return data.cd.failedmatch; }
@@ -102,6 +108,11 @@ public:
 
   unsigned getPart() const { return data.rd.partition; }
   void setPart(unsigned val) { data.rd.partition = val; }
+  //! Atomically moves the node from part from to part to; returns false if
+  //! the node is no longer in part from
+  bool casPart(unsigned from, unsigned to) {
+    return __sync_bool_compare_and_swap(&data.rd.partition, from, to);
+  }
 
   int getOldPart() const { return data.rd.oldPartition; }
   void OldPartCpyNew() { data.rd.oldPartition = data.rd.partition; }
@@ -111,6 +122,10 @@ public:
 
   void setLocked(bool locked) { pd.locked = locked; }
   bool isLocked() { return pd.locked; }
+  //! Atomically locks an unlocked node; returns false if already locked
+  bool tryLock() {
+    return __sync_bool_compare_and_swap(&pd.locked, false, true);
+  }
 
 private:
   union {
@@ -136,6 +151,11 @@ public:
     finer->coarser = this;
   }
 
+  ~MetisGraph() {
+    if (finer)
+      finer->coarser = 0;
+  }
+
   const GGraph* getGraph() const { return &graph; }
   GGraph* getGraph() { return &graph; }
   MetisGraph* getFinerGraph() const { return finer; }
@@ -207,6 +227,8 @@ std::vector<partInfo> partition(MetisGraph* coarseMetisGraph,
 std::vector<partInfo> BisectAll(MetisGraph* mcg, unsigned numPartitions,
                                 unsigned maxSize);
 // Refinement
+// Coarse levels are freed as soon as the partition has been projected past
+// them
 void refine(MetisGraph* coarseGraph, std::vector<partInfo>& parts,
             unsigned minSize, unsigned maxSize, refinementMode refM,
             bool verbose);
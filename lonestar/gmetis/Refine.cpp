@@ -23,6 +23,8 @@
 #include "Metis.h"
 #include <set>
 #include <iostream>
+#include <limits>
+#include <string>
 
 namespace {
 
@@ -381,6 +383,320 @@ void GraclusRefining(GGraph* graph, int nbParti, int nbIter) {
   std::cout<<std::endl;*/
 }
 
+/*
+ * Parallel k-way refinement: a few rounds of label propagation over the
+ * boundary followed by one localized FM pass. Label propagation moves nodes
+ * with positive gain, alternating between moves towards higher and lower
+ * part ids so two neighbors do not swap parts in the same round. The FM pass
+ * starts a local search from each boundary node, pulls the best move from
+ * per-thread gain buckets, also takes negative gain moves and rolls back to
+ * the best prefix. Part weights are reserved atomically, so the balance
+ * constraint holds throughout. All scratch space is reused across levels.
+ */
+
+const unsigned kwayLPRounds = 4;
+//! Moves without improvement after which a local FM search gives up
+const unsigned kwayFMStall = 16;
+
+//! Max-priority queue of nodes keyed by gain. Gains are binned on a log
+//! scale so coarse levels with heavy edges need few buckets; order within a
+//! bucket is LIFO.
+class GainBuckets {
+  static const int NUM_BUCKETS = 67;
+  std::vector<galois::gstl::Vector<std::pair<GNode, int>>> buckets;
+  int top;
+
+public:
+  static int bucketOf(int gain) {
+    unsigned mag = gain < 0 ? -(unsigned)gain : gain;
+    int lg       = mag ? 32 - __builtin_clz(mag) : 0;
+    return gain < 0 ? 33 - lg : 33 + lg;
+  }
+
+  GainBuckets() : buckets(NUM_BUCKETS), top(-1) {}
+
+  bool empty() const { return top < 0; }
+
+  void push(GNode n, int gain) {
+    int b = bucketOf(gain);
+    buckets[b].emplace_back(n, gain);
+    top = std::max(top, b);
+  }
+
+  std::pair<GNode, int> pop() {
+    auto retval = buckets[top].back();
+    buckets[top].pop_back();
+    while (top >= 0 && buckets[top].empty())
+      --top;
+    return retval;
+  }
+
+  void clear() {
+    for (; top >= 0; --top)
+      buckets[top].clear();
+  }
+};
+
+//! Connectivity of one node to each part; only touched entries are reset
+struct PartConnectivity {
+  std::vector<int> conn;
+  std::vector<unsigned> touched;
+
+  void add(unsigned part, int weight) {
+    if (!conn[part])
+      touched.push_back(part);
+    conn[part] += weight;
+  }
+
+  void clear(unsigned nparts) {
+    if (conn.size() != nparts)
+      conn.assign(nparts, 0);
+    for (unsigned p : touched)
+      conn[p] = 0;
+    touched.clear();
+  }
+};
+
+struct KWayThreadData {
+  PartConnectivity pc;
+  GainBuckets buckets;
+  std::vector<std::pair<GNode, unsigned>> moves;
+  //! Nodes locked by this thread's FM searches; released after the pass
+  std::vector<GNode> locked;
+};
+
+struct KWayScratch {
+  galois::substrate::PerThreadStorage<KWayThreadData> threadData;
+  GNodeBag bags[2];
+};
+
+struct KWayRefiner {
+  GGraph& g;
+  std::vector<partInfo>& parts;
+  unsigned minSize;
+  unsigned maxSize;
+  static constexpr galois::MethodFlag flag = galois::MethodFlag::UNPROTECTED;
+
+  /**
+   * Finds the part n gains most by moving to. dir > 0 (< 0) only allows
+   * parts with a higher (lower) id. Unless allowNegative is set or the part
+   * of n is overweight, only positive gains are considered.
+   *
+   * @returns the part of n if there is no admissible move
+   */
+  unsigned bestMove(GNode n, PartConnectivity& pc, int dir, bool allowNegative,
+                    int& gain, bool& boundary) {
+    MetisNode& nd = g.getData(n, flag);
+    unsigned P    = nd.getPart();
+    pc.clear(parts.size());
+    for (auto ii : g.edges(n, flag))
+      pc.add(g.getData(g.getEdgeDst(ii), flag).getPart(),
+             g.getEdgeData(ii, flag));
+
+    boundary   = pc.touched.size() > (pc.conn[P] ? 1 : 0);
+    unsigned w = nd.getWeight();
+    bool overweight = parts[P].partWeight > maxSize;
+    if (!boundary || (!overweight && parts[P].partWeight < minSize + w))
+      return P;
+
+    unsigned best = P;
+    int bestGain  = (allowNegative || overweight)
+                       ? std::numeric_limits<int>::min()
+                       : 0;
+    for (unsigned p : pc.touched) {
+      if (p == P || (dir > 0 && p < P) || (dir < 0 && p > P) ||
+          parts[p].partWeight + w > maxSize)
+        continue;
+      int pg = pc.conn[p] - pc.conn[P];
+      // zero gain moves are taken when they make the parts more even
+      if (pg > bestGain ||
+          (pg == bestGain &&
+           parts[p].partWeight + w < (best == P ? parts[P].partWeight
+                                                : parts[best].partWeight))) {
+        bestGain = pg;
+        best     = p;
+      }
+    }
+    gain = bestGain;
+    return best;
+  }
+
+  //! Moves n if the target part still has room and n has not moved since
+  bool tryMove(GNode n, unsigned from, unsigned to) {
+    MetisNode& nd = g.getData(n, flag);
+    unsigned w    = nd.getWeight();
+    if (__sync_add_and_fetch(&parts[to].partWeight, w) > maxSize ||
+        !nd.casPart(from, to)) {
+      __sync_fetch_and_sub(&parts[to].partWeight, w);
+      return false;
+    }
+    __sync_fetch_and_sub(&parts[from].partWeight, w);
+    return true;
+  }
+
+  //! Moves n without checking the balance; used to undo FM moves. n must be
+  //! locked by the caller, so no other search moves it concurrently.
+  void forceMove(GNode n, unsigned from, unsigned to) {
+    MetisNode& nd = g.getData(n, flag);
+    unsigned w    = nd.getWeight();
+    nd.setPart(to);
+    __sync_fetch_and_add(&parts[to].partWeight, w);
+    __sync_fetch_and_sub(&parts[from].partWeight, w);
+  }
+
+  //! One label propagation sweep over cur; fills next with the nodes that
+  //! are still on the boundary
+  unsigned propagate(GNodeBag& cur, GNodeBag& next, int dir,
+                     KWayScratch& scratch) {
+    galois::GAccumulator<unsigned> moved;
+    next.clear();
+    galois::do_all(
+        galois::iterate(cur),
+        [&](GNode n) {
+          auto& td = *scratch.threadData.getLocal();
+          int gain;
+          bool boundary;
+          unsigned P  = g.getData(n, flag).getPart();
+          unsigned to = bestMove(n, td.pc, dir, false, gain, boundary);
+          if (to != P && tryMove(n, P, to)) {
+            moved += 1;
+            boundary = true;
+            for (auto ii : g.edges(n, flag)) {
+              GNode neigh = g.getEdgeDst(ii);
+              auto& ned   = g.getData(neigh, flag);
+              if (!ned.getmaybeBoundary()) {
+                ned.setmaybeBoundary(true);
+                next.push(neigh);
+              }
+            }
+          }
+          if (boundary)
+            next.push(n);
+        },
+        galois::steal(), galois::loopname("refineLP"));
+    return moved.reduce();
+  }
+
+  //! Local FM search from seed; returns the number of moves kept
+  unsigned localFM(GNode seed, KWayThreadData& td) {
+    int gain;
+    bool boundary;
+    if (g.getData(seed, flag).isLocked())
+      return 0;
+    unsigned P = g.getData(seed, flag).getPart();
+    if (bestMove(seed, td.pc, 0, true, gain, boundary) == P || gain < 0)
+      return 0;
+
+    td.buckets.clear();
+    td.moves.clear();
+    td.buckets.push(seed, gain);
+    int total = 0, best = 0;
+    size_t bestLen = 0;
+    unsigned stall = 0;
+    while (!td.buckets.empty() && stall < kwayFMStall) {
+      auto item     = td.buckets.pop();
+      GNode n       = item.first;
+      MetisNode& nd = g.getData(n, flag);
+      if (nd.isLocked())
+        continue;
+      P           = nd.getPart();
+      unsigned to = bestMove(n, td.pc, 0, true, gain, boundary);
+      if (to == P)
+        continue;
+      if (GainBuckets::bucketOf(gain) < GainBuckets::bucketOf(item.second)) {
+        // gain went down since n was queued
+        td.buckets.push(n, gain);
+        continue;
+      }
+      if (!nd.tryLock())
+        continue;
+      if (!tryMove(n, P, to)) {
+        nd.setLocked(false);
+        continue;
+      }
+      td.locked.push_back(n);
+      td.moves.emplace_back(n, P);
+      total += gain;
+      if (total > best) {
+        best    = total;
+        bestLen = td.moves.size();
+        stall   = 0;
+      } else {
+        ++stall;
+      }
+      for (auto ii : g.edges(n, flag)) {
+        GNode neigh = g.getEdgeDst(ii);
+        if (g.getData(neigh, flag).isLocked())
+          continue;
+        unsigned np = g.getData(neigh, flag).getPart();
+        if (bestMove(neigh, td.pc, 0, true, gain, boundary) != np)
+          td.buckets.push(neigh, gain);
+      }
+    }
+
+    // roll back to the best prefix; an undo may not fail on balance, or the
+    // partition would not be the one the gains were computed for. Moved nodes
+    // stay locked until the end of the pass.
+    for (size_t i = td.moves.size(); i > bestLen; --i) {
+      GNode n = td.moves[i - 1].first;
+      forceMove(n, g.getData(n, flag).getPart(), td.moves[i - 1].second);
+    }
+    return bestLen;
+  }
+
+  unsigned fm(GNodeBag& seeds, KWayScratch& scratch) {
+    galois::GAccumulator<unsigned> moved;
+    galois::do_all(
+        galois::iterate(seeds),
+        [&](GNode n) { moved += localFM(n, *scratch.threadData.getLocal()); },
+        galois::steal(), galois::loopname("refineFM"));
+    galois::on_each([&](unsigned, unsigned) {
+      auto& td = *scratch.threadData.getLocal();
+      for (GNode n : td.locked)
+        g.getData(n, flag).setLocked(false);
+      td.locked.clear();
+    });
+    return moved.reduce();
+  }
+};
+
+unsigned refine_KWay(unsigned minSize, unsigned maxSize, GGraph& cg,
+                     GGraph* fg, std::vector<partInfo>& parts,
+                     KWayScratch& scratch) {
+  KWayRefiner r{cg, parts, minSize, maxSize};
+  GNodeBag* cur  = &scratch.bags[0];
+  GNodeBag* next = &scratch.bags[1];
+  cur->clear();
+  findBoundary(*cur, cg);
+
+  unsigned moved = 0;
+  for (unsigned round = 0; round < kwayLPRounds && !cur->empty(); ++round) {
+    unsigned roundMoves = 0;
+    for (int dir : {1, -1}) {
+      roundMoves += r.propagate(*cur, *next, dir, scratch);
+      std::swap(cur, next);
+    }
+    moved += roundMoves;
+    if (!roundMoves)
+      break;
+  }
+  moved += r.fm(*cur, scratch);
+
+  if (fg) {
+    galois::do_all(
+        galois::iterate(cg),
+        [&](GNode n) {
+          auto& cn      = cg.getData(n, galois::MethodFlag::UNPROTECTED);
+          bool boundary = cn.getmaybeBoundary() && isBoundary(cg, n);
+          for (unsigned x = 0; x < cn.numChildren(); ++x)
+            fg->getData(cn.getChild(x), galois::MethodFlag::UNPROTECTED)
+                .initRefine(cn.getPart(), boundary);
+        },
+        galois::loopname("projectKWay"));
+  }
+  return moved;
+}
+
 } // namespace
 
 void refine(MetisGraph* coarseGraph, std::vector<partInfo>& parts,
@@ -388,14 +704,19 @@ void refine(MetisGraph* coarseGraph, std::vector<partInfo>& parts,
             bool verbose) {
   MetisGraph* tGraph = coarseGraph;
   int nbIter         = 1;
-  if (refM == GRACLUS) {
-    while ((tGraph = tGraph->getFinerGraph()))
-      nbIter *= 2;
-    nbIter /= 4;
+  unsigned level     = 0;
+  while ((tGraph = tGraph->getFinerGraph())) {
+    nbIter *= 2;
+    ++level;
   }
+  nbIter /= 4;
+  KWayScratch kwayScratch;
   do {
     MetisGraph* fineGraph = coarseGraph->getFinerGraph();
     bool doProject        = true;
+    unsigned moved        = 0;
+    galois::Timer t;
+    t.start();
     if (verbose) {
       std::cout << "Cut " << computeCut(*coarseGraph->getGraph())
                 << " Weights ";
@@ -419,6 +740,12 @@ void refine(MetisGraph* coarseGraph, std::vector<partInfo>& parts,
       GraclusRefining(coarseGraph->getGraph(), parts.size(), nbIter);
       nbIter = (nbIter + 1) / 2;
       break;
+    case KWAY:
+      moved = refine_KWay(minSize, maxSize, *coarseGraph->getGraph(),
+                          fineGraph ? fineGraph->getGraph() : nullptr, parts,
+                          kwayScratch);
+      doProject = false;
+      break;
     default:
       abort();
     }
@@ -426,7 +753,20 @@ void refine(MetisGraph* coarseGraph, std::vector<partInfo>& parts,
     if (fineGraph && doProject) {
       projectPart(coarseGraph, parts);
     }
-  } while ((coarseGraph = coarseGraph->getFinerGraph()));
+    t.stop();
+
+    std::string suffix = "_" + std::to_string(level);
+    galois::runtime::reportStat_Single("Refine", "Time" + suffix, t.get());
+    if (refM == KWAY)
+      galois::runtime::reportStat_Single("Refine", "Moves" + suffix, moved);
+
+    // the partition now lives in the finer level; give this one's memory back
+    MetisGraph* done = coarseGraph;
+    coarseGraph      = fineGraph;
+    if (fineGraph)
+      delete done;
+    --level;
+  } while (coarseGraph);
 }
 
 /*
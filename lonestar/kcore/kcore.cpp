@@ -22,9 +22,16 @@
 #include "galois/Reduction.h"
 #include "galois/AtomicHelpers.h"
 #include "galois/graphs/LCGraph.h"
+#include "galois/substrate/PerThreadStorage.h"
 #include "Lonestar/BoilerPlate.h"
 #include "llvm/Support/CommandLine.h"
 
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <limits>
+#include <vector>
+
 constexpr static const char* const REGION_NAME = "k-core";
 
 /******************************************************************************/
@@ -32,7 +39,7 @@ constexpr static const char* const REGION_NAME = "k-core";
 /******************************************************************************/
 namespace cll = llvm::cl;
 
-enum Algo { Async = 0, Sync };
+enum Algo { Async = 0, Sync, Decompose };
 
 //! Input file: should be symmetric graph
 static cll::opt<std::string> inputFilename(cll::Positional,
@@ -43,12 +50,22 @@ static cll::opt<std::string> inputFilename(cll::Positional,
 static cll::opt<Algo> algo("algo",
     cll::desc("Choose an algorithm (default Sync):"),
     cll::values(clEnumVal(Async, "Asynchronous"), clEnumVal(Sync, "Synchronous"),
+                clEnumVal(Decompose, "Coreness of every node (-kcore is "
+                          "optional)"),
                 clEnumValEnd),
     cll::init(Sync));
 
-//! Required k specification for k-core
+//! k specification for k-core; required unless decomposing
 static cll::opt<unsigned int> k_core_num("kcore", cll::desc("k-core value"),
-                                         cll::Required);
+                                         cll::init(0));
+
+//! Output files of the decomposition
+static cll::opt<std::string> corenessFile("corenessFile",
+  cll::desc("Decompose: write the coreness of node i on line i"),
+  cll::init(""));
+static cll::opt<std::string> orderingFile("orderingFile",
+  cll::desc("Decompose: write the nodes in degeneracy order, one per line"),
+  cll::init(""));
 
 //! Flag that forces user to be aware that they should be passing in a
 //! symmetric graph
@@ -61,9 +78,11 @@ static cll::opt<bool> symmetricGraph("symmetricGraph",
 /* Graph structure declarations + other inits */
 /******************************************************************************/
 // Node deadness can be derived from current degree and k value, so no field
-// necessary
+// necessary. After a decomposition, currentDegree holds the coreness.
 struct NodeData {
   std::atomic<uint32_t> currentDegree;
+  //! Last peeling round that decremented the degree (decomposition only)
+  std::atomic<uint32_t> lastRound;
 };
 
 //! Typedef for graph used, CSR graph
@@ -75,6 +94,9 @@ using GNode = Graph::GraphNode;
 //! Chunksize for for_each worklist: best chunksize will depend on input
 constexpr static const unsigned CHUNK_SIZE = 64u;
 
+//! Number of degree buckets the decomposition keeps materialized at a time
+constexpr static const unsigned NUM_OPEN_BUCKETS = 128u;
+
 /******************************************************************************/
 /* Functions for running the algorithm */
 /******************************************************************************/
@@ -195,6 +217,305 @@ void asyncCascadeKCore(Graph& graph, galois::InsertBag<GNode>& initialWorklist)
   );
 }
 
+/**
+ * Degree buckets for the decomposition. Only the buckets in
+ * [windowBegin, windowBegin + NUM_OPEN_BUCKETS) are materialized; nodes with
+ * a larger degree wait in an overflow bag. Updates are lazy: a node whose
+ * degree drops is added to its new bucket without being removed from its old
+ * one, and stale entries are skipped when their bucket is read.
+ */
+class PeelingBuckets {
+  using Bag = galois::InsertBag<GNode>;
+
+  Graph& graph;
+  std::array<Bag, NUM_OPEN_BUCKETS> open;
+  Bag* overflow;
+  Bag* nextOverflow;
+  //! every node with a smaller degree has been peeled
+  uint32_t peeledBelow;
+
+public:
+  uint32_t windowBegin;
+
+  explicit PeelingBuckets(Graph& _graph)
+      : graph(_graph), overflow(new Bag), nextOverflow(new Bag),
+        peeledBelow(0), windowBegin(0) {
+    galois::do_all(
+      galois::iterate(graph.begin(), graph.end()),
+      [&] (GNode curNode) {
+        overflow->push(curNode);
+      },
+      galois::loopname("BucketSetup"),
+      galois::no_stats()
+    );
+  }
+
+  ~PeelingBuckets() {
+    delete overflow;
+    delete nextOverflow;
+  }
+
+  uint32_t windowEnd() const { return windowBegin + NUM_OPEN_BUCKETS; }
+
+  //! @returns bucket of nodes with the given degree, which must be open
+  Bag& bucket(uint32_t degree) { return open[degree - windowBegin]; }
+
+  /**
+   * Closes the current window and opens the next one at the smallest degree
+   * among unpeeled nodes, moving those nodes out of the overflow bag.
+   *
+   * @returns false if every node has been peeled
+   */
+  bool advance() {
+    galois::GReduceMin<uint32_t> minDegree;
+
+    galois::do_all(
+      galois::iterate(*overflow),
+      [&] (GNode curNode) {
+        uint32_t degree = graph.getData(curNode).currentDegree;
+        if (degree >= peeledBelow) {
+          minDegree.update(degree);
+        }
+      },
+      galois::loopname("BucketMinDegree"),
+      galois::no_stats()
+    );
+
+    if (minDegree.reduce() == std::numeric_limits<uint32_t>::max()) {
+      return false;
+    }
+    windowBegin = minDegree.reduce();
+
+    galois::do_all(
+      galois::iterate(*overflow),
+      [&] (GNode curNode) {
+        uint32_t degree = graph.getData(curNode).currentDegree;
+        if (degree < peeledBelow) {
+          // stale: peeled from an open bucket
+          return;
+        }
+        if (degree < windowEnd()) {
+          bucket(degree).push(curNode);
+        } else {
+          nextOverflow->push(curNode);
+        }
+      },
+      galois::loopname("BucketRefill"),
+      galois::no_stats()
+    );
+
+    overflow->clear();
+    std::swap(overflow, nextOverflow);
+    peeledBelow = windowEnd();
+    return true;
+  }
+};
+
+/**
+ * Per-thread histogram of pending degree decrements. Counts are kept in a
+ * small direct-mapped table and applied with one atomic subtract when a slot
+ * is evicted or the table is flushed, so a node hit by many peeled neighbors
+ * is decremented a few times instead of once per edge.
+ */
+class DegreeHistogram {
+  constexpr static const uint32_t NUM_SLOTS = 4096u;
+
+  std::vector<GNode> node;
+  std::vector<uint32_t> count;
+  std::vector<uint32_t> used;
+
+public:
+  //! Nodes whose degree this thread decremented first in the current round
+  std::vector<GNode> moved;
+
+  DegreeHistogram() : node(NUM_SLOTS), count(NUM_SLOTS, 0) {}
+
+  void add(Graph& graph, GNode dest, uint32_t round) {
+    uint32_t slot = (dest * 2654435761u) & (NUM_SLOTS - 1);
+    if (count[slot] != 0 && node[slot] == dest) {
+      count[slot] += 1;
+      return;
+    }
+    if (count[slot] != 0) {
+      apply(graph, slot, round);
+    } else {
+      used.push_back(slot);
+    }
+    node[slot]  = dest;
+    count[slot] = 1;
+  }
+
+  void flush(Graph& graph, uint32_t round) {
+    for (uint32_t slot : used) {
+      apply(graph, slot, round);
+      count[slot] = 0;
+    }
+    used.clear();
+  }
+
+private:
+  void apply(Graph& graph, uint32_t slot, uint32_t round) {
+    NodeData& destData = graph.getData(node[slot]);
+    galois::atomicSubtract(destData.currentDegree, count[slot]);
+    if (destData.lastRound.exchange(round) != round) {
+      moved.push_back(node[slot]);
+    }
+  }
+};
+
+/**
+ * Computes the coreness of every node by peeling whole buckets of nodes with
+ * the minimum degree at a time. In a round, decrements to the neighbors of the
+ * peeled nodes are batched in per-thread histograms, and every neighbor is
+ * then moved to the bucket of its new degree once. Degrees never drop below
+ * the current bucket, so at the end currentDegree is the coreness.
+ *
+ * @param graph Graph to operate on; degrees must have been initialized
+ * @param order Filled with the nodes in the order they were peeled, which is
+ * a degeneracy ordering
+ * @returns the largest coreness in the graph
+ */
+uint32_t coreDecomposition(Graph& graph, std::vector<GNode>& order) {
+  using LocalNodes = galois::substrate::PerThreadStorage<std::vector<GNode>>;
+  LocalNodes peeled;
+  galois::substrate::PerThreadStorage<DegreeHistogram> histograms;
+  std::vector<size_t> offsets(galois::getActiveThreads());
+
+  galois::do_all(
+    galois::iterate(graph.begin(), graph.end()),
+    [&] (GNode curNode) {
+      graph.getData(curNode).lastRound.store(0);
+    },
+    galois::loopname("RoundSetup"),
+    galois::no_stats()
+  );
+
+  PeelingBuckets buckets(graph);
+  order.resize(graph.size());
+  size_t numPeeled = 0;
+  uint32_t round = 0;
+  uint32_t maxCore = 0;
+
+  galois::StatTimer peelTimer("PeelTime", REGION_NAME);
+  peelTimer.start();
+
+  while (buckets.advance()) {
+    for (uint32_t k = buckets.windowBegin; k < buckets.windowEnd(); ++k) {
+      auto& bucket = buckets.bucket(k);
+
+      while (!bucket.empty()) {
+        // entries whose degree moved on are stale
+        galois::do_all(
+          galois::iterate(bucket),
+          [&] (GNode curNode) {
+            if (graph.getData(curNode).currentDegree == k) {
+              peeled.getLocal()->push_back(curNode);
+            }
+          },
+          galois::loopname("PeelFrontier"),
+          galois::no_stats()
+        );
+        bucket.clear();
+
+        size_t begin = numPeeled;
+        for (unsigned i = 0; i < offsets.size(); ++i) {
+          offsets[i] = numPeeled;
+          numPeeled += peeled.getRemote(i)->size();
+        }
+        if (numPeeled == begin) {
+          continue;
+        }
+        galois::on_each(
+          [&] (unsigned tid, unsigned) {
+            std::vector<GNode>& local = *peeled.getLocal();
+            std::copy(local.begin(), local.end(), order.begin() + offsets[tid]);
+            local.clear();
+          }
+        );
+
+        ++round;
+        maxCore = k;
+
+        // neighbors at degree k are peeled in this round or already queued
+        // for the next one
+        galois::do_all(
+          galois::iterate(order.begin() + begin, order.begin() + numPeeled),
+          [&] (GNode deadNode) {
+            DegreeHistogram& local = *histograms.getLocal();
+            for (auto e : graph.edges(deadNode)) {
+              GNode dest = graph.getEdgeDst(e);
+              if (graph.getData(dest).currentDegree > k) {
+                local.add(graph, dest, round);
+              }
+            }
+          },
+          galois::steal(),
+          galois::chunk_size<CHUNK_SIZE>(),
+          galois::loopname("PeelGather")
+        );
+
+        galois::on_each(
+          [&] (unsigned, unsigned) {
+            histograms.getLocal()->flush(graph, round);
+          }
+        );
+
+        galois::on_each(
+          [&] (unsigned, unsigned) {
+            std::vector<GNode>& local = histograms.getLocal()->moved;
+            for (GNode dest : local) {
+              NodeData& destData = graph.getData(dest);
+              uint32_t degree = destData.currentDegree;
+              if (degree < k) {
+                degree = k;
+                destData.currentDegree = k;
+              }
+              // larger degrees are still in the overflow bag
+              if (degree < buckets.windowEnd()) {
+                buckets.bucket(degree).push(dest);
+              }
+            }
+            local.clear();
+          }
+        );
+      }
+    }
+  }
+
+  peelTimer.stop();
+
+  galois::runtime::reportStat_Single(REGION_NAME, "Rounds", round);
+  galois::runtime::reportStat_Single(REGION_NAME, "MaxCore", maxCore);
+  galois::runtime::reportStat_Single(
+    REGION_NAME, "PeeledEdgesPerSec",
+    graph.sizeEdges() * 1000 / std::max<uint64_t>(peelTimer.get(), 1));
+
+  return maxCore;
+}
+
+/**
+ * Write the coreness of every node and the degeneracy ordering to the files
+ * given on the command line, if any.
+ *
+ * @param graph Graph after a decomposition
+ * @param order Nodes in the order they were peeled
+ */
+void writeDecomposition(Graph& graph, const std::vector<GNode>& order) {
+  if (corenessFile != "") {
+    std::ofstream outFile(corenessFile.c_str());
+    for (GNode curNode : graph) {
+      outFile << graph.getData(curNode).currentDegree << '\n';
+    }
+  }
+
+  if (orderingFile != "") {
+    std::ofstream outFile(orderingFile.c_str());
+    for (GNode curNode : order) {
+      outFile << curNode << '\n';
+    }
+  }
+}
+
 /******************************************************************************/
 /* Sanity check operators */
 /******************************************************************************/
@@ -223,6 +544,62 @@ void kCoreSanity(Graph& graph) {
                  aliveNodes.reduce(), "\n");
 }
 
+/**
+ * Check that the coreness of every node is consistent with its neighbors: a
+ * node with coreness c has at least c neighbors with coreness c or more, and
+ * fewer than c + 1 neighbors with coreness above c. Dies otherwise. Prints
+ * the size of the k-core if -kcore was given.
+ *
+ * @param graph Graph after a decomposition
+ * @param maxCore Largest coreness found
+ */
+void decompositionSanity(Graph& graph, uint32_t maxCore) {
+  galois::GAccumulator<uint32_t> badNodes;
+  galois::GAccumulator<uint32_t> maxCoreNodes;
+  galois::GAccumulator<uint32_t> aliveNodes;
+
+  galois::do_all(
+    galois::iterate(graph.begin(), graph.end()),
+    [&] (GNode curNode) {
+      uint32_t core = graph.getData(curNode).currentDegree;
+      uint32_t atLeast = 0;
+      uint32_t above = 0;
+      for (auto e : graph.edges(curNode)) {
+        uint32_t destCore = graph.getData(graph.getEdgeDst(e)).currentDegree;
+        if (destCore >= core) {
+          atLeast += 1;
+        }
+        if (destCore > core) {
+          above += 1;
+        }
+      }
+      if (atLeast < core || above > core) {
+        badNodes += 1;
+      }
+      if (core == maxCore) {
+        maxCoreNodes += 1;
+      }
+      if (core >= k_core_num) {
+        aliveNodes += 1;
+      }
+    },
+    galois::loopname("DecompositionSanityCheck"),
+    galois::no_stats()
+  );
+
+  if (badNodes.reduce() != 0) {
+    GALOIS_DIE("Coreness of ", badNodes.reduce(), " nodes is inconsistent "
+               "with their neighbors");
+  }
+
+  galois::gPrint("Max core is ", maxCore, " with ", maxCoreNodes.reduce(),
+                 " nodes\n");
+  if (k_core_num.getNumOccurrences()) {
+    galois::gPrint("Number of nodes in the ", k_core_num, "-core is ",
+                   aliveNodes.reduce(), "\n");
+  }
+}
+
 /******************************************************************************/
 /* Main method for running */
 /******************************************************************************/
@@ -242,6 +619,10 @@ int main(int argc, char** argv) {
                "aware this program needs to be passed a symmetric graph.");
   }
 
+  if (algo != Decompose && !k_core_num.getNumOccurrences()) {
+    GALOIS_DIE("-kcore must be specified unless -algo=Decompose is used");
+  }
+
   // some initial stat reporting
   galois::gInfo("Worklist chunk size of ", CHUNK_SIZE, ": best size may depend"
                 " on input.");
@@ -273,6 +654,8 @@ int main(int argc, char** argv) {
 
   // here begins main computation
   galois::StatTimer runtimeTimer;
+  std::vector<GNode> order;
+  uint32_t maxCore = 0;
 
   runtimeTimer.start();
 
@@ -290,6 +673,9 @@ int main(int argc, char** argv) {
                   k_core_num);
     // synchronous k-core
     syncCascadeKCore(graph);
+  } else if (algo == Decompose) {
+    galois::gInfo("Running full core decomposition");
+    maxCore = coreDecomposition(graph, order);
   } else {
     GALOIS_DIE("Invalid specification of k-core algorithm");
   }
@@ -299,9 +685,17 @@ int main(int argc, char** argv) {
   totalTimer.stop();
   galois::reportPageAlloc("MemAllocPost");
 
+  if (algo == Decompose) {
+    writeDecomposition(graph, order);
+  }
+
   // sanity check
   if (!skipVerify) {
-    kCoreSanity(graph);
+    if (algo == Decompose) {
+      decompositionSanity(graph, maxCore);
+    } else {
+      kCoreSanity(graph);
+    }
   }
 
   return 0;
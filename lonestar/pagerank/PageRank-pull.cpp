@@ -38,6 +38,16 @@ static cll::opt<Algo> algo("algo", cll::desc("Choose an algorithm:"),
                                        clEnumValEnd),
                            cll::init(Residual));
 
+static cll::opt<bool> replicateTopology(
+    "replicateTopology",
+    cll::desc("Keep a socket-local copy of the graph topology (default false)"),
+    cll::init(false));
+static cll::opt<unsigned> replicaBudgetMB(
+    "replicaBudgetMB",
+    cll::desc("Memory budget in MB for topology replicas; 0 = half of free "
+              "memory (default 0)"),
+    cll::init(0));
+
 constexpr static const unsigned CHUNK_SIZE = 32;
 
 struct LNode {
@@ -46,7 +56,8 @@ struct LNode {
 };
 
 typedef galois::graphs::LC_CSR_Graph<LNode, void>::with_no_lockable<
-    true>::type ::with_numa_alloc<true>::type Graph;
+    true>::type ::with_numa_alloc<true>::type ::with_replicated_topology<
+    true>::type Graph;
 typedef typename Graph::GraphNode GNode;
 
 using DeltaArray    = galois::LargeArray<PRTy>;
@@ -269,6 +280,17 @@ int main(int argc, char** argv) {
   std::cout << "Read " << transposeGraph.size() << " nodes, "
             << transposeGraph.sizeEdges() << " edges\n";
 
+  if (replicateTopology) {
+    galois::StatTimer replicateTimer("ReplicateTopologyTime");
+    replicateTimer.start();
+    bool replicated = transposeGraph.replicateTopology(
+        static_cast<size_t>(replicaBudgetMB) * 1024 * 1024);
+    replicateTimer.stop();
+    std::cout << (replicated ? "Replicated topology on each socket\n"
+                             : "WARNING: topology not replicated (single "
+                               "socket or over budget)\n");
+  }
+
   galois::preAlloc(2 * numThreads + (3 * transposeGraph.size() *
                                      sizeof(typename Graph::node_data_type)) /
                                         galois::runtime::pagePoolSize());
@@ -18,12 +18,15 @@
  */
 
 #include "galois/Galois.h"
+#include "galois/UnionFind.h"
 #include "llvm/Support/CommandLine.h"
 #include "Lonestar/BoilerPlate.h"
 #include <iostream>
 #include <fstream>
 #include <deque>
+#include <unordered_set>
 #include "SparseBitVector.h"
+#include "SharedBitVector.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // Command line parameters
@@ -55,10 +58,24 @@ static cll::opt<bool>
 static cll::opt<bool>
     useCycleDetection("ocd",
                       cll::desc("If set, online cycle detection is"
-                                " used in algorithm (serial only) "
+                                " used in algorithm; the parallel version"
+                                " uses lazy cycle detection "
                                 "(default false)"),
                       cll::init(false));
 
+enum PointsToSetKind { sparse, shared };
+
+static cll::opt<PointsToSetKind> pointsToSetKind(
+    "ptsSet", cll::desc("Representation of points-to sets:"),
+    cll::values(clEnumValN(sparse, "sparse",
+                           "Linked list sparse bit vector per variable "
+                           "(default)"),
+                clEnumValN(shared, "shared",
+                           "Hash-consed sorted word arrays shared by all "
+                           "variables with the same points-to set"),
+                clEnumValEnd),
+    cll::init(sparse));
+
 static cll::opt<unsigned>
     THRESHOLD_LS("lsThreshold",
                  cll::desc("Determines how many constraints to "
@@ -130,18 +147,54 @@ public:
  *
  * @tparam IsConcurrent if set to true, the data structures used for points
  * to results and outgoing edges will be thread safe
+ * @tparam PointsToSet set type holding the points-to results; either a
+ * SparseBitVector or a SharedBitVector
  */
-template <bool IsConcurrent>
+template <bool IsConcurrent, typename PointsToSet>
 class PTABase {
   // sparse bit vector is concurrent or serial based on template parameter
   using SparseBitVector = galois::SparseBitVector<IsConcurrent>;
 
   using PointsToConstraints = std::vector<PtsToCons>;
-  using PointsToInfo        = std::vector<SparseBitVector>;
+  using PointsToInfo        = std::vector<PointsToSet>;
   using EdgeVector          = std::vector<SparseBitVector>;
 
   using NodeAllocator =
       galois::FixedSizeAllocator<typename SparseBitVector::Node>;
+  using PointsToAllocator = typename PointsToSet::Allocator;
+
+  /**
+   * Union-find node of a constraint graph node; the root of its class is
+   * the node's representative.
+   */
+  struct RepNode : public galois::UnionFindNode<RepNode> {
+    RepNode() : galois::UnionFindNode<RepNode>(this) {}
+
+    /**
+     * Lock-free union of the classes of this node and other (same linking
+     * rule as UnionFindNode::merge).
+     *
+     * @returns the root that stopped being a representative, or nullptr if
+     * both nodes already were in the same class
+     */
+    RepNode* unite(RepNode* other) {
+      RepNode* self = this;
+      while (true) {
+        self  = self->findAndSplit();
+        other = other->findAndSplit();
+        if (self == other) {
+          return nullptr;
+        }
+        if (self < other) {
+          std::swap(self, other);
+        }
+        RepNode* expected = self;
+        if (self->m_component.compare_exchange_strong(expected, other)) {
+          return self;
+        }
+      }
+    }
+  };
 
 protected:
   PointsToInfo pointsToResult; // pointsTo results for nodes
@@ -152,18 +205,88 @@ protected:
 
   size_t numNodes = 0;
 
+  std::vector<RepNode> representatives; // representative of each node
+
+  galois::GAccumulator<size_t> numUnions;    // unions done by propagate
+  galois::GAccumulator<size_t> numCollapsed; // nodes merged into another
+
+  /**
+   * Merge the classes of two nodes (collapsing them into a single node of
+   * the constraint graph).
+   *
+   * @returns the representative of the merged class
+   */
+  unsigned mergeRepresentatives(unsigned a, unsigned b) {
+    RepNode* loser = representatives[a].unite(&representatives[b]);
+
+    if (loser) {
+      numCollapsed += 1;
+      return forwardToRepresentative(loser - &representatives[0]);
+    }
+
+    return getFinalRepresentative(a);
+  }
+
+  /**
+   * The representative needs to have all of the items and edges of the
+   * nodes it represents. Copies them from nodeID up the chain of
+   * representatives; in the parallel version nodeID may have been merged
+   * into another class while it was being updated, so the updater calls this
+   * too.
+   *
+   * @param nodeID node whose points-to set or edges may not have reached its
+   * representative
+   * @returns the representative of nodeID
+   */
+  unsigned forwardToRepresentative(unsigned nodeID) {
+    unsigned cur = nodeID;
+
+    while (true) {
+      if (IsConcurrent) {
+        // orders the update of cur before reading its representative; pairs
+        // with the compare and swap in RepNode::unite
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+      }
+
+      unsigned repr = getFinalRepresentative(cur);
+      if (repr == cur) {
+        return repr;
+      }
+
+      if (!pointsToResult[cur].isSubsetEq(pointsToResult[repr])) {
+        pointsToResult[repr].unify(pointsToResult[cur]);
+      }
+      if (!outgoingEdges[cur].isSubsetEq(outgoingEdges[repr])) {
+        outgoingEdges[repr].unify(outgoingEdges[cur]);
+      }
+
+      cur = repr;
+    }
+  }
+
+  /**
+   * Given a node id, find its representative. Also, do path splitting
+   * of the path to the representative; safe to call concurrently with
+   * merges.
+   *
+   * @param nodeid Node id to get the representative of
+   * @returns The representative of nodeid
+   */
+  unsigned getFinalRepresentative(unsigned nodeid) {
+    return representatives[nodeid].findAndSplit() - &representatives[0];
+  }
+
   ////////////////////////////////////////////////////////////////////////////////
   /**
    * Online Cycle Detection and elimination structure + functions.
    */
   struct OnlineCycleDetection {
   private:
-    PTABase<IsConcurrent>&
+    PTABase<IsConcurrent, PointsToSet>&
         outerPTA; // reference to outer PTA instance to get runtime info
 
     galois::gstl::Vector<unsigned> ancestors; // TODO find better representation
     galois::gstl::Vector<bool> visited;       // TODO use better representation
-    galois::gstl::Vector<unsigned> representative;
 
     unsigned NoRepresentative; // "constant" that represents no representative
 
@@ -196,7 +319,7 @@ protected:
      * to an ancestor), false otherwise
      */
     bool cycleDetect(unsigned nodeID, unsigned& cycleNode) {
-      unsigned nodeRep = getFinalRepresentative(nodeID);
+      unsigned nodeRep = outerPTA.getFinalRepresentative(nodeID);
 
       // if the node is an ancestor, that means there's a path from the ancestor
       // to the ancestor (i.e. cycle)
@@ -240,16 +363,12 @@ protected:
      */
     void cycleCollapse(unsigned repr) {
       // assert(repr is present in ancestors).
-      unsigned repToChangeTo = getFinalRepresentative(repr);
-
       for (auto ii = ancestors.begin(); ii != ancestors.end(); ++ii) {
         if (*ii == repr) {
           galois::gDebug("collapsing cycle for ", repr);
           // cycle exists between nodes ancestors[*ii..end].
           for (auto jj = ii; jj != ancestors.end(); ++jj) {
-            // jjRepr has no representative.
-            unsigned jjRepr = getFinalRepresentative(*jj);
-            makeRepr(jjRepr, repToChangeTo);
+            outerPTA.mergeRepresentatives(*jj, repr);
           }
 
           break;
@@ -257,36 +376,9 @@ protected:
       }
     }
 
-    /**
-     * Make repr the representative of nodeID.
-     *
-     * @param nodeID node to change the representative of
-     * @param repr nodeID will have its representative changed to this
-     */
-    void makeRepr(unsigned nodeID, unsigned repr) {
-      if (repr != nodeID) {
-        galois::gDebug("change repr[", nodeID, "] = ", repr);
-
-        representative[nodeID] = repr;
-
-        // the representative needs to have all of the items that the nodes
-        // it is representing has, so if the node has more than the rep,
-        // unify
-        if (!outerPTA.pointsToResult[nodeID].isSubsetEq(
-                outerPTA.pointsToResult[repr])) {
-          outerPTA.pointsToResult[repr].unify(outerPTA.pointsToResult[nodeID]);
-        }
-
-        // unify edges as well if necessary since rep represents it now
-        if (!outerPTA.outgoingEdges[nodeID].isSubsetEq(
-                outerPTA.outgoingEdges[repr])) {
-          outerPTA.outgoingEdges[repr].unify(outerPTA.outgoingEdges[nodeID]);
-        }
-      }
-    }
-
   public:
-    OnlineCycleDetection(PTABase<IsConcurrent>& o) : outerPTA(o) {}
+    OnlineCycleDetection(PTABase<IsConcurrent, PointsToSet>& o)
+        : outerPTA(o) {}
 
     /**
      * Init fields (outerPTA needs to have numNodes set).
@@ -294,39 +386,6 @@ protected:
     void init() {
       NoRepresentative = outerPTA.numNodes;
       visited.resize(outerPTA.numNodes);
-      representative.resize(outerPTA.numNodes);
-
-      for (unsigned ii = 0; ii < outerPTA.numNodes; ++ii) {
-        representative[ii] = NoRepresentative;
-      }
-    }
-
-    /**
-     * Given a node id, find its representative. Also, do path compression
-     * of the path to the representative.
-     *
-     * @param nodeid Node id to get the representative of
-     * @returns The representative of nodeid
-     */
-    unsigned getFinalRepresentative(unsigned nodeid) {
-      unsigned finalRep = nodeid;
-
-      // follow chain of representatives until a "root" is reached
-      while (representative[finalRep] != NoRepresentative) {
-        finalRep = representative[finalRep];
-      }
-
-      // path compression; make all things along path to final representative
-      // point to the final representative
-      unsigned curRep = representative[nodeid];
-
-      while (curRep != NoRepresentative) {
-        representative[nodeid] = finalRep;
-        nodeid                 = curRep;
-        curRep                 = representative[nodeid];
-      }
-
-      return finalRep;
     }
 
     /**
@@ -359,7 +418,7 @@ protected:
   }; // end struct OnlineCycleDetection
   ////////////////////////////////////////////////////////////////////////////////
 
-  OnlineCycleDetection ocd; // cycle detector/squasher; only works with serial
+  OnlineCycleDetection ocd; // cycle detector/squasher used by serial version
 
   /**
    * Adds edges to the graph based on load/store constraints.
@@ -388,13 +447,13 @@ protected:
       unsigned dst;
       std::tie(src, dst) = constraint.getSrcDst();
 
-      unsigned srcRepr = ocd.getFinalRepresentative(src);
-      unsigned dstRepr = ocd.getFinalRepresentative(dst);
+      unsigned srcRepr = getFinalRepresentative(src);
+      unsigned dstRepr = getFinalRepresentative(dst);
 
       if (constraint.getType() == PtsToCons::Load) {
         for (auto pointee = pointsToResult[srcRepr].begin();
              pointee != pointsToResult[srcRepr].end(); pointee++) {
-          unsigned pointeeRepr = ocd.getFinalRepresentative(*pointee);
+          unsigned pointeeRepr = getFinalRepresentative(*pointee);
 
           // add edge from pointee to dst if it doesn't already exist
           if (pointeeRepr != dstRepr &&
@@ -409,7 +468,7 @@ protected:
 
         for (auto pointee = pointsToResult[dstRepr].begin();
              pointee != pointsToResult[dstRepr].end(); pointee++) {
-          unsigned pointeeRepr = ocd.getFinalRepresentative(*pointee);
+          unsigned pointeeRepr = getFinalRepresentative(*pointee);
 
           // add edge from src -> pointee if it doesn't exist
           if (srcRepr != pointeeRepr &&
@@ -477,8 +536,8 @@ protected:
     unsigned newPtsTo = 0;
 
     if (src != dst) {
-      unsigned srcRepr = ocd.getFinalRepresentative(src);
-      unsigned dstRepr = ocd.getFinalRepresentative(dst);
+      unsigned srcRepr = getFinalRepresentative(src);
+      unsigned dstRepr = getFinalRepresentative(dst);
 
       // if src is a not subset of dst... (i.e. src has more), then
       // propogate src's points to info to dst
@@ -487,6 +546,12 @@ protected:
         galois::gDebug("unifying ", dstRepr, " by ", srcRepr);
         // newPtsTo is positive if changes are made
         newPtsTo += pointsToResult[dstRepr].unify(pointsToResult[srcRepr]);
+        numUnions += 1;
+
+        if (IsConcurrent && useCycleDetection) {
+          // a concurrent cycle collapse may have merged dstRepr away
+          forwardToRepresentative(dstRepr);
+        }
       }
     }
 
@@ -503,17 +568,21 @@ public:
    * @param n Number of nodes in the constraint graph
    * @param nodeAllocator galois allocator object to allocate nodes in the
    * sparse bit vector
+   * @param ptsAllocator allocator (or pool) of the points-to sets
    */
-  void initialize(size_t n, NodeAllocator& nodeAllocator) {
+  void initialize(size_t n, NodeAllocator& nodeAllocator,
+                  PointsToAllocator& ptsAllocator) {
     numNodes = n;
 
     // initialize different constructs based on which version is being run
     pointsToResult.resize(numNodes);
     outgoingEdges.resize(numNodes);
+    // every node starts as its own representative
+    representatives = std::vector<RepNode>(numNodes);
 
     // initialize vectors
     for (unsigned i = 0; i < numNodes; i++) {
-      pointsToResult[i].init(&nodeAllocator);
+      pointsToResult[i].init(&ptsAllocator);
       outgoingEdges[i].init(&nodeAllocator);
     }
 
@@ -603,7 +672,7 @@ public:
    */
   void checkReprPointsTo() {
     for (unsigned ii = 0; ii < pointsToResult.size(); ++ii) {
-      unsigned repr = ocd.getFinalRepresentative(ii);
+      unsigned repr = getFinalRepresentative(ii);
       if (repr != ii && !pointsToResult[ii].isSubsetEq(pointsToResult[repr])) {
         galois::gError("pointsto(", ii,
                        ") is not less than its "
@@ -619,7 +688,7 @@ public:
    */
   void checkReprEdges() {
     for (unsigned ii = 0; ii < outgoingEdges.size(); ++ii) {
-      unsigned repr = ocd.getFinalRepresentative(ii);
+      unsigned repr = getFinalRepresentative(ii);
       if (repr != ii && !outgoingEdges[ii].isSubsetEq(outgoingEdges[repr])) {
         galois::gError("edges(", ii,
                        ") is not less than its "
@@ -636,13 +705,53 @@ public:
     unsigned count = 0;
 
     for (auto ii = pointsToResult.begin(); ii != pointsToResult.end(); ++ii) {
-      unsigned repr = ocd.getFinalRepresentative(ii - pointsToResult.begin());
+      unsigned repr = getFinalRepresentative(ii - pointsToResult.begin());
       count += pointsToResult[repr].count();
     }
 
     return count;
   }
 
+  /**
+   * @returns number of unions of points-to sets done while propagating
+   */
+  size_t getNumUnions() { return numUnions.reduce(); }
+
+  /**
+   * @returns number of nodes collapsed into another node by cycle detection
+   */
+  size_t getNumCollapsed() { return numCollapsed.reduce(); }
+
+  /**
+   * @returns bytes held by the points-to sets of all nodes (for shared sets
+   * this excludes the contents, which belong to the pool)
+   */
+  size_t getPointsToBytes() {
+    size_t nbytes = 0;
+
+    for (auto& pts : pointsToResult) {
+      nbytes += pts.bytes();
+    }
+
+    return nbytes;
+  }
+
+  /**
+   * @returns number of distinct points-to sets held by representatives
+   * (shared points-to sets only)
+   */
+  size_t countDistinctPointsToSets() {
+    std::unordered_set<const void*> sets;
+
+    for (unsigned ii = 0; ii < numNodes; ++ii) {
+      if (getFinalRepresentative(ii) == ii) {
+        sets.insert(pointsToResult[ii].get());
+      }
+    }
+
+    return sets.size();
+  }
+
   /**
    * Prints out points to info for all verticies in the constraint graph.
    */
@@ -651,7 +760,7 @@ public:
 
     for (auto ii = pointsToResult.begin(); ii != pointsToResult.end(); ++ii) {
       std::cerr << prefix << ii - pointsToResult.begin() << ": ";
-      unsigned repr = ocd.getFinalRepresentative(ii - pointsToResult.begin());
+      unsigned repr = getFinalRepresentative(ii - pointsToResult.begin());
       pointsToResult[repr].print(std::cerr, prefix);
     }
   }
@@ -660,21 +769,25 @@ public:
 /**
  * Serial points to executor.
  */
-class PTASerial : public PTABase<false> {
+template <typename PointsToSet>
+class PTASerial : public PTABase<false, PointsToSet> {
 public:
   /**
    * Run points-to-analysis on a single thread.
    */
   void run() {
-    galois::gDebug(
-        "no of addr+copy constraints = ", addressCopyConstraints.size(),
-        ", no of load+store constraints = ", loadStoreConstraints.size());
-    galois::gDebug("no of nodes = ", numNodes);
+    galois::gDebug("no of addr+copy constraints = ",
+                   this->addressCopyConstraints.size(),
+                   ", no of load+store constraints = ",
+                   this->loadStoreConstraints.size());
+    galois::gDebug("no of nodes = ", this->numNodes);
 
     std::deque<unsigned> updates;
-    updates = processAddressOfCopy<galois::StdForEach, std::deque<unsigned>>(
-        addressCopyConstraints);
-    processLoadStore<galois::StdForEach>(loadStoreConstraints, updates);
+    updates = this->template processAddressOfCopy<galois::StdForEach,
+                                                  std::deque<unsigned>>(
+        this->addressCopyConstraints);
+    this->template processLoadStore<galois::StdForEach>(
+        this->loadStoreConstraints, updates);
 
     unsigned numUps = 0;
 
@@ -683,12 +796,12 @@ public:
       unsigned src = updates.front();
       updates.pop_front();
 
-      for (auto dst = outgoingEdges[src].begin();
-           dst != outgoingEdges[src].end(); dst++) {
-        unsigned newPtsTo = propagate(src, *dst);
+      for (auto dst = this->outgoingEdges[src].begin();
+           dst != this->outgoingEdges[src].end(); dst++) {
+        unsigned newPtsTo = this->propagate(src, *dst);
 
         if (newPtsTo) { // newPtsTo is positive if dst changed
-          updates.push_back(ocd.getFinalRepresentative(*dst));
+          updates.push_back(this->getFinalRepresentative(*dst));
         }
 
         numUps++;
@@ -696,15 +809,16 @@ public:
 
       if (updates.empty() || numUps >= THRESHOLD_LS) {
         galois::gDebug("No of points-to facts computed = ",
-                       countPointsToFacts());
+                       this->countPointsToFacts());
         numUps = 0;
 
         // After propagating all constraints, see if load/store
         // constraints need to be added in since graph was potentially updated
-        processLoadStore<galois::StdForEach>(loadStoreConstraints, updates);
+        this->template processLoadStore<galois::StdForEach>(
+            this->loadStoreConstraints, updates);
 
         // do cycle squashing
-        ocd.process(updates);
+        this->ocd.process(updates);
       }
     }
   }
@@ -713,21 +827,117 @@ public:
 /**
  * Concurrent points to executor.
  */
-class PTAConcurrent : public PTABase<true> {
+template <typename PointsToSet>
+class PTAConcurrent : public PTABase<true, PointsToSet> {
+  using EdgeIterator = typename galois::SparseBitVector<true>::SBVIterator;
+
+  //! Give up a cycle search after visiting this many nodes
+  static const unsigned lcdSearchLimit = 4096;
+
+  /**
+   * Per thread state of lazy cycle detection.
+   */
+  struct LazyCycleDetection {
+    // edges (by representatives) that have already triggered a search
+    std::unordered_set<uint64_t> triggered;
+    std::unordered_set<unsigned> visited;
+    // depth first search path with the next edge to follow at each node
+    std::vector<std::pair<unsigned, EdgeIterator>> path;
+  };
+
+  galois::substrate::PerThreadStorage<LazyCycleDetection> lcd;
+  galois::GAccumulator<size_t> numSearches;
+
+  /**
+   * Lazy cycle detection (Hardekopf and Lin): an edge src -> dst whose ends
+   * have the same (nonempty) points-to set after propagation hints that the
+   * two nodes are on a cycle. Look for a path from dst back to src and, if
+   * there is one, collapse the nodes on it into a single representative.
+   * Each edge triggers at most one search.
+   *
+   * Safe to run concurrently with propagation and other collapses.
+   *
+   * @returns the representative of the collapsed cycle, or numNodes if
+   * nothing was collapsed
+   */
+  unsigned lazyCycleDetect(unsigned src, unsigned dst) {
+    unsigned target = this->getFinalRepresentative(src);
+    unsigned start  = this->getFinalRepresentative(dst);
+
+    if (target == start || this->pointsToResult[target].empty()) {
+      return this->numNodes;
+    }
+
+    LazyCycleDetection& state = *lcd.getLocal();
+    uint64_t edge             = ((uint64_t)target << 32) | start;
+
+    if (state.triggered.count(edge) ||
+        !this->pointsToResult[start].isSubsetEq(
+            this->pointsToResult[target])) {
+      return this->numNodes;
+    }
+
+    state.triggered.insert(edge);
+    numSearches += 1;
+
+    state.visited.clear();
+    state.path.clear();
+    state.visited.insert(start);
+    state.path.emplace_back(start, this->outgoingEdges[start].begin());
+
+    bool found = false;
+
+    while (!state.path.empty() && state.visited.size() < lcdSearchLimit) {
+      auto& top = state.path.back();
+
+      if (top.second == this->outgoingEdges[top.first].end()) {
+        state.path.pop_back();
+        continue;
+      }
+
+      unsigned next = this->getFinalRepresentative(*top.second);
+      ++top.second;
+
+      if (next == target) {
+        found = true;
+        break;
+      }
+
+      if (state.visited.insert(next).second) {
+        state.path.emplace_back(next, this->outgoingEdges[next].begin());
+      }
+    }
+
+    if (!found) {
+      return this->numNodes;
+    }
+
+    // target -> ... -> path[0] (start) -> ... -> path.back() -> target
+    unsigned repr = target;
+    for (auto& step : state.path) {
+      repr = this->mergeRepresentatives(repr, step.first);
+    }
+
+    return repr;
+  }
+
 public:
   /**
    * Run points-to-analysis using galois::for_each as the main loop.
    */
   void run() {
-    galois::gDebug(
-        "no of addr+copy constraints = ", addressCopyConstraints.size(),
-        ", no of load+store constraints = ", loadStoreConstraints.size());
-    galois::gDebug("no of nodes = ", numNodes);
+    galois::gDebug("no of addr+copy constraints = ",
+                   this->addressCopyConstraints.size(),
+                   ", no of load+store constraints = ",
+                   this->loadStoreConstraints.size());
+    galois::gDebug("no of nodes = ", this->numNodes);
 
     galois::InsertBag<unsigned> updates;
-    updates = processAddressOfCopy<galois::DoAll, galois::InsertBag<unsigned>>(
-        addressCopyConstraints);
-    processLoadStore<galois::DoAll>(loadStoreConstraints, updates);
+    updates = this->template processAddressOfCopy<galois::DoAll,
+                                                  galois::InsertBag<unsigned>>(
+        this->addressCopyConstraints);
+    this->template processLoadStore<galois::DoAll>(this->loadStoreConstraints,
+                                                   updates);
 
     while (!updates.empty()) {
       galois::for_each(
@@ -738,7 +948,15 @@ public:
               unsigned newPtsTo = this->propagate(req, *dst);
 
               if (newPtsTo)
-                ctx.push(this->ocd.getFinalRepresentative(*dst));
+                ctx.push(this->getFinalRepresentative(*dst));
+
+              if (useCycleDetection) {
+                unsigned repr = this->lazyCycleDetect(req, *dst);
+
+                // the merged node has the edges of the whole cycle
+                if (repr != this->numNodes)
+                  ctx.push(repr);
+              }
             }
           },
           galois::loopname("PointsToMainUpdateLoop"), galois::no_conflicts(),
@@ -746,27 +964,54 @@ public:
                                                                  // with this
       );
 
-      galois::gDebug("No of points-to facts computed = ", countPointsToFacts());
+      galois::gDebug("No of points-to facts computed = ",
+                     this->countPointsToFacts());
 
       updates.clear();
 
       // After propagating all constraints, see if load/store constraints need
       // to be added in since graph was potentially updated
-      processLoadStore<galois::DoAll>(loadStoreConstraints, updates);
+      this->template processLoadStore<galois::DoAll>(
+          this->loadStoreConstraints, updates);
+    }
 
-      // do cycle squashing
-      // ocd.process(updates); // TODO have parallel OCD, if possible
+    if (useCycleDetection) {
+      galois::runtime::reportStat_Single("PointsTo", "CycleSearches",
+                                         numSearches.reduce());
     }
   }
 };
 
 /**
- * Method from running PTA.
+ * Reports stats of the pool holding shared points-to sets. The sparse bit
+ * vector allocator has nothing to report since its nodes are counted per
+ * variable.
+ *
+ * @returns bytes held by the pool
  */
 template <typename PTAClass, typename Alloc>
-void runPTA(PTAClass& pta, Alloc nodeAllocator) {
+size_t reportPointsToPool(PTAClass&, Alloc&) {
+  return 0;
+}
+
+template <typename PTAClass>
+size_t reportPointsToPool(PTAClass& pta, galois::SharedBitVectorPool& pool) {
+  galois::runtime::reportStat_Single("PointsTo", "SetsCreated",
+                                     pool.getNumSets());
+  galois::runtime::reportStat_Single("PointsTo", "DistinctPointsToSets",
+                                     pta.countDistinctPointsToSets());
+  galois::runtime::reportStat_Single("PointsTo", "UnionMemoHits",
+                                     pool.getNumMemoHits());
+  return pool.getSetBytes();
+}
+
+/**
+ * Method from running PTA.
+ */
+template <typename PTAClass, typename NodeAlloc, typename PtsAlloc>
+void runPTA(PTAClass& pta, NodeAlloc& nodeAllocator, PtsAlloc& ptsAllocator) {
   size_t numNodes = pta.readConstraints(input.c_str());
-  pta.initialize(numNodes, nodeAllocator);
+  pta.initialize(numNodes, nodeAllocator, ptsAllocator);
 
   galois::StatTimer T; // main timer
 
@@ -776,6 +1021,17 @@ void runPTA(PTAClass& pta, Alloc nodeAllocator) {
 
   galois::gInfo("No of points-to facts computed = ", pta.countPointsToFacts());
 
+  size_t numUnions = pta.getNumUnions();
+  galois::runtime::reportStat_Single("PointsTo", "Unions", numUnions);
+  galois::runtime::reportStat_Single(
+      "PointsTo", "UnionsPerSec",
+      numUnions * 1000 / std::max<size_t>(T.get(), 1));
+  galois::runtime::reportStat_Single("PointsTo", "CollapsedNodes",
+                                     pta.getNumCollapsed());
+  galois::runtime::reportStat_Single(
+      "PointsTo", "PointsToSetBytes",
+      pta.getPointsToBytes() + reportPointsToPool(pta, ptsAllocator));
+
   if (!skipVerify) {
     galois::gInfo("Doing verification step");
     pta.checkReprPointsTo();
@@ -799,20 +1055,32 @@ int main(int argc, char** argv) {
     galois::gInfo("Note correctness of this version is relative to the serial "
                   "version.");
 
-    PTAConcurrent p;
     galois::FixedSizeAllocator<typename galois::SparseBitVector<true>::Node>
         nodeAllocator;
-    runPTA(p, nodeAllocator);
+    if (pointsToSetKind == shared) {
+      galois::SharedBitVectorPool pool;
+      PTAConcurrent<galois::SharedBitVector> p;
+      runPTA(p, nodeAllocator, pool);
+    } else {
+      PTAConcurrent<galois::SparseBitVector<true>> p;
+      runPTA(p, nodeAllocator, nodeAllocator);
+    }
   } else {
     galois::gInfo("-------- Sequential version.");
     galois::gInfo(
         "The load store threshold (-lsThreshold) may need tweaking for "
         "best performance; its current setting may not be the best for "
         "your input and may actually degrade performance.");
-    PTASerial p;
     galois::FixedSizeAllocator<typename galois::SparseBitVector<false>::Node>
         nodeAllocator;
-    runPTA(p, nodeAllocator);
+    if (pointsToSetKind == shared) {
+      galois::SharedBitVectorPool pool;
+      PTASerial<galois::SharedBitVector> p;
+      runPTA(p, nodeAllocator, pool);
+    } else {
+      PTASerial<galois::SparseBitVector<false>> p;
+      runPTA(p, nodeAllocator, nodeAllocator);
+    }
   }
 
   return 0;
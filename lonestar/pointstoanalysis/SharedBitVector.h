@@ -0,0 +1,560 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef _GALOIS_SHAREDBITVECTOR_
+#define _GALOIS_SHAREDBITVECTOR_
+
+#include <galois/AtomicWrapper.h>
+#include <galois/Reduction.h>
+#include <galois/substrate/PerThreadStorage.h>
+#include <galois/substrate/SimpleLock.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <boost/iterator/iterator_facade.hpp>
+
+namespace galois {
+
+/**
+ * Pool of immutable, hash-consed bit vectors.
+ *
+ * Every set is stored once as a sorted array of (base, word) blocks in a
+ * single allocation, so identical sets held by different owners share
+ * storage and comparing two sets for equality is a pointer compare. Sets are
+ * never modified once interned: updates build a new set and intern it.
+ * Results of unions are memoized since the same pair of sets tends to be
+ * combined many times.
+ *
+ * Thread safe. Sets are freed only when the pool is destroyed.
+ */
+class SharedBitVectorPool {
+public:
+  using WORD                     = uint64_t;
+  static const unsigned wordSize = sizeof(WORD) * 8;
+
+  /**
+   * Interned set. The words are laid out right after the header, followed
+   * by the bases of the words (sorted ascending).
+   */
+  struct Set {
+    size_t hash;
+    unsigned numWords;
+    unsigned numBits;
+
+    const WORD* words() const {
+      return reinterpret_cast<const WORD*>(this + 1);
+    }
+    WORD* words() { return reinterpret_cast<WORD*>(this + 1); }
+
+    const unsigned* bases() const {
+      return reinterpret_cast<const unsigned*>(words() + numWords);
+    }
+    unsigned* bases() {
+      return reinterpret_cast<unsigned*>(words() + numWords);
+    }
+
+    /**
+     * @returns bytes used by a set with numWords words
+     */
+    static size_t bytes(unsigned numWords) {
+      return sizeof(Set) + numWords * (sizeof(WORD) + sizeof(unsigned));
+    }
+  };
+
+private:
+  //! Scratch space used to build a set before interning it
+  struct Scratch {
+    std::vector<WORD> words;
+    std::vector<unsigned> bases;
+
+    void clear() {
+      words.clear();
+      bases.clear();
+    }
+
+    void push(unsigned base, WORD word) {
+      bases.push_back(base);
+      words.push_back(word);
+    }
+  };
+
+  using SetKey = std::pair<const Set*, const Set*>;
+  struct KeyHash {
+    size_t operator()(const SetKey& k) const {
+      return std::hash<const Set*>()(k.first) * 31 +
+             std::hash<const Set*>()(k.second);
+    }
+  };
+
+  //! Hash table shard; sets are bucketed by the hash of their contents
+  struct Shard {
+    galois::substrate::SimpleLock lock;
+    std::unordered_multimap<size_t, Set*> sets;
+    std::unordered_map<SetKey, const Set*, KeyHash> unions;
+  };
+
+  static const unsigned numShards = 64;
+
+  Set emptySet;
+  std::vector<Shard> shards;
+  galois::substrate::PerThreadStorage<Scratch> scratch;
+
+  galois::GAccumulator<size_t> numSets;
+  galois::GAccumulator<size_t> setBytes;
+  galois::GAccumulator<size_t> numMemoHits;
+
+  static size_t hashWords(const Scratch& s) {
+    size_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < s.words.size(); ++i) {
+      h = (h ^ s.bases[i]) * 0x100000001b3ull;
+      h = (h ^ s.words[i]) * 0x100000001b3ull;
+    }
+    return h;
+  }
+
+  static bool sameWords(const Set* set, const Scratch& s) {
+    return set->numWords == s.words.size() &&
+           std::equal(s.words.begin(), s.words.end(), set->words()) &&
+           std::equal(s.bases.begin(), s.bases.end(), set->bases());
+  }
+
+  /**
+   * Returns the unique set with the contents in the scratch space, creating
+   * it if it does not exist yet.
+   */
+  const Set* intern(const Scratch& s) {
+    if (s.words.empty()) {
+      return &emptySet;
+    }
+
+    size_t hash  = hashWords(s);
+    Shard& shard = shards[hash % numShards];
+
+    shard.lock.lock();
+    auto range = shard.sets.equal_range(hash);
+    for (auto ii = range.first; ii != range.second; ++ii) {
+      if (sameWords(ii->second, s)) {
+        shard.lock.unlock();
+        return ii->second;
+      }
+    }
+
+    unsigned numWords = s.words.size();
+    size_t nbytes     = Set::bytes(numWords);
+    Set* set          = static_cast<Set*>(std::malloc(nbytes));
+    set->hash         = hash;
+    set->numWords     = numWords;
+    set->numBits      = 0;
+    std::copy(s.words.begin(), s.words.end(), set->words());
+    std::copy(s.bases.begin(), s.bases.end(), set->bases());
+    for (WORD w : s.words) {
+      set->numBits += __builtin_popcountll(w);
+    }
+    shard.sets.emplace(hash, set);
+    shard.lock.unlock();
+
+    numSets += 1;
+    setBytes += nbytes;
+    return set;
+  }
+
+public:
+  SharedBitVectorPool() : shards(numShards) {
+    emptySet.hash     = 0;
+    emptySet.numWords = 0;
+    emptySet.numBits  = 0;
+  }
+
+  SharedBitVectorPool(const SharedBitVectorPool&) = delete;
+  SharedBitVectorPool& operator=(const SharedBitVectorPool&) = delete;
+
+  ~SharedBitVectorPool() {
+    for (Shard& shard : shards) {
+      for (auto& ii : shard.sets) {
+        std::free(ii.second);
+      }
+    }
+  }
+
+  /**
+   * @returns the empty set
+   */
+  const Set* empty() const { return &emptySet; }
+
+  /**
+   * @returns true if bit is in set
+   */
+  static bool test(const Set* set, unsigned bit) {
+    const unsigned* bases = set->bases();
+    const unsigned* end   = bases + set->numWords;
+    const unsigned* pos   = std::lower_bound(bases, end, bit / wordSize);
+
+    return pos != end && *pos == bit / wordSize &&
+           (set->words()[pos - bases] >> (bit % wordSize)) & 1;
+  }
+
+  /**
+   * @returns true if every bit of first is also in second
+   */
+  static bool isSubsetEq(const Set* first, const Set* second) {
+    if (first == second || first->numWords == 0) {
+      return true;
+    }
+    if (first->numBits > second->numBits) {
+      return false;
+    }
+
+    const unsigned* basesOne = first->bases();
+    const unsigned* basesTwo = second->bases();
+    unsigned j               = 0;
+
+    for (unsigned i = 0; i < first->numWords; ++i) {
+      while (j < second->numWords && basesTwo[j] < basesOne[i]) {
+        ++j;
+      }
+      if (j == second->numWords || basesTwo[j] != basesOne[i] ||
+          (first->words()[i] & ~second->words()[j])) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * @returns the set holding the bits of set plus bit
+   */
+  const Set* insert(const Set* set, unsigned bit) {
+    if (test(set, bit)) {
+      return set;
+    }
+
+    Scratch& s = *scratch.getLocal();
+    s.clear();
+
+    unsigned base      = bit / wordSize;
+    WORD mask          = (WORD)1 << (bit % wordSize);
+    bool inserted      = false;
+    const WORD* ww     = set->words();
+    const unsigned* bb = set->bases();
+
+    for (unsigned i = 0; i < set->numWords; ++i) {
+      if (!inserted && bb[i] >= base) {
+        if (bb[i] == base) {
+          s.push(base, ww[i] | mask);
+          inserted = true;
+          continue;
+        }
+        s.push(base, mask);
+        inserted = true;
+      }
+      s.push(bb[i], ww[i]);
+    }
+    if (!inserted) {
+      s.push(base, mask);
+    }
+
+    return intern(s);
+  }
+
+  /**
+   * @returns the union of first and second; this is first (or second) itself
+   * if the other one is a subset of it
+   */
+  const Set* unite(const Set* first, const Set* second) {
+    if (first == second || second->numWords == 0) {
+      return first;
+    }
+    if (first->numWords == 0) {
+      return second;
+    }
+
+    // union is commutative; memoize on the ordered pair
+    SetKey key =
+        first < second ? SetKey(first, second) : SetKey(second, first);
+    Shard& shard = shards[KeyHash()(key) % numShards];
+
+    shard.lock.lock();
+    auto memo = shard.unions.find(key);
+    if (memo != shard.unions.end()) {
+      const Set* result = memo->second;
+      shard.lock.unlock();
+      numMemoHits += 1;
+      return result;
+    }
+    shard.lock.unlock();
+
+    Scratch& s = *scratch.getLocal();
+    s.clear();
+
+    const WORD* wordsOne     = first->words();
+    const WORD* wordsTwo     = second->words();
+    const unsigned* basesOne = first->bases();
+    const unsigned* basesTwo = second->bases();
+    unsigned i               = 0;
+    unsigned j               = 0;
+    bool addsToFirst         = false;
+    bool addsToSecond        = false;
+
+    while (i < first->numWords && j < second->numWords) {
+      if (basesOne[i] < basesTwo[j]) {
+        s.push(basesOne[i], wordsOne[i]);
+        addsToSecond = true;
+        ++i;
+      } else if (basesTwo[j] < basesOne[i]) {
+        s.push(basesTwo[j], wordsTwo[j]);
+        addsToFirst = true;
+        ++j;
+      } else {
+        WORD merged = wordsOne[i] | wordsTwo[j];
+        addsToFirst |= merged != wordsOne[i];
+        addsToSecond |= merged != wordsTwo[j];
+        s.push(basesOne[i], merged);
+        ++i;
+        ++j;
+      }
+    }
+    for (; i < first->numWords; ++i) {
+      s.push(basesOne[i], wordsOne[i]);
+      addsToSecond = true;
+    }
+    for (; j < second->numWords; ++j) {
+      s.push(basesTwo[j], wordsTwo[j]);
+      addsToFirst = true;
+    }
+
+    const Set* result;
+    if (!addsToFirst) {
+      result = first;
+    } else if (!addsToSecond) {
+      result = second;
+    } else {
+      result = intern(s);
+    }
+
+    shard.lock.lock();
+    shard.unions.emplace(key, result);
+    shard.lock.unlock();
+
+    return result;
+  }
+
+  /**
+   * @returns number of distinct sets created so far
+   */
+  size_t getNumSets() { return numSets.reduce(); }
+
+  /**
+   * @returns bytes used by the contents of all sets created so far
+   */
+  size_t getSetBytes() { return setBytes.reduce(); }
+
+  /**
+   * @returns number of unions answered by the memo table
+   */
+  size_t getNumMemoHits() { return numMemoHits.reduce(); }
+};
+
+/**
+ * Copy-on-write handle to a set in a SharedBitVectorPool. Supports the
+ * operations of SparseBitVector that the points-to solver uses.
+ *
+ * Updates swap the handle to a new set with a compare and swap, so a reader
+ * always sees a complete set and iteration is never disturbed by concurrent
+ * updates (it walks the set that was current when it started).
+ */
+class SharedBitVector {
+  using Set  = SharedBitVectorPool::Set;
+  using WORD = SharedBitVectorPool::WORD;
+
+  galois::CopyableAtomic<const Set*> current;
+  SharedBitVectorPool* pool;
+
+public:
+  using Allocator = SharedBitVectorPool;
+
+  /**
+   * Iterator over the set bits of a snapshot of the vector.
+   */
+  class SBVIterator
+      : public boost::iterator_facade<SBVIterator, const unsigned,
+                                      boost::forward_traversal_tag> {
+    const Set* set;
+    unsigned word;
+    WORD remaining;
+    unsigned currentValue;
+
+    void settle() {
+      while (remaining == 0) {
+        if (++word >= set->numWords) {
+          set = nullptr;
+          return;
+        }
+        remaining = set->words()[word];
+      }
+      currentValue = set->bases()[word] * SharedBitVectorPool::wordSize +
+                     __builtin_ctzll(remaining);
+    }
+
+  public:
+    /**
+     * This is the end for an iterator.
+     */
+    SBVIterator() : set(nullptr), word(0), remaining(0), currentValue(-1) {}
+
+    SBVIterator(const Set* s)
+        : set(s), word(0), remaining(0), currentValue(-1) {
+      if (set->numWords == 0) {
+        set = nullptr;
+      } else {
+        remaining = set->words()[0];
+        settle();
+      }
+    }
+
+  private:
+    friend class boost::iterator_core_access;
+
+    void increment() {
+      remaining &= remaining - 1;
+      settle();
+    }
+
+    bool equal(const SBVIterator& other) const {
+      if (set == nullptr || other.set == nullptr) {
+        return set == other.set;
+      }
+      return set == other.set && word == other.word &&
+             remaining == other.remaining;
+    }
+
+    const unsigned& dereference() const { return currentValue; }
+  };
+
+  SharedBitVector() : current(nullptr), pool(nullptr) {}
+
+  /**
+   * Initialize to the empty set of the pool.
+   *
+   * @param _pool pool that holds the sets
+   */
+  void init(SharedBitVectorPool* _pool) {
+    pool    = _pool;
+    current = pool->empty();
+  }
+
+  /**
+   * @returns the set this vector currently refers to
+   */
+  const Set* get() const { return current.load(); }
+
+  SBVIterator begin() const { return SBVIterator(get()); }
+
+  SBVIterator end() const { return SBVIterator(); }
+
+  /**
+   * Set the provided bit.
+   *
+   * @returns true if the bit wasn't set previously
+   */
+  bool set(unsigned bit) {
+    const Set* cur = get();
+    while (true) {
+      const Set* next = pool->insert(cur, bit);
+      if (next == cur) {
+        return false;
+      }
+      if (current.compare_exchange_weak(cur, next)) {
+        return true;
+      }
+    }
+  }
+
+  bool test(unsigned bit) const {
+    return SharedBitVectorPool::test(get(), bit);
+  }
+
+  bool empty() const { return get()->numWords == 0; }
+
+  /**
+   * @returns true if second has all the bits that this vector has
+   */
+  bool isSubsetEq(const SharedBitVector& second) const {
+    return SharedBitVectorPool::isSubsetEq(get(), second.get());
+  }
+
+  /**
+   * @returns true if both vectors hold the same bits
+   */
+  bool equals(const SharedBitVector& second) const {
+    return get() == second.get();
+  }
+
+  /**
+   * Add all bits of second to this vector.
+   *
+   * @returns number of bits newly set; 0 if nothing changed
+   */
+  unsigned unify(const SharedBitVector& second) {
+    const Set* other = second.get();
+    const Set* cur   = get();
+    while (true) {
+      const Set* next = pool->unite(cur, other);
+      if (next == cur) {
+        return 0;
+      }
+      if (current.compare_exchange_weak(cur, next)) {
+        return next->numBits - cur->numBits;
+      }
+    }
+  }
+
+  unsigned count() const { return get()->numBits; }
+
+  /**
+   * @returns bytes of the handle itself; the set contents are accounted for
+   * by the pool
+   */
+  size_t bytes() const { return sizeof(*this); }
+
+  std::vector<unsigned> getAllSetBits() const {
+    return std::vector<unsigned>(begin(), end());
+  }
+
+  void print(std::ostream& out, std::string prefix = std::string("")) const {
+    std::vector<unsigned> setBits = getAllSetBits();
+    out << "Elements(" << setBits.size() << "): ";
+
+    for (auto setBitNum : setBits) {
+      out << prefix << setBitNum << ", ";
+    }
+
+    out << "\n";
+  }
+};
+
+} // namespace galois
+
+#endif
@@ -357,6 +357,9 @@ struct SparseBitVector {
 
   //////////////////////////////////////////////////////////////////////////////
 
+  //! allocator type passed to init
+  using Allocator = galois::FixedSizeAllocator<Node>;
+
   using NodeType =
       typename std::conditional<IsConcurrent, galois::CopyableAtomic<Node*>,
                                 Node*>::type;
@@ -800,6 +803,24 @@ struct SparseBitVector {
     return nbits;
   }
 
+  /**
+   * @returns true if no bit is set in this bitvector
+   */
+  bool empty() const { return head == nullptr; }
+
+  /**
+   * @returns bytes used by this bitvector, including its linked list nodes
+   */
+  size_t bytes() const {
+    size_t nbytes = sizeof(*this);
+
+    for (Node* ptr = head; ptr; ptr = (ptr->_next)) {
+      nbytes += sizeof(Node);
+    }
+
+    return nbytes;
+  }
+
   /**
    * Gets the set bits in this bitvector and returns them in a vector type.
    *
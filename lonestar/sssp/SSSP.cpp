@@ -30,7 +30,9 @@
 #include "Lonestar/BoilerPlate.h"
 #include "Lonestar/BFS_SSSP.h"
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 namespace cll = llvm::cl;
 
@@ -64,12 +66,16 @@ enum Algo {
   dijkstraTile,
   dijkstra,
   topo,
-  topoTile
+  topoTile,
+  multiQueueTile,
+  multiQueue,
+  deltaFusion
 };
 
-const char* const ALGO_NAMES[] = {"deltaTile", "deltaStep",    "serDeltaTile",
-                                  "serDelta",  "dijkstraTile", "dijkstra",
-                                  "topo",      "topoTile"};
+const char* const ALGO_NAMES[] = {
+    "deltaTile", "deltaStep", "serDeltaTile", "serDelta",       "dijkstraTile",
+    "dijkstra",  "topo",      "topoTile",     "multiQueueTile", "multiQueue",
+    "deltaFusion"};
 
 static cll::opt<Algo>
     algo("algo", cll::desc("Choose an algorithm:"),
@@ -79,7 +85,10 @@ static cll::opt<Algo>
                      clEnumVal(serDelta, "serDelta"),
                      clEnumVal(dijkstraTile, "dijkstraTile"),
                      clEnumVal(dijkstra, "dijkstra"), clEnumVal(topo, "topo"),
-                     clEnumVal(topoTile, "topoTile"), clEnumValEnd),
+                     clEnumVal(topoTile, "topoTile"),
+                     clEnumVal(multiQueueTile, "multiQueueTile"),
+                     clEnumVal(multiQueue, "multiQueue"),
+                     clEnumVal(deltaFusion, "deltaFusion"), clEnumValEnd),
          cll::init(deltaTile));
 
 // typedef galois::graphs::LC_InlineEdge_Graph<std::atomic<unsigned int>,
@@ -93,6 +102,9 @@ typedef Graph::GraphNode GNode;
 constexpr static const bool TRACK_WORK          = false;
 constexpr static const unsigned CHUNK_SIZE      = 64u;
 constexpr static const ptrdiff_t EDGE_TILE_SIZE = 512;
+//! Max number of same-bucket items a thread processes locally before handing
+//! the rest to the worklist
+constexpr static const size_t FUSION_THRESHOLD = 1000;
 
 using SSSP                 = BFS_SSSP<Graph, uint32_t, true, EDGE_TILE_SIZE>;
 using Dist                 = SSSP::Dist;
@@ -105,20 +117,20 @@ using ReqPushWrap          = SSSP::ReqPushWrap;
 using OutEdgeRangeFn       = SSSP::OutEdgeRangeFn;
 using TileRangeFn          = SSSP::TileRangeFn;
 
-template <typename T, typename P, typename R>
+namespace gwl = galois::worklists;
+using PSchunk = gwl::PerSocketChunkFIFO<CHUNK_SIZE>;
+using OBIM    = gwl::OrderedByIntegerMetric<UpdateRequestIndexer, PSchunk>;
+using MQ      = gwl::MultiQueue<UpdateRequestIndexer>;
+
+template <typename T, typename WL, typename P, typename R>
 void deltaStepAlgo(Graph& graph, GNode source, const P& pushWrap,
-                   const R& edgeRange) {
+                   const R& edgeRange, unsigned shift) {
 
   //! [reducible for self-defined stats]
   galois::GAccumulator<size_t> BadWork;
   //! [reducible for self-defined stats]
   galois::GAccumulator<size_t> WLEmptyWork;
 
-  namespace gwl = galois::worklists;
-
-  using PSchunk = gwl::PerSocketChunkFIFO<CHUNK_SIZE>;
-  using OBIM    = gwl::OrderedByIntegerMetric<UpdateRequestIndexer, PSchunk>;
-
   graph.getData(source) = 0;
 
   galois::InsertBag<T> initBag;
@@ -167,7 +179,7 @@ void deltaStepAlgo(Graph& graph, GNode source, const P& pushWrap,
                        }
                      }
                    },
-                   galois::wl<OBIM>(UpdateRequestIndexer{stepShift}),
+                   galois::wl<WL>(UpdateRequestIndexer{shift}),
                    galois::no_conflicts(), galois::loopname("SSSP"));
 
   if (TRACK_WORK) {
@@ -356,6 +368,152 @@ void topoTileAlgo(Graph& graph, const GNode& source) {
   galois::runtime::reportStat_Single("SSSP-topo", "rounds", rounds);
 }
 
+/**
+ * Picks delta from edge weight statistics. Following Meyer and Sanders,
+ * delta ~ max weight / average degree keeps the number of re-relaxations per
+ * bucket small while leaving enough work in each bucket; twice the mean
+ * weight stands in for the max, which is sensitive to outliers. Returns the
+ * shift of the power of two closest below.
+ */
+unsigned autoDeltaShift(Graph& graph) {
+  galois::GAccumulator<uint64_t> weightSum;
+
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   constexpr galois::MethodFlag flag =
+                       galois::MethodFlag::UNPROTECTED;
+                   uint64_t local = 0;
+                   for (auto e : graph.edges(n, flag)) {
+                     local += graph.getEdgeData(e, flag);
+                   }
+                   weightSum += local;
+                 },
+                 galois::steal(), galois::loopname("DeltaStats"));
+
+  if (graph.sizeEdges() == 0) {
+    return 0;
+  }
+  double meanWeight = double(weightSum.reduce()) / graph.sizeEdges();
+  double avgDegree  = double(graph.sizeEdges()) / graph.size();
+  double delta      = std::max(1.0, 2.0 * meanWeight / avgDegree);
+
+  unsigned shift = 0;
+  while (shift < 31 && (2.0 * (1u << shift)) <= delta) {
+    ++shift;
+  }
+  return shift;
+}
+
+using HeavyBeginArray = galois::LargeArray<Graph::edge_iterator>;
+
+/**
+ * Sorts every adjacency list by weight and records the first edge of weight
+ * >= delta, so light and heavy edges of a node are two contiguous ranges.
+ */
+void splitLightHeavy(Graph& graph, unsigned shift,
+                     HeavyBeginArray& heavyBegin) {
+  using EI = Graph::edge_iterator;
+
+  const Dist delta = Dist(1) << shift;
+  heavyBegin.allocateInterleaved(graph.size());
+
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   constexpr galois::MethodFlag flag =
+                       galois::MethodFlag::UNPROTECTED;
+                   graph.sortEdgesByEdgeData(n, std::less<uint32_t>(), flag);
+                   heavyBegin.constructAt(
+                       n, std::partition_point(graph.edge_begin(n, flag),
+                                               graph.edge_end(n, flag),
+                                               [&](EI e) {
+                                                 return graph.getEdgeData(
+                                                            e, flag) < delta;
+                                               }));
+                 },
+                 galois::steal(), galois::loopname("SplitLightHeavy"));
+}
+
+/**
+ * Delta-stepping over edges split by splitLightHeavy, with bucket fusion.
+ * Relaxing a light edge may land in the bucket being processed; such items
+ * are kept in a per-thread bin and processed right away instead of going
+ * through the OBIM worklist (as in GAPBS). Heavy edges always land in a later
+ * bucket and are pushed directly.
+ */
+void deltaFusionAlgo(Graph& graph, GNode source, unsigned shift,
+                     const HeavyBeginArray& heavyBegin) {
+  using EI = Graph::edge_iterator;
+
+  galois::substrate::PerThreadStorage<std::vector<UpdateRequest>> bins;
+  galois::GAccumulator<size_t> fused;
+
+  graph.getData(source) = 0;
+
+  galois::InsertBag<UpdateRequest> initBag;
+  initBag.push(UpdateRequest(source, 0));
+
+  galois::for_each(
+      galois::iterate(initBag),
+      [&](const UpdateRequest& req, auto& ctx) {
+        constexpr galois::MethodFlag flag = galois::MethodFlag::UNPROTECTED;
+        const unsigned bucket             = req.dist >> shift;
+        auto& bin                         = *bins.getLocal();
+        size_t numFused                   = 0;
+
+        auto relax = [&](EI ii, Dist sdist, bool light) {
+          GNode dst          = graph.getEdgeDst(ii);
+          auto& ddist        = graph.getData(dst, flag);
+          const Dist newDist = sdist + graph.getEdgeData(ii, flag);
+
+          Dist oldDist = ddist;
+          while (newDist < oldDist) {
+            if (ddist.compare_exchange_weak(oldDist, newDist,
+                                            std::memory_order_relaxed)) {
+              if (light && (newDist >> shift) == bucket &&
+                  bin.size() < FUSION_THRESHOLD) {
+                bin.emplace_back(dst, newDist);
+                ++numFused;
+              } else {
+                ctx.push(UpdateRequest(dst, newDist));
+              }
+              break;
+            }
+          }
+        };
+
+        auto process = [&](const UpdateRequest item) {
+          const Dist sdist = graph.getData(item.src, flag);
+          if (sdist < item.dist) {
+            return;
+          }
+          EI split = heavyBegin[item.src];
+          for (EI ii = graph.edge_begin(item.src, flag); ii != split; ++ii) {
+            relax(ii, sdist, true);
+          }
+          for (EI ii = split, end = graph.edge_end(item.src, flag); ii != end;
+               ++ii) {
+            relax(ii, sdist, false);
+          }
+        };
+
+        process(req);
+
+        // FIFO order, so the fused items are processed breadth-first like the
+        // rounds of a bucket
+        for (size_t i = 0; i < bin.size(); ++i) {
+          process(bin[i]);
+        }
+        bin.clear();
+        fused += numFused;
+      },
+      galois::wl<OBIM>(UpdateRequestIndexer{shift}), galois::no_conflicts(),
+      galois::loopname("SSSP"));
+
+  galois::runtime::reportStat_Single("SSSP-Fusion", "Delta", 1u << shift);
+  galois::runtime::reportStat_Single("SSSP-Fusion", "FusedItems",
+                                     fused.reduce());
+}
+
 int main(int argc, char** argv) {
   galois::SharedMemSys G;
   LonestarStart(argc, argv, name, desc, url);
@@ -389,6 +547,18 @@ int main(int argc, char** argv) {
                    approxNodeData / galois::runtime::pagePoolSize());
   galois::reportPageAlloc("MeminfoPre");
 
+  unsigned shift = stepShift;
+  HeavyBeginArray heavyBegin;
+  if (algo == deltaFusion) {
+    if (!stepShift.getNumOccurrences()) {
+      shift = autoDeltaShift(graph);
+    }
+    std::cout << "INFO: Using delta-step of " << (1 << shift)
+              << (stepShift.getNumOccurrences() ? "" : " chosen from weights")
+              << "\n";
+    splitLightHeavy(graph, shift, heavyBegin);
+  }
+
   if (algo == deltaStep || algo == deltaTile || algo == serDelta ||
       algo == serDeltaTile) {
     std::cout << "INFO: Using delta-step of " << (1 << stepShift) << "\n";
@@ -410,12 +580,22 @@ int main(int argc, char** argv) {
 
   switch (algo) {
   case deltaTile:
-    deltaStepAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
-                               TileRangeFn());
+    deltaStepAlgo<SrcEdgeTile, OBIM>(graph, source,
+                                     SrcEdgeTilePushWrap{graph}, TileRangeFn(),
+                                     stepShift);
     break;
   case deltaStep:
-    deltaStepAlgo<UpdateRequest>(graph, source, ReqPushWrap(),
-                                 OutEdgeRangeFn{graph});
+    deltaStepAlgo<UpdateRequest, OBIM>(graph, source, ReqPushWrap(),
+                                       OutEdgeRangeFn{graph}, stepShift);
+    break;
+  case multiQueueTile:
+    // The MultiQueue has no bucket structure, so order by exact distance
+    deltaStepAlgo<SrcEdgeTile, MQ>(graph, source, SrcEdgeTilePushWrap{graph},
+                                   TileRangeFn(), 0);
+    break;
+  case multiQueue:
+    deltaStepAlgo<UpdateRequest, MQ>(graph, source, ReqPushWrap(),
+                                     OutEdgeRangeFn{graph}, 0);
     break;
   case serDeltaTile:
     serDeltaAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
@@ -439,6 +619,9 @@ int main(int argc, char** argv) {
   case topoTile:
     topoTileAlgo(graph, source);
     break;
+  case deltaFusion:
+    deltaFusionAlgo(graph, source, shift, heavyBegin);
+    break;
   default:
     std::abort();
   }
@@ -23,6 +23,7 @@
 #include "galois/Timer.h"
 #include "galois/graphs/LCGraph.h"
 #include "galois/ParallelSTL.h"
+#include "galois/SetIntersection.h"
 #include "llvm/Support/CommandLine.h"
 #include "Lonestar/BoilerPlate.h"
 
@@ -55,6 +56,11 @@ static cll::opt<Algo> algo(
                            "Edge Iterator (default)"),
                 clEnumValEnd),
     cll::init(Algo::edgeiterator));
+static cll::opt<unsigned int> hubDegree(
+    "hubDegree",
+    cll::desc("Neighborhood size from which the node iterator intersects "
+              "through a per-thread bitmap (default 1024)"),
+    cll::init(1024));
 
 typedef galois::graphs::LC_CSR_Graph<uint32_t, void>::with_numa_alloc<
     true>::type ::with_no_lockable<true>::type Graph;
@@ -63,71 +69,6 @@ typedef galois::graphs::LC_CSR_Graph<uint32_t, void>::with_numa_alloc<
 
 typedef Graph::GraphNode GNode;
 
-/**
- * Like std::lower_bound but doesn't dereference iterators. Returns the first
- * element for which comp is not true.
- */
-template <typename Iterator, typename Compare>
-Iterator lowerBound(Iterator first, Iterator last, Compare comp) {
-  Iterator it;
-  typename std::iterator_traits<Iterator>::difference_type count, half;
-  count = std::distance(first, last);
-  while (count > 0) {
-    it   = first;
-    half = count / 2;
-    std::advance(it, half);
-    if (comp(it)) {
-      first = ++it;
-      count -= half + 1;
-    } else {
-      count = half;
-    }
-  }
-  return first;
-}
-
-/**
- * std::set_intersection over edge_iterators.
- */
-template <typename G>
-size_t countEqual(G& g, typename G::edge_iterator aa,
-                  typename G::edge_iterator ea, typename G::edge_iterator bb,
-                  typename G::edge_iterator eb) {
-  size_t retval = 0;
-  while (aa != ea && bb != eb) {
-    typename G::GraphNode a = g.getEdgeDst(aa);
-    typename G::GraphNode b = g.getEdgeDst(bb);
-    if (a < b) {
-      ++aa;
-    } else if (b < a) {
-      ++bb;
-    } else {
-      retval += 1;
-      ++aa;
-      ++bb;
-    }
-  }
-  return retval;
-}
-
-template <typename G>
-struct LessThan {
-  G& g;
-  typename G::GraphNode n;
-  LessThan(G& g, typename G::GraphNode n) : g(g), n(n) {}
-  bool operator()(typename G::edge_iterator it) { return g.getEdgeDst(it) < n; }
-};
-
-template <typename G>
-struct GreaterThanOrEqual {
-  G& g;
-  typename G::GraphNode n;
-  GreaterThanOrEqual(G& g, typename G::GraphNode n) : g(g), n(n) {}
-  bool operator()(typename G::edge_iterator it) {
-    return !(n < g.getEdgeDst(it));
-  }
-};
-
 template <typename G>
 struct DegreeLess : public std::binary_function<typename G::GraphNode,
                                                 typename G::GraphNode, bool> {
@@ -162,6 +103,15 @@ struct IdLess {
   }
 };
 
+//! Reports the number of set intersections and their rate
+void reportIntersections(size_t num, const galois::Timer& timer) {
+  double secs = std::max(timer.get_usec(), 1ul) / 1e6;
+  std::cout << "Intersections: " << num << " (" << num / secs << "/s)\n";
+  galois::runtime::reportStat_Single("Triangles", "Intersections", num);
+  galois::runtime::reportStat_Single("Triangles", "IntersectionsPerSec",
+                                     num / secs);
+}
+
 /**
  * Node Iterator algorithm for counting triangles.
  * <code>
@@ -177,7 +127,11 @@ struct IdLess {
 void nodeIteratingAlgo(Graph& graph) {
 
   galois::GAccumulator<size_t> numTriangles;
+  galois::GAccumulator<size_t> numIntersections;
+  galois::substrate::PerThreadStorage<galois::intersection::Bitmap> bitmaps;
 
+  galois::Timer timer;
+  timer.start();
   //! [profile w/ vtune]
   galois::runtime::profileVtune(
       [&]() {
@@ -186,38 +140,53 @@ void nodeIteratingAlgo(Graph& graph) {
             [&](const GNode& n) {
               // Partition neighbors
               // [first, ea) [n] [bb, last)
-              Graph::edge_iterator first =
-                  graph.edge_begin(n, galois::MethodFlag::UNPROTECTED);
-              Graph::edge_iterator last =
-                  graph.edge_end(n, galois::MethodFlag::UNPROTECTED);
-              Graph::edge_iterator ea =
-                  lowerBound(first, last, LessThan<Graph>(graph, n));
-              Graph::edge_iterator bb =
-                  lowerBound(first, last, GreaterThanOrEqual<Graph>(graph, n));
-
-              for (; bb != last; ++bb) {
-                GNode B = graph.getEdgeDst(bb);
-                for (auto aa = first; aa != ea; ++aa) {
-                  GNode A = graph.getEdgeDst(aa);
-                  Graph::edge_iterator vv =
-                      graph.edge_begin(A, galois::MethodFlag::UNPROTECTED);
-                  Graph::edge_iterator ev =
-                      graph.edge_end(A, galois::MethodFlag::UNPROTECTED);
-                  Graph::edge_iterator it =
-                      lowerBound(vv, ev, LessThan<Graph>(graph, B));
-                  if (it != ev && graph.getEdgeDst(it) == B) {
-                    numTriangles += 1;
-                  }
-                }
+              const GNode* first = graph.getEdgeDstPtr(
+                  graph.edge_begin(n, galois::MethodFlag::UNPROTECTED));
+              const GNode* last = graph.getEdgeDstPtr(
+                  graph.edge_end(n, galois::MethodFlag::UNPROTECTED));
+              const GNode* ea = std::lower_bound(first, last, n);
+              const GNode* bb = std::upper_bound(ea, last, n);
+              size_t nb       = last - bb;
+              if (ea == first || nb == 0)
+                return;
+
+              // A hub's upper neighborhood is shared by all of its lower
+              // neighbors; mark it once instead of merging it every time.
+              galois::intersection::Bitmap* bitmap = nullptr;
+              if (nb >= hubDegree && ea - first > 1) {
+                bitmap = bitmaps.getLocal();
+                if (bitmap->empty())
+                  bitmap->resize(graph.size());
+                bitmap->mark(bb, nb);
               }
+
+              size_t local = 0;
+              for (const GNode* aa = first; aa != ea; ++aa) {
+                GNode A         = *aa;
+                const GNode* vv = graph.getEdgeDstPtr(
+                    graph.edge_begin(A, galois::MethodFlag::UNPROTECTED));
+                const GNode* ev = graph.getEdgeDstPtr(
+                    graph.edge_end(A, galois::MethodFlag::UNPROTECTED));
+                vv = std::upper_bound(vv, ev, n);
+                local += bitmap ? bitmap->count(vv, ev - vv)
+                                : galois::intersection::count(vv, ev - vv,
+                                                              bb, nb);
+              }
+
+              if (bitmap)
+                bitmap->unmark(bb, nb);
+              numTriangles += local;
+              numIntersections += ea - first;
             },
             galois::chunk_size<32>(), galois::steal(),
             galois::loopname("nodeIteratingAlgo"));
       },
       "nodeIteratorAlgo");
   //! [profile w/ vtune]
+  timer.stop();
 
   std::cout << "NumTriangles: " << numTriangles.reduce() << "\n";
+  reportIntersections(numIntersections.reduce(), timer);
 }
 
 /**
@@ -242,6 +211,7 @@ void edgeIteratingAlgo(Graph& graph) {
   };
 
   galois::InsertBag<WorkItem> items;
+  galois::GAccumulator<size_t> numItems;
   galois::GAccumulator<size_t> numTriangles;
 
   galois::do_all(galois::iterate(graph),
@@ -249,12 +219,16 @@ void edgeIteratingAlgo(Graph& graph) {
                    for (Graph::edge_iterator edge :
                         graph.out_edges(n, galois::MethodFlag::UNPROTECTED)) {
                      GNode dst = graph.getEdgeDst(edge);
-                     if (n < dst)
+                     if (n < dst) {
                        items.push(WorkItem(n, dst));
+                       numItems += 1;
+                     }
                    }
                  },
                  galois::loopname("Initialize"));
 
+  galois::Timer timer;
+  timer.start();
   //  galois::runtime::profileVtune(
   //! [profile w/ papi]
   galois::runtime::profilePapi(
@@ -264,33 +238,32 @@ void edgeIteratingAlgo(Graph& graph) {
             [&](const WorkItem& w) {
               // Compute intersection of range (w.src, w.dst) in neighbors of
               // w.src and w.dst
-              Graph::edge_iterator abegin =
-                  graph.edge_begin(w.src, galois::MethodFlag::UNPROTECTED);
-              Graph::edge_iterator aend =
-                  graph.edge_end(w.src, galois::MethodFlag::UNPROTECTED);
-              Graph::edge_iterator bbegin =
-                  graph.edge_begin(w.dst, galois::MethodFlag::UNPROTECTED);
-              Graph::edge_iterator bend =
-                  graph.edge_end(w.dst, galois::MethodFlag::UNPROTECTED);
-
-              Graph::edge_iterator aa = lowerBound(
-                  abegin, aend, GreaterThanOrEqual<Graph>(graph, w.src));
-              Graph::edge_iterator ea =
-                  lowerBound(abegin, aend, LessThan<Graph>(graph, w.dst));
-              Graph::edge_iterator bb = lowerBound(
-                  bbegin, bend, GreaterThanOrEqual<Graph>(graph, w.src));
-              Graph::edge_iterator eb =
-                  lowerBound(bbegin, bend, LessThan<Graph>(graph, w.dst));
-
-              numTriangles += countEqual(graph, aa, ea, bb, eb);
+              const GNode* abegin = graph.getEdgeDstPtr(
+                  graph.edge_begin(w.src, galois::MethodFlag::UNPROTECTED));
+              const GNode* aend = graph.getEdgeDstPtr(
+                  graph.edge_end(w.src, galois::MethodFlag::UNPROTECTED));
+              const GNode* bbegin = graph.getEdgeDstPtr(
+                  graph.edge_begin(w.dst, galois::MethodFlag::UNPROTECTED));
+              const GNode* bend = graph.getEdgeDstPtr(
+                  graph.edge_end(w.dst, galois::MethodFlag::UNPROTECTED));
+
+              const GNode* aa = std::upper_bound(abegin, aend, w.src);
+              const GNode* ea = std::lower_bound(aa, aend, w.dst);
+              const GNode* bb = std::upper_bound(bbegin, bend, w.src);
+              const GNode* eb = std::lower_bound(bb, bend, w.dst);
+
+              numTriangles +=
+                  galois::intersection::count(aa, ea - aa, bb, eb - bb);
             },
             galois::loopname("edgeIteratingAlgo"), galois::chunk_size<32>(),
             galois::steal());
       },
       "edgeIteratorAlgo");
   //! [profile w/ papi]
+  timer.stop();
 
   std::cout << "NumTriangles: " << numTriangles.reduce() << "\n";
+  reportIntersections(numItems.reduce(), timer);
 }
 
 void makeGraph(Graph& graph, const std::string& triangleFilename) {
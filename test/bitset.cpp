@@ -0,0 +1,164 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+#include "galois/Galois.h"
+#include "galois/DynamicBitset.h"
+#include "galois/Timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+//! Reference offsets of the set bits in [begin, end), one bit at a time
+std::vector<uint32_t> scan(const galois::DynamicBitSet& bitset, size_t begin,
+                           size_t end) {
+  std::vector<uint32_t> ret;
+  for (size_t i = begin; i < end; ++i) {
+    if (bitset.test(i))
+      ret.push_back(i);
+  }
+  return ret;
+}
+
+void checkRange(const galois::DynamicBitSet& bitset, size_t begin,
+                size_t end) {
+  std::vector<uint32_t> expected = scan(bitset, begin, end);
+  std::vector<uint32_t> got;
+  bitset.for_each_set(begin, end, [&](size_t i) { got.push_back(i); });
+  GALOIS_ASSERT(got == expected);
+  GALOIS_ASSERT(bitset.count(begin, end) == expected.size());
+}
+
+void check(const galois::DynamicBitSet& bitset, std::mt19937& gen) {
+  size_t n = bitset.size();
+  checkRange(bitset, 0, n);
+  GALOIS_ASSERT(bitset.getOffsets() == scan(bitset, 0, n));
+  GALOIS_ASSERT(bitset.count() == scan(bitset, 0, n).size());
+  galois::DynamicBitSet seen;
+  seen.resize(n);
+  bitset.parallel_for_each_set([&](size_t i) {
+    GALOIS_ASSERT(!seen.test(i));
+    seen.set(i);
+  });
+  GALOIS_ASSERT(seen.getOffsets() == scan(bitset, 0, n));
+  std::uniform_int_distribution<size_t> dist(0, n);
+  for (int i = 0; i < 50; ++i) {
+    size_t x = dist(gen), y = dist(gen);
+    checkRange(bitset, std::min(x, y), std::max(x, y));
+  }
+}
+
+void test(size_t n, double density, bool summary, std::mt19937& gen) {
+  galois::DynamicBitSet bitset;
+  if (summary)
+    bitset.enable_summary();
+  bitset.resize(n);
+
+  std::bernoulli_distribution coin(density);
+  std::vector<char> bits(n);
+  for (size_t i = 0; i < n; ++i)
+    bits[i] = coin(gen);
+  // concurrent sets keep the summary consistent
+  galois::do_all(galois::iterate((size_t)0, n), [&](size_t i) {
+    if (bits[i])
+      bitset.set(i);
+  });
+  check(bitset, gen);
+
+  // inclusive range reset, including partial words at both ends
+  std::uniform_int_distribution<size_t> dist(0, n - 1);
+  for (int i = 0; i < 5; ++i) {
+    size_t x = dist(gen), y = dist(gen);
+    size_t first = std::min(x, y), last = std::max(x, y);
+    bitset.reset(first, last);
+    GALOIS_ASSERT(bitset.count(first, last + 1) == 0);
+    check(bitset, gen);
+  }
+
+  // bits set again after a reset must be found through the summary
+  for (size_t i = 0; i < n; i += 97)
+    bitset.set(i);
+  check(bitset, gen);
+
+  galois::DynamicBitSet other;
+  other.resize(n);
+  for (size_t i = 0; i < n; i += 3)
+    other.set(i);
+  bitset.bitwise_or(other);
+  check(bitset, gen);
+
+  // a resize clears the bitset, growing or shrinking
+  bitset.resize(n / 2 + 1);
+  GALOIS_ASSERT(bitset.count() == 0 && bitset.getOffsets().empty());
+  bitset.set(n / 2);
+  bitset.resize(n + 200);
+  GALOIS_ASSERT(bitset.count() == 0 && bitset.count(0, n + 200) == 0);
+  bitset.set(n + 199);
+  check(bitset, gen);
+  bitset.reset();
+  GALOIS_ASSERT(bitset.count(0, bitset.size()) == 0);
+}
+
+void bench(size_t n, size_t numSet) {
+  std::mt19937 gen(numSet);
+  std::uniform_int_distribution<size_t> dist(0, n - 1);
+  for (bool summary : {false, true}) {
+    galois::DynamicBitSet bitset;
+    if (summary)
+      bitset.enable_summary();
+    bitset.resize(n);
+    for (size_t i = 0; i < numSet; ++i)
+      bitset.set(dist(gen));
+
+    galois::Timer tBit, tWord, tReset;
+    tBit.start();
+    size_t bitCount = scan(bitset, 0, n).size();
+    tBit.stop();
+    tWord.start();
+    std::vector<uint32_t> offsets = bitset.getOffsets();
+    tWord.stop();
+    tReset.start();
+    bitset.reset(0, n - 1);
+    tReset.stop();
+    GALOIS_ASSERT(bitCount == offsets.size());
+
+    std::printf("  %zu bits, %zu set, summary %d: bit scan %lu us, "
+                "getOffsets %lu us, reset %lu us\n",
+                n, numSet, summary, tBit.get_usec(), tWord.get_usec(),
+                tReset.get_usec());
+  }
+}
+
+int main() {
+  galois::SharedMemSys Galois_runtime;
+  galois::setActiveThreads(2);
+  std::mt19937 gen(0);
+
+  for (size_t n : {1, 63, 64, 65, 4095, 4096, 4097, 100000}) {
+    for (double density : {0.0, 0.001, 0.3, 1.0}) {
+      test(n, density, false, gen);
+      test(n, density, true, gen);
+    }
+  }
+
+  bench(10000000, 1000);
+  bench(10000000, 1000000);
+
+  return 0;
+}
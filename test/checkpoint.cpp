@@ -0,0 +1,142 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#include "galois/Galois.h"
+#include "galois/runtime/CheckpointWriter.h"
+
+#include <boost/serialization/vector.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using galois::runtime::CheckpointWriter;
+
+//! Node data that owns memory and checkpoints through boost
+struct VectorNode {
+  std::vector<double> values;
+
+  template <class Archive>
+  void serialize(Archive& ar, const unsigned int) {
+    ar& values;
+  }
+};
+
+//! Node data that owns nothing and is copied byte for byte
+struct AtomicNode {
+  std::atomic<uint32_t> count;
+  float value;
+};
+
+static_assert(!galois::runtime::internal::checkpoint_by_copy<VectorNode>::value,
+              "nodes with a vector must be serialized");
+static_assert(galois::runtime::internal::checkpoint_by_copy<AtomicNode>::value,
+              "nodes of scalars and atomics are copied");
+
+static const size_t numNodes = 100;
+static const std::string prefix = "checkpoint-test";
+
+static void set(VectorNode& n, size_t i, double scale) {
+  n.values.assign(i % 7, i * scale);
+}
+static bool equal(const VectorNode& n, size_t i, double scale) {
+  VectorNode expected;
+  set(expected, i, scale);
+  return n.values == expected.values;
+}
+static void set(AtomicNode& n, size_t i, double scale) {
+  n.count = i;
+  n.value = i * scale;
+}
+static bool equal(const AtomicNode& n, size_t i, double scale) {
+  return n.count == i && n.value == (float)(i * scale);
+}
+
+/**
+ * Saves a full snapshot and a delta with every third node changed, clobbers
+ * the nodes, replays the manifest and checks that the nodes are back.
+ */
+template <typename NodeTy>
+void roundTrip() {
+  std::vector<NodeTy> nodes(numNodes);
+  for (size_t i = 0; i < numNodes; ++i)
+    set(nodes[i], i, 1.0);
+
+  {
+    CheckpointWriter writer(prefix);
+
+    CheckpointWriter::Snapshot& full = writer.nextSnapshot();
+    full.full     = true;
+    full.numNodes = numNodes;
+    full.nodes.clear();
+    galois::runtime::saveSnapshotNodes<NodeTy>(
+        full, [&](size_t i) -> NodeTy& { return nodes[i]; });
+    writer.submit();
+
+    CheckpointWriter::Snapshot& delta = writer.nextSnapshot();
+    delta.full     = false;
+    delta.numNodes = numNodes;
+    delta.nodes.clear();
+    for (size_t i = 0; i < numNodes; i += 3) {
+      set(nodes[i], i, 2.0);
+      delta.nodes.push_back(i);
+    }
+    galois::runtime::saveSnapshotNodes<NodeTy>(
+        delta, [&](size_t n) -> NodeTy& { return nodes[delta.nodes[n]]; });
+    writer.submit(false);
+  }
+
+  for (size_t i = 0; i < numNodes; ++i)
+    set(nodes[i], i + 1, 3.0);
+
+  size_t applied = CheckpointWriter::replay(
+      prefix, [&](const CheckpointWriter::Snapshot& snapshot) {
+        GALOIS_ASSERT(snapshot.numNodes == numNodes);
+        if (snapshot.full) {
+          galois::runtime::applySnapshotNodes<NodeTy>(
+              snapshot, [&](size_t i) -> NodeTy& { return nodes[i]; });
+        } else {
+          galois::runtime::applySnapshotNodes<NodeTy>(
+              snapshot,
+              [&](size_t n) -> NodeTy& { return nodes[snapshot.nodes[n]]; });
+        }
+      });
+
+  std::remove((prefix + ".0").c_str());
+  std::remove((prefix + ".1").c_str());
+  std::remove((prefix + ".manifest").c_str());
+
+  if (applied != 2)
+    GALOIS_DIE("expected 2 snapshots, replayed ", applied);
+  for (size_t i = 0; i < numNodes; ++i) {
+    if (!equal(nodes[i], i, i % 3 == 0 ? 2.0 : 1.0))
+      GALOIS_DIE("node ", i, " not restored");
+  }
+}
+
+int main() {
+  galois::SharedMemSys G;
+  galois::setActiveThreads(2);
+
+  roundTrip<VectorNode>();
+  roundTrip<AtomicNode>();
+  return 0;
+}
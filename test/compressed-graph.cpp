@@ -0,0 +1,114 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/graphs/LCGraph.h"
+#include "galois/graphs/Util.h"
+
+#include <cstdio>
+#include <random>
+#include <set>
+#include <utility>
+
+typedef galois::graphs::FileGraph FileGraph;
+typedef galois::graphs::LC_CSR_Graph<int, int>::with_no_lockable<true>::type
+    CSRGraph;
+typedef galois::graphs::LC_Compressed_CSR_Graph<int, int>::with_no_lockable<
+    true>::type CompressedGraph;
+
+//! Random graph with duplicate edges, self loops, empty lists and hub nodes
+void makeGraph(FileGraph& out, size_t numNodes) {
+  std::mt19937 gen(0);
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  for (size_t src = 0; src < numNodes; ++src) {
+    size_t deg = (src % 7 == 0) ? 0 : gen() % 16;
+    if (src % 101 == 0)
+      deg = numNodes / 2;
+    for (size_t i = 0; i < deg; ++i)
+      edges.emplace_back(src, gen() % numNodes);
+    if (src % 13 == 0)
+      edges.emplace_back(src, src);
+  }
+
+  galois::graphs::FileGraphWriter w;
+  w.setNumNodes(numNodes);
+  w.setNumEdges(edges.size());
+  w.setSizeofEdgeData(sizeof(int));
+  w.phase1();
+  for (auto& e : edges)
+    w.incrementDegree(e.first);
+  w.phase2();
+  std::vector<int> data(edges.size());
+  for (auto& e : edges)
+    data[w.addNeighbor(e.first, e.second)] = e.first ^ e.second;
+  int* rawData = w.finish<int>();
+  std::copy(data.begin(), data.end(), rawData);
+  out = w;
+}
+
+template <typename G>
+std::multiset<std::pair<uint32_t, int>> neighbors(G& g, uint32_t n) {
+  std::multiset<std::pair<uint32_t, int>> ret;
+  for (auto e : g.edges(n))
+    ret.emplace(g.getEdgeDst(e), g.getEdgeData(e));
+  return ret;
+}
+
+void check(CSRGraph& expected, CompressedGraph& g) {
+  GALOIS_ASSERT(expected.size() == g.size());
+  GALOIS_ASSERT(expected.sizeEdges() == g.sizeEdges());
+
+  for (auto n : expected) {
+    GALOIS_ASSERT(neighbors(expected, n) == neighbors(g, n));
+
+    auto ii = g.edge_begin(n), ei = g.edge_end(n);
+    GALOIS_ASSERT(size_t(ei - ii) == g.getDegree(n));
+    GALOIS_ASSERT(size_t(std::distance(ii, ei)) == g.getDegree(n));
+    for (size_t k = 0, d = g.getDegree(n); k < d; ++k)
+      GALOIS_ASSERT((ii + k) - ii == std::ptrdiff_t(k));
+    for (auto jj = ii; jj != ei; ++jj)
+      GALOIS_ASSERT(g.findEdge(n, g.getEdgeDst(jj)) != ei);
+  }
+}
+
+int main() {
+  galois::SharedMemSys Galois_runtime;
+  galois::setActiveThreads(galois::substrate::getThreadPool().getMaxThreads());
+
+  FileGraph f;
+  makeGraph(f, 5000);
+
+  CSRGraph expected;
+  galois::graphs::readGraph(expected, f);
+
+  CompressedGraph g;
+  galois::graphs::readGraph(g, f);
+  check(expected, g);
+  GALOIS_ASSERT(g.sizeEdgeBytes() < g.sizeEdges() * sizeof(uint32_t));
+
+  std::string filename = "compressed-graph-test.vgr";
+  g.toFile(filename);
+  GALOIS_ASSERT(CompressedGraph::isCompressedFile(filename));
+  CompressedGraph h;
+  galois::graphs::readGraph(h, filename);
+  std::remove(filename.c_str());
+  check(expected, h);
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Reduction.h"
+#include "galois/Timer.h"
+#include "galois/substrate/ThreadPool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+//! Fork/join latency in ns of an empty do_all over one item per thread
+double emptyLoop(unsigned numThreads, unsigned rounds) {
+  auto loop = [&] {
+    galois::do_all(galois::iterate(0U, numThreads),
+                   [](unsigned) { asm volatile("" ::: "memory"); });
+  };
+  for (unsigned r = 0; r < std::min(rounds, 100U); ++r)
+    loop();
+
+  galois::Timer t;
+  t.start();
+  for (unsigned r = 0; r < rounds; ++r)
+    loop();
+  t.stop();
+  return t.get_usec() * 1000.0 / rounds;
+}
+
+//! Checks that every thread still picks up work after a mode switch
+void check(unsigned numThreads) {
+  galois::GAccumulator<unsigned> count;
+  galois::on_each([&](unsigned, unsigned) { count += 1; });
+  GALOIS_ASSERT(count.reduce() == numThreads);
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys Galois_runtime;
+  auto& pool = galois::substrate::getThreadPool();
+
+  unsigned rounds   = argc > 1 ? std::stoul(argv[1]) : 20000;
+  unsigned budget   = pool.getSpinBudget() ? pool.getSpinBudget() : 100;
+  unsigned original = pool.getSpinBudget();
+  unsigned maxT     = std::min(256U, pool.getMaxUsableThreads());
+
+  std::printf("%8s %12s %12s %12s %12s\n", "threads", "block(ns)",
+              "burn(ns)", "adaptive(ns)", "adapt+burn");
+  for (unsigned numT = 1;; numT = std::min(numT * 2, maxT)) {
+    galois::setActiveThreads(numT);
+
+    pool.setSpinBudget(0);
+    check(numT);
+    double block = emptyLoop(numT, rounds);
+    pool.burnPower(numT);
+    check(numT);
+    double burn = emptyLoop(numT, rounds);
+    pool.beKind();
+
+    pool.setSpinBudget(budget);
+    check(numT);
+    double adaptive = emptyLoop(numT, rounds);
+    pool.burnPower(numT);
+    double both = emptyLoop(numT, rounds);
+    pool.beKind();
+    check(numT);
+
+    std::printf("%8u %12.0f %12.0f %12.0f %12.0f\n", numT, block, burn,
+                adaptive, both);
+    if (numT == maxT)
+      break;
+  }
+
+  pool.setSpinBudget(original);
+  return 0;
+}
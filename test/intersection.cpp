@@ -0,0 +1,139 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/SetIntersection.h"
+#include "galois/Timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace intersection = galois::intersection;
+
+std::vector<uint32_t> randomSet(std::mt19937& gen, size_t size,
+                                uint32_t universe) {
+  std::vector<uint32_t> ret;
+  std::uniform_int_distribution<uint32_t> dist(0, universe - 1);
+  while (ret.size() < size) {
+    for (size_t i = ret.size(); i < size; ++i)
+      ret.push_back(dist(gen));
+    std::sort(ret.begin(), ret.end());
+    ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+  }
+  return ret;
+}
+
+size_t expected(const std::vector<uint32_t>& a,
+                const std::vector<uint32_t>& b) {
+  std::vector<uint32_t> out;
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(out));
+  return out.size();
+}
+
+void check(const std::vector<uint32_t>& x, const std::vector<uint32_t>& y,
+           uint32_t universe) {
+  size_t e = expected(x, y);
+  GALOIS_ASSERT(intersection::countMerge(x.data(), x.size(), y.data(),
+                                         y.size()) == e);
+  GALOIS_ASSERT(intersection::countSIMD(x.data(), x.size(), y.data(),
+                                        y.size()) == e);
+  GALOIS_ASSERT(intersection::countSIMD(y.data(), y.size(), x.data(),
+                                        x.size()) == e);
+  GALOIS_ASSERT(intersection::countGallop(x.data(), x.size(), y.data(),
+                                          y.size()) == e);
+  GALOIS_ASSERT(intersection::count(x.data(), x.size(), y.data(), y.size()) ==
+                e);
+
+  std::vector<uint32_t> out(std::min(x.size(), y.size()));
+  size_t n =
+      intersection::intersect(x.data(), x.size(), y.data(), y.size(), out.data());
+  std::vector<uint32_t> ref;
+  std::set_intersection(x.begin(), x.end(), y.begin(), y.end(),
+                        std::back_inserter(ref));
+  GALOIS_ASSERT(n == e && std::equal(ref.begin(), ref.end(), out.begin()));
+
+  intersection::Bitmap bitmap(universe);
+  bitmap.mark(x.data(), x.size());
+  GALOIS_ASSERT(bitmap.count(y.data(), y.size()) == e);
+  bitmap.unmark(x.data(), x.size());
+  GALOIS_ASSERT(bitmap.count(y.data(), y.size()) == 0);
+}
+
+template <typename Fn>
+void bench(const char* name, const std::vector<std::vector<uint32_t>>& sets,
+           size_t pairs, Fn fn) {
+  galois::Timer t;
+  size_t total = 0;
+  t.start();
+  for (size_t i = 0; i < pairs; ++i) {
+    auto& a = sets[i % sets.size()];
+    auto& b = sets[(i * 7 + 1) % sets.size()];
+    total += fn(a.data(), a.size(), b.data(), b.size());
+  }
+  t.stop();
+  double secs = std::max(t.get_usec(), 1ul) / 1e6;
+  std::printf("  %-8s %12.0f intersections/s (%zu common)\n", name,
+              pairs / secs, total);
+}
+
+void benchRatio(size_t small, size_t ratio, size_t pairs) {
+  std::mt19937 gen(small * ratio);
+  uint32_t universe = small * ratio * 4;
+  std::vector<std::vector<uint32_t>> sets;
+  for (int i = 0; i < 8; ++i)
+    sets.push_back(randomSet(gen, i % 2 ? small : small * ratio, universe));
+
+  std::printf("sizes %zu x %zu:\n", small, small * ratio);
+  bench("merge", sets, pairs, intersection::countMerge);
+  bench("simd", sets, pairs, intersection::countSIMD);
+  bench("gallop", sets, pairs, [](const uint32_t* a, size_t na,
+                                  const uint32_t* b, size_t nb) {
+    return na <= nb ? intersection::countGallop(a, na, b, nb)
+                    : intersection::countGallop(b, nb, a, na);
+  });
+  bench("adaptive", sets, pairs, intersection::count);
+}
+
+int main(int argc, char** argv) {
+  std::mt19937 gen(0);
+
+  // Edge cases around the SIMD block widths and empty sets
+  for (size_t na : {0, 1, 7, 8, 9, 15, 16, 17, 31, 64, 100}) {
+    for (size_t nb : {0, 1, 8, 16, 33, 100, 5000}) {
+      for (uint32_t universe : {200u, 100000u}) {
+        if (na > universe || nb > universe)
+          continue;
+        check(randomSet(gen, na, universe), randomSet(gen, nb, universe),
+              universe);
+      }
+    }
+  }
+
+  size_t pairs = argc > 1 ? std::stoul(argv[1]) : 20000;
+  benchRatio(64, 1, pairs);
+  benchRatio(1024, 1, pairs / 8);
+  benchRatio(32, 64, pairs);
+
+  return 0;
+}
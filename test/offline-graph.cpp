@@ -0,0 +1,136 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Timer.h"
+#include "galois/graphs/FileGraph.h"
+#include "galois/graphs/OfflineGraph.h"
+
+#include <cstdio>
+#include <random>
+#include <unistd.h>
+
+typedef galois::graphs::FileGraph FileGraph;
+typedef galois::graphs::OfflineGraph OfflineGraph;
+
+//! Random graph with empty lists and a few hub nodes
+void makeGraph(FileGraph& out, size_t numNodes) {
+  std::mt19937 gen(0);
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  for (size_t src = 0; src < numNodes; ++src) {
+    size_t deg = (src % 7 == 0) ? 0 : gen() % 16;
+    if (src % 10007 == 0)
+      deg = numNodes / 4;
+    for (size_t i = 0; i < deg; ++i)
+      edges.emplace_back(src, gen() % numNodes);
+  }
+
+  galois::graphs::FileGraphWriter w;
+  w.setNumNodes(numNodes);
+  w.setNumEdges(edges.size());
+  w.setSizeofEdgeData(sizeof(uint32_t));
+  w.phase1();
+  for (auto& e : edges)
+    w.incrementDegree(e.first);
+  w.phase2();
+  std::vector<uint32_t> data(edges.size());
+  for (auto& e : edges)
+    data[w.addNeighbor(e.first, e.second)] = e.first ^ e.second;
+  uint32_t* rawData = w.finish<uint32_t>();
+  std::copy(data.begin(), data.end(), rawData);
+  out = w;
+}
+
+//! Compares every node, edge and datum of g against the in-memory graph
+void check(FileGraph& expected, OfflineGraph& g) {
+  GALOIS_ASSERT(expected.size() == g.size());
+  GALOIS_ASSERT(expected.sizeEdges() == g.sizeEdges());
+
+  galois::on_each([&](unsigned tid, unsigned numT) {
+    auto r = galois::block_range(expected.begin(), expected.end(), tid, numT);
+    for (auto ii = r.first; ii != r.second; ++ii) {
+      auto n = *ii;
+      GALOIS_ASSERT(*expected.edge_begin(n) == *g.edge_begin(n));
+      GALOIS_ASSERT(*expected.edge_end(n) == *g.edge_end(n));
+      for (auto e : g.edges(n)) {
+        auto fe = expected.edge_begin(n) + (*e - *g.edge_begin(n));
+        GALOIS_ASSERT(expected.getEdgeDst(fe) == g.getEdgeDst(e));
+        GALOIS_ASSERT(expected.getEdgeData<uint32_t>(fe) ==
+                      g.getEdgeData<uint32_t>(e));
+      }
+    }
+  });
+}
+
+//! Times a serial scan of all edge destinations, the partitioners' pattern
+void scan(const char* name, OfflineGraph& g) {
+  galois::Timer t;
+  g.reset_seek_counters();
+  t.start();
+  uint64_t sum = 0;
+  for (auto n : g)
+    for (auto e : g.edges(n))
+      sum += g.getEdgeDst(e);
+  t.stop();
+  std::printf("%s: %lu ms, %lu bytes in %lu seeks (checksum %lu)\n", name,
+              t.get(), g.num_bytes_read(), g.num_seeks(), sum);
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys Galois_runtime;
+  galois::setActiveThreads(4);
+
+  size_t numNodes = argc > 1 ? std::stoul(argv[1]) : 200000;
+
+  char filename[] = "/tmp/offline-graph-XXXXXX";
+  int fd          = mkstemp(filename);
+  GALOIS_ASSERT(fd != -1);
+  close(fd);
+
+  FileGraph expected;
+  makeGraph(expected, numNodes);
+  expected.toFile(filename);
+
+  OfflineGraph mapped(filename);
+  OfflineGraph buffered(filename, false);
+  GALOIS_ASSERT(mapped.isMapped() && !buffered.isMapped());
+
+  check(expected, mapped);
+  check(expected, buffered);
+
+  for (unsigned total : {1, 3, 8}) {
+    for (unsigned id = 0; id < total; ++id) {
+      auto x = mapped.divideByNode(1, 1, id, total);
+      auto y = buffered.divideByNode(1, 1, id, total);
+      GALOIS_ASSERT(*x.first.first == *y.first.first &&
+                    *x.first.second == *y.first.second);
+      GALOIS_ASSERT(*x.second.first == *y.second.first &&
+                    *x.second.second == *y.second.second);
+    }
+  }
+
+  OfflineGraph moved(std::move(buffered));
+  check(expected, moved);
+
+  scan("mmap", mapped);
+  scan("pread", moved);
+
+  unlink(filename);
+  return 0;
+}
@@ -0,0 +1,268 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/gIO.h"
+#include "galois/graphs/Graph.h"
+#include "galois/runtime/Context.h"
+
+#include <thread>
+#include <vector>
+
+using namespace galois::runtime;
+
+typedef galois::graphs::MorphGraph<unsigned, void, true> Graph;
+typedef Graph::GraphNode GNode;
+
+static const unsigned numNodes   = 64;
+static const unsigned walkLength = 6;
+
+//! @returns true if f signals a conflict
+template <typename F>
+bool conflicts(F f) {
+#ifdef GALOIS_USE_LONGJMP_ABORT
+  if (setjmp(execFrame) == 0) {
+    f();
+    return false;
+  }
+  return true;
+#else
+  try {
+    f();
+  } catch (ConflictFlag const&) {
+    return true;
+  }
+  return false;
+#endif
+}
+
+void check(bool cond, const char* what) {
+  if (!cond)
+    GALOIS_DIE(what);
+}
+
+//! Every node has two out-edges, to n + 1 and n + 7
+void makeRing(Graph& g, std::vector<GNode>& nodes) {
+  for (unsigned i = 0; i < numNodes; ++i) {
+    nodes.push_back(g.createNode(0));
+    g.addNode(nodes.back());
+  }
+  for (unsigned i = 0; i < numNodes; ++i) {
+    g.addMultiEdge(nodes[i], nodes[(i + 1) % numNodes],
+                   galois::MethodFlag::UNPROTECTED);
+    g.addMultiEdge(nodes[i], nodes[(i + 7) % numNodes],
+                   galois::MethodFlag::UNPROTECTED);
+  }
+}
+
+/**
+ * Walks from u with MethodFlag::READ, as the mesh walks do, then retargets
+ * one out-edge of u to where the walk ended. The edge is removed and added
+ * back in place, so walkers can observe a node with a single out-edge.
+ */
+template <typename Cautious>
+void rewire(Graph& g, GNode u, Cautious cautious) {
+  g.getData(u, galois::MethodFlag::WRITE);
+  GNode cur = u;
+  for (unsigned hop = 0; hop < walkLength; ++hop) {
+    unsigned degree = 0;
+    GNode next      = cur;
+    for (auto ii : g.edges(cur, galois::MethodFlag::READ)) {
+      if (degree++ == hop % 2)
+        next = g.getEdgeDst(ii);
+      // let a rewire of cur start under the walker
+      std::this_thread::yield();
+    }
+    if (degree != 2) {
+      checkOptimisticReads();
+      GALOIS_DIE("walked a half-rewired node without a conflict");
+    }
+    cur = next;
+  }
+  cautious();
+
+  g.removeEdge(u, g.edge_begin(u, galois::MethodFlag::UNPROTECTED),
+               galois::MethodFlag::UNPROTECTED);
+  std::this_thread::yield();
+  g.addMultiEdge(u, cur, galois::MethodFlag::UNPROTECTED);
+  g.getData(u, galois::MethodFlag::UNPROTECTED) += 1;
+}
+
+void checkRing(Graph& g, std::vector<GNode>& nodes, unsigned rounds) {
+  unsigned visits = 0;
+  for (GNode n : nodes) {
+    visits += g.getData(n);
+    check(std::distance(g.edge_begin(n), g.edge_end(n)) == 2,
+          "rewiring lost an edge");
+  }
+  check(visits == rounds * numNodes, "lost or repeated a rewire");
+}
+
+int main() {
+  SimpleRuntimeContext a(false, true);
+  SimpleRuntimeContext b(false, true);
+  Lockable x, y;
+
+  // readers do not conflict with each other
+  a.startIteration();
+  b.startIteration();
+  setThreadContext(&a);
+  acquire(&x, galois::MethodFlag::READ);
+  setThreadContext(&b);
+  acquire(&x, galois::MethodFlag::READ);
+  check(!conflicts([&] { b.cautiousPoint(); }), "reader aborted reader");
+  setThreadContext(&a);
+  check(!conflicts([&] { a.cautiousPoint(); }), "reader aborted reader");
+  check(a.commitIteration() == 0, "reader took a lock");
+  check(b.commitIteration() == 0, "reader took a lock");
+
+  // a committed write invalidates an earlier read
+  a.startIteration();
+  b.startIteration();
+  setThreadContext(&a);
+  acquire(&x, galois::MethodFlag::READ);
+  setThreadContext(&b);
+  acquire(&x, galois::MethodFlag::WRITE);
+  acquire(&y, galois::MethodFlag::WRITE);
+  check(!conflicts([&] { b.cautiousPoint(); }), "writer aborted");
+  check(b.commitIteration() == 2, "writer did not lock its write set");
+  setThreadContext(&a);
+  check(conflicts([&] { a.cautiousPoint(); }), "stale read validated");
+  a.cancelIteration();
+  check(a.getValidationFailures() == 1, "validation failure not counted");
+
+  // a locked write set is visible to new readers
+  a.startIteration();
+  b.startIteration();
+  setThreadContext(&b);
+  acquire(&x, galois::MethodFlag::WRITE);
+  check(!conflicts([&] { b.cautiousPoint(); }), "writer aborted");
+  setThreadContext(&a);
+  check(conflicts([&] { acquire(&x, galois::MethodFlag::READ); }),
+        "read of a locked lockable");
+  a.cancelIteration();
+  b.commitIteration();
+
+  // the retry succeeds
+  a.startIteration();
+  acquire(&x, galois::MethodFlag::READ);
+  acquire(&y, galois::MethodFlag::WRITE);
+  check(!conflicts([&] { a.cautiousPoint(); }), "retry aborted");
+  check(a.commitIteration() == 1, "retry did not lock its write set");
+
+  // an aborted writer does not invalidate readers
+  a.startIteration();
+  b.startIteration();
+  setThreadContext(&a);
+  acquire(&x, galois::MethodFlag::READ);
+  setThreadContext(&b);
+  acquire(&x, galois::MethodFlag::WRITE);
+  check(!conflicts([&] { b.cautiousPoint(); }), "writer aborted");
+  check(b.cancelIteration() == 1, "writer did not lock its write set");
+  setThreadContext(&a);
+  check(!conflicts([&] { a.cautiousPoint(); }), "aborted write invalidated");
+  a.commitIteration();
+
+  // repeated acquires of one lockable still lock it once it is written
+  a.startIteration();
+  acquire(&x, galois::MethodFlag::READ);
+  acquire(&x, galois::MethodFlag::READ);
+  acquire(&x, galois::MethodFlag::WRITE);
+  acquire(&x, galois::MethodFlag::WRITE);
+  check(!conflicts([&] { a.cautiousPoint(); }), "repeated acquire aborted");
+  check(a.commitIteration() == 1, "repeated write not locked once");
+
+  // a walker aborts at its next acquire once something it read is locked,
+  // before it can follow a pointer out of the changing data
+  a.startIteration();
+  b.startIteration();
+  setThreadContext(&a);
+  acquire(&x, galois::MethodFlag::READ);
+  setThreadContext(&b);
+  acquire(&x, galois::MethodFlag::WRITE);
+  check(!conflicts([&] { b.cautiousPoint(); }), "writer aborted");
+  setThreadContext(&a);
+  check(conflicts([&] { acquire(&y, galois::MethodFlag::READ); }),
+        "walked past a locked read");
+  a.cancelIteration();
+  b.commitIteration();
+
+  setThreadContext(nullptr);
+
+  galois::SharedMemSys G;
+  const unsigned rounds = 50;
+
+  // for_each on a MorphGraph, with as many threads as the machine has
+  {
+    Graph g;
+    std::vector<GNode> nodes;
+    makeRing(g, nodes);
+    std::vector<unsigned> items;
+    for (unsigned r = 0; r < rounds; ++r)
+      for (unsigned i = 0; i < numNodes; ++i)
+        items.push_back(i);
+
+    galois::setActiveThreads(std::max(4U, std::thread::hardware_concurrency()));
+    galois::for_each(
+        galois::iterate(items),
+        [&](unsigned i, auto& ctx) {
+          rewire(g, nodes[i], [&] { ctx.cautiousPoint(); });
+        },
+        galois::optimistic_conflicts(), galois::loopname("Rewire"));
+    checkRing(g, nodes, rounds);
+  }
+
+  // the same operator oversubscribed on plain threads, so that walkers are
+  // preempted inside each other's rewiring even on a single core. rewire()
+  // does not allocate once the ring is built, so these threads stay out of
+  // the Galois per-thread heaps.
+  {
+    Graph g;
+    std::vector<GNode> nodes;
+    makeRing(g, nodes);
+    const unsigned numThreads = 8;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+      threads.emplace_back([&, t] {
+        SimpleRuntimeContext ctx(false, true);
+        setThreadContext(&ctx);
+        for (unsigned r = 0; r < rounds; ++r) {
+          for (unsigned i = t; i < numNodes; i += numThreads) {
+            for (;;) {
+              ctx.startIteration();
+              if (!conflicts([&] {
+                    rewire(g, nodes[i], [] { signalCautiousPoint(); });
+                  })) {
+                ctx.commitIteration();
+                break;
+              }
+              ctx.cancelIteration();
+            }
+          }
+        }
+        setThreadContext(nullptr);
+      });
+    }
+    for (auto& t : threads)
+      t.join();
+    checkRing(g, nodes, rounds);
+  }
+
+  return 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+
+#include "galois/Galois.h"
+#include "galois/Reduction.h"
+#include "galois/runtime/Context.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+struct Node : public galois::runtime::Lockable {
+  std::vector<int> log;
+};
+
+static const int numNodes = 97;
+static const int numItems = 4096;
+
+std::vector<Node> nodes(numNodes);
+
+struct Cmp {
+  bool operator()(int a, int b) const { return a < b; }
+};
+
+// Every initial item touches two nodes; items on a common node must execute
+// in order. Pushed items have empty neighborhoods, which keeps the algorithm
+// stable-source.
+struct NhFunc {
+  void operator()(int x, galois::UserContext<int>&) const {
+    if (x >= numItems)
+      return;
+    galois::runtime::acquire(&nodes[x % numNodes], galois::MethodFlag::WRITE);
+    galois::runtime::acquire(&nodes[(x / 7) % numNodes],
+                             galois::MethodFlag::WRITE);
+  }
+};
+
+struct OpFunc {
+  galois::GAccumulator<size_t>& count;
+
+  void operator()(int x, galois::UserContext<int>& ctx) const {
+    count += 1;
+    if (x >= numItems)
+      return;
+    nodes[x % numNodes].log.push_back(x);
+    if (x % numNodes != (x / 7) % numNodes)
+      nodes[(x / 7) % numNodes].log.push_back(x);
+    ctx.push(x + numItems);
+  }
+};
+
+struct OddStable {
+  bool operator()(int x) const { return x % 2 == 0 || x >= numItems; }
+};
+
+// Pushes that conflict: every item that is a multiple of 8 pushes the item 3
+// later, which touches nodes like any other item and precedes the items after
+// it in the same window. The items of [0, numItems) that are 3 modulo 8 are
+// only reached through pushes.
+struct PushNhFunc {
+  void operator()(int x, galois::UserContext<int>&) const {
+    galois::runtime::acquire(&nodes[x % numNodes], galois::MethodFlag::WRITE);
+    galois::runtime::acquire(&nodes[(x / 7) % numNodes],
+                             galois::MethodFlag::WRITE);
+  }
+};
+
+struct PushOpFunc {
+  galois::GAccumulator<size_t>& count;
+
+  void operator()(int x, galois::UserContext<int>& ctx) const {
+    count += 1;
+    nodes[x % numNodes].log.push_back(x);
+    if (x % numNodes != (x / 7) % numNodes)
+      nodes[(x / 7) % numNodes].log.push_back(x);
+    if (x % 8 == 0 && x + 3 < numItems)
+      ctx.push(x + 3);
+  }
+};
+
+using Logs = std::vector<std::vector<int>>;
+
+// Checks the per-node logs of the last run and moves them into logs
+static bool check(size_t count, Logs& logs, size_t expected = 2 * numItems) {
+  if (count != expected) {
+    std::cerr << "wrong number of iterations: " << count << "\n";
+    return false;
+  }
+  logs.clear();
+  for (Node& n : nodes) {
+    for (size_t i = 1; i < n.log.size(); ++i) {
+      if (n.log[i - 1] > n.log[i]) {
+        std::cerr << "out of order: " << n.log[i - 1] << " " << n.log[i]
+                  << "\n";
+        return false;
+      }
+    }
+    logs.push_back(std::move(n.log));
+    n.log.clear();
+  }
+  return true;
+}
+
+static bool sameLogs(const Logs& a, const Logs& b, const char* what) {
+  for (int i = 0; i < numNodes; ++i) {
+    if (a[i] != b[i]) {
+      std::cerr << what << ": logs of node " << i << " differ\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  galois::setActiveThreads(argc > 1 ? atoi(argv[1]) : 2);
+
+  std::vector<int> items;
+  for (int i = numItems - 1; i >= 0; --i)
+    items.push_back(i);
+
+  galois::GAccumulator<size_t> count;
+  Logs stableLogs;
+  galois::for_each_ordered(items.begin(), items.end(), Cmp(), NhFunc(),
+                           OpFunc{count}, "ordered-stable");
+  if (!check(count.reduce(), stableLogs))
+    return 1;
+
+  count.reset();
+  Logs unstableLogs;
+  galois::for_each_ordered(items.begin(), items.end(), Cmp(), NhFunc(),
+                           OpFunc{count}, OddStable(), "ordered-unstable");
+  if (!check(count.reduce(), unstableLogs))
+    return 1;
+
+  // The deterministic executor, with ids in priority order, must produce the
+  // same result on the same input
+  count.reset();
+  Logs detLogs;
+  auto detID = [](int x) -> uintptr_t { return x; };
+  galois::for_each(galois::iterate(items),
+                   [&](int x, galois::UserContext<int>& ctx) {
+                     NhFunc()(x, ctx);
+                     ctx.cautiousPoint();
+                     OpFunc{count}(x, ctx);
+                   },
+                   galois::wl<galois::worklists::Deterministic<>>(),
+                   galois::det_id<decltype(detID)>(detID),
+                   galois::loopname("deterministic"));
+  if (!check(count.reduce(), detLogs))
+    return 1;
+
+  if (!sameLogs(stableLogs, detLogs, "ordered-stable vs deterministic") ||
+      !sameLogs(unstableLogs, detLogs, "ordered-unstable vs deterministic"))
+    return 1;
+
+  // Pushes that precede and conflict with items of their own window. The
+  // deterministic executor runs pushed items in later rounds rather than in
+  // priority order, so the reference is the serial order: every item of
+  // [0, numItems) once, ascending. Held-back pushes are only guaranteed to
+  // reach an item before it runs when the window is executed in order, i.e.,
+  // on one thread; with more, such a loop needs a stability test.
+  std::vector<int> pushItems;
+  for (int i = numItems - 1; i >= 0; --i)
+    if (i % 8 != 3)
+      pushItems.push_back(i);
+
+  Logs serialLogs(numNodes);
+  for (int x = 0; x < numItems; ++x) {
+    serialLogs[x % numNodes].push_back(x);
+    if (x % numNodes != (x / 7) % numNodes)
+      serialLogs[(x / 7) % numNodes].push_back(x);
+  }
+
+  unsigned threads = galois::getActiveThreads();
+  galois::setActiveThreads(1);
+  count.reset();
+  Logs pushLogs;
+  galois::for_each_ordered(pushItems.begin(), pushItems.end(), Cmp(),
+                           PushNhFunc(), PushOpFunc{count}, "ordered-push");
+  galois::setActiveThreads(threads);
+  if (!check(count.reduce(), pushLogs, numItems) ||
+      !sameLogs(pushLogs, serialLogs, "ordered-push vs serial"))
+    return 1;
+
+  return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Reduction.h"
+#include "galois/runtime/Timeline.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//! Number of complete ("X") events named name in a trace
+size_t countSpans(const std::string& trace, const std::string& name) {
+  std::string key = "{\"ph\":\"X\",\"name\":\"" + name + "\"";
+  size_t count    = 0;
+  for (size_t pos = trace.find(key); pos != std::string::npos;
+       pos        = trace.find(key, pos + 1))
+    ++count;
+  return count;
+}
+
+int main() {
+  // must be set before the first traced loop reads it
+  setenv("GALOIS_TIMELINE", "timeline-test.json", 1);
+
+  {
+    galois::SharedMemSys Galois_runtime;
+    galois::setActiveThreads(2);
+
+    GALOIS_ASSERT(galois::runtime::internal::timelineEnabled());
+
+    galois::GAccumulator<unsigned> sum;
+    for (unsigned r = 0; r < 3; ++r) {
+      // the loop name is a temporary, as in the distributed apps
+      std::string name = "steal-loop";
+      galois::do_all(
+          galois::iterate(0U, 1000U), [&](unsigned i) { sum += i; },
+          galois::steal(), galois::loopname(name.c_str()));
+    }
+    galois::do_all(
+        galois::iterate(0U, 1000U), [&](unsigned i) { sum += i; },
+        galois::loopname("plain-loop"));
+    galois::do_all(galois::iterate(0U, 1000U), [&](unsigned i) { sum += i; });
+    std::vector<unsigned> roots{10U};
+    galois::for_each(
+        galois::iterate(roots),
+        [&](unsigned i, auto& ctx) {
+          if (i)
+            ctx.push(i - 1);
+        },
+        galois::loopname("push-loop"));
+    galois::on_each([&](unsigned, unsigned) { sum += 1; },
+                    galois::loopname("each-loop"));
+
+    std::ostringstream out;
+    galois::runtime::timelineWriteTrace(out, {});
+    std::string trace = out.str();
+
+    unsigned numT = galois::getActiveThreads();
+    GALOIS_ASSERT(countSpans(trace, "steal-loop") == 3 * numT);
+    GALOIS_ASSERT(countSpans(trace, "steal") >= 3 * numT);
+    GALOIS_ASSERT(countSpans(trace, "plain-loop") == numT);
+    GALOIS_ASSERT(countSpans(trace, "push-loop") == numT);
+    GALOIS_ASSERT(countSpans(trace, "each-loop") == numT);
+    // unnamed loops are not traced
+    GALOIS_ASSERT(countSpans(trace, "(NULL)") == 0);
+    GALOIS_ASSERT(trace.find("\"process_name\"") != std::string::npos);
+    GALOIS_ASSERT(trace.back() == '\n' && trace[trace.size() - 2] == '}');
+  }
+
+  // the trace is written when the runtime shuts down
+  GALOIS_ASSERT(std::remove("timeline-test.json") == 0);
+
+  return 0;
+}
@@ -18,8 +18,12 @@
  */
 
 #include "galois/Galois.h"
+#include "galois/Endian.h"
 #include "galois/LargeArray.h"
+#include "galois/Reduction.h"
 #include "galois/graphs/FileGraph.h"
+#include "galois/graphs/LC_Compressed_CSR_Graph.h"
+#include "galois/graphs/Util.h"
 
 #include "llvm/Support/CommandLine.h"
 
@@ -29,12 +33,17 @@
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <numeric>
 #include <stdint.h>
 #include <vector>
 #include <random>
 
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <cstdlib>
+#include <cstring>
 
 // TODO: move these enums to a common location for all graph convert tools
 enum ConvertMode {
@@ -75,6 +84,7 @@ enum ConvertMode {
   gr2treegr,
   gr2trigr,
   gr2totem,
+  gr2vgr,
   mtx2gr,
   nodelist2gr,
   pbbs2gr,
@@ -172,6 +182,7 @@ static cll::opt<ConvertMode> convertMode(
         clEnumVal(gr2trigr, "Convert symmetric binary gr to triangular form by "
                             "removing reverse edges"),
         clEnumVal(gr2totem, "Convert binary gr totem input format"),
+        clEnumVal(gr2vgr, "Convert binary gr to varint-compressed gr"),
         clEnumVal(mtx2gr, "Convert matrix market format to binary gr"),
         clEnumVal(nodelist2gr, "Convert node list to binary gr"),
         clEnumVal(pbbs2gr, "Convert pbbs graph to binary gr"),
@@ -196,6 +207,20 @@ static cll::opt<int>
              cll::init(1));
 static cll::opt<int> maxDegree("maxDegree", cll::desc("maximum degree to keep"),
                                cll::init(2 * 1024));
+static cll::opt<unsigned int>
+    numThreads("t", cll::desc("Number of threads (default all for parallel "
+                              "text ingestion, 1 otherwise)"),
+               cll::init(0));
+static cll::opt<bool> parallelIngest(
+    "parallelIngest",
+    cll::desc("Parse text inputs of edgelist2gr, dimacs2gr, mtx2gr and "
+              "nodelist2gr in parallel from a memory mapping (default true)"),
+    cll::init(true));
+static cll::opt<unsigned int> ingestMemoryMB(
+    "ingestMemoryMB",
+    cll::desc("Memory budget in MB for parallel text ingestion; larger graphs "
+              "are built in node buckets (default half of physical memory)"),
+    cll::init(0));
 
 struct Conversion {};
 struct HasOnlyVoidSpecialization {};
@@ -329,6 +354,575 @@ void outputPermutation(const T& perm) {
   }
 }
 
+/**
+ * Read-only mapping of a text input. The parallel parsers below never copy
+ * the text, so inputs larger than memory stream through the page cache.
+ */
+class MappedText {
+  int fd;
+  char* base;
+  size_t length;
+
+public:
+  explicit MappedText(const std::string& filename)
+      : fd(-1), base(nullptr), length(0) {
+    fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      GALOIS_SYS_DIE("failed opening ", "'", filename, "'");
+
+    struct stat buf;
+    if (fstat(fd, &buf) < 0)
+      GALOIS_SYS_DIE("failed reading ", "'", filename, "'");
+    length = buf.st_size;
+
+    if (length) {
+      void* m = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (m == MAP_FAILED)
+        GALOIS_SYS_DIE("failed mapping ", "'", filename, "'");
+      base = static_cast<char*>(m);
+      madvise(base, length, MADV_SEQUENTIAL);
+    }
+  }
+
+  ~MappedText() {
+    if (base)
+      munmap(base, length);
+    if (fd >= 0)
+      close(fd);
+  }
+
+  const char* begin() const { return base; }
+  const char* end() const { return base + length; }
+  size_t size() const { return length; }
+};
+
+static inline bool isDigitChar(char c) {
+  return static_cast<unsigned char>(c - '0') < 10;
+}
+
+static inline bool isBlankChar(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline const char* skipBlanks(const char* p, const char* end) {
+  while (p != end && isBlankChar(*p))
+    ++p;
+  return p;
+}
+
+//! Advances p to the start of the next line
+static inline const char* nextLine(const char* p, const char* end) {
+  const char* nl =
+      static_cast<const char*>(std::memchr(p, '\n', end - p));
+  return nl ? nl + 1 : end;
+}
+
+//! True if all 8 bytes of v (little-endian load) are ASCII digits
+static inline bool hasEightDigits(uint64_t v) {
+  return ((v & 0xF0F0F0F0F0F0F0F0ull) |
+          (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) ==
+         0x3333333333333333ull;
+}
+
+//! Value of the 8 ASCII digits in v (little-endian load), combined in SWAR
+static inline uint64_t eightDigitsValue(uint64_t v) {
+  v = ((v & 0x0F0F0F0F0F0F0F0Full) * 2561) >> 8;
+  v = ((v & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+  return ((v & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32;
+}
+
+/**
+ * Parses an unsigned decimal after optional blanks. Runs of eight digits are
+ * converted with a single SWAR step instead of one multiply per digit.
+ */
+static inline bool parseUnsigned(const char*& p, const char* end,
+                                 uint64_t& out) {
+  p = skipBlanks(p, end);
+  if (p == end || !isDigitChar(*p))
+    return false;
+
+  uint64_t v = 0;
+  while (end - p >= 8) {
+    uint64_t chunk;
+    std::memcpy(&chunk, p, sizeof(chunk));
+    chunk = galois::convert_le64toh(chunk);
+    if (!hasEightDigits(chunk))
+      break;
+    v = v * 100000000ull + eightDigitsValue(chunk);
+    p += 8;
+  }
+  for (; p != end && isDigitChar(*p); ++p)
+    v = v * 10 + (*p - '0');
+
+  out = v;
+  return true;
+}
+
+template <typename T>
+static inline bool
+parseValue(const char*& p, const char* end, T& out,
+           typename std::enable_if<std::is_integral<T>::value>::type* = 0) {
+  p        = skipBlanks(p, end);
+  bool neg = p != end && *p == '-';
+  if (p != end && (*p == '-' || *p == '+'))
+    ++p;
+  uint64_t v;
+  if (!parseUnsigned(p, end, v))
+    return false;
+  out = static_cast<T>(neg ? -static_cast<int64_t>(v) : static_cast<int64_t>(v));
+  return true;
+}
+
+template <typename T>
+static inline bool
+parseValue(const char*& p, const char* end, T& out,
+           typename std::enable_if<!std::is_integral<T>::value>::type* = 0) {
+  // Real values are rare in graph inputs; copy the token so strtod cannot run
+  // past the end of the mapping and rounding matches the serial parser.
+  p                 = skipBlanks(p, end);
+  const char* begin = p;
+  while (p != end && !isBlankChar(*p) && *p != '\n')
+    ++p;
+  char buf[64];
+  size_t len = std::min<size_t>(p - begin, sizeof(buf) - 1);
+  std::memcpy(buf, begin, len);
+  buf[len] = '\0';
+  char* parsed;
+  double v = std::strtod(buf, &parsed);
+  if (parsed == buf)
+    return false;
+  out = static_cast<T>(v);
+  return true;
+}
+
+/**
+ * Text formats for the parallel parser. Each format consumes its header with
+ * parseHeader and then parses one line at a time with parseLine, calling
+ * fn(src, dst, value) for every edge on that line (0-indexed ids). Formats
+ * without a node count in their header also provide scanLine, which raises
+ * maxId to the largest id that the serial converter counts as a node.
+ */
+
+//! <src> <dst> <value>?, 0-indexed; lines not starting with a number are
+//! skipped
+struct EdgelistText {
+  static constexpr bool knowsNodes = false;
+  uint64_t numNodes = 0;
+  uint64_t numEdges = 0;
+
+  const char* parseHeader(const char* begin, const char* end) { return begin; }
+
+  template <bool HasValue, typename V, typename Fn>
+  void parseLine(const char*& p, const char* end, Fn& fn) const {
+    uint64_t src, dst;
+    V value{};
+    if (parseUnsigned(p, end, src)) {
+      if (!parseUnsigned(p, end, dst) ||
+          (HasValue && !parseValue(p, end, value))) {
+        GALOIS_DIE("malformed edge list line for source ", src);
+      }
+      fn(src, dst, value);
+    }
+    p = nextLine(p, end);
+  }
+
+  template <bool HasValue, typename V>
+  void scanLine(const char*& p, const char* end, uint64_t& maxId) const {
+    auto fn = [&](uint64_t src, uint64_t dst, const V&) {
+      maxId = std::max(maxId, std::max(src, dst));
+    };
+    parseLine<HasValue, V>(p, end, fn);
+  }
+};
+
+//! DIMACS: 'p' line with node and edge counts, then a <src> <dst> <weight>,
+//! 1-indexed
+struct DimacsText {
+  static constexpr bool knowsNodes = true;
+  uint64_t numNodes = 0;
+  uint64_t numEdges = 0;
+
+  const char* parseHeader(const char* begin, const char* end) {
+    for (const char* p = begin; p != end; p = nextLine(p, end)) {
+      if (*p != 'p')
+        continue;
+      // p <problem> <num nodes> <num edges>
+      const char* q = nextLine(p, end);
+      std::istringstream line(std::string(p, q));
+      std::vector<std::string> tokens;
+      std::string tmp;
+      while (line >> tmp)
+        tokens.push_back(tmp);
+      if (tokens.size() < 3)
+        GALOIS_DIE("Unknown problem specification line: ", std::string(p, q));
+      numNodes = strtoull(tokens[tokens.size() - 2].c_str(), NULL, 0);
+      numEdges = strtoull(tokens[tokens.size() - 1].c_str(), NULL, 0);
+      return q;
+    }
+    GALOIS_DIE("Missing problem specification line");
+    return end;
+  }
+
+  template <bool HasValue, typename V, typename Fn>
+  void parseLine(const char*& p, const char* end, Fn& fn) const {
+    const char* q = skipBlanks(p, end);
+    if (q != end && *q == 'a') {
+      ++q;
+      uint64_t src, dst;
+      int32_t weight;
+      if (!parseUnsigned(q, end, src) || !parseUnsigned(q, end, dst) ||
+          !parseValue(q, end, weight)) {
+        GALOIS_DIE("malformed arc line");
+      }
+      if (src == 0 || src > numNodes)
+        GALOIS_DIE("Error: node id out of range: ", src);
+      if (dst == 0 || dst > numNodes)
+        GALOIS_DIE("Error: neighbor id out of range: ", dst);
+      fn(src - 1, dst - 1, static_cast<V>(weight));
+    }
+    p = nextLine(q, end);
+  }
+};
+
+//! Matrix Market: '%' comments, <rows> <cols> <nnz>, then <src> <dst>
+//! <value>?, 1-indexed
+struct MtxText {
+  static constexpr bool knowsNodes = true;
+  uint64_t numNodes = 0;
+  uint64_t numEdges = 0;
+
+  //! Same checks as the serial converter: the size line has exactly three
+  //! tokens, and nothing may follow the last edge line
+  const char* parseHeader(const char* begin, const char* end) {
+    const char* p = begin;
+    while (p != end && *p == '%')
+      p = nextLine(p, end);
+    const char* q = nextLine(p, end);
+    std::istringstream line(std::string(p, q));
+    std::vector<std::string> tokens;
+    std::string tmp;
+    while (line >> tmp)
+      tokens.push_back(tmp);
+    if (tokens.size() != 3)
+      GALOIS_DIE("Unknown problem specification line: ", std::string(p, q));
+    numNodes = strtoull(tokens[0].c_str(), NULL, 0);
+    numEdges = strtoull(tokens[2].c_str(), NULL, 0);
+
+    const char* last = end;
+    if (last != q && last[-1] == '\n')
+      --last;
+    const char* lastLine = last;
+    while (lastLine != q && lastLine[-1] != '\n')
+      --lastLine;
+    const char* e = lastLine;
+    uint64_t id;
+    if (numEdges ? !parseUnsigned(e, last, id) : end != q)
+      GALOIS_DIE("Error: additional lines in file");
+    return q;
+  }
+
+  template <bool HasValue, typename V, typename Fn>
+  void parseLine(const char*& p, const char* end, Fn& fn) const {
+    uint64_t src, dst;
+    if (parseUnsigned(p, end, src)) {
+      double weight = 1;
+      if (!parseUnsigned(p, end, dst))
+        GALOIS_DIE("malformed matrix market line for row ", src);
+      parseValue(p, end, weight);
+      if (src == 0 || src > numNodes)
+        GALOIS_DIE("Error: node id out of range: ", src);
+      if (dst == 0 || dst > numNodes)
+        GALOIS_DIE("Error: neighbor id out of range: ", dst);
+      fn(src - 1, dst - 1, static_cast<V>(weight));
+    } else if (p != end && *p != '\n') {
+      // the serial reader skips blank lines but fails on anything else
+      GALOIS_DIE("Error: node id out of range: 0");
+    }
+    p = nextLine(p, end);
+  }
+};
+
+//! <node id> <num neighbors> <neighbor id>* on one line, 0-indexed
+struct NodelistText {
+  static constexpr bool knowsNodes = false;
+  uint64_t numNodes = 0;
+  uint64_t numEdges = 0;
+
+  const char* parseHeader(const char* begin, const char* end) { return begin; }
+
+  template <bool HasValue, typename V, typename Fn>
+  void parseLine(const char*& p, const char* end, Fn& fn) const {
+    uint64_t src, numNeighbors;
+    if (parseUnsigned(p, end, src) && parseUnsigned(p, end, numNeighbors)) {
+      for (; numNeighbors; --numNeighbors) {
+        uint64_t dst;
+        if (!parseUnsigned(p, end, dst))
+          GALOIS_DIE("missing neighbors on node list line for ", src);
+        fn(src, dst, V{});
+      }
+    }
+    p = nextLine(p, end);
+  }
+
+  //! Nodes are counted by their own ids only, including nodes without
+  //! neighbors, as in the serial converter
+  template <bool HasValue, typename V>
+  void scanLine(const char*& p, const char* end, uint64_t& maxId) const {
+    uint64_t src, numNeighbors;
+    if (parseUnsigned(p, end, src) && parseUnsigned(p, end, numNeighbors))
+      maxId = std::max(maxId, src);
+    p = nextLine(p, end);
+  }
+};
+
+//! Splits [begin, end) into n pieces that start at line boundaries
+static std::vector<const char*> splitAtLines(const char* begin,
+                                             const char* end, unsigned n) {
+  std::vector<const char*> bounds(n + 1);
+  bounds[0] = begin;
+  bounds[n] = end;
+  for (unsigned i = 1; i < n; ++i) {
+    const char* p = begin + (end - begin) * i / n;
+    p             = std::max(p, bounds[i - 1]);
+    bounds[i]     = (p == begin) ? p : nextLine(p - 1, end);
+  }
+  return bounds;
+}
+
+static void writeFully(int fd, const void* buf, size_t bytes, off_t offset) {
+  const char* p = static_cast<const char*>(buf);
+  while (bytes) {
+    ssize_t w = pwrite(fd, p, bytes, offset);
+    if (w < 0)
+      GALOIS_SYS_DIE("failed writing output graph");
+    p += w;
+    offset += w;
+    bytes -= w;
+  }
+}
+
+static void reportThroughput(const char* phase, size_t bytes,
+                             const galois::Timer& t) {
+  double secs = std::max(t.get_usec(), 1ul) / 1e6;
+  std::cout << phase << ": " << bytes / secs / (1024 * 1024) << " MB/s ("
+            << secs << " s)\n";
+}
+
+//! Largest node id on the lines in [p, stop), for formats without a header
+template <bool HasValue, typename V, typename Format>
+uint64_t scanMaxId(const Format& format, const char* p, const char* stop,
+                   const char* end, std::false_type) {
+  uint64_t maxId = 0;
+  while (p < stop)
+    format.template scanLine<HasValue, V>(p, end, maxId);
+  return maxId;
+}
+
+//! Formats with a header already know their node count
+template <bool HasValue, typename V, typename Format>
+uint64_t scanMaxId(const Format&, const char*, const char*, const char*,
+                   std::true_type) {
+  return 0;
+}
+
+/**
+ * Parallel text to gr conversion. The mapped input is split at line
+ * boundaries, one piece per thread. Degrees are counted in per-thread
+ * histograms (or shared atomic counters when the histograms would not fit in
+ * the memory budget), and edges are scattered directly into their CSR slots.
+ * With per-thread histograms, neighbors keep their input order, so the output
+ * matches the serial converter.
+ *
+ * If the edge arrays exceed the memory budget, nodes are split into buckets
+ * that each fit and the input is scanned once per bucket, writing that slice
+ * of the output file.
+ *
+ * Returns false if the graph needs the 64-bit gr format, which is left to the
+ * serial converter.
+ */
+template <typename EdgeTy, typename Format>
+bool parallelTextToGr(Format& format, const std::string& infilename,
+                      const std::string& outfilename) {
+  constexpr bool HasValue = !std::is_void<EdgeTy>::value;
+  typedef typename std::conditional<HasValue, EdgeTy, char>::type ValueTy;
+  const size_t sizeofValue = HasValue ? sizeof(ValueTy) : 0;
+
+  MappedText text(infilename);
+  const char* body = format.parseHeader(text.begin(), text.end());
+
+  const unsigned numT = galois::getActiveThreads();
+  auto bounds         = splitAtLines(body, text.end(), numT);
+
+  auto forEachEdge = [&](unsigned tid, auto fn) {
+    const char* p = bounds[tid];
+    while (p < bounds[tid + 1])
+      format.template parseLine<HasValue, ValueTy>(p, text.end(), fn);
+  };
+
+  size_t budget = ingestMemoryMB
+                      ? static_cast<size_t>(ingestMemoryMB) * 1024 * 1024
+                      : static_cast<size_t>(sysconf(_SC_PHYS_PAGES)) *
+                            sysconf(_SC_PAGESIZE) / 2;
+
+  // Phase 0: find the number of nodes if the format has no header
+  if (!Format::knowsNodes) {
+    galois::Timer scanTime;
+    scanTime.start();
+    galois::GReduceMax<uint64_t> maxId;
+    galois::on_each([&](unsigned tid, unsigned) {
+      maxId.update(scanMaxId<HasValue, ValueTy>(
+          format, bounds[tid], bounds[tid + 1], text.end(),
+          std::integral_constant<bool, Format::knowsNodes>()));
+    });
+    format.numNodes = maxId.reduce() + 1;
+    scanTime.stop();
+    reportThroughput("Scan", text.size(), scanTime);
+  }
+
+  const uint64_t numNodes = format.numNodes;
+  if (numNodes > std::numeric_limits<uint32_t>::max())
+    return false;
+
+  // Phase 1: degrees
+  galois::Timer degreeTime;
+  degreeTime.start();
+  const bool perThread =
+      numT == 1 || numT * numNodes * sizeof(uint64_t) <= budget / 2;
+  std::vector<galois::LargeArray<uint64_t>> cursors(perThread ? numT : 1);
+  if (perThread) {
+    galois::on_each([&](unsigned tid, unsigned) {
+      cursors[tid].allocateLocal(numNodes);
+      std::fill(cursors[tid].begin(), cursors[tid].end(), 0);
+    });
+  } else {
+    cursors[0].allocateInterleaved(numNodes);
+    galois::do_all(galois::iterate(0ul, numNodes),
+                   [&](uint64_t n) { cursors[0][n] = 0; });
+  }
+
+  galois::GAccumulator<uint64_t> edgeCount;
+  galois::on_each([&](unsigned tid, unsigned) {
+    uint64_t local = 0;
+    if (perThread) {
+      auto& hist = cursors[tid];
+      forEachEdge(tid, [&](uint64_t src, uint64_t, const ValueTy&) {
+        ++hist[src];
+        ++local;
+      });
+    } else {
+      auto& hist = cursors[0];
+      forEachEdge(tid, [&](uint64_t src, uint64_t, const ValueTy&) {
+        __atomic_fetch_add(&hist[src], 1, __ATOMIC_RELAXED);
+        ++local;
+      });
+    }
+    edgeCount += local;
+  });
+  const uint64_t numEdges = edgeCount.reduce();
+  if (Format::knowsNodes && numEdges != format.numEdges)
+    GALOIS_DIE("Error: expected ", format.numEdges, " edges but found ",
+               numEdges);
+
+  // Degrees to CSR offsets; histogram entries become per-thread cursors
+  galois::LargeArray<uint64_t> outIdx;
+  outIdx.allocateInterleaved(numNodes);
+  galois::do_all(galois::iterate(0ul, numNodes), [&](uint64_t n) {
+    uint64_t d = 0;
+    for (auto& hist : cursors)
+      d += hist[n];
+    outIdx[n] = d;
+  });
+  std::partial_sum(outIdx.begin(), outIdx.end(), outIdx.begin());
+  galois::do_all(galois::iterate(0ul, numNodes), [&](uint64_t n) {
+    uint64_t run = n ? outIdx[n - 1] : 0;
+    for (auto& hist : cursors) {
+      uint64_t c = hist[n];
+      hist[n]    = run;
+      run += c;
+    }
+  });
+  degreeTime.stop();
+  reportThroughput("Degree", text.size(), degreeTime);
+
+  // Output layout (version 1): header, offsets, destinations, padding, data
+  int fd = open(outfilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    GALOIS_SYS_DIE("failed opening ", "'", outfilename, "'");
+  const off_t dstBase  = sizeof(uint64_t) * (4 + numNodes);
+  const off_t dataBase = dstBase + sizeof(uint32_t) * (numEdges + numEdges % 2);
+
+  uint64_t header[4] = {
+      galois::convert_htole64(1), galois::convert_htole64(sizeofValue),
+      galois::convert_htole64(numNodes), galois::convert_htole64(numEdges)};
+  writeFully(fd, header, sizeof(header), 0);
+  {
+    galois::LargeArray<uint64_t> leIdx;
+    leIdx.allocateInterleaved(numNodes);
+    galois::do_all(galois::iterate(0ul, numNodes), [&](uint64_t n) {
+      leIdx[n] = galois::convert_htole64(outIdx[n]);
+    });
+    writeFully(fd, leIdx.data(), sizeof(uint64_t) * numNodes,
+               sizeof(header));
+  }
+  if (ftruncate(fd, dataBase + sizeofValue * numEdges) < 0)
+    GALOIS_SYS_DIE("failed sizing output graph");
+
+  // Phase 2: scatter edges, one pass over the input per bucket of nodes
+  galois::Timer scatterTime;
+  scatterTime.start();
+  const uint64_t bucketEdges =
+      std::max<uint64_t>(1, budget / (sizeof(uint32_t) + sizeofValue));
+  unsigned numBuckets = 0;
+  for (uint64_t lo = 0; lo < numNodes; ++numBuckets) {
+    uint64_t eLo = lo ? outIdx[lo - 1] : 0;
+    uint64_t hi  = std::upper_bound(outIdx.begin() + lo, outIdx.end(),
+                                   eLo + bucketEdges) -
+                  outIdx.begin();
+    hi           = std::max(hi, lo + 1);
+    uint64_t eHi = outIdx[hi - 1];
+
+    galois::LargeArray<uint32_t> dsts;
+    galois::LargeArray<ValueTy> values;
+    dsts.allocateInterleaved(eHi - eLo);
+    if (HasValue)
+      values.allocateInterleaved(eHi - eLo);
+
+    galois::on_each([&](unsigned tid, unsigned) {
+      auto& cursor = cursors[perThread ? tid : 0];
+      forEachEdge(tid, [&](uint64_t src, uint64_t dst, const ValueTy& v) {
+        if (src < lo || src >= hi)
+          return;
+        uint64_t pos = perThread
+                           ? cursor[src]++
+                           : __atomic_fetch_add(&cursor[src], 1,
+                                                __ATOMIC_RELAXED);
+        dsts[pos - eLo] = galois::convert_htole32(static_cast<uint32_t>(dst));
+        // edge data stays in host order, as FileGraph::fromArrays writes it
+        // and FileGraph::getEdgeData reads it
+        if (HasValue)
+          values[pos - eLo] = v;
+      });
+    });
+
+    writeFully(fd, dsts.data(), sizeof(uint32_t) * (eHi - eLo),
+               dstBase + sizeof(uint32_t) * eLo);
+    if (HasValue)
+      writeFully(fd, values.data(), sizeofValue * (eHi - eLo),
+                 dataBase + sizeofValue * eLo);
+    lo = hi;
+  }
+  scatterTime.stop();
+  reportThroughput("Scatter", text.size() * std::max(numBuckets, 1u),
+                   scatterTime);
+  if (numBuckets > 1)
+    std::cout << "Graph exceeds memory budget; built in " << numBuckets
+              << " buckets\n";
+
+  close(fd);
+  printStatus(numNodes, numEdges);
+  return true;
+}
+
 /**
  * Just a bunch of pairs or triples:
  * src dst weight?
@@ -340,6 +934,12 @@ struct Edgelist2Gr : public Conversion {
     typedef galois::LargeArray<EdgeTy> EdgeData;
     typedef typename EdgeData::value_type edge_value_type;
 
+    EdgelistText format;
+    if (parallelIngest &&
+        parallelTextToGr<EdgeTy>(format, infilename, outfilename)) {
+      return;
+    }
+
     Writer p;
     EdgeData edgeData;
     std::ifstream infile(infilename.c_str());
@@ -489,6 +1089,12 @@ struct Mtx2Gr : public HasNoVoidSpecialization {
     typedef galois::LargeArray<EdgeTy> EdgeData;
     typedef typename EdgeData::value_type edge_value_type;
 
+    MtxText format;
+    if (parallelIngest &&
+        parallelTextToGr<EdgeTy>(format, infilename, outfilename)) {
+      return;
+    }
+
     Writer p;
     EdgeData edgeData;
     uint32_t nnodes;
@@ -621,6 +1227,12 @@ struct Nodelist2Gr : public HasOnlyVoidSpecialization {
                   "conversion undefined for non-void graphs");
     typedef galois::graphs::FileGraphWriter Writer;
 
+    NodelistText format;
+    if (parallelIngest &&
+        parallelTextToGr<EdgeTy>(format, infilename, outfilename)) {
+      return;
+    }
+
     Writer p;
     std::ifstream infile(infilename.c_str());
 
@@ -1801,6 +2413,31 @@ struct WeightLess {
   }
 };
 
+/**
+ * Compresses the adjacency lists of a graph (see LC_Compressed_CSR_Graph).
+ */
+struct Gr2Vgr : public Conversion {
+  template <typename EdgeTy>
+  void convert(const std::string& infilename, const std::string& outfilename) {
+    typedef typename galois::graphs::LC_Compressed_CSR_Graph<
+        void, EdgeTy>::template with_no_lockable<true>::type Graph;
+
+    galois::graphs::FileGraph in;
+    in.fromFile(infilename);
+
+    Graph graph;
+    galois::graphs::readGraph(graph, in);
+    graph.toFile(outfilename);
+
+    size_t rawBytes = graph.sizeEdges() * sizeof(uint32_t);
+    std::cout << "Edge destinations: " << rawBytes << " bytes -> "
+              << graph.sizeEdgeBytes() << " bytes ("
+              << (rawBytes ? 100.0 * graph.sizeEdgeBytes() / rawBytes : 0)
+              << "%)\n";
+    printStatus(graph.size(), graph.sizeEdges());
+  }
+};
+
 /**
  * Removes self and multi-edges from a graph.
  */
@@ -2039,6 +2676,12 @@ struct Dimacs2Gr : public HasNoVoidSpecialization {
     typedef galois::LargeArray<EdgeTy> EdgeData;
     typedef typename EdgeData::value_type edge_value_type;
 
+    DimacsText format;
+    if (parallelIngest &&
+        parallelTextToGr<EdgeTy>(format, infilename, outfilename)) {
+      return;
+    }
+
     Writer p;
     EdgeData edgeData;
     uint32_t nnodes;
@@ -2765,6 +3408,13 @@ int main(int argc, char** argv) {
   galois::SharedMemSys G;
   llvm::cl::ParseCommandLineOptions(argc, argv);
   std::ios_base::sync_with_stdio(false);
+  if (numThreads) {
+    galois::setActiveThreads(numThreads);
+  } else if (parallelIngest &&
+             (convertMode == edgelist2gr || convertMode == dimacs2gr ||
+              convertMode == mtx2gr || convertMode == nodelist2gr)) {
+    galois::setActiveThreads(~0u);
+  }
   switch (convertMode) {
   case bipartitegr2bigpetsc:
     convert<Bipartitegr2Petsc<double, false>>();
@@ -2877,6 +3527,9 @@ int main(int argc, char** argv) {
   case gr2totem:
     convert<Gr2Totem<IdLess>>();
     break;
+  case gr2vgr:
+    convert<Gr2Vgr>();
+    break;
   case mtx2gr:
     convert<Mtx2Gr>();
     break;
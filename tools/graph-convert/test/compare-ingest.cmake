@@ -0,0 +1,57 @@
+# Converts the small inputs in this directory with both the parallel and the
+# serial text parsers of graph-convert and checks that the .gr files are
+# byte-identical, and that malformed inputs are rejected by both.
+#
+# Expects GRAPH_CONVERT (the graph-convert binary), INPUT_DIR (this
+# directory) and WORK_DIR (a scratch directory).
+
+function(convert result mode edgeType input output parallel)
+  execute_process(
+    COMMAND ${GRAPH_CONVERT} -${mode} -edgeType=${edgeType} -t=2
+            -parallelIngest=${parallel} ${INPUT_DIR}/${input} ${output}
+    RESULT_VARIABLE rc OUTPUT_QUIET ERROR_QUIET)
+  set(${result} ${rc} PARENT_SCOPE)
+endfunction()
+
+function(compare mode edgeType input)
+  set(par "${WORK_DIR}/${input}.${edgeType}.parallel.gr")
+  set(ser "${WORK_DIR}/${input}.${edgeType}.serial.gr")
+  convert(rc ${mode} ${edgeType} ${input} ${par} true)
+  if(NOT rc EQUAL 0)
+    message(FATAL_ERROR "parallel ${mode} failed on ${input}")
+  endif()
+  convert(rc ${mode} ${edgeType} ${input} ${ser} false)
+  if(NOT rc EQUAL 0)
+    message(FATAL_ERROR "serial ${mode} failed on ${input}")
+  endif()
+  execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${par} ${ser}
+                  RESULT_VARIABLE rc)
+  if(NOT rc EQUAL 0)
+    message(FATAL_ERROR "${mode} -edgeType=${edgeType} on ${input}: "
+                        "parallel and serial outputs differ")
+  endif()
+endfunction()
+
+function(reject mode edgeType input)
+  foreach(parallel true false)
+    convert(rc ${mode} ${edgeType} ${input} "${WORK_DIR}/${input}.gr"
+            ${parallel})
+    if(rc EQUAL 0)
+      message(FATAL_ERROR "${mode} -parallelIngest=${parallel} accepted "
+                          "malformed ${input}")
+    endif()
+  endforeach()
+endfunction()
+
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+compare(edgelist2gr void unweighted.el)
+compare(edgelist2gr int32 small.el)
+compare(edgelist2gr uint64 small.el)
+compare(mtx2gr float32 small.mtx)
+compare(mtx2gr float64 small.mtx)
+compare(dimacs2gr int32 small.dimacs)
+compare(nodelist2gr void small.nodelist)
+
+reject(mtx2gr float32 trailing.mtx)
+reject(mtx2gr float32 header.mtx)
@@ -0,0 +1,9 @@
+0 3 7
+2 1 -4
+0 1 12
+3 0 5
+1 5 2
+2 1 9
+0 3 1
+4 2 100000003
+1 4 8
@@ -0,0 +1,9 @@
+0 3
+2 1
+0 1
+3 0
+1 5
+2 1
+0 3
+4 2
+1 4